@@ -0,0 +1,150 @@
+/*===========================================================================*/
+/// \file mod_audio.cpp
+///
+/// \brief
+///    Module for playing the adhan when a prayer is due
+///
+/// \details
+///    The task runs below the display and BLE tasks: decoding a block takes a fraction of its playing time and the
+///    task sleeps in the I2S driver the rest of it, so the other tasks keep the CPU during playback
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <mod_audio.h>
+#include <svc_audio_i2s.h>
+#include <svc_event.h>
+#include <svc_cli.h>
+#include <svc_log.h>
+#include <svc_power.h>
+#include <svc_trace.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define MOD_AUDIO_EVENT_QUEUE_SIZE 2
+#define MOD_AUDIO_PARTITION "adhan"
+
+// External codec pins, the internal DAC on GPIO25 is used when they are not given
+#ifndef MOD_AUDIO_I2S_BCLK
+#define MOD_AUDIO_I2S_BCLK SVC_AUDIO_I2S_BUILTIN_DAC
+#define MOD_AUDIO_I2S_WS I2S_PIN_NO_CHANGE
+#define MOD_AUDIO_I2S_DOUT I2S_PIN_NO_CHANGE
+#endif
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static void play();
+
+static uint32_t cycleCounter();
+
+static void commandAudio(cmd *c);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static QueueHandle_t eventQueue;
+static I2sAudioSink sink(I2S_NUM_0, MOD_AUDIO_I2S_BCLK, MOD_AUDIO_I2S_WS, MOD_AUDIO_I2S_DOUT);
+static PartitionAudioSource source(MOD_AUDIO_PARTITION);
+static volatile bool stopRequested = false;
+static volatile bool playing = false;
+static svcAudioStats_t lastStats;
+static uint16_t lastBlockMs = 0;
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+_Noreturn void modAudioTaskProcess(void *pvParameters) {
+    eventQueue = svcEventSubscribe(SVC_EVENT_MASK(SVC_EVENT_PRAYER_DUE), MOD_AUDIO_EVENT_QUEUE_SIZE);
+
+    svcCliAddCmdHelp("audio", "Show the last playback, or [play|stop] the adhan");
+    svcCliGetCli0()->addBoundlessCommand("audio", commandAudio);
+
+    svcAudioClip_t clip;
+    if (!svcAudioReadClip(&source, &clip)) {
+        SVC_LOG_WARNING("No adhan clip in the " MOD_AUDIO_PARTITION " partition, see scripts/make_adhan_clip.py");
+    }
+
+    while (true) {
+        svcEvent_t event;
+        if (xQueueReceive(eventQueue, &event, portMAX_DELAY)) {
+            play();
+        }
+    }
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+void play() {
+    svcAudioClip_t clip;
+    if (!svcAudioReadClip(&source, &clip)) {
+        return;
+    }
+
+    stopRequested = false;
+    playing = true;
+    svcPowerEnter(SVC_POWER_AUDIO_ON);
+    SVC_TRACE_BEGIN("audio.play");
+    const bool complete = svcAudioPlay(&source, &sink, &stopRequested, cycleCounter, &lastStats);
+    SVC_TRACE_END("audio.play");
+    svcPowerEnter(SVC_POWER_AUDIO_OFF);
+    playing = false;
+
+    // Budget check: the slowest block decode against the time the block plays
+    lastBlockMs = SVC_AUDIO_BLOCK_SAMPLES(clip.blockSize) * 1000 / clip.sampleRate;
+    SVC_LOG_INFO("Adhan %s, %lu blocks, slowest decode %lu us for %u ms of audio, %lu sink errors",
+                 complete ? "played" : "stopped", (unsigned long) lastStats.blocks,
+                 (unsigned long) (lastStats.maxDecodeTime / ESP.getCpuFreqMHz()), lastBlockMs,
+                 (unsigned long) lastStats.sinkErrors);
+}
+
+uint32_t cycleCounter() {
+    return ESP.getCycleCount();
+}
+
+void commandAudio(cmd *c) {
+    Command cmd(c);
+    const String action = cmd.countArgs() > 0 ? cmd.getArgument(0).getValue() : String("");
+    if (action == "play") {
+        // Same path as a due prayer, the module queue only carries play requests
+        svcEvent_t event = {SVC_EVENT_PRAYER_DUE};
+        event.data.prayer = {0, 0, NONE};
+        xQueueSend(eventQueue, &event, 0);
+    } else if (action == "stop") {
+        stopRequested = true;
+    }
+
+    svcCliOut()->printf("\r\n%s, last playback %lu blocks, %lu samples, slowest decode %lu us per %u ms block\r\n",
+                        playing ? "Playing" : "Idle", (unsigned long) lastStats.blocks,
+                        (unsigned long) lastStats.samples,
+                        (unsigned long) (lastStats.maxDecodeTime / ESP.getCpuFreqMHz()), lastBlockMs);
+}
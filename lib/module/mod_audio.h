@@ -0,0 +1,56 @@
+/*===========================================================================*/
+/// \file mod_audio.h
+///
+/// \brief
+///    Module for playing the adhan when a prayer is due
+///
+/// \details
+///     Wait for the prayer due events and stream the clip of the adhan partition to the I2S output
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOD_AUDIO_H
+#define MOD_AUDIO_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Entry point for the module
+/// \param[in] pvParameters - FreeRTOS task parameters
+_Noreturn void modAudioTaskProcess(void *pvParameters);
+
+#endif // MOD_AUDIO_H
@@ -0,0 +1,230 @@
+/*===========================================================================*/
+/// \file mod_bench.cpp
+///
+/// \brief
+///    Module for measuring the hot paths of the firmware on the device
+///
+/// \details
+///    Each case is repeated BENCH_REPEATS times, the minimum and the median cycles per iteration are reported with
+///    two decimals, so that a case of a few cycles still shows a small slowdown.
+///    Output lines start with "bench," so they can be picked out of a serial log.
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <mod_bench.h>
+#include <mod_prayer.h>
+#include <svc_clock.h>
+#include <svc_cli.h>
+#include <svc_display.h>
+#include <svc_protocol.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define BENCH_REPEATS 7
+#define BENCH_FIXTURE_DAYS 30
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+typedef void (*BenchFunction)(uint32_t iteration);
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    const char *name;
+    BenchFunction function;
+    uint32_t iterations;
+} BenchCase;
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static void benchProtocolDecode(uint32_t iteration);
+
+static void benchClockLocalToUtc(uint32_t iteration);
+
+static void benchClockToDateTime(uint32_t iteration);
+
+static void benchDayLookup(uint32_t iteration);
+
+static void benchFindNext(uint32_t iteration);
+
+static void benchRender(uint32_t iteration);
+
+static void benchCliDispatch(uint32_t iteration);
+
+static void runCase(const BenchCase *benchCase);
+
+static void commandBench(cmd *c);
+
+static void commandNop(cmd *c);
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const uint8_t timingsPacket[SVC_PROTOCOL_PRAYER_TIMINGS_SIZE] = {
+    PRAYER_TIMINGS_HEADER, 15, 3, 20, 25, 5, 12, 12, 45, 16, 2, 18, 41, 20, 3
+};
+
+static const BenchCase benchCases[] = {
+    {"protocol.decode", benchProtocolDecode, 2000},
+    {"clock.local_to_utc", benchClockLocalToUtc, 2000},
+    {"clock.to_datetime", benchClockToDateTime, 2000},
+    {"prayer.day_lookup", benchDayLookup, 2000},
+    {"prayer.find_next", benchFindNext, 500},
+    {"display.render", benchRender, 20},
+    {"cli.dispatch", benchCliDispatch, 100},
+};
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static PrayerTimetable fixtureTimetable;
+static int64_t fixtureMonthStart;
+static uint8_t fixtureFrame[SVC_DISPLAY_FRAME_SIZE];
+// Dispatching on its own instance keeps the real CLI, which runs this command, out of the measurement
+static SimpleCLI *fixtureCli;
+// Results are folded in here so the compiler cannot drop the measured calls
+static volatile uint32_t benchSink;
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+bool modBenchInit() {
+    // A regular month starting on the 1st of March 2025, local midnight
+    const svcClockDateTime_t monthStart = {2025, 3, 1, 0, 0, 0};
+    fixtureMonthStart = svcClockFromDateTime(&monthStart);
+    fixtureTimetable.numberOfDays = BENCH_FIXTURE_DAYS;
+    for (uint8_t day = 0; day < BENCH_FIXTURE_DAYS; day++) {
+        PrayerTimings &timings = fixtureTimetable.days[day];
+        timings.fajr = {5, (uint8_t) (30 - day / 2), FAJR};
+        timings.dhuhr = {12, 45, DHUHR};
+        timings.asr = {16, (uint8_t) (day / 2), ASR};
+        timings.maghrib = {18, (uint8_t) (30 + day / 2), MAGHRIB};
+        timings.isha = {20, (uint8_t) (day / 2), ISHA};
+        timings.day = day + 1;
+        timings.month = monthStart.month;
+        timings.year = monthStart.year;
+    }
+
+    // Same number of commands as the real CLI so the lookup walks a realistic list
+    fixtureCli = new SimpleCLI();
+    if (fixtureCli == nullptr) {
+        return false;
+    }
+    const char *const commandNames[] = {"help", "echo", "tasks", "events", "settime", "gettime", "blesync", "warp"};
+    for (const char *name: commandNames) {
+        fixtureCli->addCommand(name, commandNop);
+    }
+
+    svcCliAddCmdHelp("bench", "Measure the hot paths in CPU cycles [case]");
+    svcCliGetCli0()->addBoundlessCommand("bench", commandBench);
+    return true;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+void benchProtocolDecode(uint32_t iteration) {
+    svcProtocolPacket_t packet;
+    benchSink += svcProtocolDecode(timingsPacket, sizeof(timingsPacket), &packet) + packet.timings.day;
+}
+
+void benchClockLocalToUtc(uint32_t iteration) {
+    benchSink += (uint32_t) svcClockLocalToUtc(fixtureMonthStart + iteration * 1337);
+}
+
+void benchClockToDateTime(uint32_t iteration) {
+    svcClockDateTime_t dateTime;
+    svcClockToDateTime(fixtureMonthStart + iteration * 1337, &dateTime);
+    benchSink += dateTime.minute;
+}
+
+void benchDayLookup(uint32_t iteration) {
+    const svcClockDateTime_t date = {2025, 3, (uint8_t) (1 + iteration % BENCH_FIXTURE_DAYS), 0, 0, 0};
+    const PrayerTimings *timings = modPrayerGetDayTimings(&fixtureTimetable, &date);
+    benchSink += timings->isha.minute;
+}
+
+void benchFindNext(uint32_t iteration) {
+    // Walks through every prayer of the month, and past its end where no prayer is found
+    Prayer prayer;
+    int64_t timestamp;
+    const int64_t now = svcClockLocalToUtc(fixtureMonthStart) + (int64_t) iteration * 5399;
+    benchSink += modPrayerFindNext(&fixtureTimetable, now, &prayer, &timestamp) ? prayer.name : 0;
+}
+
+void benchRender(uint32_t iteration) {
+    const Prayer prayer = {(uint8_t) (iteration % 24), (uint8_t) (iteration % 60), (PrayerName) (iteration % NONE)};
+    svcDisplayRenderNextPrayer(prayer, fixtureFrame);
+    benchSink += fixtureFrame[iteration % SVC_DISPLAY_FRAME_SIZE];
+}
+
+void benchCliDispatch(uint32_t iteration) {
+    fixtureCli->parse("gettime");
+}
+
+void runCase(const BenchCase *benchCase) {
+    uint32_t samples[BENCH_REPEATS];
+    for (uint8_t repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+        // The cycle counter belongs to one core, the task must not move or be preempted while it is read
+        vTaskSuspendAll();
+        const uint32_t start = ESP.getCycleCount();
+        for (uint32_t i = 0; i < benchCase->iterations; i++) {
+            benchCase->function(i);
+        }
+        const uint32_t cycles = ESP.getCycleCount() - start;
+        xTaskResumeAll();
+        // In hundredths of a cycle, a frame render takes millions of cycles
+        samples[repeat] = (uint32_t) ((uint64_t) cycles * 100 / benchCase->iterations);
+
+        // Insertion sort, the median is read once every repeat is in
+        for (uint8_t i = repeat; i > 0 && samples[i] < samples[i - 1]; i--) {
+            const uint32_t swap = samples[i];
+            samples[i] = samples[i - 1];
+            samples[i - 1] = swap;
+        }
+    }
+
+    const uint32_t median = samples[BENCH_REPEATS / 2];
+    svcCliOut()->printf("bench,%s,%lu,%lu.%02lu,%lu.%02lu\r\n", benchCase->name, (unsigned long) benchCase->iterations,
+                        (unsigned long) (samples[0] / 100), (unsigned long) (samples[0] % 100),
+                        (unsigned long) (median / 100), (unsigned long) (median % 100));
+}
+
+void commandBench(cmd *c) {
+    Command cmd(c);
+    const String filter = cmd.countArgs() > 0 ? cmd.getArgument(0).getValue() : String("");
+
+    svcCliOut()->printf("\r\nbench,cpu_mhz,%lu\r\n", (unsigned long) ESP.getCpuFreqMHz());
+    svcCliOut()->write("bench,name,iterations,min_cycles,median_cycles\r\n");
+    for (const BenchCase &benchCase: benchCases) {
+        if (filter.length() == 0 || strstr(benchCase.name, filter.c_str()) != nullptr) {
+            runCase(&benchCase);
+        }
+    }
+}
+
+void commandNop(cmd *c) {
+}
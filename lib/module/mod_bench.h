@@ -0,0 +1,57 @@
+/*===========================================================================*/
+/// \file mod_bench.h
+///
+/// \brief
+///    Module for measuring the hot paths of the firmware on the device
+///
+/// \details
+///     The bench command runs each case with the scheduler suspended and reports CPU cycles per iteration as CSV
+///     lines, scripts/bench_compare.py checks them against a stored baseline
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOD_BENCH_H
+#define MOD_BENCH_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Build the bench fixtures and register the bench command
+/// \return true if the module was initialized successfully, false otherwise
+bool modBenchInit();
+
+#endif // MOD_BENCH_H
@@ -0,0 +1,275 @@
+/*===========================================================================*/
+/// \file mod_broadcast.cpp
+///
+/// \brief
+///    Module for sharing the timetable between displays without connecting
+///
+/// \details
+///    The body is the same packet sequence a phone writes (number of days, the days, end of timings), so the
+///    listeners reuse the timetable stream parser. A timer moves the leader to the next fragment and picks up the
+///    timetables published on the bus. The assembler only runs in the BLE stack task, from the scan callback.
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <mod_broadcast.h>
+#include <mod_timings.h>
+#include <esp_system.h>
+#include <freertos/timers.h>
+#include <svc_broadcast.h>
+#include <svc_cli.h>
+#include <svc_config.h>
+#include <svc_event.h>
+#include <svc_log.h>
+#include <svc_power.h>
+#include <svc_timetable_stream.h>
+#include <svc_trace.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define MOD_BROADCAST_EVENT_QUEUE_SIZE 2
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static void applyMode(modBroadcastMode_t mode);
+
+static void encodeBody(const PrayerTimetable *timetable);
+
+static void fragmentTimerCallback(TimerHandle_t timer);
+
+static void onBroadcast(const uint8_t *data, size_t length);
+
+static void onPacket(const svcProtocolPacket_t *packet, void *context);
+
+static void commandBroadcast(cmd *c);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static BleTransport *transport = nullptr;
+static volatile modBroadcastMode_t currentMode = MOD_BROADCAST_OFF;
+static QueueHandle_t eventQueue = nullptr;
+static TimerHandle_t fragmentTimer = nullptr;
+
+// Leader, only touched by the timer task
+static uint8_t body[SVC_BROADCAST_MAX_BODY_SIZE];
+static size_t bodyLength = 0;
+// Starts anywhere so a restarted leader does not reuse the sequence numbers the listeners saw before
+static svcBroadcastBodyId_t bodyId = {0, 0};
+static uint8_t fragmentCount = 0;
+static uint8_t nextFragment = 0;
+
+// Listener, only touched by the BLE stack task
+static svcBroadcastAssembler_t assembler;
+// Double buffered, see svcEventFreeTimetable()
+static PrayerTimetable timetables[2];
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const char *modeNames[MOD_BROADCAST_MODE_COUNT] = {
+    "off",
+    "listen",
+    "lead"
+};
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+bool modBroadcastInit(BleTransport *bleTransport) {
+    transport = bleTransport;
+    svcBroadcastReset(&assembler);
+    bodyId.sequence = (uint16_t) esp_random();
+
+    svcCliAddCmdHelp("broadcast", "Show or change the timetable broadcast [off | listen | lead]");
+    svcCliGetCli0()->addBoundlessCommand("broadcast", commandBroadcast);
+
+    // Kept up in every mode, a leader has to know the timetable before it starts broadcasting it
+    eventQueue = svcEventSubscribe(SVC_EVENT_MASK(SVC_EVENT_TIMETABLE_UPDATED), MOD_BROADCAST_EVENT_QUEUE_SIZE);
+    fragmentTimer = xTimerCreate("broadcast", pdMS_TO_TICKS(MOD_BROADCAST_FRAGMENT_PERIOD_MS), pdTRUE, nullptr,
+                                 fragmentTimerCallback);
+    if (eventQueue == nullptr || fragmentTimer == nullptr || xTimerStart(fragmentTimer, 0) != pdPASS) {
+        return false;
+    }
+
+    const uint8_t mode = svcConfigGet()->broadcastMode;
+    applyMode(mode < MOD_BROADCAST_MODE_COUNT ? (modBroadcastMode_t) mode : MOD_BROADCAST_OFF);
+    return true;
+}
+
+bool modBroadcastSetMode(modBroadcastMode_t mode) {
+    if (mode >= MOD_BROADCAST_MODE_COUNT || transport == nullptr) {
+        return false;
+    }
+    svcConfigSetInt(SVC_CONFIG_BROADCAST_MODE, mode);
+    applyMode(mode);
+    return true;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+void applyMode(modBroadcastMode_t mode) {
+    const modBroadcastMode_t previous = currentMode;
+    currentMode = mode;
+
+    if (previous == MOD_BROADCAST_LEAD && mode != MOD_BROADCAST_LEAD) {
+        transport->setBroadcastData(nullptr, 0);
+    }
+    if (mode == MOD_BROADCAST_LISTEN) {
+        if (transport->observe(onBroadcast)) {
+            svcPowerEnter(SVC_POWER_SCAN_ON);
+        } else {
+            SVC_LOG_ERROR("Broadcast scan did not start");
+        }
+    } else if (previous == MOD_BROADCAST_LISTEN) {
+        transport->observe(nullptr);
+        svcPowerEnter(SVC_POWER_SCAN_OFF);
+    }
+    SVC_LOG_INFO("Timetable broadcast %s", modeNames[mode]);
+}
+
+void encodeBody(const PrayerTimetable *timetable) {
+    size_t length = 0;
+    body[length++] = NUMBER_OF_DAYS_HEADER;
+    body[length++] = timetable->numberOfDays;
+
+    for (uint8_t i = 0; i < timetable->numberOfDays; i++) {
+        const PrayerTimings &timings = timetable->days[i];
+        // Days missing from the timetable stay missing on the listeners
+        if (timings.day == 0) {
+            continue;
+        }
+        svcProtocolEncodeTimings(&timings, &body[length]);
+        length += SVC_PROTOCOL_PRAYER_TIMINGS_SIZE;
+    }
+    body[length++] = END_OF_TIMINGS_HEADER;
+
+    bodyLength = length;
+    bodyId.sequence++;
+    bodyId.crc = svcBroadcastBodyCrc(body, length);
+    fragmentCount = timetable->numberOfDays > 0 ? svcBroadcastFragmentCount(length) : 0;
+    nextFragment = 0;
+}
+
+void fragmentTimerCallback(TimerHandle_t timer) {
+    svcEvent_t event;
+    while (xQueueReceive(eventQueue, &event, 0) == pdTRUE) {
+        encodeBody((const PrayerTimetable *) event.data.buffer);
+        svcEventRelease(event.data.buffer);
+    }
+
+    if (currentMode != MOD_BROADCAST_LEAD || fragmentCount == 0) {
+        return;
+    }
+    uint8_t fragment[SVC_BROADCAST_FRAGMENT_SIZE];
+    const size_t length = svcBroadcastEncode(body, bodyLength, bodyId, nextFragment, fragment);
+    transport->setBroadcastData(fragment, length);
+    nextFragment = (nextFragment + 1) % fragmentCount;
+}
+
+void onBroadcast(const uint8_t *data, size_t length) {
+    if (svcBroadcastFeed(&assembler, data, length) != SVC_BROADCAST_COMPLETE) {
+        return;
+    }
+    SVC_TRACE_SCOPE("broadcast.timetable");
+
+    PrayerTimetable *timetable = svcEventFreeTimetable(timetables, 2, nullptr);
+    if (timetable == nullptr) {
+        // Assembled again from the next round of fragments
+        SVC_LOG_WARNING("Broadcast timetable %u dropped, the previous ones are still in use",
+                        assembler.completed.sequence);
+        svcBroadcastForget(&assembler);
+        return;
+    }
+    *timetable = {};
+    svcTimetableStream_t stream;
+    svcTimetableStreamBegin(&stream, SVC_TIMETABLE_STREAM_BINARY, onPacket, timetable);
+    svcTimetableStreamFeed(&stream, assembler.body, assembler.length);
+    if (!svcTimetableStreamEnd(&stream) || stream.rejected > 0 || timetable->numberOfDays == 0) {
+        SVC_LOG_WARNING("Broadcast timetable %u dropped, %lu rejected packets", assembler.completed.sequence,
+                        (unsigned long) stream.rejected);
+        svcBroadcastForget(&assembler);
+        return;
+    }
+
+    svcEvent_t event = {SVC_EVENT_TIMETABLE_UPDATED};
+    event.data.buffer = timetable;
+    svcEventPublish(&event);
+    SVC_LOG_INFO("Broadcast timetable %u (CRC %04X) of %u days assembled, %lu fragments",
+                 assembler.completed.sequence, assembler.completed.crc, timetable->numberOfDays,
+                 (unsigned long) assembler.fragments);
+}
+
+void onPacket(const svcProtocolPacket_t *packet, void *context) {
+    PrayerTimetable *timetable = (PrayerTimetable *) context;
+    if (packet->header == NUMBER_OF_DAYS_HEADER) {
+        timetable->numberOfDays = packet->numberOfDays > MAX_DAYS ? MAX_DAYS : packet->numberOfDays;
+        return;
+    }
+    if (packet->header != PRAYER_TIMINGS_HEADER || packet->timings.day > timetable->numberOfDays) {
+        return;
+    }
+
+    svcProtocolApplyTimings(packet, &timetable->days[packet->timings.day - 1]);
+}
+
+void commandBroadcast(cmd *c) {
+    Command cmd(c);
+    svcCliOut()->write("\r\n");
+
+    if (cmd.countArgs() == 1) {
+        const String value = cmd.getArgument(0).getValue();
+        int mode = 0;
+        for (; mode < MOD_BROADCAST_MODE_COUNT; mode++) {
+            if (value == modeNames[mode]) {
+                break;
+            }
+        }
+        if (mode == MOD_BROADCAST_MODE_COUNT) {
+            svcCliOut()->println("Usage: broadcast [off | listen | lead]");
+            return;
+        }
+        modBroadcastSetMode((modBroadcastMode_t) mode);
+    }
+
+    svcCliOut()->printf("Broadcast %s\n", modeNames[currentMode]);
+    if (currentMode == MOD_BROADCAST_LEAD) {
+        svcCliOut()->printf("Timetable %u (CRC %04X): %u bytes in %u fragments, one every %u ms\n", bodyId.sequence,
+                            bodyId.crc, (unsigned) bodyLength, fragmentCount, MOD_BROADCAST_FRAGMENT_PERIOD_MS);
+    } else if (currentMode == MOD_BROADCAST_LISTEN) {
+        svcCliOut()->printf("Fragments: %lu new, %lu duplicate, %lu corrupted, %lu timetables assembled\n",
+                            (unsigned long) assembler.fragments, (unsigned long) assembler.duplicates,
+                            (unsigned long) assembler.corrupted, (unsigned long) assembler.bodies);
+        if (assembler.hasCompleted) {
+            svcCliOut()->printf("Last timetable %u (CRC %04X)\n", assembler.completed.sequence,
+                                assembler.completed.crc);
+        }
+    }
+}
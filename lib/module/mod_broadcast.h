@@ -0,0 +1,75 @@
+/*===========================================================================*/
+/// \file mod_broadcast.h
+///
+/// \brief
+///    Module for sharing the timetable between displays without connecting
+///
+/// \details
+///     A leading display cycles the fragments of its timetable through its advertisement, the listening displays
+///     assemble them from a passive scan and publish the timetable as if it was received over a connection. Any
+///     number of displays can listen, the time to get the timetable does not depend on how many there are.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOD_BROADCAST_H
+#define MOD_BROADCAST_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+#include <svc_ble_transport.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+// Time each fragment stays in the advertisement, several advertising events
+#define MOD_BROADCAST_FRAGMENT_PERIOD_MS 200
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    MOD_BROADCAST_OFF,
+    MOD_BROADCAST_LISTEN, // Assemble the timetable broadcast by a leader
+    MOD_BROADCAST_LEAD,   // Broadcast the timetable received over BLE or Wi-Fi
+    MOD_BROADCAST_MODE_COUNT
+} modBroadcastMode_t;
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Register the CLI command and start the saved mode, called once the BLE stack is up
+/// \param bleTransport The started transport
+/// \return true if the module started, false otherwise
+bool modBroadcastInit(BleTransport *bleTransport);
+
+/// \brief Change the mode now and save it
+/// \param mode The new mode
+/// \return true if the mode was applied, false otherwise
+bool modBroadcastSetMode(modBroadcastMode_t mode);
+
+#endif // MOD_BROADCAST_H
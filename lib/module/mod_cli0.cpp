@@ -2,10 +2,13 @@
 /// \file mod_cli0.cpp
 ///
 /// \brief
-///    Brief description of the module purpose goes here
+///    Command line interface over the UART, the BLE UART service and Bluetooth Classic SPP
 ///
 /// \details
-///    Detailed description of the module purpose goes here
+///    One task serves every session in turn: it reads what each transport received, runs the complete lines with
+///    the output sent to the session that typed them, then drains the output of every session as far as its link
+///    allows. A session whose client stops reading fills its own ring and drops its own output, the others and the
+///    rest of the firmware carry on.
 ///
 /// \author
 ///    Adam Q.
@@ -19,12 +22,30 @@
 #include "mod_cli0.h"
 
 #include "svc_cli.h"
+#include "svc_cli_session.h"
+#include "svc_cli_transport_esp.h"
+#include "svc_cli_transport_fd.h"
+#include "svc_config.h"
+#include "svc_trace.h"
 
 /*=============================================================================
                                      Defines
 =============================================================================*/
 
-#define MOD_CLI0_CMD_BUFFER_SIZE 128
+#ifdef ARDUINO
+#define MOD_CLI0_MAX_SESSIONS 3
+#else
+// A host build also serves a pty
+#define MOD_CLI0_MAX_SESSIONS 4
+#endif
+
+// Output rings, the UART one holds the longest command output (tasks, config list)
+#define MOD_CLI0_UART_OUTPUT_SIZE 4096
+#define MOD_CLI0_BLE_OUTPUT_SIZE 2048
+#define MOD_CLI0_SPP_OUTPUT_SIZE 2048
+#define MOD_CLI0_PTY_OUTPUT_SIZE 4096
+
+#define MOD_CLI0_POLL_PERIOD_MS 10
 
 /*=============================================================================
                                      Macros
@@ -38,9 +59,25 @@
                                     Structures
 =============================================================================*/
 
-typedef struct {
-    bool echo;
-} modCli0Config_t;
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+/// Output of the commands, queued in the ring of the session running them
+class SessionPrint : public Print {
+public:
+    using Print::write;
+
+    size_t write(uint8_t c) override {
+        return svcCliSessionWrite(session, &c, 1);
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+        return svcCliSessionWrite(session, buffer, size);
+    }
+
+    svcCliSession_t *session = nullptr;
+};
 
 /*=============================================================================
                             Private Function Prototypes
@@ -52,31 +89,48 @@ void commandEcho(cmd *c);
 
 void commandHelp(cmd *c);
 
-size_t readUntilEOL(char *buffer, size_t size);
+void commandSessions(cmd *c);
 
-bool isEOL(char key);
+static bool addSession(CliTransport *transport, uint8_t *output, size_t size, bool echo);
 
-bool isArrowKeySequence(char key);
+static bool serveSession(svcCliSession_t *session);
 
-bool isDeleteOrBackspace(char key);
+static void runLine(svcCliSession_t *session);
 
-void echo(char key);
+static void prompt(svcCliSession_t *session);
 
 /*=============================================================================
                                 Private Variables
 =============================================================================*/
 
 static SimpleCLI cli0;
-static unsigned long previousTime = 0;
-
-static char cmdBuffer[MOD_CLI0_CMD_BUFFER_SIZE];
-
-static modCli0Config_t modCli0Config = {
-    .echo = true,
-};
 
 static modCliCmdHelpInfo_t cmdHelpInformations[MOD_CLI0_CMD_HELP_DATA_SIZE];
 
+// Sessions below the count are complete, the BLE task adds its sessions while the CLI task serves the others
+static svcCliSession_t sessions[MOD_CLI0_MAX_SESSIONS];
+static volatile int sessionCount = 0;
+static svcCliSession_t *currentSession = nullptr;
+static SessionPrint sessionPrint;
+
+static UartCliTransport uartTransport;
+static BleUartCliTransport bleUartTransport;
+#ifdef SVC_CLI_SPP
+static SppCliTransport sppTransport;
+#endif
+#ifndef ARDUINO
+static FdCliTransport ptyTransport;
+#endif
+
+static uint8_t uartOutput[MOD_CLI0_UART_OUTPUT_SIZE];
+static uint8_t bleOutput[MOD_CLI0_BLE_OUTPUT_SIZE];
+#ifdef SVC_CLI_SPP
+static uint8_t sppOutput[MOD_CLI0_SPP_OUTPUT_SIZE];
+#endif
+#ifndef ARDUINO
+static uint8_t ptyOutput[MOD_CLI0_PTY_OUTPUT_SIZE];
+#endif
+
 /*=============================================================================
                                 Private Constants
 =============================================================================*/
@@ -84,6 +138,8 @@ static modCliCmdHelpInfo_t cmdHelpInformations[MOD_CLI0_CMD_HELP_DATA_SIZE];
 static constexpr int COMMAND_QUEUE_SIZE = 10;
 static constexpr int ERROR_QUEUE_SIZE = 10;
 
+static const char PROMPT[] = "\r\n> ";
+
 /*=============================================================================
                                 Public Functions
 =============================================================================*/
@@ -93,24 +149,45 @@ bool modCli0Init() {
     bool status = svcCliRegisterCli0(&cli0);
     status = svcCliRegisterCmdHelpData(cmdHelpInformations);
     modCLi0RegisterCommands();
+    // The UART echo follows the cli_echo setting
+    status = addSession(&uartTransport, uartOutput, sizeof(uartOutput), false) && status;
+#ifndef ARDUINO
+    // A terminal attached to the slave side is a client like any other, the pty echoes nothing itself
+    status = ptyTransport.openPty() && addSession(&ptyTransport, ptyOutput, sizeof(ptyOutput), true) && status;
+#endif
     return status;
 }
 
+bool modCli0StartRemote(BleTransport *bleTransport) {
+    // The BLE terminals print what they send, echoing it would double every line
+    bool status = bleUartTransport.begin(bleTransport) &&
+                  addSession(&bleUartTransport, bleOutput, sizeof(bleOutput), false);
+#ifdef SVC_CLI_SPP
+    status = sppTransport.begin(svcConfigGet()->deviceName) &&
+             addSession(&sppTransport, sppOutput, sizeof(sppOutput), true) && status;
+#endif
+    return status;
+}
 
-_Noreturn void modCli0EntryPoint(void *pvParameters) {
-    Serial.write("\r\n> ");
-    while (true) {
-        // Read the command
-        size_t length = readUntilEOL(cmdBuffer, MOD_CLI0_CMD_BUFFER_SIZE);
+void modCli0ReceiveBle(const uint8_t *data, size_t length) {
+    bleUartTransport.receive(data, length);
+}
 
-        // Parse the command
-        cli0.parse(cmdBuffer, length);
+#ifndef ARDUINO
+const char *modCli0PtyName() {
+    return ptyTransport.slaveName();
+}
+#endif
 
-        // New Line
-        Serial.write("\r\n> ");
+_Noreturn void modCli0EntryPoint(void *pvParameters) {
+    while (true) {
+        bool drained = true;
+        for (int i = 0; i < sessionCount; i++) {
+            drained = serveSession(&sessions[i]) && drained;
+        }
 
-        // Delay
-        vTaskDelay(10);
+        // Output still waiting for a link goes out on the next tick
+        vTaskDelay(drained ? pdMS_TO_TICKS(MOD_CLI0_POLL_PERIOD_MS) : 1);
     }
 }
 
@@ -120,29 +197,57 @@ _Noreturn void modCli0EntryPoint(void *pvParameters) {
 
 void commandEcho(cmd *c) {
     Command cmd(c);
-    Serial.write("\r\n");
+    svcCliOut()->write("\r\n");
     for (int i = 0; i < cmd.countArgs(); i++) {
         Argument arg = cmd.getArgument(i);
-        Serial.print(arg.getValue());
-        Serial.print(" ");
+        svcCliOut()->print(arg.getValue());
+        svcCliOut()->print(" ");
     }
 }
 
 void commandHelp(cmd *c) {
-    Serial.write("\r\nAvailable commands:\r\n");
+    svcCliOut()->write("\r\nAvailable commands:\r\n");
 
     for (const modCliCmdHelpInfo_t &helpInfo: cmdHelpInformations) {
         if (helpInfo.isUsed) {
-            Serial.write(helpInfo.name);
-            Serial.write(" - ");
-            Serial.write(helpInfo.description);
-            Serial.write("\r\n");
+            svcCliOut()->write(helpInfo.name);
+            svcCliOut()->write(" - ");
+            svcCliOut()->write(helpInfo.description);
+            svcCliOut()->write("\r\n");
         } else {
             break;
         }
     }
 }
 
+void commandSessions(cmd *c) {
+    Command cmd(c);
+    svcCliOut()->write("\r\n");
+
+    if (cmd.countArgs() > 0) {
+        const String value = cmd.countArgs() == 2 ? cmd.getArgument(1).getValue() : String("");
+        if (!(cmd.getArgument(0).getValue() == "echo") || !(value == "on" || value == "off")) {
+            svcCliOut()->println("Usage: sessions [echo on | off]");
+            return;
+        }
+        const bool echo = value == "on";
+        if (currentSession == &sessions[0]) {
+            svcConfigSetInt(SVC_CONFIG_CLI_ECHO, echo);
+        }
+        currentSession->echo = echo;
+    }
+
+    for (int i = 0; i < sessionCount; i++) {
+        const svcCliSession_t &session = sessions[i];
+        svcCliOut()->printf("%c %-4s %-8s echo %-3s %lu lines, %lu bytes out, %lu dropped, %u / %u pending\r\n",
+                            &session == currentSession ? '*' : ' ', session.transport->name(),
+                            session.connected ? "attached" : "idle", session.echo ? "on" : "off",
+                            (unsigned long) session.lines, (unsigned long) session.bytesOut,
+                            (unsigned long) session.dropped, (unsigned) session.outputCount,
+                            (unsigned) session.outputSize);
+    }
+}
+
 void modCLi0RegisterCommands() {
     SimpleCLI *cli = svcCliGetCli0();
     // Register the commands
@@ -150,91 +255,52 @@ void modCLi0RegisterCommands() {
     cli->addCommand("help", commandHelp);
     svcCliAddCmdHelp("echo", "Echoes the arguments back to the console");
     cli->addBoundlessCommand("echo", commandEcho);
+    svcCliAddCmdHelp("sessions", "List the CLI sessions [echo on | off]");
+    cli->addBoundlessCommand("sessions", commandSessions);
 }
 
-size_t readUntilEOL(char *buffer, size_t size) {
-    size_t cmdLength = 0;
-    while (true) {
-        if (Serial.available() > 0) {
-            const char key = static_cast<char>(Serial.read());
-
-            if (isEOL(key)) {
-                return cmdLength;
-            }
-
-            // Check for delete or backsapce
-            if (isDeleteOrBackspace(key)) {
-                if (cmdLength > 0) {
-                    cmdLength--;
-                    echo(key);
-                }
-                continue;
-            }
-
-            // Check if arrow keys are pressed
-            if (isArrowKeySequence(key)) {
-                continue;
-            }
-
-            // Check if the buffer is full
-            if (cmdLength >= size) {
-                Serial.print("Buffer full!!");
-                continue;
-            }
-
-            buffer[cmdLength] = key;
-            cmdLength++;
-
-            // Echo Back
-            echo(key);
-        }
+bool addSession(CliTransport *transport, uint8_t *output, size_t size, bool echo) {
+    if (sessionCount >= MOD_CLI0_MAX_SESSIONS) {
+        return false;
     }
+    svcCliSessionInit(&sessions[sessionCount], transport, output, size, echo);
+    sessionCount = sessionCount + 1;
+    return true;
 }
 
-void echo(const char key) {
-    if (modCli0Config.echo) {
-        Serial.write(key);
+bool serveSession(svcCliSession_t *session) {
+    if (session == &sessions[0]) {
+        session->echo = svcConfigGet()->cliEcho;
     }
-}
 
-bool isEOL(const char key) {
-    return key == '\r' || key == '\n';
-}
-
-
-bool isArrowKeySequence(const char key) {
-    // up: 27, 91, 65 - down: 27, 91, 66 - left: 27, 91, 68 - right: 27, 91, 67
-    static char lastKeyBuffer[3] = {0, 0, 0};
-    constexpr char ARROW_SEQUENCE[3] = {27, 91, 0};
-    constexpr char LAST_KEYS[4] = {65, 66, 67, 68};
-
-    // Combination - Level 1
-    if (key == ARROW_SEQUENCE[0]) {
-        lastKeyBuffer[0] = key;
-        return true;
+    switch (svcCliSessionPoll(session)) {
+        case SVC_CLI_SESSION_ATTACHED:
+            prompt(session);
+            break;
+        case SVC_CLI_SESSION_LINE:
+            runLine(session);
+            break;
+        default:
+            break;
     }
+    return svcCliSessionPump(session);
+}
 
-    // Combination - Level 2
-    if (lastKeyBuffer[0] == ARROW_SEQUENCE[0]) {
-        if (key == ARROW_SEQUENCE[1]) {
-            lastKeyBuffer[1] = key;
-            return true;
-        }
-    }
+void runLine(svcCliSession_t *session) {
+    currentSession = session;
+    sessionPrint.session = session;
+    svcCliSetOut(&sessionPrint);
 
-    // Combination - Level 3
-    if (lastKeyBuffer[1] == ARROW_SEQUENCE[1]) {
-        for (const char lastKey: LAST_KEYS) {
-            if (key == lastKey) {
-                lastKeyBuffer[2] = key;
-                return true;
-            }
-        }
-    }
+    SVC_TRACE_BEGIN("cli.command");
+    cli0.parse(session->line, session->lineLength);
+    SVC_TRACE_END("cli.command");
 
-    return false;
+    svcCliSetOut(nullptr);
+    currentSession = nullptr;
+    svcCliSessionLineDone(session);
+    prompt(session);
 }
 
-bool isDeleteOrBackspace(const char key) {
-    return key == '\b' || key == 127;
+void prompt(svcCliSession_t *session) {
+    svcCliSessionWrite(session, (const uint8_t *) PROMPT, sizeof(PROMPT) - 1);
 }
@@ -19,12 +19,13 @@
 =============================================================================*/
 
 #include <SimpleCLI.h>
+#include <svc_ble_transport.h>
 
 /*=============================================================================
                                      Defines
 =============================================================================*/
 
-#define MOD_CLI0_CMD_HELP_DATA_SIZE 10
+#define MOD_CLI0_CMD_HELP_DATA_SIZE 24
 
 /*=============================================================================
                                      Macros
@@ -62,6 +63,22 @@ typedef struct {
 
 bool modCli0Init();
 
+/// \brief Start the BLE UART session, and the SPP one when built with SVC_CLI_SPP, called once the BLE stack is up
+/// \param bleTransport The started transport
+/// \return true if the sessions started, false otherwise
+bool modCli0StartRemote(BleTransport *bleTransport);
+
+/// \brief Hand the bytes written to the BLE UART RX characteristic to the CLI, called from the BLE stack task
+/// \param data The written bytes
+/// \param length Number of bytes
+void modCli0ReceiveBle(const uint8_t *data, size_t length);
+
+#ifndef ARDUINO
+/// \brief Path of the pty a host build serves a session on, for screen or a test to open
+/// \return The slave side, empty if the pty could not be opened
+const char *modCli0PtyName();
+#endif
+
 /// \brief Entry point for the module
 /// \param[in] pvParameters - FreeRTOS task parameters
 _Noreturn void modCli0EntryPoint(void *pvParameters);
@@ -0,0 +1,382 @@
+/*===========================================================================*/
+/// \file mod_display.cpp
+///
+/// \brief
+///    Module for driving the screen from the event bus
+///
+/// \details
+///    Render every display request in its own task so the publishers never wait for the I2C transfer. The prayer
+///    module announces the screen of the next boundary as soon as the previous one is shown, it is rendered into the
+///    back buffer right away. The task wakes a few milliseconds before the boundary and busy waits the rest on the
+///    microsecond clock, so only the transfer of the changed pages is left between the boundary and the pixels.
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <mod_display.h>
+#include <mod_prayer.h>
+#include <svc_cli.h>
+#include <svc_clock.h>
+#include <svc_config.h>
+#include <svc_display.h>
+#include <svc_event.h>
+#include <svc_log.h>
+#include <svc_state.h>
+#include <svc_trace.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define MOD_DISPLAY_EVENT_QUEUE_SIZE 4
+// Longest single wait, a tick count of a few hours overflows pdMS_TO_TICKS()
+#define MOD_DISPLAY_MAX_WAIT_MS 60000
+// Woken this long before the boundary, more than a tick of scheduling jitter
+#define MOD_DISPLAY_EARLY_WAKE_MS 3
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static void handleEvent(const svcEvent_t *event);
+
+static bool applyRequestedMode();
+
+static void prepareBoundary();
+
+static void showPage(int64_t now);
+
+static void buildPageData(svcDisplayPageData_t *data, int64_t now);
+
+static svcDisplayPage_t pageAt(int64_t utc);
+
+static void swapAtBoundary();
+
+static bool isSamePrayer(const Prayer *a, const Prayer *b);
+
+static void commandDisplay(cmd *c);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static QueueHandle_t eventQueue;
+static const PrayerTimetable *timetable = nullptr;
+
+// Written by the CLI, applied by the display task
+static volatile modDisplayMode_t requestedMode = MOD_DISPLAY_NEXT;
+static modDisplayMode_t mode = MOD_DISPLAY_NEXT;
+
+// Screen waiting in the back buffer for its boundary
+static bool prepared = false;
+static Prayer preparedPrayer;
+static int64_t preparedPrayerUtc = 0;
+static int64_t preparedUtc = 0;
+
+// Set by a swap, the display request published at the same boundary has nothing left to draw
+static bool swappedAtBoundary = false;
+static Prayer swappedPrayer;
+
+static modDisplayLatencyStats_t latencyStats;
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const char *modeNames[MOD_DISPLAY_MODE_COUNT] = {
+    "next",
+    "pages"
+};
+
+/*=============================================================================
+                                Library Entry Point
+=============================================================================*/
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+_Noreturn void modDisplayTaskProcess(void *pvParameters) {
+    eventQueue = svcEventSubscribe(SVC_EVENT_MASK(SVC_EVENT_DISPLAY_REQUEST) |
+                                   SVC_EVENT_MASK(SVC_EVENT_DISPLAY_PREPARE) |
+                                   SVC_EVENT_MASK(SVC_EVENT_TIMETABLE_UPDATED),
+                                   MOD_DISPLAY_EVENT_QUEUE_SIZE);
+
+    const uint8_t savedMode = svcConfigGet()->displayMode;
+    mode = savedMode < MOD_DISPLAY_MODE_COUNT ? (modDisplayMode_t) savedMode : MOD_DISPLAY_NEXT;
+    requestedMode = mode;
+
+    svcCliAddCmdHelp("display", "Show the screen counters and the boundary latency, or change the mode [next | pages]");
+    svcCliGetCli0()->addBoundlessCommand("display", commandDisplay);
+
+    while (true) {
+        applyRequestedMode();
+
+        // Whichever comes first: the boundary of the prepared screen or the next second of the pages
+        int64_t waitMs = MOD_DISPLAY_MAX_WAIT_MS;
+        bool boundary = false;
+        if (prepared) {
+            // Real time, a warped clock reaches the boundary sooner
+            const int64_t remaining = svcClockRealMsUntil(preparedUtc * 1000);
+            if (remaining <= MOD_DISPLAY_MAX_WAIT_MS) {
+                waitMs = remaining > MOD_DISPLAY_EARLY_WAKE_MS ? remaining - MOD_DISPLAY_EARLY_WAKE_MS : 0;
+                boundary = true;
+            }
+        }
+        if (mode == MOD_DISPLAY_PAGES) {
+            const int64_t tickMs = svcClockRealMsUntil((svcClockNow() + 1) * 1000);
+            if (tickMs < waitMs) {
+                waitMs = tickMs;
+                boundary = false;
+            }
+        }
+        const TickType_t timeout = mode == MOD_DISPLAY_NEXT && !prepared ? portMAX_DELAY : pdMS_TO_TICKS(waitMs);
+
+        svcEvent_t event;
+        if (xQueueReceive(eventQueue, &event, timeout)) {
+            handleEvent(&event);
+        } else if (boundary) {
+            swapAtBoundary();
+        } else if (mode == MOD_DISPLAY_PAGES) {
+            showPage(svcClockNow());
+        }
+    }
+}
+
+bool modDisplaySetMode(modDisplayMode_t newMode) {
+    if (newMode >= MOD_DISPLAY_MODE_COUNT) {
+        return false;
+    }
+    svcConfigSetInt(SVC_CONFIG_DISPLAY_MODE, newMode);
+    requestedMode = newMode;
+
+    // Wakes the display task, which redraws the screen in the new mode
+    svcState_t state;
+    svcEvent_t event = {SVC_EVENT_DISPLAY_REQUEST};
+    event.data.prayer = svcStateRead(&state) ? state.nextPrayer : Prayer{0, 0, NONE};
+    svcEventPublish(&event);
+    return true;
+}
+
+void modDisplayGetLatencyStats(modDisplayLatencyStats_t *stats) {
+    *stats = latencyStats;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+void handleEvent(const svcEvent_t *event) {
+    switch (event->topic) {
+        case SVC_EVENT_TIMETABLE_UPDATED:
+            // Only read for today's timings, the prayer module publishes the display request that follows
+            svcEventRelease(timetable);
+            timetable = (const PrayerTimetable *) event->data.buffer;
+            return;
+        case SVC_EVENT_DISPLAY_REQUEST:
+            if (applyRequestedMode()) {
+                // Redrawn from the state snapshot in the new mode
+                return;
+            }
+            if (swappedAtBoundary && isSamePrayer(&event->data.prayer, &swappedPrayer)) {
+                // Already on the panels since the boundary
+                swappedAtBoundary = false;
+                return;
+            }
+            swappedAtBoundary = false;
+
+            if (prepared && isSamePrayer(&event->data.prayer, &preparedPrayer)) {
+                // The boundary was reached before the swap, the prepared screen is still the right one
+                prepared = false;
+                svcDisplaySwap();
+                latencyStats.missed++;
+                return;
+            }
+            // Drops the back buffer, the following prepare event fills it again
+            prepared = false;
+            if (mode == MOD_DISPLAY_PAGES) {
+                showPage(svcClockNow());
+            } else {
+                svcDisplayNextPrayer(event->data.prayer);
+            }
+            return;
+        case SVC_EVENT_DISPLAY_PREPARE:
+            applyRequestedMode();
+            preparedPrayer = event->data.prepare.prayer;
+            preparedPrayerUtc = event->data.prepare.prayerUtc;
+            preparedUtc = event->data.prepare.utc;
+            prepareBoundary();
+            return;
+        default:
+            return;
+    }
+}
+
+bool applyRequestedMode() {
+    if (requestedMode == mode) {
+        return false;
+    }
+    mode = requestedMode;
+
+    svcState_t state;
+    if (mode == MOD_DISPLAY_PAGES) {
+        showPage(svcClockNow());
+    } else if (svcStateRead(&state) && state.nextPrayer.name != NONE) {
+        svcDisplayNextPrayer(state.nextPrayer);
+    }
+    // The prepared screen was drawn for the previous mode
+    if (prepared) {
+        prepareBoundary();
+    }
+    return true;
+}
+
+void prepareBoundary() {
+    if (mode == MOD_DISPLAY_PAGES) {
+        // The page the rotation is on at the boundary, as it reads then
+        svcDisplayPageData_t data;
+        buildPageData(&data, preparedUtc);
+        data.state.nextPrayer = preparedPrayer;
+        data.state.nextPrayerUtc = preparedPrayerUtc;
+        svcDisplayPreparePage(pageAt(preparedUtc), &data);
+    } else {
+        svcDisplayPrepareNextPrayer(preparedPrayer);
+    }
+    prepared = true;
+}
+
+void showPage(int64_t now) {
+    svcDisplayPageData_t data;
+    buildPageData(&data, now);
+    svcDisplayShowPage(pageAt(now), &data);
+}
+
+void buildPageData(svcDisplayPageData_t *data, int64_t now) {
+    // A read overlapping a publish keeps the previous snapshot, the next second gets the new one
+    static svcState_t state = {{0, 0, NONE}, 0, SVC_CLOCK_SOURCE_NONE, SYNC_NONE, false, 0, 0};
+    svcStateRead(&state);
+    data->state = state;
+    data->now = now;
+
+    svcClockDateTime_t local;
+    svcClockToDateTime(svcClockUtcToLocal(now), &local);
+    const PrayerTimings *today = modPrayerGetDayTimings(timetable, &local);
+    if (today != nullptr) {
+        data->today = *today;
+    } else {
+        data->today = {};
+    }
+}
+
+svcDisplayPage_t pageAt(int64_t utc) {
+    return (svcDisplayPage_t) ((utc / MOD_DISPLAY_PAGE_PERIOD_S) % SVC_DISPLAY_PAGE_COUNT);
+}
+
+void swapAtBoundary() {
+    const int64_t boundaryUs = preparedUtc * 1000000;
+    // A tick is too coarse for the last stretch, bounded in case the clock is set back meanwhile
+    const unsigned long spinStart = micros();
+    while (svcClockNowUs() < boundaryUs && micros() - spinStart < MOD_DISPLAY_EARLY_WAKE_MS * 2000UL) {
+    }
+    if (svcClockNowUs() < boundaryUs) {
+        // Not reached yet, the wait is computed again
+        return;
+    }
+
+    SVC_TRACE_INSTANT("display.boundary", preparedPrayer.name);
+    prepared = false;
+    const bool status = svcDisplaySwap();
+    const int64_t latencyUs = svcClockNowUs() - boundaryUs;
+    if (!status) {
+        SVC_LOG_WARNING("Screen of the boundary not fully sent, %ld us", (long) latencyUs);
+    }
+    swappedAtBoundary = true;
+    swappedPrayer = preparedPrayer;
+
+    // A warped clock stretches the transfer too, it says nothing about the panels
+    if (svcClockGetWarp() != 1) {
+        return;
+    }
+    SVC_TRACE_INSTANT("display.latency", (uint32_t) latencyUs);
+    latencyStats.swaps++;
+    latencyStats.lastUs = latencyUs;
+    latencyStats.totalUs += latencyUs;
+    if (latencyUs > latencyStats.maxUs) {
+        latencyStats.maxUs = latencyUs;
+    }
+    if (latencyUs > MOD_DISPLAY_LATENCY_TARGET_US) {
+        latencyStats.late++;
+    }
+}
+
+bool isSamePrayer(const Prayer *a, const Prayer *b) {
+    return a->name == b->name && a->hour == b->hour && a->minute == b->minute;
+}
+
+void commandDisplay(cmd *c) {
+    Command cmd(c);
+    svcCliOut()->write("\r\n");
+
+    if (cmd.countArgs() == 1) {
+        const String value = cmd.getArgument(0).getValue();
+        int newMode = 0;
+        for (; newMode < MOD_DISPLAY_MODE_COUNT; newMode++) {
+            if (value == modeNames[newMode]) {
+                break;
+            }
+        }
+        if (newMode == MOD_DISPLAY_MODE_COUNT) {
+            svcCliOut()->println("Usage: display [next | pages]");
+            return;
+        }
+        modDisplaySetMode((modDisplayMode_t) newMode);
+    }
+
+    svcDisplayFlushStats_t flush;
+    svcDisplayGetFlushStats(&flush);
+    svcDisplayPageStats_t pages;
+    svcDisplayGetPageStats(&pages);
+    modDisplayLatencyStats_t latency;
+    modDisplayGetLatencyStats(&latency);
+
+    svcCliOut()->printf("Mode %s\n", modeNames[requestedMode]);
+    svcCliOut()->printf("Page flips %lu, page caches rendered %lu\n", (unsigned long) pages.flips,
+                        (unsigned long) pages.renders);
+    svcCliOut()->printf("Frames: %lu, pages sent %lu, skipped %lu, errors %lu, flush last %lu us, max %lu us\n",
+                        (unsigned long) flush.frames, (unsigned long) flush.pagesSent,
+                        (unsigned long) flush.pagesSkipped, (unsigned long) flush.errors, (unsigned long) flush.lastUs,
+                        (unsigned long) flush.maxUs);
+    if (latency.swaps == 0) {
+        svcCliOut()->println("No prayer boundary swap yet");
+    } else {
+        svcCliOut()->printf("Boundary swaps: %lu, latency last %ld us, mean %ld us, max %ld us, %lu over %u us\n",
+                            (unsigned long) latency.swaps, (long) latency.lastUs,
+                            (long) (latency.totalUs / latency.swaps), (long) latency.maxUs,
+                            (unsigned long) latency.late, MOD_DISPLAY_LATENCY_TARGET_US);
+    }
+    if (latency.missed > 0) {
+        svcCliOut()->printf("Boundaries missed: %lu\n", (unsigned long) latency.missed);
+    }
+    if (prepared) {
+        svcCliOut()->printf("Next screen prepared: prayer %d at %02d:%02d\n", preparedPrayer.name, preparedPrayer.hour,
+                            preparedPrayer.minute);
+    }
+}
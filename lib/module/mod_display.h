@@ -0,0 +1,87 @@
+/*===========================================================================*/
+/// \file mod_display.h
+///
+/// \brief
+///    Module for driving the screen from the event bus
+///
+/// \details
+///     Wait for display requests and render them through the display service. The screen due at the next prayer is
+///     rendered ahead into the back buffer and swapped in at the boundary, its latency is kept for the CLI. In the
+///     pages mode the screen rotates between today's timetable, the next prayer countdown and the status.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOD_DISPLAY_H
+#define MOD_DISPLAY_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+// Boundary to pixels latency aimed at, the swaps above it are counted
+#define MOD_DISPLAY_LATENCY_TARGET_US 5000
+// Time each page stays on the screen in the pages mode
+#define MOD_DISPLAY_PAGE_PERIOD_S 5
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    MOD_DISPLAY_NEXT,  // The next prayer only
+    MOD_DISPLAY_PAGES, // Rotating pages, redrawn every second
+    MOD_DISPLAY_MODE_COUNT
+} modDisplayMode_t;
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    uint32_t swaps;  // Prepared screens shown at their prayer boundary
+    uint32_t late;   // Swaps over MOD_DISPLAY_LATENCY_TARGET_US
+    uint32_t missed; // Prepared screens shown after their boundary, on the display request
+    int64_t lastUs;  // From the boundary to the end of the transfer
+    int64_t maxUs;
+    int64_t totalUs;
+} modDisplayLatencyStats_t;
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Entry point for the module
+/// \param[in] pvParameters - FreeRTOS task parameters
+_Noreturn void modDisplayTaskProcess(void *pvParameters);
+
+/// \brief Change the screen mode now and save it
+/// \param mode The new mode
+/// \return true if the mode was applied, false otherwise
+bool modDisplaySetMode(modDisplayMode_t mode);
+
+/// \brief Get the latency of the screen swaps at the prayer boundaries
+/// \param stats Filled with the latency counters
+void modDisplayGetLatencyStats(modDisplayLatencyStats_t *stats);
+
+#endif // MOD_DISPLAY_H
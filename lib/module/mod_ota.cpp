@@ -0,0 +1,278 @@
+/*===========================================================================*/
+/// \file mod_ota.cpp
+///
+/// \brief
+///    Module for updating the firmware over BLE
+///
+/// \details
+///    Decode the OTA control and data writes, drive the update session and notify its results. The BLE stack task
+///    only copies the writes into a queue: erasing a sector or hashing the image back takes from tens of milliseconds
+///    to a second, the OTA task does it and owns the session.
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <mod_ota.h>
+#include <svc_ota.h>
+#include <svc_ota_esp.h>
+#include <svc_cli.h>
+#include <svc_log.h>
+#include <svc_trace.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define OTA_OPCODE_BEGIN 0x01
+#define OTA_OPCODE_END 0x02
+#define OTA_OPCODE_ABORT 0x03
+// Only used in results, for the chunks written on the data characteristic
+#define OTA_OPCODE_DATA 0x04
+
+#define OTA_BEGIN_HEADER_SIZE (1 + 4 + SVC_OTA_DIGEST_SIZE)
+#define OTA_DATA_HEADER_SIZE 4
+
+// Leaves time for the result notification to reach the phone
+#define OTA_RESTART_DELAY_MS 1000
+
+// Largest attribute value, a chunk filling a 517 byte ATT MTU
+#define OTA_MAX_WRITE_SIZE 512
+// Writes arriving during a sector erase, a chunk dropped when it is full is sent again from the reported offset
+#define OTA_QUEUE_SIZE 8
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*
+Control writes:
+    BEGIN: [0] - 0x01, [1..4] - image size, little endian, [5..36] - SHA-256 of the image,
+           [37..] - DER ECDSA P-256 signature of the SHA-256
+    END:   [0] - 0x02, read the image back, verify it and restart into it
+    ABORT: [0] - 0x03
+Data writes, without response:
+    [0..3] - offset of the chunk in the image, little endian, [4..] - chunk
+Result, notified on the control characteristic after every control write and after a rejected chunk:
+*/
+typedef struct __attribute__((packed)) {
+    uint8_t opcode;          // Write it answers
+    uint8_t status;          // svcOtaStatus_t
+    uint32_t offset;         // Next offset expected by the device, where a resumed transfer carries on
+    uint32_t bytesPerSecond; // Since the last begin
+} OtaResult;
+
+typedef struct {
+    svcBleCharacteristic_t characteristic;
+    uint16_t length;
+    uint8_t data[OTA_MAX_WRITE_SIZE];
+} OtaWrite;
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static bool handleControl(const uint8_t *data, size_t length);
+
+static void handleData(const uint8_t *data, size_t length);
+
+static void notifyResult(uint8_t opcode, svcOtaStatus_t status);
+
+static uint32_t readLittleEndian32(const uint8_t *data);
+
+static uint32_t bytesPerSecond();
+
+static void commandOta(cmd *c);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static BleTransport *transport = nullptr;
+static EspOtaPartition target;
+static svcOtaSession_t session;
+
+static QueueHandle_t writeQueue = nullptr;
+// Staging copy of the BLE stack task, kept off its stack
+static OtaWrite receivedWrite;
+// Write being handled by the OTA task
+static OtaWrite pendingWrite;
+static volatile uint32_t droppedWrites = 0;
+
+static uint32_t transferStartMs = 0;
+static uint32_t transferStartOffset = 0;
+// A sender pipelining chunks after a lost one is told the expected offset once, not once per chunk
+static bool offsetReported = false;
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+void modOtaInit(BleTransport *bleTransport) {
+    transport = bleTransport;
+
+    svcCliAddCmdHelp("ota", "Show the firmware update in progress");
+    svcCliGetCli0()->addCommand("ota", commandOta);
+
+    const OtaResult idle = {0, SVC_OTA_NO_SESSION, 0, 0};
+    transport->setValue(SVC_BLE_CHAR_OTA_CONTROL, (const uint8_t *) &idle, sizeof(idle));
+
+    // The BLE stack is up, so this image can at least receive the next update
+    svcOtaEspConfirmBoot(true);
+}
+
+void modOtaHandleWrite(svcBleCharacteristic_t characteristic, const uint8_t *data, size_t length) {
+    if (writeQueue == nullptr || length > OTA_MAX_WRITE_SIZE) {
+        return;
+    }
+
+    receivedWrite.characteristic = characteristic;
+    receivedWrite.length = (uint16_t) length;
+    memcpy(receivedWrite.data, data, length);
+    if (xQueueSend(writeQueue, &receivedWrite, 0) != pdTRUE) {
+        droppedWrites++;
+    }
+}
+
+_Noreturn void modOtaTaskProcess(void *pvParameters) {
+    writeQueue = xQueueCreate(OTA_QUEUE_SIZE, sizeof(OtaWrite));
+
+    while (true) {
+        if (!xQueueReceive(writeQueue, &pendingWrite, portMAX_DELAY)) {
+            continue;
+        }
+        if (pendingWrite.characteristic == SVC_BLE_CHAR_OTA_DATA) {
+            handleData(pendingWrite.data, pendingWrite.length);
+        } else if (pendingWrite.characteristic == SVC_BLE_CHAR_OTA_CONTROL &&
+                   handleControl(pendingWrite.data, pendingWrite.length)) {
+            vTaskDelay(pdMS_TO_TICKS(OTA_RESTART_DELAY_MS));
+            ESP.restart();
+        }
+    }
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+bool handleControl(const uint8_t *data, size_t length) {
+    if (length == 0) {
+        return false;
+    }
+    SVC_TRACE_SCOPE("ota.control");
+
+    svcOtaStatus_t status = SVC_OTA_BAD_PACKET;
+    switch (data[0]) {
+        case OTA_OPCODE_BEGIN:
+            if (length <= OTA_BEGIN_HEADER_SIZE) {
+                break;
+            }
+            if (!svcOtaEspHasKey()) {
+                SVC_LOG_ERROR("OTA refused, the firmware was built without custom_ota_public_key");
+                status = SVC_OTA_BAD_SIGNATURE;
+                break;
+            }
+            if (target.partition == nullptr && !target.begin()) {
+                SVC_LOG_ERROR("OTA refused, no second app partition");
+                status = SVC_OTA_FLASH_ERROR;
+                break;
+            }
+
+            status = svcOtaBegin(&session, &target, readLittleEndian32(&data[1]), &data[5],
+                                 &data[OTA_BEGIN_HEADER_SIZE], length - OTA_BEGIN_HEADER_SIZE);
+            if (status == SVC_OTA_OK || status == SVC_OTA_RESUMED) {
+                transferStartMs = millis();
+                transferStartOffset = session.received;
+                offsetReported = false;
+                SVC_LOG_INFO("OTA of %lu bytes to %s, %s at %lu", (unsigned long) session.imageSize,
+                             target.partition->label, status == SVC_OTA_OK ? "starting" : "resuming",
+                             (unsigned long) session.received);
+            }
+            break;
+        case OTA_OPCODE_END:
+            // Reading back and hashing the image takes about a second, the writes arriving meanwhile wait in the queue
+            status = svcOtaFinish(&session, svcOtaEspVerify);
+            if (status == SVC_OTA_OK && !svcOtaEspApply(&target)) {
+                status = SVC_OTA_FLASH_ERROR;
+            }
+            SVC_LOG_INFO("OTA finished: %s, %lu bytes at %lu B/s", svcOtaStatusToString(status),
+                         (unsigned long) session.received, (unsigned long) bytesPerSecond());
+            break;
+        case OTA_OPCODE_ABORT:
+            svcOtaAbort(&session);
+            status = SVC_OTA_OK;
+            SVC_LOG_INFO("OTA aborted at %lu", (unsigned long) session.received);
+            break;
+        default:
+            break;
+    }
+    notifyResult(data[0], status);
+    return data[0] == OTA_OPCODE_END && status == SVC_OTA_OK;
+}
+
+void handleData(const uint8_t *data, size_t length) {
+    if (length <= OTA_DATA_HEADER_SIZE) {
+        notifyResult(OTA_OPCODE_DATA, SVC_OTA_BAD_PACKET);
+        return;
+    }
+
+    const svcOtaStatus_t status = svcOtaWrite(&session, readLittleEndian32(data), &data[OTA_DATA_HEADER_SIZE],
+                                              length - OTA_DATA_HEADER_SIZE);
+    if (status == SVC_OTA_OK) {
+        offsetReported = false;
+        return;
+    }
+    if (status == SVC_OTA_WRONG_OFFSET) {
+        if (offsetReported) {
+            return;
+        }
+        offsetReported = true;
+    }
+    notifyResult(OTA_OPCODE_DATA, status);
+}
+
+void notifyResult(uint8_t opcode, svcOtaStatus_t status) {
+    const OtaResult result = {opcode, (uint8_t) status, session.received, bytesPerSecond()};
+    transport->setValue(SVC_BLE_CHAR_OTA_CONTROL, (const uint8_t *) &result, sizeof(result));
+    transport->notify(SVC_BLE_CHAR_OTA_CONTROL);
+}
+
+uint32_t readLittleEndian32(const uint8_t *data) {
+    return data[0] | (uint32_t) data[1] << 8 | (uint32_t) data[2] << 16 | (uint32_t) data[3] << 24;
+}
+
+uint32_t bytesPerSecond() {
+    const uint32_t elapsedMs = millis() - transferStartMs;
+    const uint32_t bytes = session.received - transferStartOffset;
+    return elapsedMs > 0 ? (uint32_t) ((uint64_t) bytes * 1000 / elapsedMs) : 0;
+}
+
+void commandOta(cmd *c) {
+    svcCliOut()->write("\r\n");
+    svcCliOut()->printf("Running from %s, release key %s\n", esp_ota_get_running_partition()->label,
+                        svcOtaEspHasKey() ? "present" : "missing");
+    if (!session.active) {
+        svcCliOut()->println(session.verified ? "Update verified, restarting" : "No update in progress");
+        return;
+    }
+    svcCliOut()->printf("Update to %s: %lu / %lu bytes, %lu B/s, %lu writes dropped\n", target.partition->label,
+                        (unsigned long) session.received, (unsigned long) session.imageSize,
+                        (unsigned long) bytesPerSecond(), (unsigned long) droppedWrites);
+}
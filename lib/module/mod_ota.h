@@ -0,0 +1,68 @@
+/*===========================================================================*/
+/// \file mod_ota.h
+///
+/// \brief
+///    Module for updating the firmware over BLE
+///
+/// \details
+///     Receive a signed image on the OTA characteristics, write it to the inactive app partition, and boot it once
+///     its hash and signature are verified
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOD_OTA_H
+#define MOD_OTA_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+#include <svc_ble_transport.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Register the CLI command and confirm the running image, called once the BLE stack is up
+/// \param bleTransport The started transport, used for the result notifications
+void modOtaInit(BleTransport *bleTransport);
+
+/// \brief Queue a write to one of the OTA characteristics for the OTA task, called from the BLE stack task
+/// \param characteristic SVC_BLE_CHAR_OTA_CONTROL or SVC_BLE_CHAR_OTA_DATA
+/// \param data The written value
+/// \param length Bytes in the value
+void modOtaHandleWrite(svcBleCharacteristic_t characteristic, const uint8_t *data, size_t length);
+
+/// \brief Entry point of the task writing the image to flash, verifying it and restarting into it
+/// \param[in] pvParameters - FreeRTOS task parameters
+_Noreturn void modOtaTaskProcess(void *pvParameters);
+
+#endif // MOD_OTA_H
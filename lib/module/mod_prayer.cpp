@@ -18,13 +18,20 @@
 
 #include <mod_prayer.h>
 #include <mod_timings.h>
-#include <svc_display.h>
+#include <svc_event.h>
+#include <svc_clock.h>
 #include <svc_cli.h>
+#include <svc_log.h>
+#include <svc_state.h>
+#include <svc_trace.h>
 
 /*=============================================================================
                                      Defines
 =============================================================================*/
 
+#define MOD_PRAYER_EVENT_QUEUE_SIZE 8
+#define MOD_PRAYER_MAX_WAIT_MS 60000
+
 /*=============================================================================
                                      Macros
 =============================================================================*/
@@ -54,27 +61,30 @@ typedef enum {
                             Private Function Prototypes
 =============================================================================*/
 
+static void handleEvent(const svcEvent_t *event);
+
 static void processPrayerTimings();
 
-static void waitUntilNextPrayer();
+static int64_t getPrayerTimestamp(int64_t localMidnight, const Prayer *prayer);
 
 static void setCurrentTime(cmd *c);
 
 static void printCurrentTime(cmd *c);
 
+static void setWarp(cmd *c);
+
 static void modPrayerRegisterCommands();
 
-static bool isTimeValid(tm time);
+static bool isTimeValid(svcClockDateTime_t time);
 
 /*=============================================================================
                                 Private Variables
 =============================================================================*/
 
-static QueueHandle_t prayerQueue;
-static SemaphoreHandle_t prayerSemaphore;
-static PrayerTimings prayerTimings;
-static Prayer nextPrayer;
-static bool isNextDayPrayer = false;
+static QueueHandle_t eventQueue;
+static const PrayerTimetable *timetable = nullptr;
+// Only written by this task, everybody else reads it through svcStateRead()
+static svcState_t state = {{0, 0, NONE}, 0, SVC_CLOCK_SOURCE_NONE, SYNC_NONE, false, 0, 0};
 
 /*=============================================================================
                                 Private Constants
@@ -89,133 +99,216 @@ static bool isNextDayPrayer = false;
 =============================================================================*/
 
 _Noreturn void modPrayerTaskProcess(void *pvParameters) {
-    auto *modPrayerParams = (modPrayerParams_t *) pvParameters;
-    prayerQueue = modPrayerParams->prayersQueue;
+    eventQueue = svcEventSubscribe(SVC_EVENT_MASK(SVC_EVENT_TIMETABLE_UPDATED) |
+                                   SVC_EVENT_MASK(SVC_EVENT_TIME_CHANGED) |
+                                   SVC_EVENT_MASK(SVC_EVENT_SYNC_CHANGED),
+                                   MOD_PRAYER_EVENT_QUEUE_SIZE);
 
     modPrayerRegisterCommands();
 
     while (true) {
-        vTaskDelay(1000);
-        if (xQueueReceive(prayerQueue, &prayerTimings, (TickType_t) 5)) {
-            if (strcmp(prayerTimings.date.c_str(), "0/0/0") == 0) {
-                Serial.println("Finished receiving prayer timings");
-                xSemaphoreGive(prayerSemaphore);
-                continue;
+        // Sleep on the monotonic timer until the next prayer, any clock or timetable change wakes us up earlier
+        TickType_t timeout = pdMS_TO_TICKS(MOD_PRAYER_MAX_WAIT_MS);
+        if (state.nextPrayer.name != NONE) {
+            // Real time, a warped clock reaches the prayer sooner
+            const int64_t remaining = svcClockRealMsUntil(state.nextPrayerUtc * 1000);
+            if (remaining < MOD_PRAYER_MAX_WAIT_MS) {
+                timeout = pdMS_TO_TICKS(remaining);
             }
+        }
+
+        svcEvent_t event;
+        if (xQueueReceive(eventQueue, &event, timeout)) {
+            SVC_TRACE_INSTANT("prayer.wake", event.topic);
+            handleEvent(&event);
+        }
+
+        if (state.nextPrayer.name != NONE && svcClockNow() >= state.nextPrayerUtc) {
+            svcEvent_t prayerDue = {SVC_EVENT_PRAYER_DUE};
+            prayerDue.data.prayer = state.nextPrayer;
+            SVC_TRACE_INSTANT("prayer.due", state.nextPrayer.name);
+            svcEventPublish(&prayerDue);
             processPrayerTimings();
         }
     }
 }
 
+bool modPrayerFindNext(const PrayerTimetable *timetable, int64_t now, Prayer *prayer, int64_t *timestamp) {
+    // Get the current time
+    const int64_t localNow = svcClockUtcToLocal(now);
+    svcClockDateTime_t currentTime;
+    svcClockToDateTime(localNow, &currentTime);
+    const int64_t localMidnight = localNow - (currentTime.hour * 3600 + currentTime.minute * 60 + currentTime.second);
+
+    // Get the next prayer, today first and then tomorrow's fajr
+    const PrayerTimings *today = modPrayerGetDayTimings(timetable, &currentTime);
+    if (today != nullptr) {
+        const Prayer *prayers[] = {&today->fajr, &today->dhuhr, &today->asr, &today->maghrib, &today->isha};
+        for (const Prayer *candidate: prayers) {
+            const int64_t candidateTimestamp = getPrayerTimestamp(localMidnight, candidate);
+            if (candidateTimestamp > now) {
+                *prayer = *candidate;
+                *timestamp = candidateTimestamp;
+                return true;
+            }
+        }
+    }
+
+    // Local seconds, a day is always the same length there
+    svcClockDateTime_t tomorrowDate;
+    svcClockToDateTime(localMidnight + SVC_CLOCK_SECONDS_PER_DAY, &tomorrowDate);
+    const PrayerTimings *tomorrow = modPrayerGetDayTimings(timetable, &tomorrowDate);
+    if (tomorrow == nullptr) {
+        return false;
+    }
+    *prayer = tomorrow->fajr;
+    *timestamp = getPrayerTimestamp(localMidnight + SVC_CLOCK_SECONDS_PER_DAY, &tomorrow->fajr);
+    return true;
+}
+
+const PrayerTimings *modPrayerGetDayTimings(const PrayerTimetable *timetable, const svcClockDateTime_t *date) {
+    if (timetable == nullptr || date->day < MIN_DAY || date->day > timetable->numberOfDays) {
+        return nullptr;
+    }
+
+    // Indexed by the day of the month only, last month's table must not stand in for this one
+    const PrayerTimings *timings = &timetable->days[date->day - 1];
+    if (timings->fajr.name == NONE || timings->month != date->month || timings->year != date->year) {
+        return nullptr;
+    }
+    return timings;
+}
+
 /*=============================================================================
                                 Private Functions
 =============================================================================*/
 
-void processPrayerTimings() {
-    // Get the current time
-    tm currentTime;
-    time_t now;
-    time(&now);
-    localtime_r(&now, &currentTime);
-
-    Serial.printf("Processing prayer timings for %s\n", prayerTimings.date.c_str());
-
-    // Get the next prayer
-    if (currentTime.tm_hour < prayerTimings.fajr.hour ||
-        (currentTime.tm_hour == prayerTimings.fajr.hour && currentTime.tm_min < prayerTimings.fajr.minute)) {
-        nextPrayer = prayerTimings.fajr;
-    } else if (currentTime.tm_hour < prayerTimings.dhuhr.hour ||
-               (currentTime.tm_hour == prayerTimings.dhuhr.hour && currentTime.tm_min < prayerTimings.dhuhr.minute)) {
-        nextPrayer = prayerTimings.dhuhr;
-    } else if (currentTime.tm_hour < prayerTimings.asr.hour ||
-               (currentTime.tm_hour == prayerTimings.asr.hour && currentTime.tm_min < prayerTimings.asr.minute)) {
-        nextPrayer = prayerTimings.asr;
-    } else if (currentTime.tm_hour < prayerTimings.maghrib.hour || (currentTime.tm_hour == prayerTimings.maghrib.hour &&
-                                                                    currentTime.tm_min <
-                                                                    prayerTimings.maghrib.minute)) {
-        nextPrayer = prayerTimings.maghrib;
-    } else if (currentTime.tm_hour < prayerTimings.isha.hour ||
-               (currentTime.tm_hour == prayerTimings.isha.hour && currentTime.tm_min < prayerTimings.isha.minute)) {
-        nextPrayer = prayerTimings.isha;
-    } else if (isNextDayPrayer) {
-        nextPrayer = prayerTimings.fajr;
-    } else {
-        Serial.println("No more prayers for today");
-        isNextDayPrayer = true;
-        return;
+void handleEvent(const svcEvent_t *event) {
+    switch (event->topic) {
+        case SVC_EVENT_TIMETABLE_UPDATED:
+            svcEventRelease(timetable);
+            timetable = (const PrayerTimetable *) event->data.buffer;
+            state.numberOfDays = timetable->numberOfDays;
+            state.syncStatus = SYNC_DONE;
+            state.timetableVersion++;
+            SVC_LOG_INFO("Received prayer timings for %d days", timetable->numberOfDays);
+            break;
+        case SVC_EVENT_TIME_CHANGED:
+            state.timeSource = svcClockGetSource();
+            SVC_LOG_INFO("Time changed, rescheduling");
+            break;
+        case SVC_EVENT_SYNC_CHANGED:
+            state.connected = event->data.sync.connected;
+            state.syncStatus = event->data.sync.status;
+            // Nothing to reschedule
+            svcStatePublish(&state);
+            return;
+        default:
+            return;
     }
-
-    Serial.printf("Next prayer at %02d:%02d\n", nextPrayer.hour, nextPrayer.minute);
-
-    svcDisplayNextPrayer(nextPrayer);
-    waitUntilNextPrayer();
     processPrayerTimings();
 }
 
-void waitUntilNextPrayer() {
-    // Get the current time
-    tm currentTime;
-    time_t now;
-    time(&now);
-    localtime_r(&now, &currentTime);
-    Serial.printf("Current time is %02d:%02d\n", currentTime.tm_hour, currentTime.tm_min);
-
-    tm nextPrayerTime;
-    localtime_r(&now, &nextPrayerTime);
-    nextPrayerTime.tm_hour = nextPrayer.hour;
-    nextPrayerTime.tm_min = nextPrayer.minute;
-    if (isNextDayPrayer) {
-        nextPrayerTime.tm_mday++;
-        isNextDayPrayer = false;
+void processPrayerTimings() {
+    if (timetable == nullptr) {
+        // Still publish a time source change
+        svcStatePublish(&state);
+        return;
+    }
+    SVC_TRACE_SCOPE("prayer.schedule");
+
+    const int64_t now = svcClockNow();
+    if (!modPrayerFindNext(timetable, now, &state.nextPrayer, &state.nextPrayerUtc)) {
+        svcClockDateTime_t today;
+        svcClockToDateTime(svcClockUtcToLocal(now), &today);
+        SVC_LOG_INFO("No prayer timings for %04u-%02u-%02u in the timetable, waiting for the next one", today.year,
+                     today.month, today.day);
+        state.nextPrayer = {0, 0, NONE};
+        svcStatePublish(&state);
+        // The screen still shows the last prayer of the previous timetable otherwise
+        svcEvent_t event = {SVC_EVENT_DISPLAY_REQUEST};
+        event.data.prayer = state.nextPrayer;
+        svcEventPublish(&event);
+        return;
     }
 
-    time_t nextPrayerTimestamp = mktime(&nextPrayerTime);
-    time_t currentTimestamp = mktime(&currentTime);
-
-    int delay = difftime(nextPrayerTimestamp, currentTimestamp);
-    Serial.printf("Waiting for %d seconds\n", delay);
-
-    while (delay > 0) {
-        time(&now);
-        localtime_r(&now, &currentTime);
-        currentTimestamp = mktime(&currentTime);
-        delay = difftime(nextPrayerTimestamp, currentTimestamp);
-        vTaskDelay(1000);
+    SVC_LOG_INFO("Next prayer at %02d:%02d, waiting for %ld seconds", state.nextPrayer.hour, state.nextPrayer.minute,
+                  (long) (state.nextPrayerUtc - now));
+
+    // Published before the request so its subscribers already read the new prayer from the snapshot
+    svcStatePublish(&state);
+    svcEvent_t event = {SVC_EVENT_DISPLAY_REQUEST};
+    event.data.prayer = state.nextPrayer;
+    svcEventPublish(&event);
+
+    // The screen due at the next prayer is rendered ahead, only its transfer is left at the boundary
+    Prayer following;
+    int64_t followingUtc;
+    if (modPrayerFindNext(timetable, state.nextPrayerUtc, &following, &followingUtc)) {
+        svcEvent_t prepare = {SVC_EVENT_DISPLAY_PREPARE};
+        prepare.data.prepare.prayer = following;
+        prepare.data.prepare.prayerUtc = followingUtc;
+        prepare.data.prepare.utc = state.nextPrayerUtc;
+        svcEventPublish(&prepare);
     }
 }
 
+int64_t getPrayerTimestamp(int64_t localMidnight, const Prayer *prayer) {
+    // Converted through the transition table of that instant, so a DST change during the month is taken into account
+    return svcClockLocalToUtc(localMidnight + prayer->hour * 3600 + prayer->minute * 60);
+}
+
 void setCurrentTime(cmd *c) {
     Command cmd(c);
     if (cmd.countArgs() != 3) {
-        Serial.println("Usage: settime <day> <hour> <minute>");
+        svcCliOut()->println("Usage: settime <day> <hour> <minute>");
         return;
     }
-    tm currentTime;
-    time_t now;
-    time(&now);
-    localtime_r(&now, &currentTime);
-
-    currentTime.tm_mday = cmd.getArgument(0).getValue().toInt();
-    currentTime.tm_hour = cmd.getArgument(1).getValue().toInt();
-    currentTime.tm_min = cmd.getArgument(2).getValue().toInt();
+    svcClockDateTime_t currentTime;
+    svcClockToDateTime(svcClockUtcToLocal(svcClockNow()), &currentTime);
+
+    currentTime.day = cmd.getArgument(0).getValue().toInt();
+    currentTime.hour = cmd.getArgument(1).getValue().toInt();
+    currentTime.minute = cmd.getArgument(2).getValue().toInt();
+    currentTime.second = 0;
     if (!isTimeValid(currentTime)) {
-        Serial.println("Invalid time");
+        svcCliOut()->println("Invalid time");
         return;
     }
 
+    const int64_t newTime = svcClockLocalToUtc(svcClockFromDateTime(&currentTime));
+    svcCliOut()->printf("Setting time to %02d:%02d\n", currentTime.hour, currentTime.minute);
+    svcClockSet(newTime, SVC_CLOCK_SOURCE_CLI);
 
-    time_t newTime = mktime(&currentTime);
-    Serial.printf("Setting time to %02d:%02d\n", currentTime.tm_hour, currentTime.tm_min);
-    struct timeval tv = {newTime, 0};
-    settimeofday(&tv, nullptr);
+    svcEvent_t event = {SVC_EVENT_TIME_CHANGED};
+    event.data.time = newTime;
+    svcEventPublish(&event);
 }
 
 void printCurrentTime(cmd *c) {
-    tm currentTime;
-    time_t now;
-    time(&now);
-    localtime_r(&now, &currentTime);
-    Serial.printf("Current time is %02d:%02d\n", currentTime.tm_hour, currentTime.tm_min);
+    const int64_t now = svcClockNow();
+    svcClockDateTime_t currentTime;
+    svcClockToDateTime(svcClockUtcToLocal(now), &currentTime);
+    svcCliOut()->printf("Current time is %02d:%02d (%s, UTC%+ld min)\n", currentTime.hour, currentTime.minute,
+                        svcClockZoneName(), (long) (svcClockUtcOffset(now) / 60));
+}
+
+void setWarp(cmd *c) {
+    Command cmd(c);
+    if (cmd.countArgs() == 0) {
+        svcCliOut()->printf("Clock warp x%lu\n", (unsigned long) svcClockGetWarp());
+        return;
+    }
+    if (cmd.countArgs() != 1 || !svcClockSetWarp(cmd.getArgument(0).getValue().toInt())) {
+        svcCliOut()->printf("Usage: warp <1 - %lu>\n", (unsigned long) SVC_CLOCK_MAX_WARP);
+        return;
+    }
+    svcCliOut()->printf("Clock warp x%lu\n", (unsigned long) svcClockGetWarp());
+
+    // The clock did not jump but every pending wait was computed for the previous speed
+    svcEvent_t event = {SVC_EVENT_TIME_CHANGED};
+    event.data.time = svcClockNow();
+    svcEventPublish(&event);
 }
 
 void modPrayerRegisterCommands() {
@@ -225,10 +318,13 @@ void modPrayerRegisterCommands() {
 
     svcCliAddCmdHelp("gettime", "Get the current time");
     cli->addCommand("gettime", printCurrentTime);
+
+    svcCliAddCmdHelp("warp", "Run the clock faster than real time [factor]");
+    cli->addBoundlessCommand("warp", setWarp);
 }
 
-bool isTimeValid(tm time) {
-    return time.tm_mday >= MIN_DAY && time.tm_mday <= MAX_DAY &&
-           time.tm_hour >= MIN_HOUR && time.tm_hour <= MAX_HOUR &&
-           time.tm_min >= MIN_MINUTE && time.tm_min <= MAX_MINUTE;
+bool isTimeValid(svcClockDateTime_t time) {
+    return time.day >= MIN_DAY && time.day <= MAX_DAY &&
+           time.hour >= MIN_HOUR && time.hour <= MAX_HOUR &&
+           time.minute >= MIN_MINUTE && time.minute <= MAX_MINUTE;
 }
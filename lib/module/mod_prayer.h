@@ -20,6 +20,8 @@
 =============================================================================*/
 
 #include <Arduino.h>
+#include <mod_timings.h>
+#include <svc_clock.h>
 
 /*=============================================================================
                                      Defines
@@ -41,11 +43,6 @@
                                     Structures
 =============================================================================*/
 
-typedef struct {
-    QueueHandle_t prayersQueue;
-    SemaphoreHandle_t prayerSemaphore;
-} modPrayerParams_t;
-
 /*=============================================================================
                                 Public Constants
 =============================================================================*/
@@ -58,4 +55,18 @@ typedef struct {
 /// \param[in] pvParameters - FreeRTOS task parameters
 _Noreturn void modPrayerTaskProcess(void *pvParameters);
 
+/// \brief Find the first prayer after an instant, today's prayers first and then tomorrow's fajr
+/// \param timetable The timetable of the current month
+/// \param now UTC seconds since the epoch
+/// \param prayer Filled with the next prayer
+/// \param timestamp Filled with the UTC time of the next prayer
+/// \return true if a prayer was found, false if the timetable has no more days
+bool modPrayerFindNext(const PrayerTimetable *timetable, int64_t now, Prayer *prayer, int64_t *timestamp);
+
+/// \brief Get the timings of a date from the timetable
+/// \param timetable The timetable of a month
+/// \param date Local date, the time of day is ignored
+/// \return The timings of the date, nullptr if the day was not received or the timetable is for another month
+const PrayerTimings *modPrayerGetDayTimings(const PrayerTimetable *timetable, const svcClockDateTime_t *date);
+
 #endif // MOD_PRAYER_H
@@ -0,0 +1,257 @@
+/*===========================================================================*/
+/// \file mod_telemetry.cpp
+///
+/// \brief
+///    Module for the health snapshot read by the fleet monitoring
+///
+/// \details
+///    The snapshot is only built from counters the modules already keep, in the timer task. The same bytes are
+///    printed in hex by the CLI command so a serial capture goes through the same decoder as a BLE read.
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <mod_telemetry.h>
+#include <mod_display.h>
+#include <esp_timer.h>
+#include <freertos/timers.h>
+#include <svc_cli.h>
+#include <svc_clock.h>
+#include <svc_display.h>
+#include <svc_event.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define MOD_TELEMETRY_EVENT_QUEUE_SIZE 2
+// Age of something that did not happen since boot
+#define TELEMETRY_NEVER UINT32_MAX
+#define TELEMETRY_NO_TASK UINT16_MAX
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*
+Telemetry snapshot, read or notified on SVC_BLE_CHAR_TELEMETRY, little endian:
+[0] - Version, MOD_TELEMETRY_VERSION
+[1] - Number of task stacks at the end
+[2..5] - Uptime, seconds
+[6..9] - Free heap, bytes
+[10..13] - Lowest free heap since boot, bytes
+[14..17] - Seconds since the last timetable was published, TELEMETRY_NEVER if none since boot
+[18..21] - Seconds since the last applied time exchange, TELEMETRY_NEVER if none since boot
+[22..25] - Offset removed by that exchange, microseconds, signed and saturated
+[26..29] - Estimated error bound of the clock now, microseconds, saturated
+[30..33] - Rate correction of the clock, ppb, signed
+[34] - Time source, svcClockSource_t
+[35..38] - Prepared screens swapped in at their prayer boundary
+[39..42] - Swaps over MOD_DISPLAY_LATENCY_TARGET_US
+[43..46] - Prepared screens shown after their boundary
+[47..50] - Boundary to pixels latency of the last swap, microseconds
+[51..54] - Highest boundary to pixels latency, microseconds
+[55..58] - Frames flushed to the panels
+[59..62] - Page transfers that failed
+[63..66] - Duration of the last flush, microseconds
+[67..70] - Longest flush, microseconds
+[71..74] - Events dropped on the bus, every topic
+[75..] - Free stack of each task in modTelemetryTask_t order, 2 bytes each, TELEMETRY_NO_TASK if not running
+*/
+typedef struct __attribute__((packed)) {
+    uint8_t version;
+    uint8_t taskCount;
+    uint32_t uptimeS;
+    uint32_t freeHeap;
+    uint32_t minFreeHeap;
+    uint32_t timetableAgeS;
+    uint32_t clockSyncAgeS;
+    int32_t clockOffsetUs;
+    uint32_t clockErrorUs;
+    int32_t clockDriftPpb;
+    uint8_t timeSource;
+    uint32_t boundarySwaps;
+    uint32_t boundariesLate;
+    uint32_t boundariesMissed;
+    uint32_t latencyLastUs;
+    uint32_t latencyMaxUs;
+    uint32_t framesFlushed;
+    uint32_t flushErrors;
+    uint32_t flushLastUs;
+    uint32_t flushMaxUs;
+    uint32_t eventsDropped;
+    uint16_t stackFree[MOD_TELEMETRY_TASK_COUNT];
+} TelemetryPacket;
+
+static_assert(sizeof(TelemetryPacket) == 75 + 2 * MOD_TELEMETRY_TASK_COUNT, "The decoder reads fixed offsets");
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static void buildSnapshot(TelemetryPacket *packet);
+
+static void refreshTimerCallback(TimerHandle_t timer);
+
+static uint32_t saturateUnsigned(int64_t value);
+
+static int32_t saturateSigned(int64_t value);
+
+static void commandTelemetry(cmd *c);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static BleTransport *transport = nullptr;
+static QueueHandle_t eventQueue = nullptr;
+static TimerHandle_t refreshTimer = nullptr;
+static TaskHandle_t tasks[MOD_TELEMETRY_TASK_COUNT];
+
+// Written by the timer task
+static bool timetableReceived = false;
+static int64_t timetableReceivedUs = 0;
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+bool modTelemetryInit(BleTransport *bleTransport) {
+    transport = bleTransport;
+
+    svcCliAddCmdHelp("telemetry", "Print the telemetry snapshot in hex, for scripts/telemetry_decode.py");
+    svcCliGetCli0()->addCommand("telemetry", commandTelemetry);
+
+    eventQueue = svcEventSubscribe(SVC_EVENT_MASK(SVC_EVENT_TIMETABLE_UPDATED), MOD_TELEMETRY_EVENT_QUEUE_SIZE);
+    refreshTimer = xTimerCreate("telemetry", pdMS_TO_TICKS(MOD_TELEMETRY_PERIOD_MS), pdTRUE, nullptr,
+                                refreshTimerCallback);
+    if (eventQueue == nullptr || refreshTimer == nullptr || xTimerStart(refreshTimer, 0) != pdPASS) {
+        return false;
+    }
+
+    // Readable right away, not only after the first period
+    refreshTimerCallback(refreshTimer);
+    return true;
+}
+
+void modTelemetrySetTask(modTelemetryTask_t task, TaskHandle_t handle) {
+    if (task < MOD_TELEMETRY_TASK_COUNT) {
+        tasks[task] = handle;
+    }
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+void buildSnapshot(TelemetryPacket *packet) {
+    const int64_t uptimeUs = esp_timer_get_time();
+    const int64_t now = svcClockNow();
+
+    packet->version = MOD_TELEMETRY_VERSION;
+    packet->taskCount = MOD_TELEMETRY_TASK_COUNT;
+    packet->uptimeS = (uint32_t) (uptimeUs / 1000000);
+    packet->freeHeap = ESP.getFreeHeap();
+    packet->minFreeHeap = ESP.getMinFreeHeap();
+    packet->timetableAgeS = timetableReceived ? (uint32_t) ((uptimeUs - timetableReceivedUs) / 1000000)
+                                              : TELEMETRY_NEVER;
+
+    svcClockSyncStatus_t clock;
+    svcClockGetSyncStatus(&clock);
+    packet->clockSyncAgeS = clock.syncedUtc != 0 ? saturateUnsigned(now - clock.syncedUtc) : TELEMETRY_NEVER;
+    packet->clockOffsetUs = saturateSigned(clock.offsetUs);
+    packet->clockErrorUs = saturateUnsigned(clock.errorUs);
+    packet->clockDriftPpb = clock.driftPpb;
+    packet->timeSource = svcClockGetSource();
+
+    modDisplayLatencyStats_t latency;
+    modDisplayGetLatencyStats(&latency);
+    packet->boundarySwaps = latency.swaps;
+    packet->boundariesLate = latency.late;
+    packet->boundariesMissed = latency.missed;
+    packet->latencyLastUs = saturateUnsigned(latency.lastUs);
+    packet->latencyMaxUs = saturateUnsigned(latency.maxUs);
+
+    svcDisplayFlushStats_t flush;
+    svcDisplayGetFlushStats(&flush);
+    packet->framesFlushed = flush.frames;
+    packet->flushErrors = flush.errors;
+    packet->flushLastUs = flush.lastUs;
+    packet->flushMaxUs = flush.maxUs;
+
+    uint32_t dropped = 0;
+    for (int topic = 0; topic < SVC_EVENT_TOPIC_COUNT; topic++) {
+        svcEventStats_t stats;
+        if (svcEventGetStats((svcEventTopic_t) topic, &stats)) {
+            dropped += stats.dropped;
+        }
+    }
+    packet->eventsDropped = dropped;
+
+    for (int i = 0; i < MOD_TELEMETRY_TASK_COUNT; i++) {
+        packet->stackFree[i] = tasks[i] != nullptr ? (uint16_t) uxTaskGetStackHighWaterMark(tasks[i])
+                                                   : TELEMETRY_NO_TASK;
+    }
+}
+
+void refreshTimerCallback(TimerHandle_t timer) {
+    svcEvent_t event;
+    while (xQueueReceive(eventQueue, &event, 0) == pdTRUE) {
+        svcEventRelease(event.data.buffer);
+        timetableReceived = true;
+        timetableReceivedUs = esp_timer_get_time();
+    }
+
+    TelemetryPacket packet;
+    buildSnapshot(&packet);
+    transport->setValue(SVC_BLE_CHAR_TELEMETRY, (const uint8_t *) &packet, sizeof(packet));
+    if (transport->isConnected()) {
+        transport->notify(SVC_BLE_CHAR_TELEMETRY);
+    }
+}
+
+uint32_t saturateUnsigned(int64_t value) {
+    if (value < 0) {
+        return 0;
+    }
+    return value > UINT32_MAX ? UINT32_MAX : (uint32_t) value;
+}
+
+int32_t saturateSigned(int64_t value) {
+    if (value < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return value > INT32_MAX ? INT32_MAX : (int32_t) value;
+}
+
+void commandTelemetry(cmd *c) {
+    // Built again rather than read back from the characteristic, the counters are the ones of now
+    TelemetryPacket packet;
+    buildSnapshot(&packet);
+
+    svcCliOut()->write("\r\n");
+    svcCliOut()->print("telemetry,");
+    const uint8_t *bytes = (const uint8_t *) &packet;
+    for (size_t i = 0; i < sizeof(packet); i++) {
+        svcCliOut()->printf("%02x", bytes[i]);
+    }
+    svcCliOut()->println();
+}
@@ -0,0 +1,81 @@
+/*===========================================================================*/
+/// \file mod_telemetry.h
+///
+/// \brief
+///    Module for the health snapshot read by the fleet monitoring
+///
+/// \details
+///     A fixed size binary snapshot of the counters kept by the other modules (uptime, heap, task stacks, sync age,
+///     clock offset, prayer boundary swaps, display flushes) is rebuilt periodically into a read/notify
+///     characteristic. Nothing is formatted on the device, scripts/telemetry_decode.py turns it into text.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOD_TELEMETRY_H
+#define MOD_TELEMETRY_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+#include <svc_ble_transport.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define MOD_TELEMETRY_VERSION 1
+// Age of the snapshot at most, a read between two refreshes gets the previous one
+#define MOD_TELEMETRY_PERIOD_MS 10000
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+/// Slot of each task stack in the snapshot, the decoder names them in this order
+typedef enum {
+    MOD_TELEMETRY_TASK_CLI,
+    MOD_TELEMETRY_TASK_LOG,
+    MOD_TELEMETRY_TASK_TIMINGS,
+    MOD_TELEMETRY_TASK_PRAYER,
+    MOD_TELEMETRY_TASK_DISPLAY,
+    MOD_TELEMETRY_TASK_AUDIO,
+    MOD_TELEMETRY_TASK_WIFI_SYNC,
+    MOD_TELEMETRY_TASK_COUNT
+} modTelemetryTask_t;
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Register the CLI command and start refreshing the characteristic, called once the BLE stack is up
+/// \param bleTransport The started transport
+/// \return true if the module started, false otherwise
+bool modTelemetryInit(BleTransport *bleTransport);
+
+/// \brief Give the handle of a task whose stack high-water mark goes into the snapshot
+/// \param task The slot of the task
+/// \param handle The task, nullptr when it did not start
+void modTelemetrySetTask(modTelemetryTask_t task, TaskHandle_t handle);
+
+#endif // MOD_TELEMETRY_H
@@ -17,24 +17,44 @@
 =============================================================================*/
 
 #include <mod_timings.h>
-#include <BLEDevice.h>
+#include <mod_broadcast.h>
+#include <mod_cli0.h>
+#include <mod_telemetry.h>
+#include <mod_ota.h>
+#include <svc_event.h>
+#include <svc_clock.h>
+#include <svc_ble_transport.h>
+#include <svc_protocol.h>
+#include <svc_cli.h>
+#include <svc_config.h>
+#include <svc_log.h>
+#include <svc_ota_esp.h>
+#include <svc_power.h>
+#include <svc_state.h>
+#include <svc_trace.h>
+#include <mbedtls/sha256.h>
+#include <atomic>
 
 /*=============================================================================
                                      Defines
 =============================================================================*/
 
-#define SERVICE_UUID "4fafc201-1fb5-459e-8fcc-c5c9c331914b"
-#define CHARACTERISTIC_UUID "beb5483e-36e1-4688-b7f5-ea07361b26a8"
+#define STATUS_VERSION 1
+#define TIMETABLE_READBACK_VERSION 1
+#define TIMETABLE_READBACK_DAY_SIZE 14
+#define TIMETABLE_READBACK_SIZE (2 + MAX_DAYS * TIMETABLE_READBACK_DAY_SIZE)
+#define MANIFEST_VERSION 1
+#define MANIFEST_SIZE (2 + (1 + MAX_DAYS) * SVC_PROTOCOL_HASH_SIZE)
+// SHA-256, truncated to SVC_PROTOCOL_HASH_SIZE in the manifest
+#define MANIFEST_DIGEST_SIZE 32
 
-/* Check if Bluetooth configurations are enabled in the SDK */
-#if !defined(CONFIG_BT_ENABLED) || !defined(CONFIG_BLUEDROID_ENABLED)
-#error Bluetooth is not enabled! Please run `make menuconfig` to and enable it
-#endif
-
-#define NUMBER_OF_DAYS_HEADER 0x69
-#define PRAYER_TIMINGS_HEADER 0x42
-#define END_OF_TIMINGS_HEADER 0x88
-#define CURRENT_TIME_HEADER 0x20
+#define MOD_TIMINGS_EVENT_QUEUE_SIZE 4
+// Exchanges waiting for their result, the phone runs them one after the other
+#define TIME_EXCHANGE_SLOTS 4
+// Smaller corrections do not move any scheduled wait enough to reschedule it
+#define TIME_EXCHANGE_EVENT_THRESHOLD_US 100000
+// A bulk link without any write for this long goes back to idle (sync abandoned by the phone)
+#define LINK_BULK_TIMEOUT_MS 5000
 
 /*=============================================================================
                                      Macros
@@ -44,122 +64,268 @@
                                  Type definitions
 =============================================================================*/
 
+typedef enum {
+    LINK_IDLE = SVC_BLE_LINK_IDLE,
+    LINK_BULK = SVC_BLE_LINK_BULK,
+    LINK_UNSET
+} LinkProfile;
+
 /*=============================================================================
                                     Structures
 =============================================================================*/
 
+/*
+Status notification, little endian:
+[0] - Version
+[1] - Sync status
+[2] - Days in the stored timetable
+[3] - Next prayer name (NONE when unknown)
+[4] - Next prayer hour
+[5] - Next prayer minute
+[6..9] - Device clock, UTC seconds when the status was built
+*/
+typedef struct __attribute__((packed)) {
+    uint8_t version;
+    uint8_t syncStatus;
+    uint8_t numberOfDays;
+    uint8_t nextPrayerName;
+    uint8_t nextPrayerHour;
+    uint8_t nextPrayerMinute;
+    uint32_t clock;
+} StatusPacket;
+
+/*
+Time exchange answer, notified on SVC_BLE_CHAR_TIME, little endian:
+[0] - Sequence number of the request
+[1..8] - Device clock when the request was received, microseconds since the epoch
+[9..12] - Microseconds between the reception of the request and this answer
+*/
+typedef struct __attribute__((packed)) {
+    uint8_t sequence;
+    int64_t receivedUs;
+    uint32_t processingUs;
+} TimeAnswer;
+
+typedef struct {
+    bool pending;
+    uint8_t sequence;
+    int64_t t1; // phone, request sent
+    int64_t t2; // device, request received
+    int64_t t3; // device, answer sent
+} TimeExchange;
+
+typedef struct {
+    uint32_t bytes;
+    uint32_t packets;
+    uint32_t rejected;
+    uint32_t startMs;
+    uint32_t durationMs;
+    uint16_t interval;
+    bool dataLengthExtended;
+    bool update;
+} SyncReport;
+
 /*=============================================================================
                             Private Function Prototypes
 =============================================================================*/
 
+static void handleEvent(const svcEvent_t *event);
+
+static int findFreeTimetable();
+
+static void notifyStatus(bool clockChanged);
+
+static void publishSync(bool isConnected, SyncStatus syncStatus);
+
+static void updateTimetableReadback(const PrayerTimetable *timetable);
+
+static void answerTimeRequest(const svcProtocolPacket_t *packet, int64_t receivedUs);
+
+static void applyTimeResult(const svcProtocolPacket_t *packet);
+
+static void updateManifest(size_t readbackLength);
+
+static void truncatedHash(const uint8_t *data, size_t length, uint8_t *hash);
+
+static void updateLinkProfile();
+
+static void printSyncReport(const SyncReport *report);
+
+static void commandBleSync(cmd *c);
+
 /*=============================================================================
-                                Private Constants
+                                Public Constants
 =============================================================================*/
 
-static const PrayerTimings nullPrayerTimings = {
+const PrayerTimings nullPrayerTimings = {
     {0, 0, NONE},
     {0, 0, NONE},
     {0, 0, NONE},
     {0, 0, NONE},
     {0, 0, NONE},
-    "0/0/0"
+    0, 0, 0
 };
 
 /*=============================================================================
                                 Private Variables
 =============================================================================*/
 
-static bool deviceConnected = false;
-static PrayerTimings timings[MAX_DAYS] = {nullPrayerTimings};
-static bool finishedReceiving = false;
-static modBTEParams_t *modBTEParams;
-static QueueHandle_t timingsQueue;
-static uint8_t currentDay = 0;
-static SemaphoreHandle_t prayerSemaphore;
+static BleTransport *transport;
+// Double buffered, see svcEventFreeTimetable()
+static PrayerTimetable timetables[2];
+static uint8_t receivingTimetable = 0;
+// Completed by the write callback and not published yet by the task, -1 if none
+static std::atomic<int8_t> finishedTimetable(-1);
+static QueueHandle_t eventQueue;
+
+static StatusPacket status = {STATUS_VERSION, SYNC_NONE, 0, NONE, 0, 0, 0};
+static StatusPacket notifiedStatus;
+static uint8_t timetableReadback[TIMETABLE_READBACK_SIZE];
+static uint8_t manifest[MANIFEST_SIZE];
+// Last timetable published by any source, the base of an update
+static const PrayerTimetable *publishedTimetable = nullptr;
+static uint8_t publishedHash[SVC_PROTOCOL_HASH_SIZE];
+// Set by a sync that cannot be received, its days are dropped until the next sync starts
+static bool syncRefused = false;
+
+static LinkProfile requestedProfile = LINK_UNSET;
+static LinkProfile appliedProfile = LINK_UNSET;
+static uint32_t lastWriteMs = 0;
+// Last values published with SVC_EVENT_SYNC_CHANGED, only touched by the BLE callbacks
+static bool connected = false;
+static SyncStatus sync = SYNC_NONE;
+static SyncReport currentSync;
+static SyncReport lastSync;
+static TimeExchange timeExchanges[TIME_EXCHANGE_SLOTS];
 
 /*=============================================================================
                                 Class Definitions
 =============================================================================*/
 
-class ConnectionCallbacks : public BLEServerCallbacks {
-    void onConnect(BLEServer *pServer) override {
-        Serial.println("Device connected");
-        deviceConnected = true;
+class TimingsProtocol : public BleTransportHandler {
+    void onConnect() override {
+        SVC_LOG_INFO("Device connected");
+        appliedProfile = LINK_UNSET;
+        requestedProfile = LINK_IDLE;
+        svcPowerEnter(SVC_POWER_BLE_CONNECTED);
+        publishSync(true, sync);
     };
 
-    void onDisconnect(BLEServer *pServer) override {
-        Serial.println("Device disconnected");
-        deviceConnected = false;
-        BLEDevice::startAdvertising();
+    void onDisconnect() override {
+        SVC_LOG_INFO("Device disconnected");
+        requestedProfile = LINK_UNSET;
+        // The backends advertise again at once
+        svcPowerEnter(SVC_POWER_BLE_ADVERTISING);
+        publishSync(false, sync);
     }
-};
 
-class OperationCallbacks : public BLECharacteristicCallbacks {
-    void onWrite(BLECharacteristic *pCharacteristic) override {
-        uint8_t *rxValue = pCharacteristic->getData();
-        uint8_t header = rxValue[0];
-        if (header == NUMBER_OF_DAYS_HEADER) {
-            finishedReceiving = false;
-            int numberOfDays = rxValue[1];
-            if (numberOfDays != MAX_DAYS) {
-                timings[MAX_DAYS - 1] = nullPrayerTimings;
+    void onWrite(svcBleCharacteristic_t characteristic, const uint8_t *rxValue, size_t length) override {
+        if (characteristic == SVC_BLE_CHAR_OTA_CONTROL || characteristic == SVC_BLE_CHAR_OTA_DATA) {
+            // An image is a bulk transfer too
+            lastWriteMs = millis();
+            requestedProfile = LINK_BULK;
+            modOtaHandleWrite(characteristic, rxValue, length);
+            return;
+        }
+        if (characteristic == SVC_BLE_CHAR_UART_RX) {
+            modCli0ReceiveBle(rxValue, length);
+            return;
+        }
+        if (characteristic != SVC_BLE_CHAR_OPERATION) {
+            return;
+        }
+        // Taken first, it is the reception time of a time exchange request
+        const int64_t receivedUs = svcClockNowUs();
+        SVC_TRACE_SCOPE("ble.write");
+
+        svcProtocolPacket_t packet;
+        const svcProtocolStatus_t result = svcProtocolDecode(rxValue, length, &packet);
+        if (result != SVC_PROTOCOL_OK) {
+            currentSync.rejected++;
+            SVC_TRACE_INSTANT("ble.reject", result);
+            SVC_LOG_WARNING("Rejected packet 0x%02X (%u bytes): %s", length > 0 ? rxValue[0] : 0,
+                          (unsigned) length, svcProtocolStatusToString(result));
+            return;
+        }
+
+        lastWriteMs = millis();
+        currentSync.bytes += length;
+        currentSync.packets++;
+
+        if (packet.header == NUMBER_OF_DAYS_HEADER || packet.header == UPDATE_OF_DAYS_HEADER) {
+            const bool update = packet.header == UPDATE_OF_DAYS_HEADER;
+            // Applying the days to another timetable would mix two months, the phone reads the manifest again
+            syncRefused = update && memcmp(packet.update.base, publishedHash, SVC_PROTOCOL_HASH_SIZE) != 0;
+            if (syncRefused) {
+                SVC_LOG_WARNING("Timetable update refused, it was not computed against the stored timetable");
+                return;
+            }
+            // Timetables following each other faster than the subscribers handle them, the phone syncs again
+            const int freeTimetable = findFreeTimetable();
+            syncRefused = freeTimetable < 0;
+            if (syncRefused) {
+                SVC_LOG_WARNING("Timetable refused, the previous ones are still in use");
+                return;
+            }
+            receivingTimetable = (uint8_t) freeTimetable;
+
+            currentSync = {(uint32_t) length, 1, 0, lastWriteMs, 0, transport->connectionInterval(), false, update};
+            requestedProfile = LINK_BULK;
+            publishSync(connected, SYNC_RECEIVING);
+            PrayerTimetable &timetable = timetables[receivingTimetable];
+            const uint8_t numberOfDays = update ? packet.update.numberOfDays : packet.numberOfDays;
+            uint8_t keptDays = 0;
+            if (update && publishedTimetable != nullptr) {
+                // Only the days differing from the manifest follow, the others are taken from the stored timetable
+                timetable = *publishedTimetable;
+                keptDays = numberOfDays < timetable.numberOfDays ? numberOfDays : timetable.numberOfDays;
+            }
+            timetable.numberOfDays = numberOfDays > MAX_DAYS ? MAX_DAYS : numberOfDays;
+            for (uint8_t i = keptDays; i < MAX_DAYS; i++) {
+                timetable.days[i] = nullPrayerTimings;
+            }
+        } else if (syncRefused) {
+            // Days and end of the refused sync
+            return;
+        } else if (packet.header == PRAYER_TIMINGS_HEADER) {
+            // The decoder guarantees day >= 1, the timetable may still hold fewer days than the protocol allows
+            if (packet.timings.day > MAX_DAYS) {
+                return;
             }
-        } else if (header == PRAYER_TIMINGS_HEADER) {
-            /*
-            Packet representation:
-            [0] - Header
-            [1] - Day
-            [2] - Month
-            [3] - Year pt 1
-            [4] - Year pt 2
-            [5] - Fajr Hour
-            [6] - Fajr Minute
-            [7] - Dhuhr Hour
-            [8] - Dhuhr Minute
-            [9] - Asr Hour
-            [10] - Asr Minute
-            [11] - Maghrib Hour
-            [12] - Maghrib Minute
-            [13] - Isha Hour
-            [14] - Isha Minute
-            */
-            uint8_t day = rxValue[1] - 1;
-            timings[day].date =
-                    String(rxValue[1]) + "/" + String(rxValue[2]) + "/" + String(rxValue[3]) + String(rxValue[4]);
-            timings[day].fajr.hour = rxValue[5];
-            timings[day].fajr.minute = rxValue[6];
-            timings[day].fajr.name = FAJR;
-            timings[day].dhuhr.hour = rxValue[7];
-            timings[day].dhuhr.minute = rxValue[8];
-            timings[day].dhuhr.name = DHUHR;
-            timings[day].asr.hour = rxValue[9];
-            timings[day].asr.minute = rxValue[10];
-            timings[day].asr.name = ASR;
-            timings[day].maghrib.hour = rxValue[11];
-            timings[day].maghrib.minute = rxValue[12];
-            timings[day].maghrib.name = MAGHRIB;
-            timings[day].isha.hour = rxValue[13];
-            timings[day].isha.minute = rxValue[14];
-            timings[day].isha.name = ISHA;
-        } else if (header == END_OF_TIMINGS_HEADER) {
-            finishedReceiving = true;
-        } else if (header == CURRENT_TIME_HEADER) {
-            uint8_t year1 = rxValue[6]; // year first 2 digits
-            uint8_t year2 = rxValue[7]; // year last 2 digits
-            uint16_t year = year1 * 100 + year2;
-
-            tm time;
-            time.tm_hour = rxValue[1];
-            time.tm_min = rxValue[2];
-            time.tm_sec = rxValue[3];
-            time.tm_mday = rxValue[4];
-            time.tm_mon = rxValue[5];
-            time.tm_year = year - 1900;
-            time_t t = mktime(&time);
-            struct timeval tv = {t, 0};
-            settimeofday(&tv, nullptr);
-
-            currentDay = rxValue[4];
+            // Shortest interval seen during the sync, the bulk profile applies a few packets in
+            const uint16_t interval = transport->connectionInterval();
+            if (interval != 0 && (currentSync.interval == 0 || interval < currentSync.interval)) {
+                currentSync.interval = interval;
+            }
+            svcProtocolApplyTimings(&packet, &timetables[receivingTimetable].days[packet.timings.day - 1]);
+        } else if (packet.header == END_OF_TIMINGS_HEADER) {
+            currentSync.durationMs = lastWriteMs - currentSync.startMs;
+            currentSync.dataLengthExtended = transport->dataLengthExtended();
+            lastSync = currentSync;
+            requestedProfile = LINK_IDLE;
+            // Not published, the prayer module marks the sync done when it receives the timetable
+            sync = SYNC_DONE;
+            // Release: the days written above are visible to the task once it sees the index
+            finishedTimetable.store((int8_t) receivingTimetable, std::memory_order_release);
+        } else if (packet.header == CURRENT_TIME_HEADER) {
+            // The phone sends its local wall time, the month starts at 0 like tm_mon
+            svcClockDateTime_t time;
+            time.hour = packet.time.hour;
+            time.minute = packet.time.minute;
+            time.second = packet.time.second;
+            time.day = packet.time.day;
+            time.month = packet.time.month + 1;
+            time.year = packet.time.year;
+            int64_t t = svcClockLocalToUtc(svcClockFromDateTime(&time));
+            svcClockSet(t, SVC_CLOCK_SOURCE_BLE);
+
+            svcEvent_t event = {SVC_EVENT_TIME_CHANGED};
+            event.data.time = t;
+            svcEventPublish(&event);
+        } else if (packet.header == TIME_REQUEST_HEADER) {
+            answerTimeRequest(&packet, receivedUs);
+        } else if (packet.header == TIME_RESULT_HEADER) {
+            applyTimeResult(&packet);
         }
     }
 };
@@ -173,51 +339,257 @@ class OperationCallbacks : public BLECharacteristicCallbacks {
 =============================================================================*/
 
 _Noreturn void modBTETaskProcess(void *pvParameters) {
-    modBTEParams = (modBTEParams_t *) pvParameters;
-    timingsQueue = modBTEParams->timingsQueue;
-    prayerSemaphore = modBTEParams->prayerSemaphore;
-
-    BLEDevice::init("PrayerDisplayer");
-    BLEServer *pServer = BLEDevice::createServer();
-    BLEService *pService = pServer->createService(SERVICE_UUID);
-    BLECharacteristic *pCharacteristic = pService->createCharacteristic(
-        CHARACTERISTIC_UUID,
-        BLECharacteristic::PROPERTY_READ |
-        BLECharacteristic::PROPERTY_WRITE);
-    pServer->setCallbacks(new ConnectionCallbacks());
-    pCharacteristic->setCallbacks(new OperationCallbacks());
-    pService->start();
-
-    BLEAdvertising *pAdvertising = BLEDevice::getAdvertising();
-    pAdvertising->addServiceUUID(SERVICE_UUID);
-    pAdvertising->setScanResponse(true);
-    pAdvertising->setMinPreferred(0x06); // functions that help with iPhone connections issue
-    pAdvertising->setMinPreferred(0x12);
-    BLEDevice::startAdvertising();
+    eventQueue = svcEventSubscribe(SVC_EVENT_MASK(SVC_EVENT_TIMETABLE_UPDATED) |
+                                   SVC_EVENT_MASK(SVC_EVENT_TIME_CHANGED) |
+                                   SVC_EVENT_MASK(SVC_EVENT_DISPLAY_REQUEST),
+                                   MOD_TIMINGS_EVENT_QUEUE_SIZE);
+
+    SimpleCLI *cli = svcCliGetCli0();
+    svcCliAddCmdHelp("blesync", "Show the link report of the last timetable sync");
+    cli->addCommand("blesync", commandBleSync);
+
+    transport = svcBleTransportGet();
+    if (!transport->begin(svcConfigGet()->deviceName, new TimingsProtocol())) {
+        SVC_LOG_ERROR("BLE stack did not start");
+        // An updated image that cannot receive the next update goes back to the previous one
+        svcOtaEspConfirmBoot(false);
+    } else {
+        svcPowerEnter(SVC_POWER_BLE_ADVERTISING);
+    }
+    modOtaInit(transport);
+    if (!modBroadcastInit(transport)) {
+        SVC_LOG_ERROR("Broadcast module did not start");
+    }
+    if (!modTelemetryInit(transport)) {
+        SVC_LOG_ERROR("Telemetry module did not start");
+    }
+    if (!modCli0StartRemote(transport)) {
+        SVC_LOG_ERROR("Remote CLI sessions did not start");
+    }
+    SVC_LOG_INFO("BLE ready, free heap %lu bytes", (unsigned long) ESP.getFreeHeap());
+
+    updateTimetableReadback(nullptr);
+    notifyStatus(false);
 
     while (true) {
-        if (finishedReceiving) {
-            int remainingDays = MAX_DAYS - currentDay;
-            for (int i = -1; i < remainingDays; i++) {
-                if (timings[currentDay + i].date == "0/0/0") {
-                    break;
-                }
-                xQueueSend(timingsQueue, (void *) &timings[currentDay + i], (TickType_t) 5);
-                Serial.printf("Sending %s\n", timings[currentDay + i].date.c_str());
-            }
-            // Send a null prayer timings to indicate that the timings of the month have been sent
-            if (timings[MAX_DAYS - 1].date == "0/0/0") {
-                xQueueSend(timingsQueue, (void *) &nullPrayerTimings, (TickType_t) 5);
-            }
+        const int8_t finished = finishedTimetable.load(std::memory_order_acquire);
+        if (finished >= 0) {
+            const PrayerTimetable *timetable = &timetables[finished];
+            SVC_TRACE_INSTANT("ble.timetable", timetable->numberOfDays);
+            svcEvent_t event = {SVC_EVENT_TIMETABLE_UPDATED};
+            event.data.buffer = timetable;
+            svcEventPublish(&event);
+            // Held by the subscribers from now on, unless a sync completed again in the meantime
+            int8_t expected = finished;
+            finishedTimetable.compare_exchange_strong(expected, -1, std::memory_order_acq_rel);
+            SVC_LOG_INFO("Published prayer timings for %d days, %lu bytes (%lu rejected packets) in %lu ms, "
+                         "blesync for details", timetable->numberOfDays, (unsigned long) lastSync.bytes,
+                         (unsigned long) lastSync.rejected, (unsigned long) lastSync.durationMs);
+        }
 
-            finishedReceiving = false;
-            xSemaphoreTake(prayerSemaphore, portMAX_DELAY);
-            Serial.println("Finished sending prayer timings, waiting for next month");
+        updateLinkProfile();
+
+        svcEvent_t event;
+        if (xQueueReceive(eventQueue, &event, pdMS_TO_TICKS(1000))) {
+            handleEvent(&event);
+        } else {
+            // Picks up the sync status changed by the write callback
+            notifyStatus(false);
         }
-        vTaskDelay(1000);
     }
 }
 
 /*=============================================================================
                                 Private Functions
 =============================================================================*/
+
+void handleEvent(const svcEvent_t *event) {
+    switch (event->topic) {
+        case SVC_EVENT_TIMETABLE_UPDATED: {
+            // Also published by the Wi-Fi sync, an update over BLE then applies to that timetable
+            const PrayerTimetable *timetable = (const PrayerTimetable *) event->data.buffer;
+            svcEventRelease(publishedTimetable);
+            publishedTimetable = timetable;
+            updateTimetableReadback(timetable);
+            notifyStatus(false);
+            break;
+        }
+        case SVC_EVENT_TIME_CHANGED:
+            notifyStatus(true);
+            break;
+        case SVC_EVENT_DISPLAY_REQUEST:
+            notifyStatus(false);
+            break;
+        default:
+            break;
+    }
+}
+
+int findFreeTimetable() {
+    // Called from the write callback, the completed timetable not published yet is not held but still taken
+    const int8_t finished = finishedTimetable.load(std::memory_order_acquire);
+    const PrayerTimetable *taken = finished >= 0 ? &timetables[finished] : nullptr;
+    const PrayerTimetable *timetable = svcEventFreeTimetable(timetables, 2, taken);
+    return timetable != nullptr ? (int) (timetable - timetables) : -1;
+}
+
+void notifyStatus(bool clockChanged) {
+    // Published by the prayer module before its display request, a timetable shows up at the latest a second later
+    svcState_t state;
+    if (svcStateRead(&state)) {
+        status.syncStatus = state.syncStatus;
+        status.numberOfDays = state.numberOfDays;
+        status.nextPrayerName = state.nextPrayer.name;
+        status.nextPrayerHour = state.nextPrayer.hour;
+        status.nextPrayerMinute = state.nextPrayer.minute;
+    }
+    status.clock = (uint32_t) svcClockNow();
+
+    // The clock always moves, it only counts as a change when it was set
+    StatusPacket previous = notifiedStatus;
+    previous.clock = status.clock;
+    if (!clockChanged && memcmp(&previous, &status, sizeof(status)) == 0) {
+        return;
+    }
+
+    transport->setValue(SVC_BLE_CHAR_STATUS, (const uint8_t *) &status, sizeof(status));
+    transport->notify(SVC_BLE_CHAR_STATUS);
+    notifiedStatus = status;
+}
+
+void publishSync(bool isConnected, SyncStatus syncStatus) {
+    connected = isConnected;
+    sync = syncStatus;
+
+    svcEvent_t event = {SVC_EVENT_SYNC_CHANGED};
+    event.data.sync.connected = isConnected;
+    event.data.sync.status = syncStatus;
+    svcEventPublish(&event);
+}
+
+void updateTimetableReadback(const PrayerTimetable *timetable) {
+    /*
+    Readback representation:
+    [0] - Version
+    [1] - Number of days
+    Then for each day the bytes [1] to [14] of its PRAYER_TIMINGS_HEADER packet
+    */
+    size_t length = 0;
+    timetableReadback[length++] = TIMETABLE_READBACK_VERSION;
+    timetableReadback[length++] = timetable != nullptr ? timetable->numberOfDays : 0;
+
+    for (uint8_t i = 0; timetable != nullptr && i < timetable->numberOfDays; i++) {
+        uint8_t packet[SVC_PROTOCOL_PRAYER_TIMINGS_SIZE];
+        svcProtocolEncodeTimings(&timetable->days[i], packet);
+        memcpy(&timetableReadback[length], &packet[1], TIMETABLE_READBACK_DAY_SIZE);
+        length += TIMETABLE_READBACK_DAY_SIZE;
+    }
+
+    // Longer than the MTU, the client reads it with ATT long reads
+    transport->setValue(SVC_BLE_CHAR_TIMETABLE, timetableReadback, length);
+    updateManifest(length);
+}
+
+void updateManifest(size_t readbackLength) {
+    /*
+    Manifest representation:
+    [0] - Version
+    [1] - Number of days
+    [2..5] - Timetable hash: SHA-256 of the readback from its byte [1], truncated to 4 bytes
+    Then for each day the SHA-256 of bytes [1] to [14] of its PRAYER_TIMINGS_HEADER packet, truncated to 4 bytes
+    The phone compares it with the hashes of its own packets: nothing to send when the timetable hash matches,
+    otherwise an UPDATE_OF_DAYS_HEADER carrying the timetable hash followed by the differing days only.
+    */
+    const uint8_t numberOfDays = timetableReadback[1];
+    size_t length = 0;
+    manifest[length++] = MANIFEST_VERSION;
+    manifest[length++] = numberOfDays;
+
+    truncatedHash(&timetableReadback[1], readbackLength - 1, publishedHash);
+    memcpy(&manifest[length], publishedHash, SVC_PROTOCOL_HASH_SIZE);
+    length += SVC_PROTOCOL_HASH_SIZE;
+
+    for (uint8_t i = 0; i < numberOfDays; i++) {
+        truncatedHash(&timetableReadback[2 + i * TIMETABLE_READBACK_DAY_SIZE], TIMETABLE_READBACK_DAY_SIZE,
+                      &manifest[length]);
+        length += SVC_PROTOCOL_HASH_SIZE;
+    }
+
+    transport->setValue(SVC_BLE_CHAR_MANIFEST, manifest, length);
+}
+
+void truncatedHash(const uint8_t *data, size_t length, uint8_t *hash) {
+    uint8_t digest[MANIFEST_DIGEST_SIZE];
+    mbedtls_sha256_ret(data, length, digest, 0);
+    memcpy(hash, digest, SVC_PROTOCOL_HASH_SIZE);
+}
+
+void answerTimeRequest(const svcProtocolPacket_t *packet, int64_t receivedUs) {
+    TimeExchange &exchange = timeExchanges[packet->exchange.sequence % TIME_EXCHANGE_SLOTS];
+    exchange.pending = true;
+    exchange.sequence = packet->exchange.sequence;
+    exchange.t1 = packet->exchange.utcUs;
+    exchange.t2 = receivedUs;
+    exchange.t3 = svcClockNowUs();
+
+    const TimeAnswer answer = {exchange.sequence, exchange.t2, (uint32_t) (exchange.t3 - exchange.t2)};
+    transport->setValue(SVC_BLE_CHAR_TIME, (const uint8_t *) &answer, sizeof(answer));
+    transport->notify(SVC_BLE_CHAR_TIME);
+}
+
+void applyTimeResult(const svcProtocolPacket_t *packet) {
+    TimeExchange &exchange = timeExchanges[packet->exchange.sequence % TIME_EXCHANGE_SLOTS];
+    if (!exchange.pending || exchange.sequence != packet->exchange.sequence) {
+        return;
+    }
+    exchange.pending = false;
+    if (!svcClockSyncSample(exchange.t1, exchange.t2, exchange.t3, packet->exchange.utcUs)) {
+        return;
+    }
+
+    svcClockSyncStatus_t status;
+    svcClockGetSyncStatus(&status);
+    SVC_TRACE_INSTANT("ble.time", (uint32_t) status.delayUs);
+    if (status.offsetUs > TIME_EXCHANGE_EVENT_THRESHOLD_US || status.offsetUs < -TIME_EXCHANGE_EVENT_THRESHOLD_US) {
+        svcEvent_t event = {SVC_EVENT_TIME_CHANGED};
+        event.data.time = svcClockNow();
+        svcEventPublish(&event);
+    }
+}
+
+void updateLinkProfile() {
+    if (requestedProfile == LINK_BULK && millis() - lastWriteMs > LINK_BULK_TIMEOUT_MS) {
+        requestedProfile = LINK_IDLE;
+    }
+
+    const LinkProfile profile = requestedProfile;
+    if (profile == LINK_UNSET || profile == appliedProfile) {
+        return;
+    }
+    transport->setLinkProfile((svcBleLinkProfile_t) profile);
+    appliedProfile = profile;
+    SVC_LOG_INFO("Link profile %s requested", profile == LINK_BULK ? "bulk" : "idle");
+}
+
+void printSyncReport(const SyncReport *report) {
+    if (report->packets == 0) {
+        svcCliOut()->println("No timetable sync since boot");
+        return;
+    }
+
+    // Intervals are in 1.25 ms units, the connection events are counted from the shortest interval of the sync
+    const uint32_t bytesPerSecond = report->durationMs > 0 ? report->bytes * 1000 / report->durationMs : report->bytes;
+    const uint32_t connectionEvents = report->interval > 0 ? report->durationMs * 4 / (report->interval * 5) + 1 : 0;
+    svcCliOut()->printf("%s: %lu bytes in %lu packets (%lu rejected), %lu ms, %lu B/s, interval %u.%02u ms, ~%lu connection events, DLE %s\n",
+                        report->update ? "Update" : "Sync", (unsigned long) report->bytes,
+                        (unsigned long) report->packets,
+                        (unsigned long) report->rejected,
+                        (unsigned long) report->durationMs,
+                        (unsigned long) bytesPerSecond, report->interval * 125 / 100, report->interval * 125 % 100,
+                        (unsigned long) connectionEvents, report->dataLengthExtended ? "on" : "off");
+}
+
+void commandBleSync(cmd *c) {
+    svcCliOut()->write("\r\n");
+    printSyncReport(&lastSync);
+}
@@ -42,15 +42,16 @@ typedef enum {
     NONE
 } PrayerName;
 
+typedef enum {
+    SYNC_NONE,      // No timetable received since boot
+    SYNC_RECEIVING, // NUMBER_OF_DAYS_HEADER received, waiting for END_OF_TIMINGS_HEADER
+    SYNC_DONE       // Timetable received and published
+} SyncStatus;
+
 /*=============================================================================
                                  Type definitions
 =============================================================================*/
 
-typedef struct {
-    QueueHandle_t timingsQueue;
-    SemaphoreHandle_t prayerSemaphore;
-} modBTEParams_t;
-
 typedef struct {
     uint8_t hour;
     uint8_t minute;
@@ -63,9 +64,17 @@ typedef struct {
     Prayer asr;
     Prayer maghrib;
     Prayer isha;
-    String date;
+    uint8_t day;
+    uint8_t month;
+    uint16_t year;
 } PrayerTimings;
 
+/// Month of timings as published on the event bus, never modified once published
+typedef struct {
+    uint8_t numberOfDays;
+    PrayerTimings days[MAX_DAYS];
+} PrayerTimetable;
+
 /*=============================================================================
                                     Structures
 =============================================================================*/
@@ -74,6 +83,9 @@ typedef struct {
                                 Public Constants
 =============================================================================*/
 
+/// Day not received yet, every prayer named NONE
+extern const PrayerTimings nullPrayerTimings;
+
 /*=============================================================================
                             Public Function Prototypes
 =============================================================================*/
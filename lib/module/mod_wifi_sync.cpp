@@ -0,0 +1,310 @@
+/*===========================================================================*/
+/// \file mod_wifi_sync.cpp
+///
+/// \brief
+///    Module for fetching the timetable from an HTTP server over Wi-Fi
+///
+/// \details
+///    Fetch MOD_WIFI_SYNC_URL at boot, then periodically or on the wifisync command. The body may hold a whole year,
+///    only the days of the current month are kept and published like a BLE sync.
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifdef MOD_WIFI_SYNC
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <mod_wifi_sync.h>
+#include <mod_timings.h>
+#include <svc_event.h>
+#include <svc_clock.h>
+#include <svc_cli.h>
+#include <svc_timetable_stream.h>
+#include <svc_log.h>
+#include <svc_power.h>
+#include <WiFi.h>
+#include <HTTPClient.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#if !defined(MOD_WIFI_SYNC_SSID) || !defined(MOD_WIFI_SYNC_URL)
+#error "MOD_WIFI_SYNC needs MOD_WIFI_SYNC_SSID and MOD_WIFI_SYNC_URL"
+#endif
+
+#ifndef MOD_WIFI_SYNC_PASSWORD
+#define MOD_WIFI_SYNC_PASSWORD ""
+#endif
+
+#ifndef MOD_WIFI_SYNC_PERIOD_MS
+#define MOD_WIFI_SYNC_PERIOD_MS (6UL * 60 * 60 * 1000)
+#endif
+
+#define CONNECT_TIMEOUT_MS 15000
+#define HTTP_TIMEOUT_MS 10000
+#define CHUNK_SIZE 128
+
+// Before this year the clock was never set, the month to keep is then taken from the first record
+#define MIN_CLOCK_YEAR 2024
+
+#define ETAG_SIZE 64
+#define LAST_MODIFIED_SIZE 32
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    PrayerTimetable *timetable;
+    uint8_t month;
+    uint16_t year;
+} FetchTarget;
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static bool connect();
+
+static void disconnect();
+
+static void fetch();
+
+static bool streamBody(HTTPClient *http, svcTimetableStream_t *stream, uint32_t *bytes);
+
+static void onPacket(const svcProtocolPacket_t *packet, void *context);
+
+static void copyHeader(HTTPClient *http, const char *name, char *destination, size_t size);
+
+static void commandWifiSync(cmd *c);
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const char *collectedHeaders[] = {"ETag", "Last-Modified", "Content-Type"};
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static TaskHandle_t taskHandle = nullptr;
+// Double buffered, see svcEventFreeTimetable()
+static PrayerTimetable timetables[2];
+static char etag[ETAG_SIZE];
+static char lastModified[LAST_MODIFIED_SIZE];
+// Month kept from the body the validators came with, the same file is read again for any other month
+static uint8_t validatorsMonth = 0;
+static uint16_t validatorsYear = 0;
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+_Noreturn void modWifiSyncTaskProcess(void *pvParameters) {
+    taskHandle = xTaskGetCurrentTaskHandle();
+    svcCliAddCmdHelp("wifisync", "Fetch the timetable over Wi-Fi now");
+    svcCliGetCli0()->addCommand("wifisync", commandWifiSync);
+
+    while (true) {
+        fetch();
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MOD_WIFI_SYNC_PERIOD_MS));
+    }
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+bool connect() {
+    svcPowerEnter(SVC_POWER_WIFI_ON);
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(MOD_WIFI_SYNC_SSID, MOD_WIFI_SYNC_PASSWORD);
+
+    const uint32_t startMs = millis();
+    while (WiFi.status() != WL_CONNECTED) {
+        if (millis() - startMs > CONNECT_TIMEOUT_MS) {
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    return true;
+}
+
+void disconnect() {
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+    svcPowerEnter(SVC_POWER_WIFI_OFF);
+}
+
+void fetch() {
+    const uint32_t startMs = millis();
+    PrayerTimetable *timetable = svcEventFreeTimetable(timetables, 2, nullptr);
+    if (timetable == nullptr) {
+        SVC_LOG_WARNING("Wi-Fi sync skipped, the previous timetables are still in use");
+        return;
+    }
+    if (!connect()) {
+        SVC_LOG_WARNING("Wi-Fi sync could not join " MOD_WIFI_SYNC_SSID);
+        disconnect();
+        return;
+    }
+
+    HTTPClient http;
+    // HTTP/1.0 keeps the body free of chunk framing so it can be parsed straight from the socket
+    http.useHTTP10(true);
+    http.setTimeout(HTTP_TIMEOUT_MS);
+    if (!http.begin(MOD_WIFI_SYNC_URL)) {
+        SVC_LOG_WARNING("Wi-Fi sync has an invalid URL");
+        disconnect();
+        return;
+    }
+    http.collectHeaders(collectedHeaders, sizeof(collectedHeaders) / sizeof(collectedHeaders[0]));
+
+    // The month to keep is decided before the body, a year long file only fills the current month. An unchanged
+    // file is only skipped while that month is the one kept from it, not after a month rollover nor when the month
+    // was taken from the first record because the clock was not set yet
+    svcClockDateTime_t now;
+    svcClockToDateTime(svcClockUtcToLocal(svcClockNow()), &now);
+    const bool clockSet = now.year >= MIN_CLOCK_YEAR;
+    if (clockSet && now.month == validatorsMonth && now.year == validatorsYear) {
+        if (etag[0] != '\0') {
+            http.addHeader("If-None-Match", etag);
+        }
+        if (lastModified[0] != '\0') {
+            http.addHeader("If-Modified-Since", lastModified);
+        }
+    }
+
+    const int code = http.GET();
+    if (code != HTTP_CODE_OK) {
+        if (code == HTTP_CODE_NOT_MODIFIED) {
+            SVC_LOG_INFO("Wi-Fi sync: timetable unchanged, %lu ms", (unsigned long) (millis() - startMs));
+        } else {
+            SVC_LOG_WARNING("Wi-Fi sync failed: HTTP %d", code);
+        }
+        http.end();
+        disconnect();
+        return;
+    }
+
+    FetchTarget target = {timetable, 0, 0};
+    if (clockSet) {
+        target.month = now.month;
+        target.year = now.year;
+    }
+    target.timetable->numberOfDays = 0;
+    for (PrayerTimings &day: target.timetable->days) {
+        day = nullPrayerTimings;
+    }
+
+    const svcTimetableStreamFormat_t format = http.header("Content-Type").startsWith("application/json")
+                                              ? SVC_TIMETABLE_STREAM_JSON : SVC_TIMETABLE_STREAM_BINARY;
+    svcTimetableStream_t stream;
+    svcTimetableStreamBegin(&stream, format, onPacket, &target);
+    uint32_t bytes = 0;
+    const bool complete = streamBody(&http, &stream, &bytes) && svcTimetableStreamEnd(&stream);
+
+    // Only remember the validators of a body that was fully used, a broken one is downloaded again next time
+    if (complete && target.timetable->numberOfDays > 0) {
+        copyHeader(&http, "ETag", etag, sizeof(etag));
+        copyHeader(&http, "Last-Modified", lastModified, sizeof(lastModified));
+        validatorsMonth = target.month;
+        validatorsYear = target.year;
+    }
+    http.end();
+    disconnect();
+
+    SVC_LOG_INFO("Wi-Fi sync: %lu bytes, %lu records (%lu rejected), %u days kept, %lu ms%s",
+                  (unsigned long) bytes, (unsigned long) stream.records, (unsigned long) stream.rejected,
+                  target.timetable->numberOfDays, (unsigned long) (millis() - startMs),
+                  complete ? "" : ", body malformed or truncated");
+    if (!complete || target.timetable->numberOfDays == 0) {
+        return;
+    }
+
+    svcEvent_t event = {SVC_EVENT_TIMETABLE_UPDATED};
+    event.data.buffer = target.timetable;
+    svcEventPublish(&event);
+}
+
+bool streamBody(HTTPClient *http, svcTimetableStream_t *stream, uint32_t *bytes) {
+    WiFiClient *client = http->getStreamPtr();
+    // -1 when the server sends no length, the body then ends with the connection
+    int remaining = http->getSize();
+    uint8_t chunk[CHUNK_SIZE];
+    uint32_t lastDataMs = millis();
+
+    while (remaining != 0 && (http->connected() || client->available() > 0)) {
+        const int available = client->available();
+        if (available <= 0) {
+            if (millis() - lastDataMs > HTTP_TIMEOUT_MS) {
+                return false;
+            }
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+
+        const int length = client->readBytes(chunk, available < CHUNK_SIZE ? available : CHUNK_SIZE);
+        lastDataMs = millis();
+        *bytes += length;
+        if (remaining > 0) {
+            remaining -= length;
+        }
+        if (!svcTimetableStreamFeed(stream, chunk, length)) {
+            return false;
+        }
+    }
+    return remaining <= 0;
+}
+
+void onPacket(const svcProtocolPacket_t *packet, void *context) {
+    FetchTarget *target = (FetchTarget *) context;
+    if (packet->header != PRAYER_TIMINGS_HEADER || packet->timings.day > MAX_DAYS) {
+        return;
+    }
+
+    if (target->year == 0) {
+        target->month = packet->timings.month;
+        target->year = packet->timings.year;
+    }
+    if (packet->timings.month != target->month || packet->timings.year != target->year) {
+        return;
+    }
+
+    svcProtocolApplyTimings(packet, &target->timetable->days[packet->timings.day - 1]);
+    if (packet->timings.day > target->timetable->numberOfDays) {
+        target->timetable->numberOfDays = packet->timings.day;
+    }
+}
+
+void copyHeader(HTTPClient *http, const char *name, char *destination, size_t size) {
+    const String value = http->header(name);
+    // A validator that does not fit is dropped rather than sent back truncated
+    if (value.length() >= size) {
+        destination[0] = '\0';
+        return;
+    }
+    strncpy(destination, value.c_str(), size);
+}
+
+void commandWifiSync(cmd *c) {
+    svcCliOut()->write("\r\nWi-Fi sync requested\r\n");
+    xTaskNotifyGive(taskHandle);
+}
+
+#endif // MOD_WIFI_SYNC
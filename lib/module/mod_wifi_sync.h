@@ -0,0 +1,57 @@
+/*===========================================================================*/
+/// \file mod_wifi_sync.h
+///
+/// \brief
+///    Module for fetching the timetable from an HTTP server over Wi-Fi
+///
+/// \details
+///     Optional, only built with MOD_WIFI_SYNC defined. The radio is turned on for each fetch and off right after it,
+///     the body is parsed while it is received and unchanged files are skipped with conditional requests.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOD_WIFI_SYNC_H
+#define MOD_WIFI_SYNC_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Entry point for the module
+/// \param[in] pvParameters - FreeRTOS task parameters
+_Noreturn void modWifiSyncTaskProcess(void *pvParameters);
+
+#endif // MOD_WIFI_SYNC_H
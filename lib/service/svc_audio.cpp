@@ -0,0 +1,180 @@
+/*===========================================================================*/
+/// \file svc_audio.cpp
+///
+/// \brief
+///    Streaming player of IMA-ADPCM clips
+///
+/// \details
+///    IMA-ADPCM decoding with the standard step tables, and the block loop alternating between two sample buffers
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_audio.h"
+#include <string.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define STEP_INDEX_MAX 88
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static uint16_t readLe16(const uint8_t *data);
+
+static uint32_t readLe32(const uint8_t *data);
+
+static int16_t decodeNibble(uint8_t nibble, int32_t *predictor, int32_t *index);
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const int16_t stepTable[STEP_INDEX_MAX + 1] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107,
+    118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894,
+    6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+
+static const int8_t indexTable[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static uint8_t block[SVC_AUDIO_MAX_BLOCK_SIZE];
+// The sink may still be sending one buffer while the next block is decoded into the other
+static int16_t sampleBuffers[2][SVC_AUDIO_MAX_BLOCK_SAMPLES];
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+bool svcAudioReadClip(AudioSource *source, svcAudioClip_t *clip) {
+    uint8_t header[SVC_AUDIO_HEADER_SIZE];
+    if (!source->read(0, header, sizeof(header)) || readLe32(&header[0]) != SVC_AUDIO_CLIP_MAGIC ||
+        header[4] != SVC_AUDIO_CLIP_VERSION || header[5] != 1) {
+        return false;
+    }
+
+    clip->blockSize = readLe16(&header[6]);
+    clip->sampleRate = readLe32(&header[8]);
+    clip->dataLength = readLe32(&header[12]);
+    return clip->blockSize > 4 && clip->blockSize <= SVC_AUDIO_MAX_BLOCK_SIZE && clip->sampleRate > 0;
+}
+
+size_t svcAudioDecodeBlock(const uint8_t *data, size_t blockSize, int16_t *samples) {
+    int32_t predictor = (int16_t) readLe16(&data[0]);
+    int32_t index = data[2] > STEP_INDEX_MAX ? STEP_INDEX_MAX : data[2];
+
+    size_t count = 0;
+    samples[count++] = predictor;
+    // Low nibble first
+    for (size_t i = 4; i < blockSize; i++) {
+        samples[count++] = decodeNibble(data[i] & 0x0F, &predictor, &index);
+        samples[count++] = decodeNibble(data[i] >> 4, &predictor, &index);
+    }
+    return count;
+}
+
+bool svcAudioPlay(AudioSource *source, AudioSink *sink, const volatile bool *stop, svcAudioCounter_t counter,
+                  svcAudioStats_t *stats) {
+    svcAudioStats_t played = {};
+    svcAudioClip_t clip;
+    if (!svcAudioReadClip(source, &clip) || !sink->begin(clip.sampleRate)) {
+        return false;
+    }
+
+    const uint32_t blockCount = clip.dataLength / clip.blockSize;
+    bool complete = true;
+    for (uint32_t i = 0; i < blockCount; i++) {
+        if ((stop != nullptr && *stop) ||
+            !source->read(SVC_AUDIO_HEADER_SIZE + i * clip.blockSize, block, clip.blockSize)) {
+            complete = false;
+            break;
+        }
+
+        int16_t *samples = sampleBuffers[i & 1];
+        const uint32_t start = counter != nullptr ? counter() : 0;
+        const size_t count = svcAudioDecodeBlock(block, clip.blockSize, samples);
+        const uint32_t decodeTime = counter != nullptr ? counter() - start : 0;
+        if (decodeTime > played.maxDecodeTime) {
+            played.maxDecodeTime = decodeTime;
+        }
+
+        if (!sink->write(samples, count)) {
+            played.sinkErrors++;
+        }
+        played.blocks++;
+        played.samples += count;
+    }
+    sink->end();
+
+    if (stats != nullptr) {
+        *stats = played;
+    }
+    return complete;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+uint16_t readLe16(const uint8_t *data) {
+    return data[0] | (data[1] << 8);
+}
+
+uint32_t readLe32(const uint8_t *data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t) data[3] << 24);
+}
+
+int16_t decodeNibble(uint8_t nibble, int32_t *predictor, int32_t *index) {
+    const int32_t step = stepTable[*index];
+    int32_t difference = step >> 3;
+    if (nibble & 4) {
+        difference += step;
+    }
+    if (nibble & 2) {
+        difference += step >> 1;
+    }
+    if (nibble & 1) {
+        difference += step >> 2;
+    }
+    *predictor += (nibble & 8) ? -difference : difference;
+    if (*predictor > INT16_MAX) {
+        *predictor = INT16_MAX;
+    } else if (*predictor < INT16_MIN) {
+        *predictor = INT16_MIN;
+    }
+
+    *index += indexTable[nibble];
+    if (*index < 0) {
+        *index = 0;
+    } else if (*index > STEP_INDEX_MAX) {
+        *index = STEP_INDEX_MAX;
+    }
+    return *predictor;
+}
@@ -0,0 +1,147 @@
+/*===========================================================================*/
+/// \file svc_audio.h
+///
+/// \brief
+///    Streaming player of IMA-ADPCM clips
+///
+/// \details
+///     A clip is a 16 byte header followed by IMA-ADPCM blocks (WAV layout, mono). The player reads one block at a
+///     time from an audio source, decodes it into one of two sample buffers and hands it to an audio sink, so the
+///     block being decoded never overwrites the block the sink is still sending. Only plain C++ is used so the player
+///     can run on a host between a file source and a file sink. scripts/make_adhan_clip.py builds clips from WAV files.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_AUDIO_H
+#define SVC_AUDIO_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SVC_AUDIO_CLIP_MAGIC 0x43504441UL // "ADPC"
+#define SVC_AUDIO_CLIP_VERSION 1
+#define SVC_AUDIO_HEADER_SIZE 16
+#define SVC_AUDIO_MAX_BLOCK_SIZE 512
+// A block holds its first sample in the header and two samples per following byte
+#define SVC_AUDIO_BLOCK_SAMPLES(blockSize) (1 + ((blockSize) - 4) * 2)
+#define SVC_AUDIO_MAX_BLOCK_SAMPLES SVC_AUDIO_BLOCK_SAMPLES(SVC_AUDIO_MAX_BLOCK_SIZE)
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/// \brief Free running counter used to measure the decoding time, in any unit
+typedef uint32_t (*svcAudioCounter_t)();
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*
+Clip header, little endian:
+[0-3]   - SVC_AUDIO_CLIP_MAGIC
+[4]     - Version
+[5]     - Channels, always 1
+[6-7]   - Block size in bytes
+[8-11]  - Sample rate in Hz
+[12-15] - Length of the blocks in bytes
+*/
+typedef struct {
+    uint16_t blockSize;
+    uint32_t sampleRate;
+    uint32_t dataLength;
+} svcAudioClip_t;
+
+typedef struct {
+    uint32_t blocks;
+    uint32_t samples;
+    uint32_t maxDecodeTime; // in counter units
+    uint32_t sinkErrors;
+} svcAudioStats_t;
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+class AudioSource {
+public:
+    virtual ~AudioSource() = default;
+
+    /// \brief Read bytes of the clip
+    /// \param offset Offset from the start of the clip header
+    /// \param data Filled with the bytes
+    /// \param length Number of bytes to read
+    /// \return true if every byte was read, false otherwise
+    virtual bool read(uint32_t offset, uint8_t *data, size_t length) = 0;
+};
+
+class AudioSink {
+public:
+    virtual ~AudioSink() = default;
+
+    /// \brief Prepare the output for a clip
+    /// \param sampleRate Sample rate of the clip in Hz
+    /// \return true if the output is ready, false otherwise
+    virtual bool begin(uint32_t sampleRate) = 0;
+
+    /// \brief Queue samples, may block until the output has room for them
+    /// \param samples Signed 16-bit samples, the sink may convert them in place
+    /// \param count Number of samples
+    /// \return true if the samples were queued, false otherwise
+    virtual bool write(int16_t *samples, size_t count) = 0;
+
+    /// \brief Let the queued samples play out and release the output
+    virtual void end() = 0;
+};
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Read and check the header of a clip
+/// \param source The clip
+/// \param clip Filled with the header fields
+/// \return true if the clip can be played, false otherwise
+bool svcAudioReadClip(AudioSource *source, svcAudioClip_t *clip);
+
+/// \brief Decode one IMA-ADPCM block
+/// \param block The block, its 4 byte header first
+/// \param blockSize Number of bytes in the block
+/// \param samples Filled with SVC_AUDIO_BLOCK_SAMPLES(blockSize) samples
+/// \return Number of samples decoded
+size_t svcAudioDecodeBlock(const uint8_t *block, size_t blockSize, int16_t *samples);
+
+/// \brief Play a whole clip, one block at a time
+/// \param source The clip
+/// \param sink The output
+/// \param stop Polled before each block, playback ends early when it becomes true
+/// \param counter Measures the decoding time of each block, may be nullptr
+/// \param stats Counters of the playback, may be nullptr
+/// \return true if the clip was played to the end, false otherwise
+bool svcAudioPlay(AudioSource *source, AudioSink *sink, const volatile bool *stop, svcAudioCounter_t counter,
+                  svcAudioStats_t *stats);
+
+#endif // SVC_AUDIO_H
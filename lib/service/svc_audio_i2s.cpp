@@ -0,0 +1,156 @@
+/*===========================================================================*/
+/// \file svc_audio_i2s.cpp
+///
+/// \brief
+///    Audio sink on the I2S peripheral and audio source in a flash partition
+///
+/// \details
+///    The I2S driver is installed for each clip with its sample rate and removed after it, so the peripheral and the
+///    DMA buffers only exist while something plays
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_audio_i2s.h"
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+I2sAudioSink::I2sAudioSink(i2s_port_t port, int bitClockPin, int wordSelectPin, int dataPin)
+    : port(port), bitClockPin(bitClockPin), wordSelectPin(wordSelectPin), dataPin(dataPin) {
+}
+
+bool I2sAudioSink::begin(uint32_t rate) {
+    const bool builtinDac = bitClockPin == SVC_AUDIO_I2S_BUILTIN_DAC;
+#if !SOC_I2S_SUPPORTS_DAC
+    if (builtinDac) {
+        return false;
+    }
+#endif
+
+    i2s_config_t config = {};
+    config.mode = (i2s_mode_t) (I2S_MODE_MASTER | I2S_MODE_TX);
+    config.sample_rate = rate;
+    config.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+    config.channel_format = I2S_CHANNEL_FMT_ONLY_LEFT;
+    config.communication_format = I2S_COMM_FORMAT_STAND_I2S;
+    config.intr_alloc_flags = ESP_INTR_FLAG_LEVEL1;
+    config.dma_buf_count = SVC_AUDIO_I2S_DMA_BUFFERS;
+    config.dma_buf_len = SVC_AUDIO_I2S_DMA_FRAMES;
+    // An underrun plays silence instead of repeating the last buffer
+    config.tx_desc_auto_clear = true;
+#if SOC_I2S_SUPPORTS_DAC
+    if (builtinDac) {
+        // The DAC on GPIO25 is the right channel and takes the most significant byte
+        config.mode = (i2s_mode_t) (config.mode | I2S_MODE_DAC_BUILT_IN);
+        config.channel_format = I2S_CHANNEL_FMT_ONLY_RIGHT;
+        config.communication_format = I2S_COMM_FORMAT_STAND_MSB;
+    }
+#endif
+
+    if (i2s_driver_install(port, &config, 0, nullptr) != ESP_OK) {
+        return false;
+    }
+
+    esp_err_t status;
+#if SOC_I2S_SUPPORTS_DAC
+    if (builtinDac) {
+        status = i2s_set_dac_mode(I2S_DAC_CHANNEL_RIGHT_EN);
+    } else
+#endif
+    {
+        i2s_pin_config_t pins = {};
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 4, 0)
+        pins.mck_io_num = I2S_PIN_NO_CHANGE;
+#endif
+        pins.bck_io_num = bitClockPin;
+        pins.ws_io_num = wordSelectPin;
+        pins.data_out_num = dataPin;
+        pins.data_in_num = I2S_PIN_NO_CHANGE;
+        status = i2s_set_pin(port, &pins);
+    }
+    if (status != ESP_OK) {
+        i2s_driver_uninstall(port);
+        return false;
+    }
+
+    sampleRate = rate;
+    return true;
+}
+
+bool I2sAudioSink::write(int16_t *samples, size_t count) {
+    if (bitClockPin == SVC_AUDIO_I2S_BUILTIN_DAC) {
+        // The DAC is unsigned, move the signed samples up by half the range
+        for (size_t i = 0; i < count; i++) {
+            samples[i] ^= (int16_t) 0x8000;
+        }
+    }
+
+    // Blocks while both DMA buffers are queued, which paces the decoding to the sample rate
+    size_t written = 0;
+    return i2s_write(port, samples, count * sizeof(int16_t), &written, portMAX_DELAY) == ESP_OK &&
+           written == count * sizeof(int16_t);
+}
+
+void I2sAudioSink::end() {
+    // Let the queued DMA buffers play out before removing the driver
+    vTaskDelay(pdMS_TO_TICKS(SVC_AUDIO_I2S_DMA_BUFFERS * SVC_AUDIO_I2S_DMA_FRAMES * 1000 / sampleRate + 1));
+#if SOC_I2S_SUPPORTS_DAC
+    if (bitClockPin == SVC_AUDIO_I2S_BUILTIN_DAC) {
+        i2s_set_dac_mode(I2S_DAC_CHANNEL_DISABLE);
+    }
+#endif
+    i2s_driver_uninstall(port);
+}
+
+PartitionAudioSource::PartitionAudioSource(const char *label) : label(label) {
+}
+
+bool PartitionAudioSource::read(uint32_t offset, uint8_t *data, size_t length) {
+    if (partition == nullptr) {
+        partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+        if (partition == nullptr) {
+            return false;
+        }
+    }
+    return offset + length <= partition->size && esp_partition_read(partition, offset, data, length) == ESP_OK;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
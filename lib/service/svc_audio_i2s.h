@@ -0,0 +1,95 @@
+/*===========================================================================*/
+/// \file svc_audio_i2s.h
+///
+/// \brief
+///    Audio sink on the I2S peripheral and audio source in a flash partition
+///
+/// \details
+///     The sink feeds either the internal DAC (GPIO25) or an external I2S codec, through two DMA buffers so one plays
+///     while the next is filled. The source reads the clip straight from a data partition, without loading it.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_AUDIO_I2S_H
+#define SVC_AUDIO_I2S_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+#include <driver/i2s.h>
+#include <esp_partition.h>
+#include <svc_audio.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+// Pass as the bit clock pin to use the internal DAC instead of an external codec
+#define SVC_AUDIO_I2S_BUILTIN_DAC (-1)
+// Samples per DMA buffer, one buffer plays while the other is filled
+#define SVC_AUDIO_I2S_DMA_FRAMES 512
+#define SVC_AUDIO_I2S_DMA_BUFFERS 2
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+class I2sAudioSink : public AudioSink {
+public:
+    I2sAudioSink(i2s_port_t port, int bitClockPin, int wordSelectPin, int dataPin);
+
+    bool begin(uint32_t sampleRate) override;
+
+    bool write(int16_t *samples, size_t count) override;
+
+    void end() override;
+
+private:
+    const i2s_port_t port;
+    const int bitClockPin;
+    const int wordSelectPin;
+    const int dataPin;
+    uint32_t sampleRate = 0;
+};
+
+class PartitionAudioSource : public AudioSource {
+public:
+    explicit PartitionAudioSource(const char *label);
+
+    bool read(uint32_t offset, uint8_t *data, size_t length) override;
+
+private:
+    const char *const label;
+    const esp_partition_t *partition = nullptr;
+};
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+#endif // SVC_AUDIO_I2S_H
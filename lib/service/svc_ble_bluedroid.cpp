@@ -0,0 +1,312 @@
+/*===========================================================================*/
+/// \file svc_ble_bluedroid.cpp
+///
+/// \brief
+///    Bluedroid backend of the BLE transport
+///
+/// \details
+///    Build the GATT table with the Arduino BLE library and forward its callbacks to the transport handler. Used
+///    unless SVC_BLE_NIMBLE is defined, host builds use the mock backend of test/mock instead.
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+#if defined(ARDUINO) && !defined(SVC_BLE_NIMBLE)
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_ble_transport.h"
+#include <Arduino.h>
+#include <BLEDevice.h>
+#include <BLE2902.h>
+#include <esp_gap_ble_api.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/* Check if Bluetooth configurations are enabled in the SDK */
+#if !defined(CONFIG_BT_ENABLED) || !defined(CONFIG_BLUEDROID_ENABLED)
+#error Bluetooth is not enabled! Please run `make menuconfig` to and enable it
+#endif
+
+// Largest link layer payload with the data length extension
+#define LINK_MAX_TX_OCTETS 251
+// Payload of a link layer packet without the data length extension
+#define LINK_DEFAULT_TX_OCTETS 27
+// Left in the scan response next to the 128 bit service UUID while broadcasting
+#define BROADCAST_NAME_SIZE 11
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+class BluedroidTransport : public BleTransport, public BLEServerCallbacks {
+public:
+    bool begin(const char *name, BleTransportHandler *transportHandler) override;
+
+    void setValue(svcBleCharacteristic_t characteristic, const uint8_t *data, size_t length) override;
+
+    void notify(svcBleCharacteristic_t characteristic) override;
+
+    bool isConnected() const override;
+
+    void setLinkProfile(svcBleLinkProfile_t profile) override;
+
+    uint16_t connectionInterval() const override;
+
+    bool dataLengthExtended() const override;
+
+    void setBroadcastData(const uint8_t *data, size_t length) override;
+
+    bool observe(svcBleBroadcastCallback_t callback) override;
+
+    void onConnect(BLEServer *pServer, esp_ble_gatts_cb_param_t *param) override;
+
+    void onDisconnect(BLEServer *pServer) override;
+
+    static void gapEventHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param);
+
+    BleTransportHandler *handler = nullptr;
+    std::string name;
+    BLECharacteristic *characteristics[SVC_BLE_CHAR_COUNT] = {};
+    esp_bd_addr_t remoteAddress = {};
+    volatile bool connected = false;
+    volatile uint16_t interval = 0;
+    volatile bool extendedLength = false;
+    volatile svcBleBroadcastCallback_t observerCallback = nullptr;
+};
+
+class CharacteristicCallbacks : public BLECharacteristicCallbacks {
+public:
+    CharacteristicCallbacks(BluedroidTransport *transport, svcBleCharacteristic_t characteristic)
+        : transport(transport), characteristic(characteristic) {
+    }
+
+    void onWrite(BLECharacteristic *pCharacteristic) override {
+        transport->handler->onWrite(characteristic, pCharacteristic->getData(), pCharacteristic->getLength());
+    }
+
+private:
+    BluedroidTransport *transport;
+    svcBleCharacteristic_t characteristic;
+};
+
+class ObserverCallbacks : public BLEAdvertisedDeviceCallbacks {
+public:
+    explicit ObserverCallbacks(BluedroidTransport *transport) : transport(transport) {
+    }
+
+    void onResult(BLEAdvertisedDevice advertisedDevice) override {
+        const svcBleBroadcastCallback_t callback = transport->observerCallback;
+        if (callback != nullptr && advertisedDevice.haveManufacturerData()) {
+            const std::string data = advertisedDevice.getManufacturerData();
+            callback((const uint8_t *) data.data(), data.length());
+        }
+    }
+
+private:
+    BluedroidTransport *transport;
+};
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static BluedroidTransport transport;
+static ObserverCallbacks observerCallbacks(&transport);
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+BleTransport *svcBleTransportGet() {
+    return &transport;
+}
+
+bool BluedroidTransport::begin(const char *name, BleTransportHandler *transportHandler) {
+    handler = transportHandler;
+    this->name = name;
+
+    BLEDevice::init(name);
+    BLEDevice::setCustomGapHandler(gapEventHandler);
+    BLEServer *pServer = BLEDevice::createServer();
+    BLEService *services[SVC_BLE_SERVICE_COUNT];
+    for (int service = 0; service < SVC_BLE_SERVICE_COUNT; service++) {
+        int count = 0;
+        for (const svcBleCharacteristicInfo_t &info: svcBleCharacteristics) {
+            count += info.service == service;
+        }
+        // Three handles per characteristic (declaration, value, CCCD) plus the service itself
+        services[service] = pServer->createService(svcBleServices[service], count * 3 + 1, 0);
+    }
+
+    for (int i = 0; i < SVC_BLE_CHAR_COUNT; i++) {
+        const svcBleCharacteristicInfo_t &info = svcBleCharacteristics[i];
+        uint32_t properties = 0;
+        properties |= (info.properties & SVC_BLE_PROPERTY_READ) ? BLECharacteristic::PROPERTY_READ : 0;
+        properties |= (info.properties & SVC_BLE_PROPERTY_WRITE) ? BLECharacteristic::PROPERTY_WRITE : 0;
+        properties |= (info.properties & SVC_BLE_PROPERTY_WRITE_NR) ? BLECharacteristic::PROPERTY_WRITE_NR : 0;
+        properties |= (info.properties & SVC_BLE_PROPERTY_NOTIFY) ? BLECharacteristic::PROPERTY_NOTIFY : 0;
+
+        characteristics[i] = services[info.service]->createCharacteristic(info.uuid, properties);
+        if (info.properties & SVC_BLE_PROPERTY_NOTIFY) {
+            characteristics[i]->addDescriptor(new BLE2902());
+        }
+        if (info.properties & (SVC_BLE_PROPERTY_WRITE | SVC_BLE_PROPERTY_WRITE_NR)) {
+            characteristics[i]->setCallbacks(new CharacteristicCallbacks(this, (svcBleCharacteristic_t) i));
+        }
+    }
+    pServer->setCallbacks(this);
+    for (BLEService *service: services) {
+        service->start();
+    }
+
+    BLEAdvertising *pAdvertising = BLEDevice::getAdvertising();
+    pAdvertising->addServiceUUID(SVC_BLE_SERVICE_UUID);
+    pAdvertising->setScanResponse(true);
+    pAdvertising->setMinPreferred(0x06); // functions that help with iPhone connections issue
+    pAdvertising->setMinPreferred(0x12);
+    BLEDevice::startAdvertising();
+    return true;
+}
+
+void BluedroidTransport::setValue(svcBleCharacteristic_t characteristic, const uint8_t *data, size_t length) {
+    characteristics[characteristic]->setValue((uint8_t *) data, length);
+}
+
+void BluedroidTransport::notify(svcBleCharacteristic_t characteristic) {
+    if (connected) {
+        characteristics[characteristic]->notify();
+    }
+}
+
+bool BluedroidTransport::isConnected() const {
+    return connected;
+}
+
+void BluedroidTransport::setLinkProfile(svcBleLinkProfile_t profile) {
+    if (!connected) {
+        return;
+    }
+
+    const svcBleLinkParameters_t &parameters = svcBleLinkProfiles[profile];
+    esp_ble_conn_update_params_t updateParams = {};
+    memcpy(updateParams.bda, remoteAddress, sizeof(esp_bd_addr_t));
+    updateParams.min_int = parameters.minInterval;
+    updateParams.max_int = parameters.maxInterval;
+    updateParams.latency = parameters.latency;
+    updateParams.timeout = parameters.timeout;
+    esp_ble_gap_update_conn_params(&updateParams);
+
+    if (profile == SVC_BLE_LINK_BULK) {
+        esp_ble_gap_set_pkt_data_len(remoteAddress, LINK_MAX_TX_OCTETS);
+#if CONFIG_BT_BLE_50_FEATURES_SUPPORTED
+        // Only controllers with BLE 5 (ESP32-C3/S3) have the 2M PHY, the ESP32 stays on 1M
+        esp_ble_gap_set_preferred_phy(remoteAddress, 0, ESP_BLE_GAP_PHY_2M_PREF_MASK, ESP_BLE_GAP_PHY_2M_PREF_MASK,
+                                      ESP_BLE_GAP_PHY_OPTIONS_NO_PREF);
+#endif
+    }
+}
+
+uint16_t BluedroidTransport::connectionInterval() const {
+    return interval;
+}
+
+bool BluedroidTransport::dataLengthExtended() const {
+    return extendedLength;
+}
+
+void BluedroidTransport::setBroadcastData(const uint8_t *data, size_t length) {
+    BLEAdvertisementData advertisement;
+    BLEAdvertisementData scanResponse;
+    advertisement.setFlags(ESP_BLE_ADV_FLAG_GEN_DISC | ESP_BLE_ADV_FLAG_BREDR_NOT_SPT);
+    if (data != nullptr) {
+        // The 128 bit UUID and the manufacturer data do not fit together in the 31 bytes of the advertisement
+        advertisement.setManufacturerData(std::string((const char *) data, length));
+        scanResponse.setCompleteServices(BLEUUID(SVC_BLE_SERVICE_UUID));
+        scanResponse.setShortName(name.substr(0, BROADCAST_NAME_SIZE));
+    } else {
+        advertisement.setCompleteServices(BLEUUID(SVC_BLE_SERVICE_UUID));
+        scanResponse.setName(name);
+    }
+
+    // Taken by the running advertisement, and by the next one after a connection
+    BLEAdvertising *pAdvertising = BLEDevice::getAdvertising();
+    pAdvertising->setAdvertisementData(advertisement);
+    pAdvertising->setScanResponseData(scanResponse);
+}
+
+bool BluedroidTransport::observe(svcBleBroadcastCallback_t callback) {
+    BLEScan *scan = BLEDevice::getScan();
+    observerCallback = callback;
+    if (callback == nullptr) {
+        scan->stop();
+        return true;
+    }
+
+    // Duplicates are wanted, the same advertiser carries a different fragment every few hundred milliseconds
+    scan->setAdvertisedDeviceCallbacks(&observerCallbacks, true);
+    scan->setActiveScan(false);
+    scan->setInterval(SVC_BLE_OBSERVER_INTERVAL_MS);
+    scan->setWindow(SVC_BLE_OBSERVER_WINDOW_MS);
+    // A duration of 0 scans until stopped
+    return scan->start(0, nullptr, false);
+}
+
+void BluedroidTransport::onConnect(BLEServer *pServer, esp_ble_gatts_cb_param_t *param) {
+    memcpy(remoteAddress, param->connect.remote_bda, sizeof(esp_bd_addr_t));
+    interval = param->connect.conn_params.interval;
+    extendedLength = false;
+    connected = true;
+    handler->onConnect();
+}
+
+void BluedroidTransport::onDisconnect(BLEServer *pServer) {
+    connected = false;
+    handler->onDisconnect();
+    BLEDevice::startAdvertising();
+}
+
+void BluedroidTransport::gapEventHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param) {
+    switch (event) {
+        case ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT:
+            transport.interval = param->update_conn_params.conn_int;
+            break;
+        case ESP_GAP_BLE_SET_PKT_LENGTH_COMPLETE_EVT:
+            transport.extendedLength = param->pkt_data_length_cmpl.params.tx_len > LINK_DEFAULT_TX_OCTETS;
+            break;
+        default:
+            break;
+    }
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+#endif // ARDUINO && !SVC_BLE_NIMBLE
@@ -0,0 +1,279 @@
+/*===========================================================================*/
+/// \file svc_ble_nimble.cpp
+///
+/// \brief
+///    NimBLE backend of the BLE transport
+///
+/// \details
+///    Build the same GATT table as the Bluedroid backend with NimBLE-Arduino, which needs far less flash and RAM.
+///    Used when SVC_BLE_NIMBLE is defined (see the esp32dev-nimble environment).
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+#if defined(ARDUINO) && defined(SVC_BLE_NIMBLE)
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_ble_transport.h"
+#include <Arduino.h>
+#include <NimBLEDevice.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+// Largest link layer payload with the data length extension
+#define LINK_MAX_TX_OCTETS 251
+// Left in the scan response next to the 128 bit service UUID while broadcasting
+#define BROADCAST_NAME_SIZE 11
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+class NimbleTransport : public BleTransport, public NimBLEServerCallbacks {
+public:
+    bool begin(const char *name, BleTransportHandler *transportHandler) override;
+
+    void setValue(svcBleCharacteristic_t characteristic, const uint8_t *data, size_t length) override;
+
+    void notify(svcBleCharacteristic_t characteristic) override;
+
+    bool isConnected() const override;
+
+    void setLinkProfile(svcBleLinkProfile_t profile) override;
+
+    uint16_t connectionInterval() const override;
+
+    bool dataLengthExtended() const override;
+
+    void setBroadcastData(const uint8_t *data, size_t length) override;
+
+    bool observe(svcBleBroadcastCallback_t callback) override;
+
+    void onConnect(NimBLEServer *pServer, ble_gap_conn_desc *desc) override;
+
+    void onDisconnect(NimBLEServer *pServer) override;
+
+    BleTransportHandler *handler = nullptr;
+    std::string name;
+    NimBLEServer *server = nullptr;
+    NimBLECharacteristic *characteristics[SVC_BLE_CHAR_COUNT] = {};
+    volatile uint16_t connectionHandle = BLE_HS_CONN_HANDLE_NONE;
+    volatile bool extendedLength = false;
+    volatile svcBleBroadcastCallback_t observerCallback = nullptr;
+};
+
+class CharacteristicCallbacks : public NimBLECharacteristicCallbacks {
+public:
+    CharacteristicCallbacks(NimbleTransport *transport, svcBleCharacteristic_t characteristic)
+        : transport(transport), characteristic(characteristic) {
+    }
+
+    void onWrite(NimBLECharacteristic *pCharacteristic) override {
+        NimBLEAttValue value = pCharacteristic->getValue();
+        transport->handler->onWrite(characteristic, value.data(), value.length());
+    }
+
+private:
+    NimbleTransport *transport;
+    svcBleCharacteristic_t characteristic;
+};
+
+class ObserverCallbacks : public NimBLEAdvertisedDeviceCallbacks {
+public:
+    explicit ObserverCallbacks(NimbleTransport *transport) : transport(transport) {
+    }
+
+    void onResult(NimBLEAdvertisedDevice *advertisedDevice) override {
+        const svcBleBroadcastCallback_t callback = transport->observerCallback;
+        if (callback != nullptr && advertisedDevice->haveManufacturerData()) {
+            const std::string data = advertisedDevice->getManufacturerData();
+            callback((const uint8_t *) data.data(), data.length());
+        }
+    }
+
+private:
+    NimbleTransport *transport;
+};
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static NimbleTransport transport;
+static ObserverCallbacks observerCallbacks(&transport);
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+BleTransport *svcBleTransportGet() {
+    return &transport;
+}
+
+bool NimbleTransport::begin(const char *name, BleTransportHandler *transportHandler) {
+    handler = transportHandler;
+    this->name = name;
+
+    NimBLEDevice::init(name);
+    server = NimBLEDevice::createServer();
+    server->setCallbacks(this, false);
+    NimBLEService *services[SVC_BLE_SERVICE_COUNT];
+    for (int service = 0; service < SVC_BLE_SERVICE_COUNT; service++) {
+        services[service] = server->createService(svcBleServices[service]);
+    }
+
+    for (int i = 0; i < SVC_BLE_CHAR_COUNT; i++) {
+        const svcBleCharacteristicInfo_t &info = svcBleCharacteristics[i];
+        uint32_t properties = 0;
+        properties |= (info.properties & SVC_BLE_PROPERTY_READ) ? NIMBLE_PROPERTY::READ : 0;
+        properties |= (info.properties & SVC_BLE_PROPERTY_WRITE) ? NIMBLE_PROPERTY::WRITE : 0;
+        properties |= (info.properties & SVC_BLE_PROPERTY_WRITE_NR) ? NIMBLE_PROPERTY::WRITE_NR : 0;
+        properties |= (info.properties & SVC_BLE_PROPERTY_NOTIFY) ? NIMBLE_PROPERTY::NOTIFY : 0;
+
+        // NimBLE adds the CCCD of notifying characteristics by itself
+        characteristics[i] = services[info.service]->createCharacteristic(info.uuid, properties);
+        if (info.properties & (SVC_BLE_PROPERTY_WRITE | SVC_BLE_PROPERTY_WRITE_NR)) {
+            characteristics[i]->setCallbacks(new CharacteristicCallbacks(this, (svcBleCharacteristic_t) i));
+        }
+    }
+    for (NimBLEService *service: services) {
+        service->start();
+    }
+
+    NimBLEAdvertising *pAdvertising = NimBLEDevice::getAdvertising();
+    pAdvertising->addServiceUUID(SVC_BLE_SERVICE_UUID);
+    pAdvertising->setScanResponse(true);
+    pAdvertising->setMinPreferred(0x06); // functions that help with iPhone connections issue
+    pAdvertising->setMinPreferred(0x12);
+    pAdvertising->start();
+    return true;
+}
+
+void NimbleTransport::setValue(svcBleCharacteristic_t characteristic, const uint8_t *data, size_t length) {
+    characteristics[characteristic]->setValue(data, length);
+}
+
+void NimbleTransport::notify(svcBleCharacteristic_t characteristic) {
+    if (isConnected()) {
+        characteristics[characteristic]->notify();
+    }
+}
+
+bool NimbleTransport::isConnected() const {
+    return connectionHandle != BLE_HS_CONN_HANDLE_NONE;
+}
+
+void NimbleTransport::setLinkProfile(svcBleLinkProfile_t profile) {
+    const uint16_t handle = connectionHandle;
+    if (handle == BLE_HS_CONN_HANDLE_NONE) {
+        return;
+    }
+
+    const svcBleLinkParameters_t &parameters = svcBleLinkProfiles[profile];
+    server->updateConnParams(handle, parameters.minInterval, parameters.maxInterval, parameters.latency,
+                             parameters.timeout);
+
+    if (profile == SVC_BLE_LINK_BULK) {
+        server->setDataLen(handle, LINK_MAX_TX_OCTETS);
+        extendedLength = true;
+#if defined(CONFIG_IDF_TARGET_ESP32C3) || defined(CONFIG_IDF_TARGET_ESP32S3)
+        // Only controllers with BLE 5 have the 2M PHY, the ESP32 stays on 1M
+        ble_gap_set_prefered_le_phy(handle, BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_CODED_ANY);
+#endif
+    }
+}
+
+uint16_t NimbleTransport::connectionInterval() const {
+    ble_gap_conn_desc desc;
+    if (connectionHandle == BLE_HS_CONN_HANDLE_NONE || ble_gap_conn_find(connectionHandle, &desc) != 0) {
+        return 0;
+    }
+    return desc.conn_itvl;
+}
+
+bool NimbleTransport::dataLengthExtended() const {
+    return extendedLength;
+}
+
+void NimbleTransport::setBroadcastData(const uint8_t *data, size_t length) {
+    NimBLEAdvertisementData advertisement;
+    NimBLEAdvertisementData scanResponse;
+    advertisement.setFlags(BLE_HS_ADV_F_DISC_GEN | BLE_HS_ADV_F_BREDR_UNSUP);
+    if (data != nullptr) {
+        // The 128 bit UUID and the manufacturer data do not fit together in the 31 bytes of the advertisement
+        advertisement.setManufacturerData(std::string((const char *) data, length));
+        scanResponse.setCompleteServices(NimBLEUUID(SVC_BLE_SERVICE_UUID));
+        scanResponse.setShortName(name.substr(0, BROADCAST_NAME_SIZE));
+    } else {
+        advertisement.setCompleteServices(NimBLEUUID(SVC_BLE_SERVICE_UUID));
+        scanResponse.setName(name);
+    }
+
+    // Applied to the running advertisement, and kept for the restart after a connection
+    NimBLEAdvertising *pAdvertising = NimBLEDevice::getAdvertising();
+    pAdvertising->setAdvertisementData(advertisement);
+    pAdvertising->setScanResponseData(scanResponse);
+}
+
+bool NimbleTransport::observe(svcBleBroadcastCallback_t callback) {
+    NimBLEScan *scan = NimBLEDevice::getScan();
+    observerCallback = callback;
+    if (callback == nullptr) {
+        return scan->stop();
+    }
+
+    // Duplicates are wanted, the same advertiser carries a different fragment every few hundred milliseconds
+    scan->setAdvertisedDeviceCallbacks(&observerCallbacks, true);
+    scan->setActiveScan(false);
+    scan->setInterval(SVC_BLE_OBSERVER_INTERVAL_MS);
+    scan->setWindow(SVC_BLE_OBSERVER_WINDOW_MS);
+    // Results are only passed to the callback, none is kept
+    scan->setMaxResults(0);
+    // A duration of 0 scans until stopped
+    return scan->start(0, nullptr, false);
+}
+
+void NimbleTransport::onConnect(NimBLEServer *pServer, ble_gap_conn_desc *desc) {
+    connectionHandle = desc->conn_handle;
+    extendedLength = false;
+    handler->onConnect();
+}
+
+void NimbleTransport::onDisconnect(NimBLEServer *pServer) {
+    // NimBLE restarts advertising by itself after a disconnection
+    connectionHandle = BLE_HS_CONN_HANDLE_NONE;
+    handler->onDisconnect();
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+#endif // ARDUINO && SVC_BLE_NIMBLE
@@ -0,0 +1,79 @@
+/*===========================================================================*/
+/// \file svc_ble_transport.cpp
+///
+/// \brief
+///    BLE GATT transport interface shared by the Bluedroid and NimBLE backends
+///
+/// \details
+///    GATT table and link profiles common to every backend
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_ble_transport.h"
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+const char *const svcBleServices[SVC_BLE_SERVICE_COUNT] = {
+    SVC_BLE_SERVICE_UUID,
+    SVC_BLE_UART_SERVICE_UUID
+};
+
+const svcBleCharacteristicInfo_t svcBleCharacteristics[SVC_BLE_CHAR_COUNT] = {
+    {"beb5483e-36e1-4688-b7f5-ea07361b26a8", SVC_BLE_PROPERTY_READ | SVC_BLE_PROPERTY_WRITE, SVC_BLE_SERVICE_MAIN},
+    {"beb5483e-36e1-4688-b7f5-ea07361b26a9", SVC_BLE_PROPERTY_READ | SVC_BLE_PROPERTY_NOTIFY, SVC_BLE_SERVICE_MAIN},
+    {"beb5483e-36e1-4688-b7f5-ea07361b26aa", SVC_BLE_PROPERTY_READ, SVC_BLE_SERVICE_MAIN},
+    {"beb5483e-36e1-4688-b7f5-ea07361b26ab", SVC_BLE_PROPERTY_READ | SVC_BLE_PROPERTY_WRITE | SVC_BLE_PROPERTY_NOTIFY,
+     SVC_BLE_SERVICE_MAIN},
+    {"beb5483e-36e1-4688-b7f5-ea07361b26ac", SVC_BLE_PROPERTY_WRITE_NR, SVC_BLE_SERVICE_MAIN},
+    {"beb5483e-36e1-4688-b7f5-ea07361b26ad", SVC_BLE_PROPERTY_READ, SVC_BLE_SERVICE_MAIN},
+    {"beb5483e-36e1-4688-b7f5-ea07361b26ae", SVC_BLE_PROPERTY_READ | SVC_BLE_PROPERTY_NOTIFY, SVC_BLE_SERVICE_MAIN},
+    {"beb5483e-36e1-4688-b7f5-ea07361b26af", SVC_BLE_PROPERTY_READ | SVC_BLE_PROPERTY_NOTIFY, SVC_BLE_SERVICE_MAIN},
+    {"6e400002-b5a3-f393-e0a9-e50e24dcca9e", SVC_BLE_PROPERTY_WRITE | SVC_BLE_PROPERTY_WRITE_NR, SVC_BLE_SERVICE_UART},
+    {"6e400003-b5a3-f393-e0a9-e50e24dcca9e", SVC_BLE_PROPERTY_NOTIFY, SVC_BLE_SERVICE_UART}
+};
+
+const svcBleLinkParameters_t svcBleLinkProfiles[] = {
+    {320, 400, 4, 600}, // SVC_BLE_LINK_IDLE: 400 - 500 ms interval, up to 4 skipped events, 6 s supervision timeout
+    {6, 12, 0, 400}     // SVC_BLE_LINK_BULK: 7.5 - 15 ms interval, no latency, 4 s supervision timeout
+};
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
@@ -0,0 +1,174 @@
+/*===========================================================================*/
+/// \file svc_ble_transport.h
+///
+/// \brief
+///    BLE GATT transport interface shared by the Bluedroid and NimBLE backends
+///
+/// \details
+///     The protocol modules only see characteristic identifiers and byte buffers, the backend selected at build time
+///     (SVC_BLE_NIMBLE defined or not) owns the stack. The service and characteristic UUIDs are defined once here so
+///     every backend exposes the same GATT table. Only plain C++ is used so a mock backend can run on a host.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_BLE_TRANSPORT_H
+#define SVC_BLE_TRANSPORT_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SVC_BLE_SERVICE_UUID "4fafc201-1fb5-459e-8fcc-c5c9c331914b"
+// Nordic UART service, understood by the usual BLE terminal apps
+#define SVC_BLE_UART_SERVICE_UUID "6e400001-b5a3-f393-e0a9-e50e24dcca9e"
+
+#define SVC_BLE_PROPERTY_READ (1 << 0)
+#define SVC_BLE_PROPERTY_WRITE (1 << 1)
+#define SVC_BLE_PROPERTY_WRITE_NR (1 << 2)
+#define SVC_BLE_PROPERTY_NOTIFY (1 << 3)
+
+// Passive scan of the observer, half of the time on air
+#define SVC_BLE_OBSERVER_INTERVAL_MS 100
+#define SVC_BLE_OBSERVER_WINDOW_MS 50
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    SVC_BLE_SERVICE_MAIN, // Advertised
+    SVC_BLE_SERVICE_UART,
+    SVC_BLE_SERVICE_COUNT
+} svcBleService_t;
+
+typedef enum {
+    SVC_BLE_CHAR_OPERATION, // Timetable and time sync packets written by the phone
+    SVC_BLE_CHAR_STATUS,    // Device status, notified on change
+    SVC_BLE_CHAR_TIMETABLE, // Stored timetable, read with long reads
+    SVC_BLE_CHAR_OTA_CONTROL, // Firmware update commands, results notified
+    SVC_BLE_CHAR_OTA_DATA,    // Firmware update chunks, written without response
+    SVC_BLE_CHAR_MANIFEST,    // Hashes of the stored timetable and of each day, read with long reads
+    SVC_BLE_CHAR_TIME,        // Answers to the time exchange requests, notified
+    SVC_BLE_CHAR_TELEMETRY,   // Health counters snapshot, refreshed and notified periodically
+    SVC_BLE_CHAR_UART_RX,     // CLI input, written by the terminal
+    SVC_BLE_CHAR_UART_TX,     // CLI output, notified
+    SVC_BLE_CHAR_COUNT
+} svcBleCharacteristic_t;
+
+typedef enum {
+    SVC_BLE_LINK_IDLE,
+    SVC_BLE_LINK_BULK
+} svcBleLinkProfile_t;
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/// \brief Called from the stack task with the manufacturer data of an advertisement, company id first
+typedef void (*svcBleBroadcastCallback_t)(const uint8_t *data, size_t length);
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    const char *uuid;
+    uint8_t properties;
+    svcBleService_t service;
+} svcBleCharacteristicInfo_t;
+
+/// Connection parameters in controller units: intervals of 1.25 ms, timeout of 10 ms
+typedef struct {
+    uint16_t minInterval;
+    uint16_t maxInterval;
+    uint16_t latency;
+    uint16_t timeout;
+} svcBleLinkParameters_t;
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+class BleTransportHandler {
+public:
+    virtual ~BleTransportHandler() = default;
+
+    virtual void onConnect() = 0;
+
+    virtual void onDisconnect() = 0;
+
+    /// \brief Called from the stack task for every write to a writable characteristic
+    virtual void onWrite(svcBleCharacteristic_t characteristic, const uint8_t *data, size_t length) = 0;
+};
+
+class BleTransport {
+public:
+    virtual ~BleTransport() = default;
+
+    /// \brief Start the stack, create the GATT table and start advertising
+    /// \param name The advertised device name
+    /// \param handler Receives the connection and write events
+    /// \return true if the stack started, false otherwise
+    virtual bool begin(const char *name, BleTransportHandler *handler) = 0;
+
+    /// \brief Set the value returned by reads of a characteristic
+    virtual void setValue(svcBleCharacteristic_t characteristic, const uint8_t *data, size_t length) = 0;
+
+    /// \brief Notify the current value of a characteristic to the connected client
+    virtual void notify(svcBleCharacteristic_t characteristic) = 0;
+
+    virtual bool isConnected() const = 0;
+
+    /// \brief Request the connection parameters of a profile for the current connection
+    virtual void setLinkProfile(svcBleLinkProfile_t profile) = 0;
+
+    /// \brief Current connection interval, in 1.25 ms units, 0 when unknown
+    virtual uint16_t connectionInterval() const = 0;
+
+    /// \brief true when the data length extension is active on the current connection
+    virtual bool dataLengthExtended() const = 0;
+
+    /// \brief Advertise manufacturer data, the service UUID moves to the scan response to leave it room
+    /// \param data Manufacturer data starting with the company id, nullptr to go back to the service UUID
+    /// \param length Bytes in the data, at most 26
+    virtual void setBroadcastData(const uint8_t *data, size_t length) = 0;
+
+    /// \brief Passively scan for advertisements with manufacturer data, alongside advertising and the connection
+    /// \param callback Receives the manufacturer data of every advertisement seen, nullptr to stop scanning
+    /// \return true if the scan started or stopped, false otherwise
+    virtual bool observe(svcBleBroadcastCallback_t callback) = 0;
+};
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+extern const char *const svcBleServices[SVC_BLE_SERVICE_COUNT];
+
+extern const svcBleCharacteristicInfo_t svcBleCharacteristics[SVC_BLE_CHAR_COUNT];
+
+extern const svcBleLinkParameters_t svcBleLinkProfiles[];
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Get the backend selected at build time
+/// \return The transport
+BleTransport *svcBleTransportGet();
+
+#endif // SVC_BLE_TRANSPORT_H
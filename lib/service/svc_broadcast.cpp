@@ -0,0 +1,230 @@
+/*===========================================================================*/
+/// \file svc_broadcast.cpp
+///
+/// \brief
+///    Fragmentation of a timetable body into advertising packets and its reassembly
+///
+/// \details
+///    Fragment representation, little endian:
+///    [0..1] - Company id, SVC_BROADCAST_COMPANY_ID
+///    [2] - Magic, SVC_BROADCAST_MAGIC
+///    [3] - Version
+///    [4..5] - Sequence number of the body, the sender adds one for every new timetable
+///    [6..7] - CRC-16 of the whole body
+///    [8] - Fragment index
+///    [9] - Fragment count
+///    [10..] - Up to SVC_BROADCAST_PAYLOAD_SIZE bytes of the body, only the last fragment is shorter
+///    Last 2 bytes - CRC-16 of the fragment bytes before it
+///    The CRC is CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF).
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_broadcast.h"
+#include <string.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define CRC_INITIAL_VALUE 0xFFFF
+#define CRC_POLYNOMIAL 0x1021
+
+static_assert(SVC_BROADCAST_MAX_FRAGMENTS <= 64, "The received fragments are tracked in a 64 bit mask");
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static uint16_t crc16(const uint8_t *data, size_t length);
+
+static uint16_t readLittleEndian16(const uint8_t *data);
+
+static void writeLittleEndian16(uint8_t *data, uint16_t value);
+
+static bool sameBody(svcBroadcastBodyId_t a, svcBroadcastBodyId_t b);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const char *statusNames[SVC_BROADCAST_STATUS_COUNT] = {
+    "added",
+    "complete",
+    "duplicate",
+    "foreign",
+    "corrupted"
+};
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+uint16_t svcBroadcastBodyCrc(const uint8_t *body, size_t length) {
+    return crc16(body, length);
+}
+
+uint8_t svcBroadcastFragmentCount(size_t length) {
+    if (length == 0 || length > SVC_BROADCAST_MAX_BODY_SIZE) {
+        return 0;
+    }
+    return (uint8_t) ((length + SVC_BROADCAST_PAYLOAD_SIZE - 1) / SVC_BROADCAST_PAYLOAD_SIZE);
+}
+
+size_t svcBroadcastEncode(const uint8_t *body, size_t length, svcBroadcastBodyId_t id, uint8_t index,
+                          uint8_t *fragment) {
+    const uint8_t count = svcBroadcastFragmentCount(length);
+    if (index >= count) {
+        return 0;
+    }
+
+    const size_t offset = (size_t) index * SVC_BROADCAST_PAYLOAD_SIZE;
+    const size_t payloadLength = length - offset < SVC_BROADCAST_PAYLOAD_SIZE ? length - offset
+                                                                                : SVC_BROADCAST_PAYLOAD_SIZE;
+    writeLittleEndian16(&fragment[0], SVC_BROADCAST_COMPANY_ID);
+    fragment[2] = SVC_BROADCAST_MAGIC;
+    fragment[3] = SVC_BROADCAST_VERSION;
+    writeLittleEndian16(&fragment[4], id.sequence);
+    writeLittleEndian16(&fragment[6], id.crc);
+    fragment[8] = index;
+    fragment[9] = count;
+    memcpy(&fragment[SVC_BROADCAST_HEADER_SIZE], &body[offset], payloadLength);
+
+    const size_t crcOffset = SVC_BROADCAST_HEADER_SIZE + payloadLength;
+    writeLittleEndian16(&fragment[crcOffset], crc16(fragment, crcOffset));
+    return crcOffset + SVC_BROADCAST_CRC_SIZE;
+}
+
+void svcBroadcastReset(svcBroadcastAssembler_t *assembler) {
+    memset(assembler, 0, sizeof(*assembler));
+}
+
+svcBroadcastStatus_t svcBroadcastFeed(svcBroadcastAssembler_t *assembler, const uint8_t *data, size_t length) {
+    // Any other advertisement with manufacturer data goes through here, it is dropped without counting it
+    if (length < 4 || readLittleEndian16(data) != SVC_BROADCAST_COMPANY_ID || data[2] != SVC_BROADCAST_MAGIC ||
+        data[3] != SVC_BROADCAST_VERSION) {
+        return SVC_BROADCAST_FOREIGN;
+    }
+
+    const size_t crcOffset = length - SVC_BROADCAST_CRC_SIZE;
+    if (length <= SVC_BROADCAST_HEADER_SIZE + SVC_BROADCAST_CRC_SIZE || length > SVC_BROADCAST_FRAGMENT_SIZE ||
+        readLittleEndian16(&data[crcOffset]) != crc16(data, crcOffset)) {
+        assembler->corrupted++;
+        return SVC_BROADCAST_CORRUPTED;
+    }
+
+    const svcBroadcastBodyId_t id = {readLittleEndian16(&data[4]), readLittleEndian16(&data[6])};
+    const uint8_t index = data[8];
+    const uint8_t count = data[9];
+    const size_t payloadLength = crcOffset - SVC_BROADCAST_HEADER_SIZE;
+    const bool last = index == count - 1;
+    if (count == 0 || count > SVC_BROADCAST_MAX_FRAGMENTS || index >= count ||
+        (!last && payloadLength != SVC_BROADCAST_PAYLOAD_SIZE)) {
+        assembler->corrupted++;
+        return SVC_BROADCAST_CORRUPTED;
+    }
+
+    // The sender keeps repeating a body long after every display has it
+    if (assembler->hasCompleted && sameBody(id, assembler->completed)) {
+        assembler->duplicates++;
+        return SVC_BROADCAST_DUPLICATE;
+    }
+    if (!sameBody(id, assembler->id) || count != assembler->count) {
+        // A newer body replaces the one being assembled, its fragments cannot be mixed
+        assembler->id = id;
+        assembler->count = count;
+        assembler->received = 0;
+        assembler->length = 0;
+    }
+
+    const uint64_t bit = 1ULL << index;
+    if (assembler->received & bit) {
+        assembler->duplicates++;
+        return SVC_BROADCAST_DUPLICATE;
+    }
+    memcpy(&assembler->body[index * SVC_BROADCAST_PAYLOAD_SIZE], &data[SVC_BROADCAST_HEADER_SIZE], payloadLength);
+    assembler->received |= bit;
+    assembler->fragments++;
+    if (last) {
+        assembler->length = (uint16_t) (index * SVC_BROADCAST_PAYLOAD_SIZE + payloadLength);
+    }
+
+    const uint64_t all = (1ULL << count) - 1;
+    if (assembler->received != all) {
+        return SVC_BROADCAST_ADDED;
+    }
+
+    // Every fragment passed its own CRC, a mismatch here means a sender reused a sequence number for another body
+    if (svcBroadcastBodyCrc(assembler->body, assembler->length) != id.crc) {
+        assembler->received = 0;
+        assembler->corrupted++;
+        return SVC_BROADCAST_CORRUPTED;
+    }
+    assembler->completed = id;
+    assembler->hasCompleted = true;
+    assembler->bodies++;
+    return SVC_BROADCAST_COMPLETE;
+}
+
+void svcBroadcastForget(svcBroadcastAssembler_t *assembler) {
+    assembler->hasCompleted = false;
+    assembler->received = 0;
+    assembler->length = 0;
+}
+
+const char *svcBroadcastStatusToString(svcBroadcastStatus_t status) {
+    if (status >= SVC_BROADCAST_STATUS_COUNT) {
+        return "unknown";
+    }
+    return statusNames[status];
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+uint16_t crc16(const uint8_t *data, size_t length) {
+    uint16_t crc = CRC_INITIAL_VALUE;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t) data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = crc & 0x8000 ? (uint16_t) ((crc << 1) ^ CRC_POLYNOMIAL) : (uint16_t) (crc << 1);
+        }
+    }
+    return crc;
+}
+
+uint16_t readLittleEndian16(const uint8_t *data) {
+    return data[0] | (uint16_t) data[1] << 8;
+}
+
+void writeLittleEndian16(uint8_t *data, uint16_t value) {
+    data[0] = value & 0xFF;
+    data[1] = value >> 8;
+}
+
+bool sameBody(svcBroadcastBodyId_t a, svcBroadcastBodyId_t b) {
+    return a.sequence == b.sequence && a.crc == b.crc;
+}
@@ -0,0 +1,148 @@
+/*===========================================================================*/
+/// \file svc_broadcast.h
+///
+/// \brief
+///    Fragmentation of a timetable body into advertising packets and its reassembly
+///
+/// \details
+///     The body (the BLE packets back to back, as in the Wi-Fi sync) is cut into fragments small enough for the
+///     manufacturer data of a legacy advertisement. Every fragment carries the sequence number the sender gave the
+///     body, the CRC of the whole body, its index and the fragment count, and a CRC of its own bytes. A sender moves to
+///     the next sequence number for every new timetable, so two bodies sharing a CRC are still told apart, and a
+///     completed body is checked against its CRC before it is accepted. Fragments are taken in any order and any
+///     number of times, a lost one simply arrives on a later turn of the sender. Only plain C++ is used so the
+///     assembler can be driven on a host with dropped, duplicated and corrupted fragments.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_BROADCAST_H
+#define SVC_BROADCAST_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+// Bluetooth SIG identifier reserved for tests, the first two bytes of every fragment
+#define SVC_BROADCAST_COMPANY_ID 0xFFFF
+// Follows the company id, tells the fragments from the other devices advertising with the test identifier
+#define SVC_BROADCAST_MAGIC 0xA7
+#define SVC_BROADCAST_VERSION 2
+
+// Company id, magic, version, sequence, body CRC, index, count
+#define SVC_BROADCAST_HEADER_SIZE 10
+#define SVC_BROADCAST_CRC_SIZE 2
+// 31 bytes of advertising data less the flags (3) and the manufacturer data header (2)
+#define SVC_BROADCAST_FRAGMENT_SIZE 26
+#define SVC_BROADCAST_PAYLOAD_SIZE (SVC_BROADCAST_FRAGMENT_SIZE - SVC_BROADCAST_HEADER_SIZE - SVC_BROADCAST_CRC_SIZE)
+
+// Tracked in a 64 bit mask, a month of packets (468 bytes) takes 34
+#define SVC_BROADCAST_MAX_FRAGMENTS 40
+#define SVC_BROADCAST_MAX_BODY_SIZE (SVC_BROADCAST_MAX_FRAGMENTS * SVC_BROADCAST_PAYLOAD_SIZE)
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    SVC_BROADCAST_ADDED,     // New fragment of the body being assembled
+    SVC_BROADCAST_COMPLETE,  // Last missing fragment, the body is ready
+    SVC_BROADCAST_DUPLICATE, // Fragment already received, or body already completed
+    SVC_BROADCAST_FOREIGN,   // Not a fragment: other company id, magic or version
+    SVC_BROADCAST_CORRUPTED, // Fragment or body CRC mismatch, malformed header
+    SVC_BROADCAST_STATUS_COUNT
+} svcBroadcastStatus_t;
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/// A body is known by the sequence number of its sender and its CRC
+typedef struct {
+    uint16_t sequence;
+    uint16_t crc;
+} svcBroadcastBodyId_t;
+
+typedef struct {
+    svcBroadcastBodyId_t id;        // Body being assembled
+    uint8_t count;                  // Fragments of that body, 0 before the first fragment
+    uint64_t received;              // One bit per fragment index
+    uint16_t length;                // Body size, known once the last fragment arrived
+    svcBroadcastBodyId_t completed; // Last completed body
+    bool hasCompleted;
+    uint8_t body[SVC_BROADCAST_MAX_BODY_SIZE];
+
+    uint32_t fragments; // Counters since the assembler was reset
+    uint32_t duplicates;
+    uint32_t corrupted;
+    uint32_t bodies;
+} svcBroadcastAssembler_t;
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Get the CRC of a body, carried by its fragments
+/// \param body The body
+/// \param length Bytes in the body
+/// \return The CRC
+uint16_t svcBroadcastBodyCrc(const uint8_t *body, size_t length);
+
+/// \brief Get the number of fragments of a body
+/// \param length Bytes in the body
+/// \return The number of fragments, 0 if the body is empty or too large
+uint8_t svcBroadcastFragmentCount(size_t length);
+
+/// \brief Build one fragment of a body
+/// \param body The body
+/// \param length Bytes in the body
+/// \param id Sequence number the sender gave the body and its CRC, from svcBroadcastBodyCrc()
+/// \param index Fragment to build, below svcBroadcastFragmentCount()
+/// \param fragment Filled with up to SVC_BROADCAST_FRAGMENT_SIZE bytes
+/// \return The size of the fragment, 0 if the index is out of range
+size_t svcBroadcastEncode(const uint8_t *body, size_t length, svcBroadcastBodyId_t id, uint8_t index,
+                          uint8_t *fragment);
+
+/// \brief Reset an assembler, forgetting the completed body and the counters
+/// \param assembler The assembler
+void svcBroadcastReset(svcBroadcastAssembler_t *assembler);
+
+/// \brief Add a received fragment
+/// \param assembler The assembler
+/// \param data The manufacturer data of the advertisement
+/// \param length Bytes in the data
+/// \return SVC_BROADCAST_COMPLETE once the body can be read from the assembler, until a newer body starts
+svcBroadcastStatus_t svcBroadcastFeed(svcBroadcastAssembler_t *assembler, const uint8_t *data, size_t length);
+
+/// \brief Forget the body just completed, so that its fragments are assembled again on the next round
+/// \details For a body the caller could not take, the counters are kept
+/// \param assembler The assembler
+void svcBroadcastForget(svcBroadcastAssembler_t *assembler);
+
+/// \brief Get the printable name of a status
+/// \param status The status to convert
+/// \return The name of the status
+const char *svcBroadcastStatusToString(svcBroadcastStatus_t status);
+
+#endif // SVC_BROADCAST_H
@@ -50,6 +50,7 @@
 static SimpleCLI *cli = nullptr;
 static modCliCmdHelpInfo_t *cmdHelpData = nullptr;
 static uint32_t cmdHelpSize = 0;
+static Print *out = nullptr;
 
 /*=============================================================================
                                 Private Constants
@@ -96,10 +97,18 @@ void svcCliAddCmdHelp(const char *name, const char *description) {
             .description = description
         };
     } else {
-        Serial.println("[ERROR] : No more space for help data");
+        svcCliOut()->println("[ERROR] : No more space for help data");
     }
 }
 
+Print *svcCliOut() {
+    return out != nullptr ? out : &Serial;
+}
+
+void svcCliSetOut(Print *sessionOut) {
+    out = sessionOut;
+}
+
 /*=============================================================================
                                 Private Functions
 =============================================================================*/
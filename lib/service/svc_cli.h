@@ -58,4 +58,12 @@ SimpleCLI *svcCliGetCli0();
 
 void svcCliAddCmdHelp(const char *name, const char *description);
 
+/// \brief Get the output of the command being run, the session that typed it
+/// \return The output, the serial port outside of a command
+Print *svcCliOut();
+
+/// \brief Send the output of the next commands to a session, called by the CLI task only
+/// \param out The session output, nullptr to go back to the serial port
+void svcCliSetOut(Print *out);
+
 #endif //SVC_CLI_H
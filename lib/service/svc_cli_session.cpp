@@ -0,0 +1,241 @@
+/*===========================================================================*/
+/// \file svc_cli_session.cpp
+///
+/// \brief
+///    Line editing and output buffering of one CLI session
+///
+/// \details
+///    Keys understood while typing a line:
+///    CR, LF or CR LF - End of the line, an empty line only asks for a new prompt
+///    Backspace, DEL - Erase the last character
+///    ESC [ ... final byte - Cursor keys and other control sequences, ignored
+///    Anything else is taken as is. A line longer than the buffer is discarded once it ends.
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_cli_session.h"
+#include <string.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define KEY_BACKSPACE '\b'
+#define KEY_ESCAPE 27
+#define KEY_DELETE 127
+
+// Final byte of a control sequence
+#define ESCAPE_FINAL_FIRST 0x40
+#define ESCAPE_FINAL_LAST 0x7E
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static bool processKey(svcCliSession_t *session, uint8_t key);
+
+static bool endLine(svcCliSession_t *session);
+
+static void resetLine(svcCliSession_t *session);
+
+static void echo(svcCliSession_t *session, const char *text);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const char LINE_TOO_LONG[] = "\r\nLine too long, discarded";
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+void svcCliSessionInit(svcCliSession_t *session, CliTransport *transport, uint8_t *output, size_t size, bool echo) {
+    memset(session, 0, sizeof(*session));
+    session->transport = transport;
+    session->echo = echo;
+    session->output = output;
+    session->outputSize = size;
+}
+
+svcCliSessionStatus_t svcCliSessionPoll(svcCliSession_t *session) {
+    const bool connected = session->transport->isConnected();
+    if (connected != session->connected) {
+        // Neither the half typed line nor the pending output belong to the next client
+        session->connected = connected;
+        session->outputTail = 0;
+        session->outputCount = 0;
+        resetLine(session);
+        if (connected) {
+            return SVC_CLI_SESSION_ATTACHED;
+        }
+    }
+    if (!connected) {
+        return SVC_CLI_SESSION_IDLE;
+    }
+    if (session->lineReady) {
+        return SVC_CLI_SESSION_LINE;
+    }
+
+    // One byte at a time, the bytes after the end of the line stay in the transport for the next line
+    for (int i = 0; i < SVC_CLI_SESSION_POLL_BUDGET; i++) {
+        uint8_t key;
+        if (session->transport->read(&key, 1) == 0) {
+            break;
+        }
+        if (processKey(session, key)) {
+            return SVC_CLI_SESSION_LINE;
+        }
+    }
+    return SVC_CLI_SESSION_IDLE;
+}
+
+void svcCliSessionLineDone(svcCliSession_t *session) {
+    resetLine(session);
+}
+
+size_t svcCliSessionWrite(svcCliSession_t *session, const uint8_t *data, size_t length) {
+    if (!session->connected) {
+        return 0;
+    }
+
+    size_t queued = 0;
+    while (queued < length) {
+        if (session->outputCount == session->outputSize) {
+            // Whatever the link takes right now makes room, the rest is dropped instead of waiting for the client
+            svcCliSessionPump(session);
+            if (session->outputCount == session->outputSize) {
+                break;
+            }
+        }
+        const size_t head = (session->outputTail + session->outputCount) % session->outputSize;
+        size_t chunk = session->outputSize - session->outputCount;
+        if (chunk > session->outputSize - head) {
+            chunk = session->outputSize - head;
+        }
+        if (chunk > length - queued) {
+            chunk = length - queued;
+        }
+        memcpy(&session->output[head], &data[queued], chunk);
+        session->outputCount += chunk;
+        queued += chunk;
+    }
+    session->dropped += length - queued;
+    return queued;
+}
+
+bool svcCliSessionPump(svcCliSession_t *session) {
+    while (session->outputCount > 0) {
+        size_t chunk = session->outputSize - session->outputTail;
+        if (chunk > session->outputCount) {
+            chunk = session->outputCount;
+        }
+        const size_t sent = session->transport->write(&session->output[session->outputTail], chunk);
+        session->outputTail = (session->outputTail + sent) % session->outputSize;
+        session->outputCount -= sent;
+        session->bytesOut += sent;
+        if (sent < chunk) {
+            break;
+        }
+    }
+    return session->outputCount == 0;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+bool processKey(svcCliSession_t *session, uint8_t key) {
+    const bool afterCr = session->afterCr;
+    session->afterCr = key == '\r';
+
+    if (session->escape == 1) {
+        // ESC followed by anything but [ is a two byte sequence
+        session->escape = key == '[' ? 2 : 0;
+        return false;
+    }
+    if (session->escape == 2) {
+        if (key >= ESCAPE_FINAL_FIRST && key <= ESCAPE_FINAL_LAST) {
+            session->escape = 0;
+        }
+        return false;
+    }
+    if (key == KEY_ESCAPE) {
+        session->escape = 1;
+        return false;
+    }
+
+    if (key == '\n' && afterCr) {
+        return false;
+    }
+    if (key == '\r' || key == '\n') {
+        return endLine(session);
+    }
+    if (key == KEY_BACKSPACE || key == KEY_DELETE) {
+        if (session->lineLength > 0 && !session->overflow) {
+            session->lineLength--;
+            echo(session, "\b \b");
+        }
+        return false;
+    }
+    if (session->overflow) {
+        return false;
+    }
+    if (session->lineLength >= SVC_CLI_SESSION_LINE_SIZE - 1) {
+        session->overflow = true;
+        return false;
+    }
+
+    session->line[session->lineLength++] = (char) key;
+    const char text[2] = {(char) key, '\0'};
+    echo(session, text);
+    return false;
+}
+
+bool endLine(svcCliSession_t *session) {
+    if (session->overflow) {
+        svcCliSessionWrite(session, (const uint8_t *) LINE_TOO_LONG, sizeof(LINE_TOO_LONG) - 1);
+        session->lineLength = 0;
+        session->overflow = false;
+    }
+    session->line[session->lineLength] = '\0';
+    session->lineReady = true;
+    session->lines++;
+    return true;
+}
+
+void resetLine(svcCliSession_t *session) {
+    session->lineLength = 0;
+    session->lineReady = false;
+    session->overflow = false;
+    session->escape = 0;
+}
+
+void echo(svcCliSession_t *session, const char *text) {
+    if (session->echo) {
+        svcCliSessionWrite(session, (const uint8_t *) text, strlen(text));
+    }
+}
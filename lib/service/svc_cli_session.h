@@ -0,0 +1,120 @@
+/*===========================================================================*/
+/// \file svc_cli_session.h
+///
+/// \brief
+///    Line editing and output buffering of one CLI session
+///
+/// \details
+///     A session reads its transport byte by byte into its own line buffer, echoes and edits the line if asked to,
+///     and hands complete lines to the caller. Its output goes to a ring that is drained as fast as the transport
+///     takes it, a full ring drops the rest of the output and counts it, so a client that stops reading never blocks
+///     the task serving the other sessions. Only plain C++ is used so the sessions can be driven on a host, over a
+///     pty for instance.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_CLI_SESSION_H
+#define SVC_CLI_SESSION_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <svc_cli_transport.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+// Longest command line, terminator included
+#define SVC_CLI_SESSION_LINE_SIZE 128
+// Bytes read from the transport by one poll, the other sessions are served in between
+#define SVC_CLI_SESSION_POLL_BUDGET 64
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    SVC_CLI_SESSION_IDLE,     // Nothing to do
+    SVC_CLI_SESSION_ATTACHED, // A client attached to the transport, it is waiting for a prompt
+    SVC_CLI_SESSION_LINE      // A line is ready, until svcCliSessionLineDone()
+} svcCliSessionStatus_t;
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    CliTransport *transport;
+    bool echo;
+    bool connected;
+
+    // Line being typed, NUL terminated once complete
+    char line[SVC_CLI_SESSION_LINE_SIZE];
+    size_t lineLength;
+    bool lineReady;
+    bool overflow;    // The line outgrew the buffer, it is discarded at its end
+    bool afterCr;     // An LF right after a CR ends no line
+    uint8_t escape;   // Bytes of the escape sequence being skipped
+
+    // Output ring
+    uint8_t *output;
+    size_t outputSize;
+    size_t outputTail;
+    size_t outputCount;
+
+    uint32_t lines;   // Counters since the session started
+    uint32_t bytesOut;
+    uint32_t dropped;
+} svcCliSession_t;
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Start a session over a transport
+/// \param session The session state
+/// \param transport The byte stream, valid for the lifetime of the session
+/// \param output Buffer of the output ring, valid for the lifetime of the session
+/// \param size Bytes in the output buffer
+/// \param echo Echo the typed characters back to the client
+void svcCliSessionInit(svcCliSession_t *session, CliTransport *transport, uint8_t *output, size_t size, bool echo);
+
+/// \brief Read what the transport received, without waiting
+/// \param session The session state
+/// \return SVC_CLI_SESSION_LINE while a complete line is in session->line, SVC_CLI_SESSION_ATTACHED once per client
+svcCliSessionStatus_t svcCliSessionPoll(svcCliSession_t *session);
+
+/// \brief Release the line returned by svcCliSessionPoll() and start the next one
+/// \param session The session state
+void svcCliSessionLineDone(svcCliSession_t *session);
+
+/// \brief Queue output for the client, without waiting
+/// \param session The session state
+/// \param data The bytes to send
+/// \param length Number of bytes
+/// \return Bytes queued, the others were dropped because the ring is full or no client is attached
+size_t svcCliSessionWrite(svcCliSession_t *session, const uint8_t *data, size_t length);
+
+/// \brief Hand the queued output to the transport, as much as it takes without waiting
+/// \param session The session state
+/// \return true once the ring is empty, false otherwise
+bool svcCliSessionPump(svcCliSession_t *session);
+
+#endif // SVC_CLI_SESSION_H
@@ -0,0 +1,78 @@
+/*===========================================================================*/
+/// \file svc_cli_transport.h
+///
+/// \brief
+///    Byte stream carrying a CLI session
+///
+/// \details
+///     The sessions only see this interface, the same line editing and output buffering runs over the UART,
+///     Bluetooth Classic SPP, the BLE UART service and, on a host, a pty. Neither call may block: a link that cannot
+///     take more bytes says so and the session keeps them for later.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_CLI_TRANSPORT_H
+#define SVC_CLI_TRANSPORT_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+class CliTransport {
+public:
+    virtual ~CliTransport() = default;
+
+    /// \brief Name shown in the session list
+    virtual const char *name() const = 0;
+
+    /// \brief true while a client is attached, the output of a detached session is discarded
+    virtual bool isConnected() const = 0;
+
+    /// \brief Copy the received bytes without waiting
+    /// \return Bytes copied, 0 when nothing was received
+    virtual size_t read(uint8_t *data, size_t size) = 0;
+
+    /// \brief Queue bytes for sending without waiting
+    /// \return Bytes taken, less than length when the link is busy
+    virtual size_t write(const uint8_t *data, size_t length) = 0;
+};
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+#endif // SVC_CLI_TRANSPORT_H
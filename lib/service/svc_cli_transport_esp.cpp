@@ -0,0 +1,173 @@
+/*===========================================================================*/
+/// \file svc_cli_transport_esp.cpp
+///
+/// \brief
+///    CLI transports of the ESP32: UART, Bluetooth Classic SPP and the BLE UART service
+///
+/// \details
+///    None of the writes waits for the client: the UART takes what fits in its driver buffer, SPP a bounded chunk
+///    for its queue and nothing while the link is congested, BLE a few notifications. The session keeps the rest for
+///    its next pump.
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_cli_transport_esp.h"
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+const char *UartCliTransport::name() const {
+    return "uart";
+}
+
+bool UartCliTransport::isConnected() const {
+    return true;
+}
+
+size_t UartCliTransport::read(uint8_t *data, size_t size) {
+    size_t length = 0;
+    while (length < size && Serial.available() > 0) {
+        data[length++] = (uint8_t) Serial.read();
+    }
+    return length;
+}
+
+size_t UartCliTransport::write(const uint8_t *data, size_t length) {
+    const int room = Serial.availableForWrite();
+    if (room <= 0) {
+        return 0;
+    }
+    return Serial.write(data, length < (size_t) room ? length : (size_t) room);
+}
+
+#ifdef SVC_CLI_SPP
+std::atomic<bool> SppCliTransport::congested(false);
+
+bool SppCliTransport::begin(const char *deviceName) {
+    port.register_callback(onSppEvent);
+    started = port.begin(deviceName);
+    return started;
+}
+
+const char *SppCliTransport::name() const {
+    return "spp";
+}
+
+bool SppCliTransport::isConnected() const {
+    return started && port.hasClient();
+}
+
+size_t SppCliTransport::read(uint8_t *data, size_t size) {
+    size_t length = 0;
+    while (length < size && port.available() > 0) {
+        data[length++] = (uint8_t) port.read();
+    }
+    return length;
+}
+
+size_t SppCliTransport::write(const uint8_t *data, size_t length) {
+    // BluetoothSerial waits for room in its queue, which does not drain while the link is congested
+    if (congested.load(std::memory_order_acquire)) {
+        return 0;
+    }
+    return port.write(data, length < SVC_CLI_SPP_CHUNK_SIZE ? length : SVC_CLI_SPP_CHUNK_SIZE);
+}
+#endif
+
+bool BleUartCliTransport::begin(BleTransport *bleTransport) {
+    received = xStreamBufferCreate(SVC_CLI_BLE_UART_RX_SIZE, 1);
+    if (received == nullptr) {
+        return false;
+    }
+    transport = bleTransport;
+    return true;
+}
+
+void BleUartCliTransport::receive(const uint8_t *data, size_t length) {
+    // A client writing faster than the CLI reads loses the end of its line, the stack task never waits
+    if (received != nullptr) {
+        xStreamBufferSend(received, data, length, 0);
+    }
+}
+
+const char *BleUartCliTransport::name() const {
+    return "ble";
+}
+
+bool BleUartCliTransport::isConnected() const {
+    return transport != nullptr && transport->isConnected();
+}
+
+size_t BleUartCliTransport::read(uint8_t *data, size_t size) {
+    return xStreamBufferReceive(received, data, size, 0);
+}
+
+size_t BleUartCliTransport::write(const uint8_t *data, size_t length) {
+    size_t sent = 0;
+    for (int i = 0; i < SVC_CLI_BLE_UART_CHUNKS_PER_WRITE && sent < length; i++) {
+        const size_t chunk = length - sent < SVC_CLI_BLE_UART_CHUNK_SIZE ? length - sent : SVC_CLI_BLE_UART_CHUNK_SIZE;
+        transport->setValue(SVC_BLE_CHAR_UART_TX, &data[sent], chunk);
+        transport->notify(SVC_BLE_CHAR_UART_TX);
+        sent += chunk;
+    }
+    return sent;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+#ifdef SVC_CLI_SPP
+void SppCliTransport::onSppEvent(esp_spp_cb_event_t event, esp_spp_cb_param_t *param) {
+    switch (event) {
+        case ESP_SPP_CONG_EVT:
+            congested.store(param->cong.cong, std::memory_order_release);
+            break;
+        case ESP_SPP_WRITE_EVT:
+            congested.store(param->write.cong, std::memory_order_release);
+            break;
+        case ESP_SPP_SRV_OPEN_EVT:
+        case ESP_SPP_CLOSE_EVT:
+            congested.store(false, std::memory_order_release);
+            break;
+        default:
+            break;
+    }
+}
+#endif
@@ -0,0 +1,143 @@
+/*===========================================================================*/
+/// \file svc_cli_transport_esp.h
+///
+/// \brief
+///    CLI transports of the ESP32: UART, Bluetooth Classic SPP and the BLE UART service
+///
+/// \details
+///     The UART is always attached. SPP needs the Bluedroid host and is only built with SVC_CLI_SPP. The BLE UART
+///     service is the Nordic UART layout: the client writes the commands to the RX characteristic and subscribes to
+///     the notifications of the TX characteristic, on the same connection as the timetable service.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_CLI_TRANSPORT_ESP_H
+#define SVC_CLI_TRANSPORT_ESP_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/stream_buffer.h>
+#include <svc_ble_transport.h>
+#include <svc_cli_transport.h>
+
+#ifdef SVC_CLI_SPP
+#ifdef SVC_BLE_NIMBLE
+#error "SVC_CLI_SPP needs the Bluedroid host, it cannot be built with SVC_BLE_NIMBLE"
+#endif
+#include <BluetoothSerial.h>
+#endif
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+// Received bytes waiting for the CLI task, a pasted line or two
+#define SVC_CLI_BLE_UART_RX_SIZE 256
+// Notification payload with the default ATT MTU of 23
+#define SVC_CLI_BLE_UART_CHUNK_SIZE 20
+// Notifications sent by one write, the other sessions are served in between
+#define SVC_CLI_BLE_UART_CHUNKS_PER_WRITE 4
+// Bytes handed to the SPP stack by one write, its queue takes them without waiting while the link is not congested
+#define SVC_CLI_SPP_CHUNK_SIZE 128
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+/// The serial port, shared with the log output
+class UartCliTransport : public CliTransport {
+public:
+    const char *name() const override;
+
+    bool isConnected() const override;
+
+    size_t read(uint8_t *data, size_t size) override;
+
+    size_t write(const uint8_t *data, size_t length) override;
+};
+
+#ifdef SVC_CLI_SPP
+/// Bluetooth Classic serial port, started once the BLE stack is up
+class SppCliTransport : public CliTransport {
+public:
+    /// \brief Start the SPP server
+    /// \param deviceName Name shown to the Bluetooth Classic devices
+    /// \return true if the server started, false otherwise
+    bool begin(const char *deviceName);
+
+    const char *name() const override;
+
+    bool isConnected() const override;
+
+    size_t read(uint8_t *data, size_t size) override;
+
+    size_t write(const uint8_t *data, size_t length) override;
+
+private:
+    /// \brief Follow the congestion of the link, called from the Bluetooth stack task
+    static void onSppEvent(esp_spp_cb_event_t event, esp_spp_cb_param_t *param);
+
+    mutable BluetoothSerial port;
+    bool started = false;
+    // Set while the stack cannot send, static like the callback, there is a single SPP port
+    static std::atomic<bool> congested;
+};
+#endif
+
+/// Nordic UART service of the BLE transport
+class BleUartCliTransport : public CliTransport {
+public:
+    /// \brief Attach to a started BLE transport
+    /// \param bleTransport Carries the RX and TX characteristics
+    /// \return true if the receive buffer was allocated, false otherwise
+    bool begin(BleTransport *bleTransport);
+
+    /// \brief Take the bytes written to the RX characteristic, called from the BLE stack task
+    void receive(const uint8_t *data, size_t length);
+
+    const char *name() const override;
+
+    bool isConnected() const override;
+
+    size_t read(uint8_t *data, size_t size) override;
+
+    size_t write(const uint8_t *data, size_t length) override;
+
+private:
+    BleTransport *transport = nullptr;
+    StreamBufferHandle_t received = nullptr;
+};
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+#endif // SVC_CLI_TRANSPORT_ESP_H
@@ -0,0 +1,131 @@
+/*===========================================================================*/
+/// \file svc_cli_transport_fd.cpp
+///
+/// \brief
+///    CLI transport over a POSIX file descriptor, for host builds
+///
+/// \details
+///    A client is attached while the descriptor reports no hang up, for a pty master while the slave side is open.
+///    The slave is put in raw mode so that the line discipline neither echoes the output back as input nor edits the
+///    lines, the session does both.
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef ARDUINO
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_cli_transport_fd.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+bool FdCliTransport::begin(int descriptor) {
+    const int flags = fcntl(descriptor, F_GETFL);
+    if (flags < 0 || fcntl(descriptor, F_SETFL, flags | O_NONBLOCK) < 0) {
+        return false;
+    }
+    fd = descriptor;
+    return true;
+}
+
+bool FdCliTransport::openPty() {
+    const int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0) {
+        return false;
+    }
+    const char *path = ptsname(master);
+    if (grantpt(master) != 0 || unlockpt(master) != 0 || path == nullptr || strlen(path) >= sizeof(slave)) {
+        close(master);
+        return false;
+    }
+    strcpy(slave, path);
+
+    // The settings stay with the pty once the slave is closed again
+    const int slaveFd = open(slave, O_RDWR | O_NOCTTY);
+    struct termios settings;
+    if (slaveFd < 0 || tcgetattr(slaveFd, &settings) != 0) {
+        if (slaveFd >= 0) {
+            close(slaveFd);
+        }
+        close(master);
+        return false;
+    }
+    cfmakeraw(&settings);
+    tcsetattr(slaveFd, TCSANOW, &settings);
+    close(slaveFd);
+    return begin(master);
+}
+
+const char *FdCliTransport::slaveName() const {
+    return slave;
+}
+
+const char *FdCliTransport::name() const {
+    return "pty";
+}
+
+bool FdCliTransport::isConnected() const {
+    if (fd < 0) {
+        return false;
+    }
+    struct pollfd descriptor = {fd, POLLIN, 0};
+    return poll(&descriptor, 1, 0) >= 0 && !(descriptor.revents & (POLLHUP | POLLERR | POLLNVAL));
+}
+
+size_t FdCliTransport::read(uint8_t *data, size_t size) {
+    const ssize_t received = ::read(fd, data, size);
+    // EAGAIN when nothing is waiting, EIO on a pty master with no slave open
+    return received > 0 ? (size_t) received : 0;
+}
+
+size_t FdCliTransport::write(const uint8_t *data, size_t length) {
+    const ssize_t sent = ::write(fd, data, length);
+    return sent > 0 ? (size_t) sent : 0;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+#endif // ARDUINO
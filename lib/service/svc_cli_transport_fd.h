@@ -0,0 +1,89 @@
+/*===========================================================================*/
+/// \file svc_cli_transport_fd.h
+///
+/// \brief
+///    CLI transport over a POSIX file descriptor, for host builds
+///
+/// \details
+///     Runs the sessions on a host against the master side of a pty, so a terminal or a script attached to the slave
+///     side exercises the same line editing and output buffering as the device. The descriptor is switched to
+///     non-blocking mode. Only built when the Arduino core is not.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_CLI_TRANSPORT_FD_H
+#define SVC_CLI_TRANSPORT_FD_H
+
+#ifndef ARDUINO
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <svc_cli_transport.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+class FdCliTransport : public CliTransport {
+public:
+    /// \brief Take over a descriptor
+    /// \param descriptor Open for reading and writing, the pty master for instance
+    /// \return true if the descriptor could be made non-blocking, false otherwise
+    bool begin(int descriptor);
+
+    /// \brief Open a new raw pty and take over its master side
+    /// \return true if the pty was opened, false otherwise
+    bool openPty();
+
+    /// \brief Path of the slave side opened by openPty(), for the client
+    const char *slaveName() const;
+
+    const char *name() const override;
+
+    bool isConnected() const override;
+
+    size_t read(uint8_t *data, size_t size) override;
+
+    size_t write(const uint8_t *data, size_t length) override;
+
+private:
+    int fd = -1;
+    char slave[64] = "";
+};
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+#endif // ARDUINO
+
+#endif // SVC_CLI_TRANSPORT_FD_H
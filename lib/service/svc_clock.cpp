@@ -0,0 +1,398 @@
+/*===========================================================================*/
+/// \file svc_clock.cpp
+///
+/// \brief
+///    Service for keeping the wall clock and converting it to local time
+///
+/// \details
+///    The wall clock is an offset applied to the monotonic timer so reading it never goes through the C library,
+///    the local offset is found by a binary search in the generated transition table
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_clock.h"
+#include <svc_cli.h>
+#include <svc_config.h>
+#include <esp_timer.h>
+#include <sys/time.h>
+
+#if __has_include(<svc_clock_tz.h>)
+#include <svc_clock_tz.h>
+#else
+#define SVC_CLOCK_TZ_NAME "UTC"
+static const svcClockTransition_t svcClockTzTransitions[] = {
+    {0UL, 0},
+};
+#endif
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SVC_CLOCK_TRANSITION_COUNT (sizeof(svcClockTzTransitions) / sizeof(svcClockTzTransitions[0]))
+// Longest warped time from the anchor, leaves room in int64_t for the anchor and the drift correction
+#define SVC_CLOCK_MAX_ELAPSED_US (INT64_MAX / 4)
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static int64_t daysFromCivil(int year, int month, int day);
+
+static void civilFromDays(int64_t days, svcClockDateTime_t *dateTime);
+
+static int64_t floorDiv(int64_t value, int64_t divisor);
+
+static int64_t nowUs();
+
+static int64_t utcAt(int64_t monoUs);
+
+static void commandClock(cmd *c);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+// The clock runs at warp times the monotonic timer from the anchor, corrected by the drift:
+// utc = anchorUtcUs + elapsed + elapsed * driftPpb / 10^9, elapsed = (mono - anchorMonoUs) * warp
+static int64_t anchorMonoUs = 0;
+static int64_t anchorUtcUs = 0;
+static uint32_t warp = 1;
+static int32_t driftPpb = 0;
+static svcClockSource_t source = SVC_CLOCK_SOURCE_NONE;
+static portMUX_TYPE clockLock = portMUX_INITIALIZER_UNLOCKED;
+
+// Exchange based synchronization, only touched by svcClockSyncSample() and the status readers
+static svcClockSyncStatus_t syncStatus = {0, 0, 0, 0, SVC_CLOCK_DEFAULT_DRIFT_ERROR_PPB, 0, 0};
+static int64_t syncMonoUs = 0;        // Timer at the last applied exchange, 0 if none
+static int64_t burstMonoUs = 0;       // Timer at the last exchange of the current burst
+static int64_t burstElapsedUs = 0;    // Timer since the previous burst, when the current one started
+static int32_t burstDriftPpb = 0;     // Drift before the current burst
+static int64_t burstCorrectionUs = 0; // Offset already removed during the current burst
+static uint32_t burstDelayUs = 0;     // Shortest round trip of the current burst
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const char *const sourceNames[SVC_CLOCK_SOURCE_COUNT] = {
+    "none",
+    "saved",
+    "cli",
+    "ble",
+    "ble-exchange"
+};
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+bool svcClockInit() {
+    timeval tv;
+    gettimeofday(&tv, nullptr);
+    int64_t utcUs = (int64_t) tv.tv_sec * 1000000 + tv.tv_usec;
+
+    // The RTC keeps the time across a reset but not across a power loss
+    const int64_t lastTime = svcConfigGet()->lastTime;
+    const bool restored = tv.tv_sec < lastTime;
+    if (restored) {
+        utcUs = lastTime * 1000000;
+    }
+
+    const int64_t savedDrift = svcConfigGet()->clockDriftPpb;
+    portENTER_CRITICAL(&clockLock);
+    anchorMonoUs = esp_timer_get_time();
+    anchorUtcUs = utcUs;
+    driftPpb = (int32_t) savedDrift;
+    source = restored ? SVC_CLOCK_SOURCE_SAVED : SVC_CLOCK_SOURCE_NONE;
+    portEXIT_CRITICAL(&clockLock);
+    syncStatus.driftPpb = (int32_t) savedDrift;
+
+    svcCliAddCmdHelp("clock", "Show the clock offset, drift and error estimate");
+    svcCliGetCli0()->addCommand("clock", commandClock);
+    return true;
+}
+
+int64_t svcClockNow() {
+    return floorDiv(svcClockNowMs(), 1000);
+}
+
+int64_t svcClockNowMs() {
+    return floorDiv(svcClockNowUs(), 1000);
+}
+
+int64_t svcClockNowUs() {
+    portENTER_CRITICAL(&clockLock);
+    const int64_t utcUs = nowUs();
+    portEXIT_CRITICAL(&clockLock);
+    return utcUs;
+}
+
+void svcClockSet(int64_t utc, svcClockSource_t newSource) {
+    portENTER_CRITICAL(&clockLock);
+    const int64_t monoUs = esp_timer_get_time();
+    // A time in whole seconds cannot refine a clock already within that second, it would only lose the fraction
+    if (floorDiv(utcAt(monoUs), 1000000) != utc || source != SVC_CLOCK_SOURCE_BLE_EXCHANGE) {
+        anchorMonoUs = monoUs;
+        anchorUtcUs = utc * 1000000;
+        source = newSource;
+    }
+    portEXIT_CRITICAL(&clockLock);
+
+    // Keep the C library in step for anything still reading it
+    timeval tv = {(time_t) utc, 0};
+    settimeofday(&tv, nullptr);
+
+    svcConfigSetInt(SVC_CONFIG_LAST_TIME, utc);
+}
+
+bool svcClockSyncSample(int64_t t1, int64_t t2, int64_t t3, int64_t t4) {
+    syncStatus.samples++;
+    // The round trip would be stretched by the warp
+    const int64_t delayUs = (t4 - t1) - (t3 - t2);
+    if (svcClockGetWarp() != 1 || delayUs < 0 || delayUs > SVC_CLOCK_MAX_SYNC_DELAY_US) {
+        return false;
+    }
+    const int64_t offsetUs = ((t2 - t1) + (t3 - t4)) / 2;
+
+    const int64_t monoUs = esp_timer_get_time();
+    if (burstMonoUs == 0 || monoUs - burstMonoUs > SVC_CLOCK_SYNC_BURST_US) {
+        burstElapsedUs = syncMonoUs != 0 ? monoUs - syncMonoUs : 0;
+        burstDriftPpb = driftPpb;
+        burstCorrectionUs = 0;
+        burstDelayUs = UINT32_MAX;
+    }
+    burstMonoUs = monoUs;
+    if ((uint32_t) delayUs >= burstDelayUs) {
+        return false;
+    }
+    burstDelayUs = (uint32_t) delayUs;
+
+    // What the clock gained since the previous burst, counting the offsets already removed in this one
+    int32_t newDriftPpb = driftPpb;
+    if (burstElapsedUs >= SVC_CLOCK_DRIFT_MIN_US) {
+        const int64_t gainedUs = offsetUs + burstCorrectionUs;
+        int64_t rateErrorPpb = gainedUs * 1000000000LL / burstElapsedUs;
+        // A short interval gives a noisy rate, it only moves the correction part of the way
+        if (burstElapsedUs < SVC_CLOCK_DRIFT_FULL_US) {
+            rateErrorPpb = rateErrorPpb * burstElapsedUs / SVC_CLOCK_DRIFT_FULL_US;
+        }
+        int64_t drift = burstDriftPpb - rateErrorPpb;
+        drift = drift > SVC_CLOCK_MAX_DRIFT_PPB ? SVC_CLOCK_MAX_DRIFT_PPB : drift;
+        drift = drift < -SVC_CLOCK_MAX_DRIFT_PPB ? -SVC_CLOCK_MAX_DRIFT_PPB : drift;
+        newDriftPpb = (int32_t) drift;
+        syncStatus.driftErrorPpb = (uint32_t) (delayUs / 2 * 1000000000LL / burstElapsedUs);
+    }
+    burstCorrectionUs += offsetUs;
+
+    portENTER_CRITICAL(&clockLock);
+    anchorUtcUs = utcAt(monoUs) - offsetUs;
+    anchorMonoUs = monoUs;
+    driftPpb = newDriftPpb;
+    source = SVC_CLOCK_SOURCE_BLE_EXCHANGE;
+    const int64_t utcUs = anchorUtcUs;
+    portEXIT_CRITICAL(&clockLock);
+    syncMonoUs = monoUs;
+
+    syncStatus.syncedUtc = floorDiv(utcUs, 1000000);
+    syncStatus.offsetUs = offsetUs;
+    syncStatus.delayUs = (uint32_t) delayUs;
+    syncStatus.driftPpb = newDriftPpb;
+
+    timeval tv = {(time_t) syncStatus.syncedUtc, (suseconds_t) (utcUs - syncStatus.syncedUtc * 1000000)};
+    settimeofday(&tv, nullptr);
+    svcConfigSetInt(SVC_CONFIG_LAST_TIME, syncStatus.syncedUtc);
+    svcConfigSetInt(SVC_CONFIG_CLOCK_DRIFT, newDriftPpb);
+    return true;
+}
+
+void svcClockGetSyncStatus(svcClockSyncStatus_t *status) {
+    *status = syncStatus;
+    if (syncMonoUs == 0) {
+        status->errorUs = -1;
+        return;
+    }
+    // Half the round trip at the exchange, then whatever the rate correction still misses
+    const int64_t sinceUs = esp_timer_get_time() - syncMonoUs;
+    status->errorUs = status->delayUs / 2 + sinceUs * status->driftErrorPpb / 1000000000LL;
+}
+
+svcClockSource_t svcClockGetSource() {
+    return source;
+}
+
+const char *svcClockSourceToString(svcClockSource_t clockSource) {
+    if (clockSource >= SVC_CLOCK_SOURCE_COUNT) {
+        return "unknown";
+    }
+    return sourceNames[clockSource];
+}
+
+bool svcClockSetWarp(uint32_t factor) {
+    if (factor == 0 || factor > SVC_CLOCK_MAX_WARP) {
+        return false;
+    }
+
+    // Re-anchored at the current instant so changing the speed never makes the clock jump
+    portENTER_CRITICAL(&clockLock);
+    const int64_t monoUs = esp_timer_get_time();
+    anchorUtcUs = utcAt(monoUs);
+    anchorMonoUs = monoUs;
+    warp = factor;
+    portEXIT_CRITICAL(&clockLock);
+    return true;
+}
+
+uint32_t svcClockGetWarp() {
+    portENTER_CRITICAL(&clockLock);
+    const uint32_t factor = warp;
+    portEXIT_CRITICAL(&clockLock);
+    return factor;
+}
+
+int64_t svcClockRealMsUntil(int64_t utcMs) {
+    portENTER_CRITICAL(&clockLock);
+    const int64_t remainingUs = utcMs * 1000 - nowUs();
+    const uint32_t factor = warp;
+    portEXIT_CRITICAL(&clockLock);
+
+    if (remainingUs <= 0) {
+        return 0;
+    }
+    // Rounded up so a wait never ends just before the instant
+    return (remainingUs + (int64_t) factor * 1000 - 1) / ((int64_t) factor * 1000);
+}
+
+int32_t svcClockUtcOffset(int64_t utc) {
+    // Last transition at or before the instant
+    size_t low = 0;
+    size_t high = SVC_CLOCK_TRANSITION_COUNT;
+    while (high - low > 1) {
+        const size_t middle = (low + high) / 2;
+        if ((int64_t) svcClockTzTransitions[middle].utc <= utc) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return svcClockTzTransitions[low].offset;
+}
+
+int64_t svcClockUtcToLocal(int64_t utc) {
+    return utc + svcClockUtcOffset(utc);
+}
+
+int64_t svcClockLocalToUtc(int64_t local) {
+    // The offset at the guessed instant is right everywhere except inside a gap or an overlap
+    const int64_t guess = local - svcClockUtcOffset(local);
+    return local - svcClockUtcOffset(guess);
+}
+
+int64_t svcClockFromDateTime(const svcClockDateTime_t *dateTime) {
+    return daysFromCivil(dateTime->year, dateTime->month, dateTime->day) * SVC_CLOCK_SECONDS_PER_DAY +
+           dateTime->hour * 3600 + dateTime->minute * 60 + dateTime->second;
+}
+
+void svcClockToDateTime(int64_t local, svcClockDateTime_t *dateTime) {
+    const int64_t days = floorDiv(local, SVC_CLOCK_SECONDS_PER_DAY);
+    const int64_t seconds = local - days * SVC_CLOCK_SECONDS_PER_DAY;
+    civilFromDays(days, dateTime);
+    dateTime->hour = seconds / 3600;
+    dateTime->minute = (seconds / 60) % 60;
+    dateTime->second = seconds % 60;
+}
+
+const char *svcClockZoneName() {
+    return SVC_CLOCK_TZ_NAME;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+// Days since 1970-01-01 in the proleptic Gregorian calendar (H. Hinnant's algorithm)
+int64_t daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    const int64_t era = floorDiv(year, 400);
+    const int64_t yearOfEra = year - era * 400;
+    const int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+void civilFromDays(int64_t days, svcClockDateTime_t *dateTime) {
+    days += 719468;
+    const int64_t era = floorDiv(days, 146097);
+    const int64_t dayOfEra = days - era * 146097;
+    const int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+    const int month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+
+    dateTime->day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    dateTime->month = month;
+    dateTime->year = yearOfEra + era * 400 + (month <= 2);
+}
+
+int64_t floorDiv(int64_t value, int64_t divisor) {
+    const int64_t quotient = value / divisor;
+    return (value % divisor != 0 && (value < 0) != (divisor < 0)) ? quotient - 1 : quotient;
+}
+
+int64_t nowUs() {
+    // Called with clockLock held
+    return utcAt(esp_timer_get_time());
+}
+
+int64_t utcAt(int64_t monoUs) {
+    // Called with clockLock held. At the largest warp the product only overflows after years without re-anchoring,
+    // the clock then stops there instead of wrapping around
+    int64_t monoElapsedUs = monoUs - anchorMonoUs;
+    if (monoElapsedUs > SVC_CLOCK_MAX_ELAPSED_US / warp) {
+        monoElapsedUs = SVC_CLOCK_MAX_ELAPSED_US / warp;
+    } else if (monoElapsedUs < -SVC_CLOCK_MAX_ELAPSED_US / warp) {
+        monoElapsedUs = -SVC_CLOCK_MAX_ELAPSED_US / warp;
+    }
+    const int64_t elapsedUs = monoElapsedUs * warp;
+    // Split so the drift product stays in range however long the clock ran
+    const int64_t correctionUs = elapsedUs / 1000000000LL * driftPpb +
+                                 elapsedUs % 1000000000LL * driftPpb / 1000000000LL;
+    return anchorUtcUs + elapsedUs + correctionUs;
+}
+
+void commandClock(cmd *c) {
+    svcClockSyncStatus_t status;
+    svcClockGetSyncStatus(&status);
+    svcCliOut()->write("\r\n");
+    svcCliOut()->printf("Source %s, drift correction %ld.%03ld ppm (+/- %lu.%03lu ppm)\n",
+                        svcClockSourceToString(source),
+                        (long) (status.driftPpb / 1000), (long) abs(status.driftPpb % 1000),
+                        (unsigned long) (status.driftErrorPpb / 1000), (unsigned long) (status.driftErrorPpb % 1000));
+    if (status.syncedUtc == 0) {
+        svcCliOut()->printf("No time exchange since boot, %lu discarded\n", (unsigned long) status.samples);
+        return;
+    }
+    svcCliOut()->printf("Last exchange %lld s ago: offset %lld us, round trip %lu us, %lu exchanges\n",
+                        (long long) (svcClockNow() - status.syncedUtc), (long long) status.offsetUs,
+                        (unsigned long) status.delayUs, (unsigned long) status.samples);
+    svcCliOut()->printf("Estimated error now +/- %lld ms\n", (long long) (status.errorUs / 1000));
+}
@@ -0,0 +1,191 @@
+/*===========================================================================*/
+/// \file svc_clock.h
+///
+/// \brief
+///    Service for keeping the wall clock and converting it to local time
+///
+/// \details
+///     Wall clock time is kept as a UTC epoch derived from the monotonic timer, local time comes from a table of UTC
+///     offset transitions generated at build time for the configured zone (see scripts/gen_tz_table.py). Every module
+///     reads time through this service, so warping it speeds up the whole firmware for simulations.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_CLOCK_H
+#define SVC_CLOCK_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SVC_CLOCK_SECONDS_PER_DAY 86400
+// A year in about five minutes
+#define SVC_CLOCK_MAX_WARP 100000
+
+// Exchanges with a longer round trip say too little about the offset
+#define SVC_CLOCK_MAX_SYNC_DELAY_US 2000000
+// Exchanges closer than this to each other form a burst, only its shortest round trips are applied
+#define SVC_CLOCK_SYNC_BURST_US 30000000LL
+// The rate is only measured over at least this long, and fully trusted after SVC_CLOCK_DRIFT_FULL_US
+#define SVC_CLOCK_DRIFT_MIN_US 600000000LL
+#define SVC_CLOCK_DRIFT_FULL_US 21600000000LL
+// Rate correction limit, well above the tolerance of the crystal
+#define SVC_CLOCK_MAX_DRIFT_PPB 200000
+// Rate uncertainty assumed before a drift was measured
+#define SVC_CLOCK_DEFAULT_DRIFT_ERROR_PPB 20000
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    SVC_CLOCK_SOURCE_NONE,  // Never set since boot
+    SVC_CLOCK_SOURCE_SAVED, // Last time set before the reboot, only a lower bound
+    SVC_CLOCK_SOURCE_CLI,
+    SVC_CLOCK_SOURCE_BLE,
+    SVC_CLOCK_SOURCE_BLE_EXCHANGE, // Round trip compensated exchange with the phone
+    SVC_CLOCK_SOURCE_COUNT
+} svcClockSource_t;
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    uint32_t utc;   // first UTC second running on this offset
+    int32_t offset; // seconds east of UTC
+} svcClockTransition_t;
+
+typedef struct {
+    int64_t syncedUtc;        // UTC seconds of the last applied exchange, 0 if none since boot
+    int64_t offsetUs;         // Offset removed by that exchange, clock minus reference
+    uint32_t delayUs;         // Round trip of that exchange
+    int32_t driftPpb;         // Rate correction applied to the timer, positive when the crystal runs slow
+    uint32_t driftErrorPpb;   // Uncertainty of the rate correction
+    uint32_t samples;         // Exchanges since boot, applied or not
+    int64_t errorUs;          // Estimated error bound of the clock now
+} svcClockSyncStatus_t;
+
+typedef struct {
+    uint16_t year;
+    uint8_t month;  // 1 - 12
+    uint8_t day;    // 1 - 31
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+} svcClockDateTime_t;
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Initialize the clock from the current system time, or the last time set when the RTC lost it
+/// \return true if the clock was initialized successfully, false otherwise
+bool svcClockInit();
+
+/// \brief Get the current UTC time
+/// \return Seconds since the epoch
+int64_t svcClockNow();
+
+/// \brief Get the current UTC time with millisecond resolution
+/// \return Milliseconds since the epoch
+int64_t svcClockNowMs();
+
+/// \brief Get the current UTC time with microsecond resolution
+/// \return Microseconds since the epoch
+int64_t svcClockNowUs();
+
+/// \brief Set the current UTC time
+/// \param utc Seconds since the epoch
+/// \param source Where the time comes from
+void svcClockSet(int64_t utc, svcClockSource_t source);
+
+/// \brief Correct the clock from a time exchange with a reference clock, NTP style
+/// \details The offset is the mean of the two one-way differences, the round trip bounds its error. Within a burst of
+///          exchanges only one with a shorter round trip than the previous ones is applied. The offset left since
+///          the previous burst gives the rate error of the timer, corrected from then on and kept in the config.
+/// \param t1 Reference time the request was sent, UTC microseconds
+/// \param t2 Clock time the request was received, from svcClockNowUs()
+/// \param t3 Clock time the answer was sent, from svcClockNowUs()
+/// \param t4 Reference time the answer was received, UTC microseconds
+/// \return true if the exchange was applied, false if it was discarded
+bool svcClockSyncSample(int64_t t1, int64_t t2, int64_t t3, int64_t t4);
+
+/// \brief Get the state of the exchange based synchronization
+/// \param status Filled with the state
+void svcClockGetSyncStatus(svcClockSyncStatus_t *status);
+
+/// \brief Get where the current time comes from
+/// \return The source of the last svcClockSet()
+svcClockSource_t svcClockGetSource();
+
+/// \brief Get the printable name of a time source
+/// \param source The source to convert
+/// \return The name of the source
+const char *svcClockSourceToString(svcClockSource_t source);
+
+/// \brief Make the clock run faster than real time, for simulating long periods on the device
+/// \param factor Clock seconds per real second, 1 for real time
+/// \return true if the factor is between 1 and SVC_CLOCK_MAX_WARP, false otherwise
+bool svcClockSetWarp(uint32_t factor);
+
+/// \brief Get the current warp factor
+/// \return Clock seconds per real second
+uint32_t svcClockGetWarp();
+
+/// \brief Get the real time to wait until a clock instant, taking the warp into account
+/// \param utcMs Milliseconds since the epoch
+/// \return Real milliseconds until the instant, 0 if it is already reached
+int64_t svcClockRealMsUntil(int64_t utcMs);
+
+/// \brief Get the UTC offset in effect at a given instant
+/// \param utc Seconds since the epoch
+/// \return Offset in seconds east of UTC
+int32_t svcClockUtcOffset(int64_t utc);
+
+/// \brief Convert a UTC instant to local seconds
+/// \param utc Seconds since the epoch
+/// \return Local seconds since the local epoch
+int64_t svcClockUtcToLocal(int64_t utc);
+
+/// \brief Convert local seconds to a UTC instant
+/// \param local Local seconds since the local epoch
+/// \return Seconds since the epoch, a local time skipped by a transition is moved forward by the gap
+int64_t svcClockLocalToUtc(int64_t local);
+
+/// \brief Build local seconds from a civil date and time
+/// \param dateTime The civil date and time
+/// \return Local seconds since the local epoch
+int64_t svcClockFromDateTime(const svcClockDateTime_t *dateTime);
+
+/// \brief Split local seconds into a civil date and time
+/// \param local Local seconds since the local epoch
+/// \param dateTime Filled with the civil date and time
+void svcClockToDateTime(int64_t local, svcClockDateTime_t *dateTime);
+
+/// \brief Get the name of the configured time zone
+/// \return The IANA name of the zone
+const char *svcClockZoneName();
+
+#endif // SVC_CLOCK_H
@@ -0,0 +1,455 @@
+/*===========================================================================*/
+/// \file svc_config.cpp
+///
+/// \brief
+///    Service for the persistent device configuration
+///
+/// \details
+///    Every setting is one NVS key described by the entry table, a missing or out of range key falls back to its
+///    default. The changed keys are tracked in a mask and written from a one-shot timer restarted by every change.
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_config.h"
+#include <Preferences.h>
+#include <freertos/timers.h>
+#include <svc_cli.h>
+#include <svc_log.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SVC_CONFIG_NAMESPACE "config"
+#define SVC_CONFIG_VERSION_KEY "version"
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+typedef enum {
+    CONFIG_BOOL,
+    CONFIG_U8,
+    CONFIG_I64,
+    CONFIG_STRING,
+    CONFIG_TABLE  // SVC_CONFIG_POWER_TABLE_SIZE uint32_t, min and max apply to each value
+} ConfigType;
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    const char *name; // NVS key and CLI name, at most 15 characters
+    ConfigType type;
+    size_t offset;    // in svcConfig_t
+    int64_t min;      // value, or length for CONFIG_STRING
+    int64_t max;
+    const char *description;
+} ConfigEntry;
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static void migrate(uint16_t version);
+
+static void readKey(svcConfigKey_t key);
+
+static void writeKey(const svcConfig_t *values, svcConfigKey_t key);
+
+static void markChanged(svcConfigKey_t key);
+
+static void commitTimerCallback(TimerHandle_t timer);
+
+static int findKey(const char *name);
+
+static void printKey(svcConfigKey_t key);
+
+static bool parseTable(svcConfigKey_t key, const char *value);
+
+static void commandConfig(cmd *c);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static svcConfig_t config = {"PrayerDisplayer", 0x3C, true, 0, 0, 0, 0, {
+    // Rough ESP32 DevKit figures in uA, measure the actual board and set them with `power current`
+    15000, 1000,        // cpu0 active, idle
+    15000, 1000,        // cpu1 active, idle
+    0, 30000, 40000,    // BLE off, advertising, connected (Bluedroid keeps the receiver on)
+    0, 60000,           // BLE scan off, on
+    0, 110000,          // Wi-Fi off, on
+    0, 15000,           // display off, on
+    0, 150000,          // audio off, playing
+    20000, 800, 10      // awake baseline, light sleep, deep sleep
+}};
+static Preferences store;
+static bool storeOpen = false;
+static uint32_t changedKeys = 0;
+static TimerHandle_t commitTimer = nullptr;
+static portMUX_TYPE configLock = portMUX_INITIALIZER_UNLOCKED;
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const ConfigEntry entries[SVC_CONFIG_KEY_COUNT] = {
+    {"name", CONFIG_STRING, offsetof(svcConfig_t, deviceName), 1, SVC_CONFIG_NAME_SIZE - 1,
+     "BLE device name, at the next boot"},
+    {"display_addr", CONFIG_U8, offsetof(svcConfig_t, displayAddress), 0x08, 0x77,
+     "I2C address of the primary panel, at the next boot"},
+    {"cli_echo", CONFIG_BOOL, offsetof(svcConfig_t, cliEcho), 0, 1, "Echo the typed characters"},
+    {"last_time", CONFIG_I64, offsetof(svcConfig_t, lastTime), 0, INT64_MAX, "Last time set, restored at boot"},
+    {"broadcast", CONFIG_U8, offsetof(svcConfig_t, broadcastMode), 0, 2,
+     "Timetable broadcast: 0 off, 1 listen, 2 lead"},
+    // Same limit as SVC_CLOCK_MAX_DRIFT_PPB
+    {"clock_drift", CONFIG_I64, offsetof(svcConfig_t, clockDriftPpb), -200000, 200000,
+     "Clock rate correction in ppb"},
+    {"display_mode", CONFIG_U8, offsetof(svcConfig_t, displayMode), 0, 1, "Screen: 0 next prayer, 1 rotating pages"},
+    {"power_ua", CONFIG_TABLE, offsetof(svcConfig_t, powerCurrentsUa), 0, 1000000,
+     "Current of each power state in uA, see power"},
+};
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+bool svcConfigInit() {
+    storeOpen = store.begin(SVC_CONFIG_NAMESPACE, false);
+    if (storeOpen) {
+        const uint16_t version = store.getUShort(SVC_CONFIG_VERSION_KEY, 0);
+        if (version < SVC_CONFIG_VERSION) {
+            migrate(version);
+            store.putUShort(SVC_CONFIG_VERSION_KEY, SVC_CONFIG_VERSION);
+        } else if (version > SVC_CONFIG_VERSION) {
+            // Running an older image after a rollback, the keys it does not know are kept for the newer one
+            SVC_LOG_WARNING("Configuration version %u is newer than %u, keeping it", version, SVC_CONFIG_VERSION);
+        }
+
+        for (int key = 0; key < SVC_CONFIG_KEY_COUNT; key++) {
+            readKey((svcConfigKey_t) key);
+        }
+    }
+
+    commitTimer = xTimerCreate("config", pdMS_TO_TICKS(SVC_CONFIG_COMMIT_DELAY_MS), pdFALSE, nullptr,
+                               commitTimerCallback);
+
+    svcCliAddCmdHelp("config", "Show or change the settings [list | get <key> | set <key> <value>]");
+    svcCliGetCli0()->addBoundlessCommand("config", commandConfig);
+    return storeOpen;
+}
+
+const svcConfig_t *svcConfigGet() {
+    return &config;
+}
+
+bool svcConfigSetInt(svcConfigKey_t key, int64_t value) {
+    if (key >= SVC_CONFIG_KEY_COUNT) {
+        return false;
+    }
+    const ConfigEntry &entry = entries[key];
+    if (entry.type == CONFIG_STRING || value < entry.min || value > entry.max) {
+        return false;
+    }
+
+    uint8_t *field = (uint8_t *) &config + entry.offset;
+    bool changed = false;
+    portENTER_CRITICAL(&configLock);
+    switch (entry.type) {
+        case CONFIG_BOOL:
+            changed = *(bool *) field != (value != 0);
+            *(bool *) field = value != 0;
+            break;
+        case CONFIG_U8:
+            changed = *field != (uint8_t) value;
+            *field = (uint8_t) value;
+            break;
+        case CONFIG_I64:
+            changed = *(int64_t *) field != value;
+            *(int64_t *) field = value;
+            break;
+        default:
+            break;
+    }
+    portEXIT_CRITICAL(&configLock);
+
+    if (changed) {
+        markChanged(key);
+    }
+    return true;
+}
+
+bool svcConfigSetString(svcConfigKey_t key, const char *value) {
+    if (key >= SVC_CONFIG_KEY_COUNT) {
+        return false;
+    }
+    const ConfigEntry &entry = entries[key];
+    const size_t length = strlen(value);
+    if (entry.type != CONFIG_STRING || (int64_t) length < entry.min || (int64_t) length > entry.max) {
+        return false;
+    }
+
+    char *field = (char *) &config + entry.offset;
+    portENTER_CRITICAL(&configLock);
+    const bool changed = strcmp(field, value) != 0;
+    memcpy(field, value, length + 1);
+    portEXIT_CRITICAL(&configLock);
+
+    if (changed) {
+        markChanged(key);
+    }
+    return true;
+}
+
+bool svcConfigSetTableEntry(svcConfigKey_t key, size_t index, int64_t value) {
+    if (key >= SVC_CONFIG_KEY_COUNT) {
+        return false;
+    }
+    const ConfigEntry &entry = entries[key];
+    if (entry.type != CONFIG_TABLE || index >= SVC_CONFIG_POWER_TABLE_SIZE || value < entry.min ||
+        value > entry.max) {
+        return false;
+    }
+
+    uint32_t *field = (uint32_t *) ((uint8_t *) &config + entry.offset);
+    portENTER_CRITICAL(&configLock);
+    const bool changed = field[index] != (uint32_t) value;
+    field[index] = (uint32_t) value;
+    portEXIT_CRITICAL(&configLock);
+
+    if (changed) {
+        markChanged(key);
+    }
+    return true;
+}
+
+void svcConfigCommit() {
+    // Written from a copy so the flash access happens outside the lock
+    portENTER_CRITICAL(&configLock);
+    const uint32_t keys = changedKeys;
+    changedKeys = 0;
+    const svcConfig_t values = config;
+    portEXIT_CRITICAL(&configLock);
+
+    if (!storeOpen || keys == 0) {
+        return;
+    }
+    for (int key = 0; key < SVC_CONFIG_KEY_COUNT; key++) {
+        if (keys & (1UL << key)) {
+            writeKey(&values, (svcConfigKey_t) key);
+        }
+    }
+    SVC_LOG_DEBUG("Configuration saved, keys 0x%02lX", (unsigned long) keys);
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+void migrate(uint16_t version) {
+    // Every schema change adds a case converting the store from the previous version and falls through to the next
+    switch (version) {
+        case 0:
+            // Empty store, or written before the configuration existed: the defaults apply
+        default:
+            break;
+    }
+}
+
+void readKey(svcConfigKey_t key) {
+    const ConfigEntry &entry = entries[key];
+    if (!store.isKey(entry.name)) {
+        return;
+    }
+
+    uint8_t *field = (uint8_t *) &config + entry.offset;
+    switch (entry.type) {
+        case CONFIG_BOOL:
+            *(bool *) field = store.getBool(entry.name, *(bool *) field);
+            break;
+        case CONFIG_U8: {
+            const uint8_t value = store.getUChar(entry.name, *field);
+            if (value >= entry.min && value <= entry.max) {
+                *field = value;
+            }
+            break;
+        }
+        case CONFIG_I64: {
+            const int64_t value = store.getLong64(entry.name, *(int64_t *) field);
+            if (value >= entry.min && value <= entry.max) {
+                *(int64_t *) field = value;
+            }
+            break;
+        }
+        case CONFIG_STRING: {
+            char value[SVC_CONFIG_NAME_SIZE];
+            const size_t length = store.getString(entry.name, value, sizeof(value));
+            // The length includes the terminator
+            if (length > (size_t) entry.min && length <= (size_t) entry.max + 1) {
+                memcpy(field, value, length);
+            }
+            break;
+        }
+        case CONFIG_TABLE: {
+            // A table of another size was written by another firmware, the defaults are kept
+            uint32_t values[SVC_CONFIG_POWER_TABLE_SIZE];
+            if (store.getBytesLength(entry.name) != sizeof(values) ||
+                store.getBytes(entry.name, values, sizeof(values)) != sizeof(values)) {
+                break;
+            }
+            for (uint32_t value: values) {
+                if (value < entry.min || value > entry.max) {
+                    return;
+                }
+            }
+            memcpy(field, values, sizeof(values));
+            break;
+        }
+    }
+}
+
+void writeKey(const svcConfig_t *values, svcConfigKey_t key) {
+    const ConfigEntry &entry = entries[key];
+    const uint8_t *field = (const uint8_t *) values + entry.offset;
+    switch (entry.type) {
+        case CONFIG_BOOL:
+            store.putBool(entry.name, *(const bool *) field);
+            break;
+        case CONFIG_U8:
+            store.putUChar(entry.name, *field);
+            break;
+        case CONFIG_I64:
+            store.putLong64(entry.name, *(const int64_t *) field);
+            break;
+        case CONFIG_STRING:
+            store.putString(entry.name, (const char *) field);
+            break;
+        case CONFIG_TABLE:
+            store.putBytes(entry.name, field, SVC_CONFIG_POWER_TABLE_SIZE * sizeof(uint32_t));
+            break;
+    }
+}
+
+void markChanged(svcConfigKey_t key) {
+    portENTER_CRITICAL(&configLock);
+    changedKeys |= 1UL << key;
+    portEXIT_CRITICAL(&configLock);
+
+    // Restarted by every change, so a burst of changes costs one write per key
+    if (commitTimer != nullptr) {
+        xTimerReset(commitTimer, 0);
+    }
+}
+
+void commitTimerCallback(TimerHandle_t timer) {
+    svcConfigCommit();
+}
+
+int findKey(const char *name) {
+    for (int key = 0; key < SVC_CONFIG_KEY_COUNT; key++) {
+        if (strcmp(entries[key].name, name) == 0) {
+            return key;
+        }
+    }
+    return -1;
+}
+
+void printKey(svcConfigKey_t key) {
+    const ConfigEntry &entry = entries[key];
+    const uint8_t *field = (const uint8_t *) &config + entry.offset;
+    svcCliOut()->printf("%-14s ", entry.name);
+    switch (entry.type) {
+        case CONFIG_BOOL:
+            svcCliOut()->printf("%-18s", *(const bool *) field ? "true" : "false");
+            break;
+        case CONFIG_U8:
+            svcCliOut()->printf("0x%02X%14s", *field, "");
+            break;
+        case CONFIG_I64:
+            svcCliOut()->printf("%-18lld", (long long) *(const int64_t *) field);
+            break;
+        case CONFIG_STRING:
+            svcCliOut()->printf("%-18s", (const char *) field);
+            break;
+        case CONFIG_TABLE:
+            for (size_t i = 0; i < SVC_CONFIG_POWER_TABLE_SIZE; i++) {
+                svcCliOut()->printf(i == 0 ? "%lu" : ",%lu", (unsigned long) ((const uint32_t *) field)[i]);
+            }
+            break;
+    }
+    svcCliOut()->printf(" %s\n", entry.description);
+}
+
+void commandConfig(cmd *c) {
+    Command cmd(c);
+    svcCliOut()->write("\r\n");
+    const String action = cmd.countArgs() > 0 ? cmd.getArgument(0).getValue() : "list";
+
+    if (action == "list" && cmd.countArgs() <= 1) {
+        for (int key = 0; key < SVC_CONFIG_KEY_COUNT; key++) {
+            printKey((svcConfigKey_t) key);
+        }
+        return;
+    }
+
+    const int key = cmd.countArgs() > 1 ? findKey(cmd.getArgument(1).getValue().c_str()) : -1;
+    if (action == "get" && cmd.countArgs() == 2 && key >= 0) {
+        printKey((svcConfigKey_t) key);
+        return;
+    }
+    if (action == "set" && cmd.countArgs() == 3 && key >= 0) {
+        const String value = cmd.getArgument(2).getValue();
+        bool valid;
+        if (entries[key].type == CONFIG_STRING) {
+            valid = svcConfigSetString((svcConfigKey_t) key, value.c_str());
+        } else if (entries[key].type == CONFIG_TABLE) {
+            valid = parseTable((svcConfigKey_t) key, value.c_str());
+        } else if (entries[key].type == CONFIG_BOOL) {
+            valid = (value == "true" || value == "false") && svcConfigSetInt((svcConfigKey_t) key, value == "true");
+        } else {
+            // Base 0 takes 0x3D as well as 61
+            char *end;
+            const long long number = strtoll(value.c_str(), &end, 0);
+            valid = *end == '\0' && svcConfigSetInt((svcConfigKey_t) key, number);
+        }
+        if (!valid) {
+            svcCliOut()->printf("Invalid value for %s\n", entries[key].name);
+            return;
+        }
+        printKey((svcConfigKey_t) key);
+        return;
+    }
+    svcCliOut()->println("Usage: config [list | get <key> | set <key> <value>]");
+}
+
+bool parseTable(svcConfigKey_t key, const char *value) {
+    // Comma separated, every value is checked before the first one is applied
+    int64_t values[SVC_CONFIG_POWER_TABLE_SIZE];
+    const char *position = value;
+    for (size_t i = 0; i < SVC_CONFIG_POWER_TABLE_SIZE; i++) {
+        char *end;
+        values[i] = strtoll(position, &end, 0);
+        const char expected = i + 1 < SVC_CONFIG_POWER_TABLE_SIZE ? ',' : '\0';
+        if (end == position || *end != expected || values[i] < entries[key].min || values[i] > entries[key].max) {
+            return false;
+        }
+        position = end + 1;
+    }
+    for (size_t i = 0; i < SVC_CONFIG_POWER_TABLE_SIZE; i++) {
+        svcConfigSetTableEntry(key, i, values[i]);
+    }
+    return true;
+}
@@ -0,0 +1,116 @@
+/*===========================================================================*/
+/// \file svc_config.h
+///
+/// \brief
+///    Service for the persistent device configuration
+///
+/// \details
+///     The configuration is loaded from NVS once at boot into a RAM copy, reading a setting is a plain field access.
+///     Changes update the RAM copy at once and are written to flash together a few seconds after the last one, only
+///     for the keys whose value changed. The store carries a schema version, a store written by an older firmware is
+///     migrated at boot and one written by a newer firmware (after a rollback) keeps its version and unknown keys.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_CONFIG_H
+#define SVC_CONFIG_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SVC_CONFIG_VERSION 1
+// Names up to 29 characters, the longest the scan response can carry
+#define SVC_CONFIG_NAME_SIZE 30
+// Changes within this delay of each other are written in one go
+#define SVC_CONFIG_COMMIT_DELAY_MS 5000
+// One current per svcPowerState_t
+#define SVC_CONFIG_POWER_TABLE_SIZE 18
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    SVC_CONFIG_DEVICE_NAME,
+    SVC_CONFIG_DISPLAY_ADDRESS,
+    SVC_CONFIG_CLI_ECHO,
+    SVC_CONFIG_LAST_TIME,
+    SVC_CONFIG_BROADCAST_MODE,
+    SVC_CONFIG_CLOCK_DRIFT,
+    SVC_CONFIG_DISPLAY_MODE,
+    SVC_CONFIG_POWER_CURRENTS,
+    SVC_CONFIG_KEY_COUNT
+} svcConfigKey_t;
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    char deviceName[SVC_CONFIG_NAME_SIZE]; // BLE name, applied at the next boot
+    uint8_t displayAddress;                // I2C address of the primary panel, applied at the next boot
+    bool cliEcho;                          // echo the characters typed on the CLI
+    int64_t lastTime;                      // UTC seconds of the last time set, restored when the RTC lost the time
+    uint8_t broadcastMode;                 // modBroadcastMode_t, timetable broadcast between displays
+    int64_t clockDriftPpb;                 // rate correction of the clock, measured by the time exchanges
+    uint8_t displayMode;                   // modDisplayMode_t, next prayer only or rotating pages
+    uint32_t powerCurrentsUa[SVC_CONFIG_POWER_TABLE_SIZE]; // Current of each svcPowerState_t, for the estimate
+} svcConfig_t;
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Load the configuration, migrate an older store and register the CLI commands
+/// \return true if the store was opened, false if the defaults are used and nothing will be saved
+bool svcConfigInit();
+
+/// \brief Get the RAM copy of the configuration
+/// \return The configuration, valid for the lifetime of the program
+const svcConfig_t *svcConfigGet();
+
+/// \brief Change an integer or boolean setting
+/// \param key The setting
+/// \param value The new value
+/// \return true if the value is valid for the setting, false otherwise
+bool svcConfigSetInt(svcConfigKey_t key, int64_t value);
+
+/// \brief Change a text setting
+/// \param key The setting
+/// \param value The new value
+/// \return true if the value is valid for the setting, false otherwise
+bool svcConfigSetString(svcConfigKey_t key, const char *value);
+
+/// \brief Change one value of a table setting
+/// \param key The setting
+/// \param index Position in the table
+/// \param value The new value
+/// \return true if the index and the value are valid for the setting, false otherwise
+bool svcConfigSetTableEntry(svcConfigKey_t key, size_t index, int64_t value);
+
+/// \brief Write the pending changes now instead of after SVC_CONFIG_COMMIT_DELAY_MS
+void svcConfigCommit();
+
+#endif // SVC_CONFIG_H
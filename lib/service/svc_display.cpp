@@ -17,16 +17,44 @@
 =============================================================================*/
 
 #include "svc_display.h"
-#include "Adafruit_SSD1306.h"
+#include "svc_display_ssd1306.h"
+#include "Adafruit_GFX.h"
 #include "Fonts/FreeSerif9pt7b.h"
 #include <Wire.h>
+#include <svc_clock.h>
+#include <svc_config.h>
+#include <svc_glyph.h>
+#include <svc_power.h>
+#include <svc_trace.h>
 
 /*=============================================================================
                                      Defines
 =============================================================================*/
 
-#define SCREEN_WIDTH 128 // OLED display width, in pixels
-#define SCREEN_HEIGHT 64 // OLED display height, in pixels
+#define SCREEN_WIDTH SVC_DISPLAY_WIDTH // OLED display width, in pixels
+#define SCREEN_HEIGHT SVC_DISPLAY_HEIGHT // OLED display height, in pixels
+
+#define SVC_DISPLAY_I2C_CLOCK 400000
+
+#define DISPLAY_BLACK 0
+#define DISPLAY_WHITE 1
+#define DISPLAY_INVERSE 2
+
+// Hour and minute digits around the colon
+#define DISPLAY_TIME_GLYPHS 5
+// The atlas glyphs are cropped to their ink, space the digits apart
+#define DISPLAY_GLYPH_SPACING 2
+
+// Pages use the built-in 6x8 font, fixed width so the dynamic fields line up
+#define PAGE_LINE_HEIGHT 8
+#define PAGE_CHAR_WIDTH 6
+// Today page: date line then a row per prayer
+#define PAGE_TODAY_ROW_HEIGHT 10
+#define PAGE_TODAY_FIRST_ROW 13
+#define PAGE_TODAY_TIME_X 80
+// Status page: labels on the left, values after them
+#define PAGE_STATUS_ROW_HEIGHT 13
+#define PAGE_STATUS_VALUE_X 48
 
 /*=============================================================================
                                      Macros
@@ -40,17 +68,101 @@
                                     Structures
 =============================================================================*/
 
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+/// GFX canvas drawing straight into the SSD1306 page layout, shared by every panel
+class DisplayFrame : public Adafruit_GFX {
+public:
+    explicit DisplayFrame(uint8_t *buffer) : Adafruit_GFX(SCREEN_WIDTH, SCREEN_HEIGHT), buffer(buffer) {
+        setTextColor(DISPLAY_WHITE);
+        setFont(&FreeSerif9pt7b);
+    }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+        if (x < 0 || x >= SCREEN_WIDTH || y < 0 || y >= SCREEN_HEIGHT) {
+            return;
+        }
+
+        uint8_t *pixelByte = &buffer[x + (y / 8) * SCREEN_WIDTH];
+        const uint8_t pixelBit = 1 << (y & 7);
+        switch (color) {
+            case DISPLAY_WHITE:
+                *pixelByte |= pixelBit;
+                break;
+            case DISPLAY_BLACK:
+                *pixelByte &= ~pixelBit;
+                break;
+            case DISPLAY_INVERSE:
+                *pixelByte ^= pixelBit;
+                break;
+            default:
+                break;
+        }
+    }
+
+    void clearDisplay() {
+        memset(buffer, 0, SVC_DISPLAY_FRAME_SIZE);
+    }
+
+    uint8_t *const buffer;
+};
+
 /*=============================================================================
                             Private Function Prototypes
 =============================================================================*/
 
 String svcPrayerNameToString(PrayerName prayerName);
 
+static bool svcDisplayFlush(const uint8_t *frame);
+
+static void renderNextPrayer(DisplayFrame *frame, Prayer nextPrayer);
+
+static void renderNextPrayerArabic(DisplayFrame *frame, Prayer nextPrayer);
+
+static void drawGlyphsCentered(DisplayFrame *frame, const svcGlyph_t *glyphs, uint8_t count, int16_t y);
+
+static void drawGlyphSpan(int16_t x, int16_t y, int16_t length, void *context);
+
+static void renderPageStatic(DisplayFrame *frame, svcDisplayPage_t page, const svcDisplayPageData_t *data);
+
+static void renderPageDynamic(DisplayFrame *frame, svcDisplayPage_t page, const svcDisplayPageData_t *data);
+
+static bool isPageStale(svcDisplayPage_t page, const svcDisplayPageData_t *cached, const svcDisplayPageData_t *data);
+
+static bool isSamePrayer(const Prayer *a, const Prayer *b);
+
+static int8_t todayRowOf(const PrayerTimings *today, const Prayer *prayer);
+
+static void drawText(DisplayFrame *frame, const char *text, int16_t x, int16_t y, uint8_t size);
+
+static void drawTextCentered(DisplayFrame *frame, const char *text, int16_t y, uint8_t size);
+
 /*=============================================================================
                                 Private Variables
 =============================================================================*/
 
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+static uint8_t frameBuffer[SVC_DISPLAY_FRAME_SIZE];
+static DisplayFrame display(frameBuffer);
+
+// Screen rendered ahead of its deadline, copied to the frame buffer once it is on the panels
+static uint8_t backBuffer[SVC_DISPLAY_FRAME_SIZE];
+static DisplayFrame backDisplay(backBuffer);
+static bool backBufferReady = false;
+
+// Static part of every page, rendered again only when what it shows changed
+static uint8_t pageCaches[SVC_DISPLAY_PAGE_COUNT][SVC_DISPLAY_FRAME_SIZE];
+static svcDisplayPageData_t pageCacheData[SVC_DISPLAY_PAGE_COUNT];
+static bool pageCacheValid[SVC_DISPLAY_PAGE_COUNT];
+static svcDisplayPageStats_t pageStats;
+
+// Frame flushed last, only the pages that differ from it are sent besides those a panel missed
+static uint8_t shownFrame[SVC_DISPLAY_FRAME_SIZE];
+
+static DisplaySink *sinks[SVC_DISPLAY_MAX_SINKS];
+static uint8_t sinkCount = 0;
+static svcDisplayFlushStats_t flushStats;
 
 /*=============================================================================
                                 Private Constants
@@ -65,47 +177,128 @@ Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
 =============================================================================*/
 
 bool svcDisplayInit() {
-    if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
+    Wire.begin();
+    Wire.setClock(SVC_DISPLAY_I2C_CLOCK);
+
+    // The address comes from the configuration, so the panel is only built now
+    static Ssd1306I2cSink primaryPanel(&Wire, svcConfigGet()->displayAddress);
+    sinks[0] = &primaryPanel;
+    sinkCount = 1;
+
+    bool status = true;
+    for (uint8_t i = 0; i < sinkCount; i++) {
+        status &= sinks[i]->begin();
+    }
+    if (!status) {
         return false;
     }
 
     display.clearDisplay();
-    display.setTextColor(SSD1306_WHITE);
-    display.setFont(&FreeSerif9pt7b);
     // display.setTextSize(1);
     display.setCursor(10, 35);
     display.println("svcDisplayInit");
-    display.display();
+    svcDisplayFlush(frameBuffer);
+    svcPowerEnter(SVC_POWER_DISPLAY_ON);
+
+    return true;
+}
+
+bool svcDisplayAddSink(DisplaySink *sink) {
+    if (sink == nullptr || sinkCount >= SVC_DISPLAY_MAX_SINKS || !sink->begin()) {
+        return false;
+    }
 
+    // The new panel shows nothing yet, it gets every page on the next flush without resending them to the others
+    sink->stalePages = 0xFF;
+    sinks[sinkCount] = sink;
+    sinkCount++;
     return true;
 }
 
+void svcDisplayGetFlushStats(svcDisplayFlushStats_t *stats) {
+    *stats = flushStats;
+}
+
+void svcDisplayGetPageStats(svcDisplayPageStats_t *stats) {
+    *stats = pageStats;
+}
+
 void svcDisplayNextPrayer(Prayer nextPrayer) {
-    display.clearDisplay(); // Clear the display before drawing new content
+    SVC_TRACE_BEGIN("display.render");
+    renderNextPrayer(&display, nextPrayer);
+    SVC_TRACE_END("display.render");
 
-    // Display the header
-    display.setTextSize(1);
-    int16_t x1, y1;
-    uint16_t w, h;
-    display.getTextBounds("Next Prayer:", 0, 0, &x1, &y1, &w, &h);
-    display.setCursor((SCREEN_WIDTH - w) / 2, 15);
-    display.println("Next Prayer:");
+    SVC_TRACE_BEGIN("display.flush");
+    svcDisplayFlush(frameBuffer); // Update the panels with the new content
+    SVC_TRACE_END("display.flush");
+    // Whatever was prepared is older than this screen
+    backBufferReady = false;
+}
 
-    // Display the prayer name
-    display.setTextSize(1); // Increase text size for better readability
-    display.getTextBounds(svcPrayerNameToString(nextPrayer.name), 0, 0, &x1, &y1, &w, &h);
-    display.setCursor((SCREEN_WIDTH - w) / 2, 35); // Adjust cursor position
-    display.println(svcPrayerNameToString(nextPrayer.name));
+void svcDisplayPrepareNextPrayer(Prayer nextPrayer) {
+    SVC_TRACE_SCOPE("display.prepare");
+    renderNextPrayer(&backDisplay, nextPrayer);
+    backBufferReady = true;
+}
 
-    // Display the prayer time
-    display.setTextSize(1); // Keep the same text size for consistency
-    char timeBuffer[6]; // Buffer to hold the formatted time string
-    sprintf(timeBuffer, "%02d:%02d", nextPrayer.hour, nextPrayer.minute);
-    display.getTextBounds(timeBuffer, 0, 0, &x1, &y1, &w, &h);
-    display.setCursor((SCREEN_WIDTH - w) / 2, 55); // Adjust cursor position
-    display.println(timeBuffer);
+bool svcDisplaySwap() {
+    if (!backBufferReady) {
+        return false;
+    }
 
-    display.display(); // Update the display with the new content
+    SVC_TRACE_BEGIN("display.swap");
+    const bool status = svcDisplayFlush(backBuffer);
+    SVC_TRACE_END("display.swap");
+    // After the transfer, the deadline only waited for the panels
+    memcpy(frameBuffer, backBuffer, sizeof(frameBuffer));
+    backBufferReady = false;
+    return status;
+}
+
+void svcDisplayRenderNextPrayer(Prayer nextPrayer, uint8_t *frame) {
+    DisplayFrame target(frame);
+    renderNextPrayer(&target, nextPrayer);
+}
+
+void svcDisplayShowPage(svcDisplayPage_t page, const svcDisplayPageData_t *data) {
+    if (page >= SVC_DISPLAY_PAGE_COUNT) {
+        return;
+    }
+
+    if (!pageCacheValid[page] || isPageStale(page, &pageCacheData[page], data)) {
+        SVC_TRACE_BEGIN("display.cache");
+        DisplayFrame cache(pageCaches[page]);
+        renderPageStatic(&cache, page, data);
+        pageCacheData[page] = *data;
+        pageCacheValid[page] = true;
+        pageStats.renders++;
+        SVC_TRACE_END("display.cache");
+    }
+
+    // A flip is a copy of the cache and a few short strings
+    SVC_TRACE_BEGIN("display.compose");
+    memcpy(frameBuffer, pageCaches[page], sizeof(frameBuffer));
+    DisplayFrame frame(frameBuffer);
+    renderPageDynamic(&frame, page, data);
+    pageStats.flips++;
+    SVC_TRACE_END("display.compose");
+
+    SVC_TRACE_BEGIN("display.flush");
+    svcDisplayFlush(frameBuffer);
+    SVC_TRACE_END("display.flush");
+}
+
+void svcDisplayPreparePage(svcDisplayPage_t page, const svcDisplayPageData_t *data) {
+    if (page >= SVC_DISPLAY_PAGE_COUNT) {
+        return;
+    }
+
+    // Drawn for the instant of the swap, the caches keep what is shown until then
+    SVC_TRACE_SCOPE("display.prepare");
+    DisplayFrame frame(backBuffer);
+    renderPageStatic(&frame, page, data);
+    renderPageDynamic(&frame, page, data);
+    backBufferReady = true;
 }
 
 /*=============================================================================
@@ -128,3 +321,250 @@ String svcPrayerNameToString(PrayerName prayerName) {
             return "None";
     }
 }
+
+void renderNextPrayer(DisplayFrame *frame, Prayer nextPrayer) {
+    if (nextPrayer.name == NONE) {
+        // No timetable for the current date, the previous month's times must not stay on screen
+        frame->clearDisplay();
+        frame->setTextSize(1);
+        int16_t x1, y1;
+        uint16_t w, h;
+        // Centered on its bounds, y1 is where the top of the text lies from the cursor (the baseline of FreeSerif)
+        frame->getTextBounds("No timings", 0, 0, &x1, &y1, &w, &h);
+        frame->setCursor((SCREEN_WIDTH - w) / 2 - x1, (SCREEN_HEIGHT - h) / 2 - y1);
+        frame->print("No timings");
+        return;
+    }
+    if (svcGlyphAvailable()) {
+        renderNextPrayerArabic(frame, nextPrayer);
+        return;
+    }
+
+    frame->clearDisplay(); // Clear the display before drawing new content
+
+    // Display the header
+    frame->setTextSize(1);
+    int16_t x1, y1;
+    uint16_t w, h;
+    frame->getTextBounds("Next Prayer:", 0, 0, &x1, &y1, &w, &h);
+    frame->setCursor((SCREEN_WIDTH - w) / 2, 15);
+    frame->println("Next Prayer:");
+
+    // Display the prayer name
+    frame->setTextSize(1); // Increase text size for better readability
+    frame->getTextBounds(svcPrayerNameToString(nextPrayer.name), 0, 0, &x1, &y1, &w, &h);
+    frame->setCursor((SCREEN_WIDTH - w) / 2, 35); // Adjust cursor position
+    frame->println(svcPrayerNameToString(nextPrayer.name));
+
+    // Display the prayer time
+    frame->setTextSize(1); // Keep the same text size for consistency
+    char timeBuffer[6]; // Buffer to hold the formatted time string
+    sprintf(timeBuffer, "%02d:%02d", nextPrayer.hour, nextPrayer.minute);
+    frame->getTextBounds(timeBuffer, 0, 0, &x1, &y1, &w, &h);
+    frame->setCursor((SCREEN_WIDTH - w) / 2, 55); // Adjust cursor position
+    frame->println(timeBuffer);
+}
+
+void renderNextPrayerArabic(DisplayFrame *frame, Prayer nextPrayer) {
+    frame->clearDisplay();
+
+    // Every glyph has the same height, spread the three lines evenly
+    uint8_t width, height;
+    svcGlyphSize(SVC_GLYPH_NEXT_PRAYER, &width, &height);
+    const int16_t gap = height * 3 < SCREEN_HEIGHT ? (SCREEN_HEIGHT - height * 3) / 4 : 0;
+
+    const svcGlyph_t header = SVC_GLYPH_NEXT_PRAYER;
+    drawGlyphsCentered(frame, &header, 1, gap);
+
+    // The prayer glyphs follow PrayerName
+    if (nextPrayer.name < NONE) {
+        const svcGlyph_t name = (svcGlyph_t) (SVC_GLYPH_FAJR + nextPrayer.name);
+        drawGlyphsCentered(frame, &name, 1, gap * 2 + height);
+    }
+
+    // Numbers are written left to right in Arabic too
+    const svcGlyph_t time[DISPLAY_TIME_GLYPHS] = {
+        (svcGlyph_t) (SVC_GLYPH_DIGIT_0 + nextPrayer.hour / 10),
+        (svcGlyph_t) (SVC_GLYPH_DIGIT_0 + nextPrayer.hour % 10),
+        SVC_GLYPH_COLON,
+        (svcGlyph_t) (SVC_GLYPH_DIGIT_0 + nextPrayer.minute / 10),
+        (svcGlyph_t) (SVC_GLYPH_DIGIT_0 + nextPrayer.minute % 10),
+    };
+    drawGlyphsCentered(frame, time, DISPLAY_TIME_GLYPHS, gap * 3 + height * 2);
+}
+
+void drawGlyphsCentered(DisplayFrame *frame, const svcGlyph_t *glyphs, uint8_t count, int16_t y) {
+    int16_t lineWidth = 0;
+    uint8_t width, height;
+    for (uint8_t i = 0; i < count; i++) {
+        svcGlyphSize(glyphs[i], &width, &height);
+        lineWidth += width + (i > 0 ? DISPLAY_GLYPH_SPACING : 0);
+    }
+
+    int16_t x = (SCREEN_WIDTH - lineWidth) / 2;
+    for (uint8_t i = 0; i < count; i++) {
+        svcGlyphDraw(glyphs[i], x, y, drawGlyphSpan, frame);
+        svcGlyphSize(glyphs[i], &width, &height);
+        x += width + DISPLAY_GLYPH_SPACING;
+    }
+}
+
+void drawGlyphSpan(int16_t x, int16_t y, int16_t length, void *context) {
+    static_cast<DisplayFrame *>(context)->drawFastHLine(x, y, length, DISPLAY_WHITE);
+}
+
+bool svcDisplayFlush(const uint8_t *frame) {
+    const unsigned long startUs = micros();
+    const bool status = svcDisplaySinkFlush(sinks, sinkCount, frame, shownFrame, &flushStats);
+    flushStats.lastUs = micros() - startUs;
+    if (flushStats.lastUs > flushStats.maxUs) {
+        flushStats.maxUs = flushStats.lastUs;
+    }
+    return status;
+}
+
+void renderPageStatic(DisplayFrame *frame, svcDisplayPage_t page, const svcDisplayPageData_t *data) {
+    frame->clearDisplay();
+    frame->setFont(nullptr);
+    char text[24];
+
+    switch (page) {
+        case SVC_DISPLAY_PAGE_TODAY: {
+            if (data->today.day == 0) {
+                drawTextCentered(frame, "No timings for today", (SCREEN_HEIGHT - PAGE_LINE_HEIGHT) / 2, 1);
+                return;
+            }
+            // The clock is drawn on the right of the date line
+            snprintf(text, sizeof(text), "%02u/%02u/%04u", data->today.day, data->today.month, data->today.year);
+            drawText(frame, text, 0, 0, 1);
+            frame->drawFastHLine(0, PAGE_TODAY_FIRST_ROW - 3, SCREEN_WIDTH, DISPLAY_WHITE);
+
+            const Prayer *prayers[] = {&data->today.fajr, &data->today.dhuhr, &data->today.asr,
+                                       &data->today.maghrib, &data->today.isha};
+            for (uint8_t i = 0; i < sizeof(prayers) / sizeof(prayers[0]); i++) {
+                const int16_t y = PAGE_TODAY_FIRST_ROW + i * PAGE_TODAY_ROW_HEIGHT;
+                drawText(frame, svcPrayerNameToString((PrayerName) i).c_str(), PAGE_CHAR_WIDTH * 2, y, 1);
+                snprintf(text, sizeof(text), "%02u:%02u", prayers[i]->hour, prayers[i]->minute);
+                drawText(frame, text, PAGE_TODAY_TIME_X, y, 1);
+            }
+            return;
+        }
+        case SVC_DISPLAY_PAGE_NEXT:
+            if (data->state.nextPrayer.name == NONE) {
+                drawTextCentered(frame, "No prayer scheduled", (SCREEN_HEIGHT - PAGE_LINE_HEIGHT) / 2, 1);
+                return;
+            }
+            drawTextCentered(frame, "Next prayer", 0, 1);
+            snprintf(text, sizeof(text), "%s at %02u:%02u", svcPrayerNameToString(data->state.nextPrayer.name).c_str(),
+                     data->state.nextPrayer.hour, data->state.nextPrayer.minute);
+            drawTextCentered(frame, text, 16, 1);
+            // Countdown between the two lines
+            drawTextCentered(frame, "remaining", SCREEN_HEIGHT - PAGE_LINE_HEIGHT, 1);
+            return;
+        case SVC_DISPLAY_PAGE_STATUS: {
+            const char *labels[] = {"Time", "Clock", "Sync", "BLE", "Days"};
+            for (uint8_t i = 0; i < sizeof(labels) / sizeof(labels[0]); i++) {
+                drawText(frame, labels[i], 0, i * PAGE_STATUS_ROW_HEIGHT, 1);
+            }
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+void renderPageDynamic(DisplayFrame *frame, svcDisplayPage_t page, const svcDisplayPageData_t *data) {
+    frame->setFont(nullptr);
+    char text[24];
+    svcClockDateTime_t local;
+    svcClockToDateTime(svcClockUtcToLocal(data->now), &local);
+
+    switch (page) {
+        case SVC_DISPLAY_PAGE_TODAY: {
+            if (data->today.day == 0) {
+                return;
+            }
+            snprintf(text, sizeof(text), "%02d:%02d", local.hour, local.minute);
+            drawText(frame, text, SCREEN_WIDTH - PAGE_CHAR_WIDTH * 5, 0, 1);
+
+            const int8_t row = todayRowOf(&data->today, &data->state.nextPrayer);
+            if (row >= 0) {
+                frame->fillRect(0, PAGE_TODAY_FIRST_ROW + row * PAGE_TODAY_ROW_HEIGHT - 1, SCREEN_WIDTH,
+                                PAGE_TODAY_ROW_HEIGHT, DISPLAY_INVERSE);
+            }
+            return;
+        }
+        case SVC_DISPLAY_PAGE_NEXT: {
+            if (data->state.nextPrayer.name == NONE) {
+                return;
+            }
+            int64_t left = data->state.nextPrayerUtc - data->now;
+            if (left < 0) {
+                left = 0;
+            }
+            const long hours = (long) (left / 3600);
+            snprintf(text, sizeof(text), "%02ld:%02d:%02d", hours > 99 ? 99L : hours, (int) (left / 60 % 60),
+                     (int) (left % 60));
+            drawTextCentered(frame, text, 32, 2);
+            return;
+        }
+        case SVC_DISPLAY_PAGE_STATUS: {
+            const char *syncNames[] = {"none", "receiving", "done"};
+            snprintf(text, sizeof(text), "%02d:%02d:%02d", local.hour, local.minute, local.second);
+            drawText(frame, text, PAGE_STATUS_VALUE_X, 0, 1);
+            drawText(frame, svcClockSourceToString(data->state.timeSource), PAGE_STATUS_VALUE_X,
+                     PAGE_STATUS_ROW_HEIGHT, 1);
+            drawText(frame, data->state.syncStatus <= SYNC_DONE ? syncNames[data->state.syncStatus] : "?",
+                     PAGE_STATUS_VALUE_X, PAGE_STATUS_ROW_HEIGHT * 2, 1);
+            drawText(frame, data->state.connected ? "connected" : "advertising", PAGE_STATUS_VALUE_X,
+                     PAGE_STATUS_ROW_HEIGHT * 3, 1);
+            snprintf(text, sizeof(text), "%u", data->state.numberOfDays);
+            drawText(frame, text, PAGE_STATUS_VALUE_X, PAGE_STATUS_ROW_HEIGHT * 4, 1);
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+bool isPageStale(svcDisplayPage_t page, const svcDisplayPageData_t *cached, const svcDisplayPageData_t *data) {
+    switch (page) {
+        case SVC_DISPLAY_PAGE_TODAY: {
+            const PrayerTimings &a = cached->today;
+            const PrayerTimings &b = data->today;
+            return a.day != b.day || a.month != b.month || a.year != b.year || !isSamePrayer(&a.fajr, &b.fajr) ||
+                   !isSamePrayer(&a.dhuhr, &b.dhuhr) || !isSamePrayer(&a.asr, &b.asr) ||
+                   !isSamePrayer(&a.maghrib, &b.maghrib) || !isSamePrayer(&a.isha, &b.isha);
+        }
+        case SVC_DISPLAY_PAGE_NEXT:
+            return !isSamePrayer(&cached->state.nextPrayer, &data->state.nextPrayer);
+        default:
+            // Labels only
+            return false;
+    }
+}
+
+bool isSamePrayer(const Prayer *a, const Prayer *b) {
+    return a->name == b->name && a->hour == b->hour && a->minute == b->minute;
+}
+
+int8_t todayRowOf(const PrayerTimings *today, const Prayer *prayer) {
+    const Prayer *prayers[] = {&today->fajr, &today->dhuhr, &today->asr, &today->maghrib, &today->isha};
+    for (int8_t i = 0; i < (int8_t) (sizeof(prayers) / sizeof(prayers[0])); i++) {
+        // Tomorrow's fajr has the same name but not the same time, nothing is highlighted after isha
+        if (isSamePrayer(prayers[i], prayer)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void drawText(DisplayFrame *frame, const char *text, int16_t x, int16_t y, uint8_t size) {
+    frame->setTextSize(size);
+    frame->setCursor(x, y);
+    frame->print(text);
+}
+
+void drawTextCentered(DisplayFrame *frame, const char *text, int16_t y, uint8_t size) {
+    drawText(frame, text, (SCREEN_WIDTH - (int16_t) strlen(text) * PAGE_CHAR_WIDTH * size) / 2, y, size);
+}
@@ -21,6 +21,8 @@
 
 #include <Arduino.h>
 #include <mod_timings.h>
+#include <svc_display_sink.h>
+#include <svc_state.h>
 
 /*=============================================================================
                                      Defines
@@ -34,6 +36,13 @@
                                       Enums
 =============================================================================*/
 
+typedef enum {
+    SVC_DISPLAY_PAGE_TODAY,  // The prayers of the day, the next one highlighted
+    SVC_DISPLAY_PAGE_NEXT,   // The next prayer and the time left
+    SVC_DISPLAY_PAGE_STATUS, // Clock, time source and timetable sync
+    SVC_DISPLAY_PAGE_COUNT
+} svcDisplayPage_t;
+
 /*=============================================================================
                                  Type definitions
 =============================================================================*/
@@ -42,6 +51,17 @@
                                     Structures
 =============================================================================*/
 
+typedef struct {
+    svcState_t state;    // Snapshot the page is drawn from
+    PrayerTimings today; // day is 0 when the timetable does not have today
+    int64_t now;         // UTC seconds the clock and the countdown are drawn for
+} svcDisplayPageData_t;
+
+typedef struct {
+    uint32_t renders; // Static parts rendered into the page caches
+    uint32_t flips;   // Pages shown from their cache
+} svcDisplayPageStats_t;
+
 /*=============================================================================
                                 Public Constants
 =============================================================================*/
@@ -58,4 +78,41 @@ bool svcDisplayInit();
 /// \param nextPrayer The prayer timings to be displayed
 void svcDisplayNextPrayer(Prayer nextPrayer);
 
+/// \brief Render the next prayer screen into a caller buffer without touching the panels
+/// \param nextPrayer The prayer timings to be rendered
+/// \param frame Buffer of SVC_DISPLAY_FRAME_SIZE bytes in the SSD1306 page layout
+void svcDisplayRenderNextPrayer(Prayer nextPrayer, uint8_t *frame);
+
+/// \brief Render the next prayer screen into the back buffer, shown by svcDisplaySwap()
+/// \param nextPrayer The prayer timings to be rendered
+void svcDisplayPrepareNextPrayer(Prayer nextPrayer);
+
+/// \brief Send the back buffer to the panels, only the transfer of the pages that changed is left
+/// \return true if the panels show the back buffer, false if nothing was prepared or a transfer failed
+bool svcDisplaySwap();
+
+/// \brief Show a page, the static part comes from its cache and only the clock, countdown and highlight are drawn
+/// \details The cache of the page is rendered again when the data it shows changed: the day, the next prayer.
+/// \param page The page to show
+/// \param data What the page shows
+void svcDisplayShowPage(svcDisplayPage_t page, const svcDisplayPageData_t *data);
+
+/// \brief Render a page into the back buffer, shown by svcDisplaySwap()
+/// \param page The page to render
+/// \param data What the page shows at the swap
+void svcDisplayPreparePage(svcDisplayPage_t page, const svcDisplayPageData_t *data);
+
+/// \brief Add a panel receiving the same frames as the primary panel, after svcDisplayInit()
+/// \param sink The panel, must stay valid for the lifetime of the program
+/// \return true if the panel was initialized and added, false otherwise
+bool svcDisplayAddSink(DisplaySink *sink);
+
+/// \brief Get the counters of the frame flushes
+/// \param stats Filled with the counters
+void svcDisplayGetFlushStats(svcDisplayFlushStats_t *stats);
+
+/// \brief Get the counters of the page caches
+/// \param stats Filled with the counters
+void svcDisplayGetPageStats(svcDisplayPageStats_t *stats);
+
 #endif // SVC_DISPLAY_H
@@ -0,0 +1,140 @@
+/*===========================================================================*/
+/// \file svc_display_sink.cpp
+///
+/// \brief
+///    Display sink abstraction used to push one rendered frame to several panels
+///
+/// \details
+///    Flush the changed pages of a frame to every sink, interleaving the sinks chunk by chunk. Each sink keeps the
+///    pages it missed, so a panel that failed or joined late catches up without resending to the others.
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_display_sink.h"
+#include <string.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static_assert(SVC_DISPLAY_PAGES <= 8, "One bit per page in DisplaySink::stalePages");
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+bool svcDisplaySinkFlush(DisplaySink *const *sinks, size_t sinkCount, const uint8_t *frame, uint8_t *previous,
+                         svcDisplayFlushStats_t *stats) {
+    if (sinkCount > SVC_DISPLAY_MAX_SINKS) {
+        return false;
+    }
+    bool success = true;
+
+    for (uint8_t page = 0; page < SVC_DISPLAY_PAGES; page++) {
+        const uint8_t *pageData = &frame[page * SVC_DISPLAY_WIDTH];
+        const uint8_t pageBit = (uint8_t) (1 << page);
+        const bool changed = previous == nullptr ||
+                             memcmp(pageData, &previous[page * SVC_DISPLAY_WIDTH], SVC_DISPLAY_WIDTH) != 0;
+
+        // Only the sinks showing something else get the page, a failure on one panel costs the others nothing
+        bool sending[SVC_DISPLAY_MAX_SINKS];
+        bool pageNeeded = false;
+        size_t chunk = SVC_DISPLAY_WIDTH;
+        for (size_t i = 0; i < sinkCount; i++) {
+            sending[i] = changed || (sinks[i]->stalePages & pageBit) != 0;
+            if (!sending[i]) {
+                continue;
+            }
+            const size_t sinkChunk = sinks[i]->chunkSize();
+            if (sinkChunk == 0) {
+                // Could never take a byte, counted as a failed transfer instead of stalling the flush
+                sending[i] = false;
+                sinks[i]->stalePages |= pageBit;
+                success = false;
+                if (stats != nullptr) {
+                    stats->errors++;
+                }
+                continue;
+            }
+            pageNeeded = true;
+            if (sinkChunk < chunk) {
+                chunk = sinkChunk;
+            }
+        }
+
+        if (previous != nullptr && changed) {
+            memcpy(&previous[page * SVC_DISPLAY_WIDTH], pageData, SVC_DISPLAY_WIDTH);
+        }
+        if (!pageNeeded) {
+            if (stats != nullptr) {
+                stats->pagesSkipped++;
+            }
+            continue;
+        }
+
+        // Interleave the sinks so a slow panel never holds the others back for a whole frame
+        for (size_t column = 0; column < SVC_DISPLAY_WIDTH; column += chunk) {
+            const size_t length = SVC_DISPLAY_WIDTH - column < chunk ? SVC_DISPLAY_WIDTH - column : chunk;
+            for (size_t i = 0; i < sinkCount; i++) {
+                if (sending[i] && !sinks[i]->writeChunk(page, (uint8_t) column, &pageData[column], length)) {
+                    // The rest of the page waits for the next flush
+                    sending[i] = false;
+                    sinks[i]->stalePages |= pageBit;
+                    success = false;
+                    if (stats != nullptr) {
+                        stats->errors++;
+                    }
+                }
+            }
+        }
+
+        for (size_t i = 0; i < sinkCount; i++) {
+            if (sending[i]) {
+                sinks[i]->stalePages &= (uint8_t) ~pageBit;
+            }
+        }
+        if (stats != nullptr) {
+            stats->pagesSent++;
+        }
+    }
+
+    if (stats != nullptr) {
+        stats->frames++;
+    }
+    return success;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
@@ -0,0 +1,109 @@
+/*===========================================================================*/
+/// \file svc_display_sink.h
+///
+/// \brief
+///    Display sink abstraction used to push one rendered frame to several panels
+///
+/// \details
+///     A frame is rendered once in the SSD1306 page layout (one byte = 8 vertical pixels) and flushed to every sink
+///     chunk by chunk, interleaving the sinks so that each added panel only costs its own bus time. Only plain C++ is
+///     used here so the flush logic can run on a host against emulated sinks.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_DISPLAY_SINK_H
+#define SVC_DISPLAY_SINK_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SVC_DISPLAY_WIDTH 128 // Panel width, in pixels
+#define SVC_DISPLAY_HEIGHT 64 // Panel height, in pixels
+#define SVC_DISPLAY_PAGES (SVC_DISPLAY_HEIGHT / 8)
+#define SVC_DISPLAY_FRAME_SIZE (SVC_DISPLAY_WIDTH * SVC_DISPLAY_PAGES)
+
+#define SVC_DISPLAY_MAX_SINKS 4
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    uint32_t frames;
+    uint32_t pagesSent;
+    uint32_t pagesSkipped;
+    uint32_t errors;
+    uint32_t lastUs; // Duration of the last flush
+    uint32_t maxUs;
+} svcDisplayFlushStats_t;
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+class DisplaySink {
+public:
+    virtual ~DisplaySink() = default;
+
+    /// \brief Initialize the panel behind the sink
+    /// \return true if the panel answered, false otherwise
+    virtual bool begin() = 0;
+
+    /// \brief Send part of a page of the frame
+    /// \param page The page (row of 8 pixels) being written
+    /// \param column The first column written
+    /// \param data The bytes of the page starting at the column
+    /// \param length Number of bytes to send, never more than chunkSize()
+    /// \return true if the transfer succeeded, false otherwise
+    virtual bool writeChunk(uint8_t page, uint8_t column, const uint8_t *data, size_t length) = 0;
+
+    /// \brief Largest number of bytes the sink can send in one transfer
+    virtual size_t chunkSize() const = 0;
+
+    /// Pages, one bit each, the panel does not show from the previous frame: all of them until the first flush
+    /// reached it, then those of a failed transfer. They are sent again even when the frame did not change them.
+    uint8_t stalePages = 0xFF;
+};
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Flush to every sink the pages of a frame that differ from the previous frame or that it does not show
+/// \param sinks The sinks to flush to
+/// \param sinkCount Number of sinks, up to SVC_DISPLAY_MAX_SINKS
+/// \param frame The frame to send, SVC_DISPLAY_FRAME_SIZE bytes
+/// \param previous The frame flushed last, replaced by this one, nullptr to send every page
+/// \param stats Counters updated by the flush, may be nullptr
+/// \return true if every sink received every page it needed, false otherwise
+bool svcDisplaySinkFlush(DisplaySink *const *sinks, size_t sinkCount, const uint8_t *frame, uint8_t *previous,
+                         svcDisplayFlushStats_t *stats);
+
+#endif // SVC_DISPLAY_SINK_H
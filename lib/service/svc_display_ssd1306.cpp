@@ -0,0 +1,183 @@
+/*===========================================================================*/
+/// \file svc_display_ssd1306.cpp
+///
+/// \brief
+///    SSD1306 panels as display sinks
+///
+/// \details
+///    Initialize the panels in horizontal addressing mode and write the frame chunks to them over I2C or SPI
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_display_ssd1306.h"
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SSD1306_I2C_COMMAND 0x00
+#define SSD1306_I2C_DATA 0x40
+#define SSD1306_COLUMN_ADDRESS 0x21
+#define SSD1306_PAGE_ADDRESS 0x22
+
+// The ESP32 Wire buffer holds 128 bytes including the control byte
+#define SSD1306_I2C_CHUNK_SIZE 64
+#define SSD1306_SPI_CHUNK_SIZE SVC_DISPLAY_WIDTH
+#define SSD1306_SPI_CLOCK 8000000
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static const SPISettings spiSettings(SSD1306_SPI_CLOCK, MSBFIRST, SPI_MODE0);
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+// 128x64 panel, internal charge pump, horizontal addressing mode (same values as the Adafruit driver)
+static const uint8_t initSequence[] = {
+    0xAE,       // Display off
+    0xD5, 0x80, // Clock divide ratio
+    0xA8, 0x3F, // Multiplex ratio (64 - 1)
+    0xD3, 0x00, // Display offset
+    0x40,       // Start line 0
+    0x8D, 0x14, // Charge pump on
+    0x20, 0x00, // Horizontal addressing mode
+    0xA1,       // Segment remap
+    0xC8,       // COM scan direction remapped
+    0xDA, 0x12, // COM pins configuration
+    0x81, 0xCF, // Contrast
+    0xD9, 0xF1, // Pre-charge period
+    0xDB, 0x40, // VCOMH deselect level
+    0xA4,       // Resume to RAM content
+    0xA6,       // Normal, not inverted
+    0x2E,       // Scroll off
+    0xAF        // Display on
+};
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+Ssd1306I2cSink::Ssd1306I2cSink(TwoWire *wire, uint8_t address, uint8_t muxAddress, uint8_t muxChannel)
+    : wire(wire), address(address), muxAddress(muxAddress), muxChannel(muxChannel) {
+}
+
+bool Ssd1306I2cSink::begin() {
+    return sendCommands(initSequence, sizeof(initSequence));
+}
+
+bool Ssd1306I2cSink::writeChunk(uint8_t page, uint8_t column, const uint8_t *data, size_t length) {
+    const uint8_t window[] = {
+        SSD1306_COLUMN_ADDRESS, column, (uint8_t) (column + length - 1),
+        SSD1306_PAGE_ADDRESS, page, page
+    };
+    if (!sendCommands(window, sizeof(window))) {
+        return false;
+    }
+
+    wire->beginTransmission(address);
+    wire->write(SSD1306_I2C_DATA);
+    wire->write(data, length);
+    return wire->endTransmission() == 0;
+}
+
+size_t Ssd1306I2cSink::chunkSize() const {
+    return SSD1306_I2C_CHUNK_SIZE;
+}
+
+bool Ssd1306I2cSink::selectChannel() {
+    if (muxAddress == SVC_SSD1306_NO_MUX) {
+        return true;
+    }
+
+    wire->beginTransmission(muxAddress);
+    wire->write((uint8_t) (1 << muxChannel));
+    return wire->endTransmission() == 0;
+}
+
+bool Ssd1306I2cSink::sendCommands(const uint8_t *commands, size_t length) {
+    if (!selectChannel()) {
+        return false;
+    }
+
+    wire->beginTransmission(address);
+    wire->write(SSD1306_I2C_COMMAND);
+    wire->write(commands, length);
+    return wire->endTransmission() == 0;
+}
+
+Ssd1306SpiSink::Ssd1306SpiSink(SPIClass *spi, int8_t csPin, int8_t dcPin, int8_t resetPin)
+    : spi(spi), csPin(csPin), dcPin(dcPin), resetPin(resetPin) {
+}
+
+bool Ssd1306SpiSink::begin() {
+    pinMode(csPin, OUTPUT);
+    pinMode(dcPin, OUTPUT);
+    digitalWrite(csPin, HIGH);
+    spi->begin();
+
+    if (resetPin >= 0) {
+        pinMode(resetPin, OUTPUT);
+        digitalWrite(resetPin, HIGH);
+        delay(1);
+        digitalWrite(resetPin, LOW);
+        delay(10);
+        digitalWrite(resetPin, HIGH);
+    }
+
+    send(false, initSequence, sizeof(initSequence));
+    // SPI is write only, there is no acknowledge to check
+    return true;
+}
+
+bool Ssd1306SpiSink::writeChunk(uint8_t page, uint8_t column, const uint8_t *data, size_t length) {
+    const uint8_t window[] = {
+        SSD1306_COLUMN_ADDRESS, column, (uint8_t) (column + length - 1),
+        SSD1306_PAGE_ADDRESS, page, page
+    };
+    send(false, window, sizeof(window));
+    send(true, data, length);
+    return true;
+}
+
+size_t Ssd1306SpiSink::chunkSize() const {
+    return SSD1306_SPI_CHUNK_SIZE;
+}
+
+void Ssd1306SpiSink::send(bool isData, const uint8_t *bytes, size_t length) {
+    spi->beginTransaction(spiSettings);
+    digitalWrite(dcPin, isData ? HIGH : LOW);
+    digitalWrite(csPin, LOW);
+    spi->writeBytes(bytes, length);
+    digitalWrite(csPin, HIGH);
+    spi->endTransaction();
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
@@ -0,0 +1,110 @@
+/*===========================================================================*/
+/// \file svc_display_ssd1306.h
+///
+/// \brief
+///    SSD1306 panels as display sinks
+///
+/// \details
+///     The sinks only own their bus settings, the frame buffer is shared so adding a panel costs no render work and no
+///     extra RAM. I2C panels can sit behind a TCA9548A multiplexer, SPI panels use the 4-wire interface.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_DISPLAY_SSD1306_H
+#define SVC_DISPLAY_SSD1306_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <Wire.h>
+#include <svc_display_sink.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SVC_SSD1306_NO_MUX 0xFF
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+class Ssd1306I2cSink : public DisplaySink {
+public:
+    /// \param wire The I2C bus of the panel
+    /// \param address The I2C address of the panel, usually 0x3C or 0x3D
+    /// \param muxAddress The address of the TCA9548A in front of the panel, SVC_SSD1306_NO_MUX if none
+    /// \param muxChannel The multiplexer channel of the panel
+    Ssd1306I2cSink(TwoWire *wire, uint8_t address, uint8_t muxAddress = SVC_SSD1306_NO_MUX, uint8_t muxChannel = 0);
+
+    bool begin() override;
+
+    bool writeChunk(uint8_t page, uint8_t column, const uint8_t *data, size_t length) override;
+
+    size_t chunkSize() const override;
+
+private:
+    bool selectChannel();
+
+    bool sendCommands(const uint8_t *commands, size_t length);
+
+    TwoWire *wire;
+    uint8_t address;
+    uint8_t muxAddress;
+    uint8_t muxChannel;
+};
+
+class Ssd1306SpiSink : public DisplaySink {
+public:
+    /// \param spi The SPI bus of the panel
+    /// \param csPin Chip select pin
+    /// \param dcPin Data/command pin
+    /// \param resetPin Reset pin, -1 if not connected
+    Ssd1306SpiSink(SPIClass *spi, int8_t csPin, int8_t dcPin, int8_t resetPin = -1);
+
+    bool begin() override;
+
+    bool writeChunk(uint8_t page, uint8_t column, const uint8_t *data, size_t length) override;
+
+    size_t chunkSize() const override;
+
+private:
+    void send(bool isData, const uint8_t *bytes, size_t length);
+
+    SPIClass *spi;
+    int8_t csPin;
+    int8_t dcPin;
+    int8_t resetPin;
+};
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+#endif // SVC_DISPLAY_SSD1306_H
@@ -0,0 +1,293 @@
+/*===========================================================================*/
+/// \file svc_event.cpp
+///
+/// \brief
+///    Service for publishing typed events between modules
+///
+/// \details
+///    Keep the subscriber table and the per-topic counters, and fan each published event out to the subscribers.
+///    Subscribers are only ever appended, so a publish walks the table without any lock and only takes the bus
+///    spinlock around the counters and the buffer holds.
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_event.h"
+#include <svc_cli.h>
+#include <svc_log.h>
+#include <svc_trace.h>
+#include <atomic>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    QueueHandle_t queue;
+    uint32_t topicMask;
+} svcEventSubscriber_t;
+
+typedef struct {
+    const void *buffer;
+    uint32_t holds; // Delivered copies not released yet
+} svcEventHeldBuffer_t;
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static svcEventHeldBuffer_t *findHeld(const void *buffer);
+
+static void svcEventRegisterCommands();
+
+static void commandEvents(cmd *c);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+// Only short sections without any FreeRTOS call, publishers on both cores and in interrupts take it
+static portMUX_TYPE busLock = portMUX_INITIALIZER_UNLOCKED;
+// Entries below the count are never modified again, the publishers read them without the lock
+static svcEventSubscriber_t subscribers[SVC_EVENT_MAX_SUBSCRIBERS];
+static std::atomic<uint8_t> subscriberCount(0);
+static svcEventStats_t topicStats[SVC_EVENT_TOPIC_COUNT];
+static svcEventHeldBuffer_t heldBuffers[SVC_EVENT_MAX_HELD_BUFFERS];
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const char *const topicNames[SVC_EVENT_TOPIC_COUNT] = {
+    "timetable-updated",
+    "time-changed",
+    "prayer-due",
+    "display-request",
+    "sync-changed",
+    "display-prepare"
+};
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+bool svcEventInit() {
+    svcEventRegisterCommands();
+    return true;
+}
+
+QueueHandle_t svcEventSubscribe(uint32_t topicMask, UBaseType_t depth) {
+    QueueHandle_t queue = xQueueCreate(depth, sizeof(svcEvent_t));
+    bool added = false;
+    if (queue != nullptr) {
+        portENTER_CRITICAL(&busLock);
+        // Only written under the lock, a relaxed load is enough here
+        const uint8_t count = subscriberCount.load(std::memory_order_relaxed);
+        if (count < SVC_EVENT_MAX_SUBSCRIBERS) {
+            subscribers[count] = {queue, topicMask};
+            for (int topic = 0; topic < SVC_EVENT_TOPIC_COUNT; topic++) {
+                if (topicMask & SVC_EVENT_MASK(topic)) {
+                    topicStats[topic].subscribers++;
+                }
+            }
+            // Release: counted once complete, a concurrent publish sees the entry whole or not at all
+            subscriberCount.store(count + 1, std::memory_order_release);
+            added = true;
+        }
+        portEXIT_CRITICAL(&busLock);
+    }
+
+    if (!added) {
+        if (queue != nullptr) {
+            vQueueDelete(queue);
+        }
+        SVC_LOG_ERROR("No more space for event subscribers");
+        return nullptr;
+    }
+    return queue;
+}
+
+bool svcEventPublish(const svcEvent_t *event) {
+    if (event == nullptr || event->topic >= SVC_EVENT_TOPIC_COUNT) {
+        return false;
+    }
+    const uint32_t topicMask = SVC_EVENT_MASK(event->topic);
+    const bool fromIsr = xPortInIsrContext();
+    // Acquire: the entries below the count are read without the lock
+    const uint8_t count = subscriberCount.load(std::memory_order_acquire);
+
+    // Held for every subscriber up front, one may release it before the loop below is done
+    svcEventHeldBuffer_t *held = nullptr;
+    bool holdable = true;
+    if ((topicMask & SVC_EVENT_BUFFER_TOPICS) && event->data.buffer != nullptr) {
+        uint32_t holds = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            holds += (subscribers[i].topicMask & topicMask) ? 1 : 0;
+        }
+        portENTER_CRITICAL_SAFE(&busLock);
+        held = findHeld(event->data.buffer);
+        if (held == nullptr) {
+            held = findHeld(nullptr);
+        }
+        if (held != nullptr) {
+            held->buffer = event->data.buffer;
+            held->holds += holds;
+        }
+        holdable = held != nullptr;
+        portEXIT_CRITICAL_SAFE(&busLock);
+    }
+
+    uint32_t delivered = 0;
+    uint32_t dropped = 0;
+    uint32_t maxDepth = 0;
+    BaseType_t woken = pdFALSE;
+    for (uint8_t i = 0; i < count; i++) {
+        if (!(subscribers[i].topicMask & topicMask)) {
+            continue;
+        }
+
+        // Never block the publisher, a full subscriber queue only costs that subscriber the event
+        QueueHandle_t queue = subscribers[i].queue;
+        const bool sent = holdable && (fromIsr ? xQueueSendFromISR(queue, event, &woken) : xQueueSend(queue, event, 0))
+                                      == pdTRUE;
+        if (sent) {
+            delivered++;
+        } else {
+            dropped++;
+            SVC_TRACE_INSTANT("event.drop", event->topic);
+        }
+
+        const uint32_t depth = fromIsr ? uxQueueMessagesWaitingFromISR(queue) : uxQueueMessagesWaiting(queue);
+        if (depth > maxDepth) {
+            maxDepth = depth;
+        }
+    }
+
+    portENTER_CRITICAL_SAFE(&busLock);
+    if (held != nullptr) {
+        // The dropped copies will never be released
+        held->holds -= dropped;
+        if (held->holds == 0) {
+            held->buffer = nullptr;
+        }
+    }
+    svcEventStats_t &stats = topicStats[event->topic];
+    stats.published++;
+    stats.delivered += delivered;
+    stats.dropped += dropped;
+    stats.depth = maxDepth;
+    if (maxDepth > stats.maxDepth) {
+        stats.maxDepth = maxDepth;
+    }
+    portEXIT_CRITICAL_SAFE(&busLock);
+
+    if (woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+    return dropped == 0;
+}
+
+void svcEventRelease(const void *buffer) {
+    if (buffer == nullptr) {
+        return;
+    }
+    portENTER_CRITICAL_SAFE(&busLock);
+    svcEventHeldBuffer_t *held = findHeld(buffer);
+    if (held != nullptr && --held->holds == 0) {
+        held->buffer = nullptr;
+    }
+    portEXIT_CRITICAL_SAFE(&busLock);
+}
+
+bool svcEventIsHeld(const void *buffer) {
+    portENTER_CRITICAL_SAFE(&busLock);
+    const bool held = buffer != nullptr && findHeld(buffer) != nullptr;
+    portEXIT_CRITICAL_SAFE(&busLock);
+    return held;
+}
+
+PrayerTimetable *svcEventFreeTimetable(PrayerTimetable *timetables, size_t count, const PrayerTimetable *taken) {
+    for (size_t i = 0; i < count; i++) {
+        if (&timetables[i] != taken && !svcEventIsHeld(&timetables[i])) {
+            return &timetables[i];
+        }
+    }
+    return nullptr;
+}
+
+bool svcEventGetStats(svcEventTopic_t topic, svcEventStats_t *stats) {
+    if (topic >= SVC_EVENT_TOPIC_COUNT || stats == nullptr) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&busLock);
+    *stats = topicStats[topic];
+    portEXIT_CRITICAL(&busLock);
+    return true;
+}
+
+const char *svcEventTopicToString(svcEventTopic_t topic) {
+    if (topic >= SVC_EVENT_TOPIC_COUNT) {
+        return "unknown";
+    }
+    return topicNames[topic];
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+svcEventHeldBuffer_t *findHeld(const void *buffer) {
+    // Called with busLock held, nullptr finds a free entry
+    for (svcEventHeldBuffer_t &held: heldBuffers) {
+        if (held.buffer == buffer) {
+            return &held;
+        }
+    }
+    return nullptr;
+}
+
+void svcEventRegisterCommands() {
+    SimpleCLI *cli = svcCliGetCli0();
+    svcCliAddCmdHelp("events", "List the event bus topics and their counters");
+    cli->addCommand("events", commandEvents);
+}
+
+void commandEvents(cmd *c) {
+    svcCliOut()->write("\r\n--------------------------------------------------------------------------\r\n");
+    svcCliOut()->printf("%-18s | %-4s | %-9s | %-9s | %-7s | %-5s | %-5s\r\n", "Topic", "Subs", "Published",
+                        "Delivered", "Dropped", "Depth", "Max");
+    svcCliOut()->write("--------------------------------------------------------------------------\r\n");
+
+    for (int topic = 0; topic < SVC_EVENT_TOPIC_COUNT; topic++) {
+        svcEventStats_t stats;
+        svcEventGetStats((svcEventTopic_t) topic, &stats);
+        svcCliOut()->printf("%-18s | %-4u | %-9lu | %-9lu | %-7lu | %-5lu | %-5lu\r\n",
+                            svcEventTopicToString((svcEventTopic_t) topic),
+                            stats.subscribers,
+                            (unsigned long) stats.published,
+                            (unsigned long) stats.delivered,
+                            (unsigned long) stats.dropped,
+                            (unsigned long) stats.depth,
+                            (unsigned long) stats.maxDepth);
+    }
+    svcCliOut()->write("--------------------------------------------------------------------------\r\n");
+}
@@ -0,0 +1,145 @@
+/*===========================================================================*/
+/// \file svc_event.h
+///
+/// \brief
+///    Service for publishing typed events between modules
+///
+/// \details
+///     Small publish/subscribe bus. Each subscriber owns a FreeRTOS queue that receives the topics it asked for, so
+///     modules never need to know each other's queues. Large payloads are passed as pointers to immutable buffers
+///     owned by the publisher: each delivered copy holds the buffer until its subscriber releases it, the publisher
+///     only writes into a buffer nobody holds. Publishing never blocks and works from an interrupt.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_EVENT_H
+#define SVC_EVENT_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+#include <mod_timings.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SVC_EVENT_MAX_SUBSCRIBERS 8
+// Buffers held at the same time, two per timetable source
+#define SVC_EVENT_MAX_HELD_BUFFERS 8
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+#define SVC_EVENT_MASK(topic) (1UL << (topic))
+
+// Topics whose data.buffer is held by the subscribers, each of them calls svcEventRelease() once done with it
+#define SVC_EVENT_BUFFER_TOPICS SVC_EVENT_MASK(SVC_EVENT_TIMETABLE_UPDATED)
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    SVC_EVENT_TIMETABLE_UPDATED, // data.buffer -> const PrayerTimetable *
+    SVC_EVENT_TIME_CHANGED,      // data.time   -> new epoch
+    SVC_EVENT_PRAYER_DUE,        // data.prayer -> prayer whose time has come
+    SVC_EVENT_DISPLAY_REQUEST,   // data.prayer -> next prayer to show
+    SVC_EVENT_SYNC_CHANGED,      // data.sync   -> BLE connection and timetable transfer
+    SVC_EVENT_DISPLAY_PREPARE,   // data.prepare -> prayer to show once the next one is due
+    SVC_EVENT_TOPIC_COUNT
+} svcEventTopic_t;
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    svcEventTopic_t topic;
+    union {
+        const void *buffer;
+        Prayer prayer;
+        int64_t time;
+        struct {
+            bool connected;
+            SyncStatus status;
+        } sync;
+        struct {
+            Prayer prayer;
+            int64_t prayerUtc; // Seconds since the epoch of the prayer
+            int64_t utc;       // Seconds since the epoch the prayer has to be shown at
+        } prepare;
+    } data;
+} svcEvent_t;
+
+typedef struct {
+    uint32_t published;
+    uint32_t delivered;
+    uint32_t dropped;
+    uint32_t depth;
+    uint32_t maxDepth;
+    uint8_t subscribers;
+} svcEventStats_t;
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Initialize the event bus and register its CLI commands
+/// \return true if the bus was initialized successfully, false otherwise
+bool svcEventInit();
+
+/// \brief Create a queue receiving every topic in the mask
+/// \param topicMask Combination of SVC_EVENT_MASK() values
+/// \param depth Number of events the queue can hold
+/// \return The subscriber queue, or nullptr if no slot is left
+QueueHandle_t svcEventSubscribe(uint32_t topicMask, UBaseType_t depth);
+
+/// \brief Deliver an event to every subscriber of its topic without blocking, also from an interrupt
+/// \param event The event to publish, copied into each subscriber queue
+/// \return true if every subscriber received the event, false if at least one copy was dropped
+bool svcEventPublish(const svcEvent_t *event);
+
+/// \brief Give back the buffer of a SVC_EVENT_BUFFER_TOPICS event, once the subscriber stopped reading it
+/// \param buffer The data.buffer of a received event, nullptr is ignored
+void svcEventRelease(const void *buffer);
+
+/// \brief Check whether a subscriber still holds a published buffer, the publisher only writes into free ones
+/// \param buffer The buffer to check
+/// \return true if a delivered copy was not released yet, false otherwise
+bool svcEventIsHeld(const void *buffer);
+
+/// \brief Find a timetable buffer no subscriber holds, the publishers double buffer their timetables so the one handed
+///        to the subscribers stays untouched while the next one is written
+/// \param timetables The buffers of the publisher
+/// \param count Number of buffers
+/// \param taken Buffer the publisher still owns although nobody holds it, nullptr if none
+/// \return The first free buffer, nullptr if every buffer is in use
+PrayerTimetable *svcEventFreeTimetable(PrayerTimetable *timetables, size_t count, const PrayerTimetable *taken);
+
+/// \brief Get the counters of a topic
+/// \param topic The topic to query
+/// \param stats Filled with the counters of the topic
+/// \return true if the topic is valid, false otherwise
+bool svcEventGetStats(svcEventTopic_t topic, svcEventStats_t *stats);
+
+/// \brief Get the printable name of a topic
+/// \param topic The topic to convert
+/// \return The name of the topic
+const char *svcEventTopicToString(svcEventTopic_t topic);
+
+#endif // SVC_EVENT_H
@@ -0,0 +1,130 @@
+/*===========================================================================*/
+/// \file svc_glyph.cpp
+///
+/// \brief
+///    Atlas of pre-shaped Arabic words and numerals
+///
+/// \details
+///     Every glyph is a row major bitmap stored as run lengths, alternating clear and set pixels and starting with
+///     clear. A run of 255 keeps the same color for the next byte, so longer runs are 255, 255, ..., rest.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_glyph.h"
+
+// Generated before the build by scripts/gen_glyph_atlas.py, empty when no font is configured
+#if __has_include(<svc_glyph_atlas.h>)
+#include <svc_glyph_atlas.h>
+#else
+#define SVC_GLYPH_ATLAS_COUNT 0
+static const svcGlyphEntry_t svcGlyphAtlasEntries[] = {
+    {0, 0, 0, 0},
+};
+static const uint8_t svcGlyphAtlasData[] = {0};
+#endif
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SVC_GLYPH_RUN_CONTINUE 255
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static const svcGlyphEntry_t *findEntry(svcGlyph_t glyph);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+bool svcGlyphAvailable() {
+    return SVC_GLYPH_ATLAS_COUNT == SVC_GLYPH_COUNT;
+}
+
+bool svcGlyphSize(svcGlyph_t glyph, uint8_t *width, uint8_t *height) {
+    const svcGlyphEntry_t *entry = findEntry(glyph);
+    if (entry == nullptr) {
+        return false;
+    }
+
+    *width = entry->width;
+    *height = entry->height;
+    return true;
+}
+
+bool svcGlyphDraw(svcGlyph_t glyph, int16_t x, int16_t y, svcGlyphSpan_t span, void *context) {
+    const svcGlyphEntry_t *entry = findEntry(glyph);
+    if (entry == nullptr) {
+        return false;
+    }
+
+    svcGlyphDecode(entry, svcGlyphAtlasData, x, y, span, context);
+    return true;
+}
+
+void svcGlyphDecode(const svcGlyphEntry_t *entry, const uint8_t *data, int16_t x, int16_t y, svcGlyphSpan_t span,
+                    void *context) {
+    const uint8_t *runs = &data[entry->offset];
+    uint16_t column = 0;
+    uint16_t row = 0;
+    bool set = false;
+    for (uint16_t i = 0; i < entry->length && row < entry->height; i++) {
+        uint16_t run = runs[i];
+        // Split the run at the row ends so a span never wraps
+        while (run > 0 && row < entry->height) {
+            const uint16_t length = run < entry->width - column ? run : entry->width - column;
+            if (set) {
+                span((int16_t) (x + column), (int16_t) (y + row), (int16_t) length, context);
+            }
+            column += length;
+            run -= length;
+            if (column == entry->width) {
+                column = 0;
+                row++;
+            }
+        }
+        if (runs[i] != SVC_GLYPH_RUN_CONTINUE) {
+            set = !set;
+        }
+    }
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+const svcGlyphEntry_t *findEntry(svcGlyph_t glyph) {
+    if (!svcGlyphAvailable() || glyph >= SVC_GLYPH_COUNT) {
+        return nullptr;
+    }
+    return &svcGlyphAtlasEntries[glyph];
+}
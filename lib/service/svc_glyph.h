@@ -0,0 +1,110 @@
+/*===========================================================================*/
+/// \file svc_glyph.h
+///
+/// \brief
+///    Atlas of pre-shaped Arabic words and numerals
+///
+/// \details
+///     The words shown on the screen are shaped and rendered on the build host (see scripts/gen_glyph_atlas.py) into
+///     run length encoded 1 bit bitmaps kept in flash. Drawing one only walks its runs, there is no shaping, bidi or
+///     font rasterizing on the device. Only plain C++ is used so the decoder can be checked on a host.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_GLYPH_H
+#define SVC_GLYPH_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+// Same order as VOCABULARY in scripts/gen_glyph_atlas.py, the prayers follow PrayerName
+typedef enum {
+    SVC_GLYPH_FAJR,
+    SVC_GLYPH_DHUHR,
+    SVC_GLYPH_ASR,
+    SVC_GLYPH_MAGHRIB,
+    SVC_GLYPH_ISHA,
+    SVC_GLYPH_NEXT_PRAYER,
+    SVC_GLYPH_REMAINING,
+    SVC_GLYPH_DIGIT_0, // Eastern Arabic digits, SVC_GLYPH_DIGIT_0 + n
+    SVC_GLYPH_DIGIT_9 = SVC_GLYPH_DIGIT_0 + 9,
+    SVC_GLYPH_COLON,
+    SVC_GLYPH_COUNT
+} svcGlyph_t;
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/// \brief Called for every horizontal run of set pixels of a drawn glyph
+typedef void (*svcGlyphSpan_t)(int16_t x, int16_t y, int16_t length, void *context);
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    uint8_t width;
+    uint8_t height;
+    uint16_t offset; // first run in the atlas data
+    uint16_t length; // bytes of runs
+} svcGlyphEntry_t;
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Check that the firmware was built with an atlas
+/// \return true if every glyph can be drawn, false if the build had no Arabic font
+bool svcGlyphAvailable();
+
+/// \brief Get the size of a glyph
+/// \param glyph The glyph
+/// \param width Filled with the width in pixels
+/// \param height Filled with the height in pixels, the same for every glyph so they share a baseline
+/// \return true if the glyph is in the atlas, false otherwise
+bool svcGlyphSize(svcGlyph_t glyph, uint8_t *width, uint8_t *height);
+
+/// \brief Draw a glyph by decoding its runs
+/// \param glyph The glyph
+/// \param x Left edge
+/// \param y Top edge
+/// \param span Called for every run of set pixels, runs never cross a row
+/// \param context Passed to the callback
+/// \return true if the glyph is in the atlas, false otherwise
+bool svcGlyphDraw(svcGlyph_t glyph, int16_t x, int16_t y, svcGlyphSpan_t span, void *context);
+
+/// \brief Decode the runs of an atlas entry, what svcGlyphDraw does with the generated atlas
+/// \param entry The entry, its offset indexes the data
+/// \param data The runs of the atlas
+/// \param x Left edge
+/// \param y Top edge
+/// \param span Called for every run of set pixels, runs never cross a row
+/// \param context Passed to the callback
+void svcGlyphDecode(const svcGlyphEntry_t *entry, const uint8_t *data, int16_t x, int16_t y, svcGlyphSpan_t span,
+                    void *context);
+
+#endif // SVC_GLYPH_H
@@ -0,0 +1,279 @@
+/*===========================================================================*/
+/// \file svc_log.cpp
+///
+/// \brief
+///    Service for logging without blocking the caller
+///
+/// \details
+///    Writers reserve a slot with a compare-and-swap and publish it with its sequence number, the drain task takes the
+///    oldest published record of all the rings and formats it, or sends it raw in binary mode
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_log.h"
+#include <svc_cli.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SVC_LOG_LINE_SIZE 160
+#define SVC_LOG_DRAIN_PERIOD_MS 20
+
+/*
+Binary record:
+[0]     - SVC_LOG_BINARY_SYNC
+[1]     - Level
+[2]     - Argument count
+[3-6]   - Time in ms, little endian
+[7-10]  - Format string address
+[11-]   - Arguments, 4 bytes each
+Then for each %s of the format, a length byte followed by the string
+*/
+#define SVC_LOG_BINARY_SYNC 0xA5
+#define SVC_LOG_BINARY_MAX_STRING 255
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    uint32_t sequence; // position + 1 once the record is complete
+    uint32_t timeMs;
+    const char *format;
+    uint8_t level;
+    uint8_t argCount;
+    uintptr_t args[SVC_LOG_MAX_ARGS];
+} LogRecord;
+
+typedef struct {
+    LogRecord records[SVC_LOG_RING_SIZE];
+    uint32_t reserved; // next position handed to a writer
+    uint32_t drained;  // next position read by the drain task
+    uint32_t written;
+    uint32_t dropped;
+} LogRing;
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static bool takeOldest(LogRecord *record);
+
+static void writeText(const LogRecord *record);
+
+static void writeBinary(const LogRecord *record);
+
+static void commandLog(cmd *c);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static LogRing rings[portNUM_PROCESSORS];
+static uint8_t runtimeLevel = SVC_LOG_LEVEL;
+static svcLogMode_t mode = SVC_LOG_MODE_TEXT;
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const char *const levelNames[] = {"NONE", "ERROR", "WARNING", "INFO", "DEBUG"};
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+bool svcLogInit() {
+    svcCliAddCmdHelp("log", "Show the log counters, or set [level <name>] [mode <text|binary>]");
+    svcCliGetCli0()->addBoundlessCommand("log", commandLog);
+    return true;
+}
+
+_Noreturn void svcLogTaskProcess(void *pvParameters) {
+    while (true) {
+        LogRecord record;
+        while (takeOldest(&record)) {
+            if (mode == SVC_LOG_MODE_BINARY) {
+                writeBinary(&record);
+            } else {
+                writeText(&record);
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(SVC_LOG_DRAIN_PERIOD_MS));
+    }
+}
+
+void svcLogRecord(uint8_t level, const char *format, const uintptr_t *args, uint8_t argCount) {
+    if (level > runtimeLevel) {
+        return;
+    }
+
+    // The core only picks the ring, a task moved to the other core in between is still safe with the CAS
+    LogRing &ring = rings[xPortGetCoreID()];
+    uint32_t position = __atomic_load_n(&ring.reserved, __ATOMIC_RELAXED);
+    do {
+        if (position - __atomic_load_n(&ring.drained, __ATOMIC_ACQUIRE) >= SVC_LOG_RING_SIZE) {
+            __atomic_fetch_add(&ring.dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&ring.reserved, &position, position + 1, true, __ATOMIC_ACQ_REL,
+                                          __ATOMIC_RELAXED));
+
+    LogRecord &record = ring.records[position % SVC_LOG_RING_SIZE];
+    record.timeMs = millis();
+    record.format = format;
+    record.level = level;
+    record.argCount = argCount;
+    for (uint8_t i = 0; i < argCount; i++) {
+        record.args[i] = args[i];
+    }
+    __atomic_fetch_add(&ring.written, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&record.sequence, position + 1, __ATOMIC_RELEASE);
+}
+
+void svcLogSetLevel(uint8_t level) {
+    runtimeLevel = level > SVC_LOG_LEVEL ? SVC_LOG_LEVEL : level;
+}
+
+void svcLogSetMode(svcLogMode_t newMode) {
+    mode = newMode;
+}
+
+bool svcLogGetStats(uint8_t core, svcLogStats_t *stats) {
+    if (core >= portNUM_PROCESSORS) {
+        return false;
+    }
+    stats->written = __atomic_load_n(&rings[core].written, __ATOMIC_RELAXED);
+    stats->dropped = __atomic_load_n(&rings[core].dropped, __ATOMIC_RELAXED);
+    return true;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+bool takeOldest(LogRecord *record) {
+    // Merge the rings by time, a record still being written stops its ring until the next pass
+    LogRing *oldest = nullptr;
+    for (LogRing &ring: rings) {
+        const LogRecord &head = ring.records[ring.drained % SVC_LOG_RING_SIZE];
+        if (__atomic_load_n(&head.sequence, __ATOMIC_ACQUIRE) != ring.drained + 1) {
+            continue;
+        }
+        if (oldest == nullptr ||
+            (int32_t) (head.timeMs - oldest->records[oldest->drained % SVC_LOG_RING_SIZE].timeMs) < 0) {
+            oldest = &ring;
+        }
+    }
+    if (oldest == nullptr) {
+        return false;
+    }
+
+    *record = oldest->records[oldest->drained % SVC_LOG_RING_SIZE];
+    __atomic_store_n(&oldest->drained, oldest->drained + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void writeText(const LogRecord *record) {
+    char line[SVC_LOG_LINE_SIZE];
+    int length = snprintf(line, sizeof(line), "[%lu.%03lu] [%s] : ", (unsigned long) (record->timeMs / 1000),
+                          (unsigned long) (record->timeMs % 1000), levelNames[record->level]);
+
+    // Every argument is a machine word, passing all of them lets printf pick the ones the format uses
+    const uintptr_t *a = record->args;
+    length += snprintf(line + length, sizeof(line) - length, record->format, a[0], a[1], a[2], a[3], a[4], a[5],
+                       a[6], a[7]);
+    if (length >= (int) sizeof(line)) {
+        length = sizeof(line) - 1;
+    }
+    // The formats of the call sites keep their trailing newline or not, every record gets exactly one
+    while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+        length--;
+    }
+    Serial.write((const uint8_t *) line, length);
+    Serial.write("\r\n");
+}
+
+void writeBinary(const LogRecord *record) {
+    uint8_t header[11 + SVC_LOG_MAX_ARGS * 4];
+    const uint32_t format = (uint32_t) (uintptr_t) record->format;
+    header[0] = SVC_LOG_BINARY_SYNC;
+    header[1] = record->level;
+    header[2] = record->argCount;
+    memcpy(&header[3], &record->timeMs, 4);
+    memcpy(&header[7], &format, 4);
+    for (uint8_t i = 0; i < record->argCount; i++) {
+        const uint32_t arg = (uint32_t) record->args[i];
+        memcpy(&header[11 + i * 4], &arg, 4);
+    }
+    Serial.write(header, 11 + record->argCount * 4);
+
+    // The host cannot read the strings of the device, they follow the record
+    uint8_t argIndex = 0;
+    for (const char *p = record->format; *p != '\0' && argIndex < record->argCount; p++) {
+        if (*p != '%') {
+            continue;
+        }
+        p++;
+        if (*p == '%') {
+            continue;
+        }
+        while (*p != '\0' && strchr("-+ #0123456789.lhzjt", *p) != nullptr) {
+            p++;
+        }
+        if (*p == 's') {
+            const char *string = (const char *) record->args[argIndex];
+            const size_t length = string == nullptr ? 0 : strnlen(string, SVC_LOG_BINARY_MAX_STRING);
+            const uint8_t lengthByte = length;
+            Serial.write(&lengthByte, 1);
+            Serial.write((const uint8_t *) string, length);
+        }
+        if (*p == '\0') {
+            break;
+        }
+        argIndex++;
+    }
+}
+
+void commandLog(cmd *c) {
+    Command cmd(c);
+    const int argCount = cmd.countArgs();
+    for (int i = 0; i + 1 < argCount; i += 2) {
+        const String key = cmd.getArgument(i).getValue();
+        const String value = cmd.getArgument(i + 1).getValue();
+        if (key == "mode") {
+            svcLogSetMode(value == "binary" ? SVC_LOG_MODE_BINARY : SVC_LOG_MODE_TEXT);
+        } else if (key == "level") {
+            for (uint8_t level = 0; level < sizeof(levelNames) / sizeof(levelNames[0]); level++) {
+                if (value.equalsIgnoreCase(levelNames[level])) {
+                    svcLogSetLevel(level);
+                }
+            }
+        }
+    }
+
+    svcCliOut()->printf("\r\nLevel %s (compiled up to %s), mode %s\r\n", levelNames[runtimeLevel],
+                        levelNames[SVC_LOG_LEVEL], mode == SVC_LOG_MODE_BINARY ? "binary" : "text");
+    for (uint8_t core = 0; core < portNUM_PROCESSORS; core++) {
+        svcLogStats_t stats;
+        svcLogGetStats(core, &stats);
+        svcCliOut()->printf("Core %u: %lu written, %lu dropped\r\n", core, (unsigned long) stats.written,
+                            (unsigned long) stats.dropped);
+    }
+}
@@ -0,0 +1,159 @@
+/*===========================================================================*/
+/// \file svc_log.h
+///
+/// \brief
+///    Service for logging without blocking the caller
+///
+/// \details
+///     A log call only stores the format string pointer and its raw arguments in a lock-free ring of the current core,
+///     the formatting and the UART output are done later by a low priority task. A full ring drops the record and
+///     counts it, the caller never waits, so the macros can be used from BLE callbacks and interrupts.
+///     Arguments are machine words: integers, characters and pointers. %s arguments are read when the record is
+///     formatted, they must point to strings that outlive the call (literals or static buffers). Levels above
+///     SVC_LOG_LEVEL are compiled out, the others can be filtered at runtime with the log command.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_LOG_H
+#define SVC_LOG_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+#include <type_traits>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SVC_LOG_LEVEL_NONE 0
+#define SVC_LOG_LEVEL_ERROR 1
+#define SVC_LOG_LEVEL_WARNING 2
+#define SVC_LOG_LEVEL_INFO 3
+#define SVC_LOG_LEVEL_DEBUG 4
+
+// Highest level compiled in, override with -D SVC_LOG_LEVEL=...
+#ifndef SVC_LOG_LEVEL
+#define SVC_LOG_LEVEL SVC_LOG_LEVEL_INFO
+#endif
+
+#define SVC_LOG_MAX_ARGS 8
+// Records per core, a power of two
+#define SVC_LOG_RING_SIZE 64
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+#if SVC_LOG_LEVEL >= SVC_LOG_LEVEL_ERROR
+#define SVC_LOG_ERROR(...) svcLogWrite(SVC_LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define SVC_LOG_ERROR(...) do {} while (0)
+#endif
+
+#if SVC_LOG_LEVEL >= SVC_LOG_LEVEL_WARNING
+#define SVC_LOG_WARNING(...) svcLogWrite(SVC_LOG_LEVEL_WARNING, __VA_ARGS__)
+#else
+#define SVC_LOG_WARNING(...) do {} while (0)
+#endif
+
+#if SVC_LOG_LEVEL >= SVC_LOG_LEVEL_INFO
+#define SVC_LOG_INFO(...) svcLogWrite(SVC_LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define SVC_LOG_INFO(...) do {} while (0)
+#endif
+
+#if SVC_LOG_LEVEL >= SVC_LOG_LEVEL_DEBUG
+#define SVC_LOG_DEBUG(...) svcLogWrite(SVC_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define SVC_LOG_DEBUG(...) do {} while (0)
+#endif
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    SVC_LOG_MODE_TEXT,  // formatted lines
+    SVC_LOG_MODE_BINARY // raw records for scripts/log_decode.py
+} svcLogMode_t;
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    uint32_t written;
+    uint32_t dropped;
+} svcLogStats_t;
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Register the log CLI command, records can be written before
+/// \return true if the service was initialized successfully, false otherwise
+bool svcLogInit();
+
+/// \brief Entry point of the task formatting the records to the UART
+/// \param[in] pvParameters - FreeRTOS task parameters
+_Noreturn void svcLogTaskProcess(void *pvParameters);
+
+/// \brief Store a record, use the SVC_LOG_* macros instead
+/// \param level Level of the record
+/// \param format printf format, must outlive the call
+/// \param args Raw arguments
+/// \param argCount Number of arguments
+void svcLogRecord(uint8_t level, const char *format, const uintptr_t *args, uint8_t argCount);
+
+/// \brief Set the highest level kept at runtime
+/// \param level One of the SVC_LOG_LEVEL_* values
+void svcLogSetLevel(uint8_t level);
+
+/// \brief Select how the records are written to the UART
+/// \param mode Text or binary
+void svcLogSetMode(svcLogMode_t mode);
+
+/// \brief Get the counters of a core ring
+/// \param core Core index
+/// \param stats Filled with the counters
+/// \return true if the core exists, false otherwise
+bool svcLogGetStats(uint8_t core, svcLogStats_t *stats);
+
+/*=============================================================================
+                                Template Functions
+=============================================================================*/
+
+template<typename T>
+inline uintptr_t svcLogArg(T value) {
+    static_assert(!std::is_floating_point<T>::value, "log arguments cannot be floating point");
+    static_assert(sizeof(T) <= sizeof(uintptr_t), "log arguments must fit a machine word, cast 64-bit values");
+    return (uintptr_t) value;
+}
+
+template<typename T>
+inline uintptr_t svcLogArg(T *value) {
+    return (uintptr_t) value;
+}
+
+template<typename... Args>
+inline void svcLogWrite(uint8_t level, const char *format, Args... args) {
+    static_assert(sizeof...(Args) <= SVC_LOG_MAX_ARGS, "too many log arguments");
+    const uintptr_t words[sizeof...(Args) + 1] = {svcLogArg(args)...};
+    svcLogRecord(level, format, words, sizeof...(Args));
+}
+
+#endif // SVC_LOG_H
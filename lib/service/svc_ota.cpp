@@ -0,0 +1,182 @@
+/*===========================================================================*/
+/// \file svc_ota.cpp
+///
+/// \brief
+///    Streaming firmware update session
+///
+/// \details
+///    Keep the expected offset and the erased area of the session, and verify the image from the partition content
+///    rather than from the received chunks so whatever is booted is exactly what was checked
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_ota.h"
+#include <mbedtls/sha256.h>
+#include <string.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SVC_OTA_READ_CHUNK_SIZE 512
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static bool hashPartition(svcOtaSession_t *session, uint8_t *digest);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const char *const statusNames[SVC_OTA_STATUS_COUNT] = {
+    "ok",
+    "resumed",
+    "no session",
+    "bad packet",
+    "too large",
+    "wrong offset",
+    "incomplete",
+    "flash error",
+    "hash mismatch",
+    "bad signature"
+};
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+svcOtaStatus_t svcOtaBegin(svcOtaSession_t *session, OtaPartition *partition, uint32_t imageSize,
+                           const uint8_t *digest, const uint8_t *signature, size_t signatureLength) {
+    if (imageSize == 0 || signatureLength == 0 || signatureLength > SVC_OTA_MAX_SIGNATURE_SIZE) {
+        return SVC_OTA_BAD_PACKET;
+    }
+    if (imageSize > partition->size()) {
+        return SVC_OTA_TOO_LARGE;
+    }
+
+    // The chunks already in flash are only worth keeping for the very same image
+    if (session->active && session->partition == partition && session->imageSize == imageSize &&
+        memcmp(session->digest, digest, SVC_OTA_DIGEST_SIZE) == 0) {
+        return SVC_OTA_RESUMED;
+    }
+
+    session->partition = partition;
+    session->imageSize = imageSize;
+    session->received = 0;
+    session->erasedEnd = 0;
+    memcpy(session->digest, digest, SVC_OTA_DIGEST_SIZE);
+    memcpy(session->signature, signature, signatureLength);
+    session->signatureLength = (uint8_t) signatureLength;
+    session->active = true;
+    session->verified = false;
+    return SVC_OTA_OK;
+}
+
+svcOtaStatus_t svcOtaWrite(svcOtaSession_t *session, uint32_t offset, const uint8_t *data, size_t length) {
+    if (!session->active) {
+        return SVC_OTA_NO_SESSION;
+    }
+    if (offset != session->received) {
+        return SVC_OTA_WRONG_OFFSET;
+    }
+    if (length > session->imageSize - offset) {
+        return SVC_OTA_TOO_LARGE;
+    }
+
+    const uint32_t end = offset + length;
+    if (end > session->erasedEnd) {
+        const uint32_t eraseEnd = (end + SVC_OTA_SECTOR_SIZE - 1) / SVC_OTA_SECTOR_SIZE * SVC_OTA_SECTOR_SIZE;
+        if (!session->partition->erase(session->erasedEnd, eraseEnd - session->erasedEnd)) {
+            return SVC_OTA_FLASH_ERROR;
+        }
+        session->erasedEnd = eraseEnd;
+    }
+
+    if (!session->partition->write(offset, data, length)) {
+        return SVC_OTA_FLASH_ERROR;
+    }
+    session->received = end;
+    return SVC_OTA_OK;
+}
+
+svcOtaStatus_t svcOtaFinish(svcOtaSession_t *session, svcOtaVerifier_t verify) {
+    if (!session->active) {
+        return SVC_OTA_NO_SESSION;
+    }
+    if (session->received != session->imageSize) {
+        return SVC_OTA_INCOMPLETE;
+    }
+
+    // Whatever happens next the image has to be sent again from the start
+    session->active = false;
+
+    uint8_t digest[SVC_OTA_DIGEST_SIZE];
+    if (!hashPartition(session, digest)) {
+        return SVC_OTA_FLASH_ERROR;
+    }
+    if (memcmp(digest, session->digest, SVC_OTA_DIGEST_SIZE) != 0) {
+        return SVC_OTA_HASH_MISMATCH;
+    }
+    if (!verify(digest, session->signature, session->signatureLength)) {
+        return SVC_OTA_BAD_SIGNATURE;
+    }
+
+    session->verified = true;
+    return SVC_OTA_OK;
+}
+
+void svcOtaAbort(svcOtaSession_t *session) {
+    session->active = false;
+    session->verified = false;
+}
+
+const char *svcOtaStatusToString(svcOtaStatus_t status) {
+    if (status >= SVC_OTA_STATUS_COUNT) {
+        return "unknown";
+    }
+    return statusNames[status];
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+bool hashPartition(svcOtaSession_t *session, uint8_t *digest) {
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    bool hashed = mbedtls_sha256_starts_ret(&sha, 0) == 0;
+
+    uint8_t chunk[SVC_OTA_READ_CHUNK_SIZE];
+    for (uint32_t offset = 0; hashed && offset < session->imageSize; offset += sizeof(chunk)) {
+        const size_t length = session->imageSize - offset < sizeof(chunk) ? session->imageSize - offset : sizeof(chunk);
+        hashed = session->partition->read(offset, chunk, length) && mbedtls_sha256_update_ret(&sha, chunk, length) == 0;
+    }
+    hashed = hashed && mbedtls_sha256_finish_ret(&sha, digest) == 0;
+    mbedtls_sha256_free(&sha);
+    return hashed;
+}
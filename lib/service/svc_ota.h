@@ -0,0 +1,148 @@
+/*===========================================================================*/
+/// \file svc_ota.h
+///
+/// \brief
+///    Streaming firmware update session
+///
+/// \details
+///     Chunks are written straight into the inactive partition at their offset, sectors are erased just before the
+///     first chunk reaching them, nothing is buffered. Only the next expected offset is accepted, so after a dropped
+///     connection the sender starts again with the same image and carries on from the offset it is given back.
+///     Once every byte arrived the partition is read back and hashed, the digest must match the announced one and its
+///     signature must be accepted by the verifier before the image counts as verified. Besides mbedTLS, which hashes on
+///     the SHA accelerator of the chip, only plain C++ is used so the session can be driven on a host against a
+///     partition backed by a file.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_OTA_H
+#define SVC_OTA_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SVC_OTA_SECTOR_SIZE 4096
+// SHA-256 of the image
+#define SVC_OTA_DIGEST_SIZE 32
+// DER encoded ECDSA P-256 signature
+#define SVC_OTA_MAX_SIGNATURE_SIZE 72
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    SVC_OTA_OK,
+    SVC_OTA_RESUMED,        // Same image as the session in progress, carry on from the returned offset
+    SVC_OTA_NO_SESSION,
+    SVC_OTA_BAD_PACKET,
+    SVC_OTA_TOO_LARGE,      // Image or chunk past the end of the partition or of the image
+    SVC_OTA_WRONG_OFFSET,   // Chunk not at the expected offset
+    SVC_OTA_INCOMPLETE,     // Finished before every byte arrived
+    SVC_OTA_FLASH_ERROR,
+    SVC_OTA_HASH_MISMATCH,
+    SVC_OTA_BAD_SIGNATURE,
+    SVC_OTA_STATUS_COUNT
+} svcOtaStatus_t;
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/// \brief Check the signature of an image digest
+/// \return true if the signature was made by the release key, false otherwise
+typedef bool (*svcOtaVerifier_t)(const uint8_t *digest, const uint8_t *signature, size_t length);
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    class OtaPartition *partition;
+    uint32_t imageSize;
+    uint32_t received;  // next expected offset
+    uint32_t erasedEnd; // first byte not erased yet
+    uint8_t digest[SVC_OTA_DIGEST_SIZE];
+    uint8_t signature[SVC_OTA_MAX_SIGNATURE_SIZE];
+    uint8_t signatureLength;
+    bool active;
+    bool verified;
+} svcOtaSession_t;
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+/// Flash area receiving the image, offsets are relative to its start
+class OtaPartition {
+public:
+    virtual ~OtaPartition() = default;
+
+    virtual uint32_t size() const = 0;
+
+    /// \brief Erase whole sectors, offset and length are multiples of SVC_OTA_SECTOR_SIZE
+    virtual bool erase(uint32_t offset, uint32_t length) = 0;
+
+    virtual bool write(uint32_t offset, const uint8_t *data, size_t length) = 0;
+
+    virtual bool read(uint32_t offset, uint8_t *data, size_t length) = 0;
+};
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Start an update, or resume the one in progress when the image is the same
+/// \param session The session
+/// \param partition The inactive partition, must stay valid until the session ends
+/// \param imageSize Bytes in the image
+/// \param digest SHA-256 of the image, SVC_OTA_DIGEST_SIZE bytes
+/// \param signature Signature of the digest
+/// \param signatureLength Bytes in the signature, up to SVC_OTA_MAX_SIGNATURE_SIZE
+/// \return SVC_OTA_OK for a new session, SVC_OTA_RESUMED to continue from session->received, an error otherwise
+svcOtaStatus_t svcOtaBegin(svcOtaSession_t *session, OtaPartition *partition, uint32_t imageSize,
+                           const uint8_t *digest, const uint8_t *signature, size_t signatureLength);
+
+/// \brief Write the next chunk of the image
+/// \param session The session
+/// \param offset Position of the chunk in the image, must be session->received
+/// \param data The chunk
+/// \param length Bytes in the chunk
+/// \return SVC_OTA_OK if the chunk was written, an error otherwise
+svcOtaStatus_t svcOtaWrite(svcOtaSession_t *session, uint32_t offset, const uint8_t *data, size_t length);
+
+/// \brief Read the image back and check its digest and signature
+/// \param session The session, ends unless it was only incomplete
+/// \param verify Checks the signature of the digest
+/// \return SVC_OTA_OK if the image is verified and may be booted, an error otherwise
+svcOtaStatus_t svcOtaFinish(svcOtaSession_t *session, svcOtaVerifier_t verify);
+
+/// \brief Drop the session, the next begin starts from scratch
+/// \param session The session
+void svcOtaAbort(svcOtaSession_t *session);
+
+/// \brief Get the printable name of a status
+/// \param status The status to convert
+/// \return The name of the status
+const char *svcOtaStatusToString(svcOtaStatus_t status);
+
+#endif // SVC_OTA_H
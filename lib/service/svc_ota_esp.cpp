@@ -0,0 +1,127 @@
+/*===========================================================================*/
+/// \file svc_ota_esp.cpp
+///
+/// \brief
+///    Firmware update session on the ESP32 app partitions
+///
+/// \details
+///    Flash access goes through the partition API so offsets can never leave the target partition, the signature is
+///    checked with mbedTLS and the rollback relies on the bootloader's pending verification state
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_ota_esp.h"
+#include <mbedtls/pk.h>
+
+// Generated before the build by scripts/gen_ota_key.py, empty when no key is configured
+#if __has_include(<svc_ota_key.h>)
+#include <svc_ota_key.h>
+#else
+#define SVC_OTA_KEY_SIZE 0
+static const uint8_t svcOtaPublicKey[] = {0};
+#endif
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+// Called by the Arduino core before setup(), the image is only confirmed once the firmware proved it can run
+extern "C" bool verifyRollbackLater() {
+    return true;
+}
+
+bool EspOtaPartition::begin() {
+    partition = esp_ota_get_next_update_partition(nullptr);
+    return partition != nullptr;
+}
+
+uint32_t EspOtaPartition::size() const {
+    return partition != nullptr ? partition->size : 0;
+}
+
+bool EspOtaPartition::erase(uint32_t offset, uint32_t length) {
+    return esp_partition_erase_range(partition, offset, length) == ESP_OK;
+}
+
+bool EspOtaPartition::write(uint32_t offset, const uint8_t *data, size_t length) {
+    return esp_partition_write(partition, offset, data, length) == ESP_OK;
+}
+
+bool EspOtaPartition::read(uint32_t offset, uint8_t *data, size_t length) {
+    return esp_partition_read(partition, offset, data, length) == ESP_OK;
+}
+
+bool svcOtaEspHasKey() {
+    return SVC_OTA_KEY_SIZE > 0;
+}
+
+bool svcOtaEspVerify(const uint8_t *digest, const uint8_t *signature, size_t length) {
+    if (!svcOtaEspHasKey()) {
+        return false;
+    }
+
+    mbedtls_pk_context key;
+    mbedtls_pk_init(&key);
+    const bool valid = mbedtls_pk_parse_public_key(&key, svcOtaPublicKey, SVC_OTA_KEY_SIZE) == 0 &&
+                       mbedtls_pk_verify(&key, MBEDTLS_MD_SHA256, digest, SVC_OTA_DIGEST_SIZE, signature, length) == 0;
+    mbedtls_pk_free(&key);
+    return valid;
+}
+
+bool svcOtaEspApply(EspOtaPartition *target) {
+    // Also checks the image header and segments before accepting it
+    return esp_ota_set_boot_partition(target->partition) == ESP_OK;
+}
+
+void svcOtaEspConfirmBoot(bool healthy) {
+    esp_ota_img_states_t state;
+    if (esp_ota_get_state_partition(esp_ota_get_running_partition(), &state) != ESP_OK ||
+        state != ESP_OTA_IMG_PENDING_VERIFY) {
+        return;
+    }
+
+    if (healthy) {
+        esp_ota_mark_app_valid_cancel_rollback();
+    } else {
+        esp_ota_mark_app_invalid_rollback_and_reboot();
+    }
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
@@ -0,0 +1,98 @@
+/*===========================================================================*/
+/// \file svc_ota_esp.h
+///
+/// \brief
+///    Firmware update session on the ESP32 app partitions
+///
+/// \details
+///     The inactive app partition as the OTA target, the signature check against the key generated at build time
+///     (see scripts/gen_ota_key.py), and the boot switch with rollback: a new image boots pending verification and
+///     goes back to the previous one unless it confirms itself healthy before the next reset.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_OTA_ESP_H
+#define SVC_OTA_ESP_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+#include <esp_ota_ops.h>
+#include <svc_ota.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+/// The app partition the running firmware did not boot from
+class EspOtaPartition : public OtaPartition {
+public:
+    /// \brief Pick the partition after the running one
+    /// \return true if the table has a second app partition, false otherwise
+    bool begin();
+
+    uint32_t size() const override;
+
+    bool erase(uint32_t offset, uint32_t length) override;
+
+    bool write(uint32_t offset, const uint8_t *data, size_t length) override;
+
+    bool read(uint32_t offset, uint8_t *data, size_t length) override;
+
+    const esp_partition_t *partition = nullptr;
+};
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Check that the firmware was built with a release key
+/// \return true if updates can be verified, false if every update will be refused
+bool svcOtaEspHasKey();
+
+/// \brief Check the ECDSA P-256 signature of an image digest with the release key
+/// \param digest SHA-256 of the image
+/// \param signature DER encoded signature
+/// \param length Bytes in the signature
+/// \return true if the signature is valid, false otherwise
+bool svcOtaEspVerify(const uint8_t *digest, const uint8_t *signature, size_t length);
+
+/// \brief Boot the verified image on the next reset
+/// \param target The partition holding the image
+/// \return true if the boot partition was switched, false if the bootloader rejected the image
+bool svcOtaEspApply(EspOtaPartition *target);
+
+/// \brief Confirm or reject the running image when it was booted for the first time after an update
+/// \param healthy true to keep it, false to reboot into the previous image
+void svcOtaEspConfirmBoot(bool healthy);
+
+#endif // SVC_OTA_ESP_H
@@ -0,0 +1,342 @@
+/*===========================================================================*/
+/// \file svc_power.cpp
+///
+/// \brief
+///    Service for the power state residency and the energy estimate
+///
+/// \details
+///    A domain keeps its state and the time it entered it, a transition adds the elapsed time to the residency of
+///    the state it leaves. The CPU residencies grow by one tick at every tick interrupt of their core. The
+///    residencies are kept in RTC memory: a boot after a timed deep sleep adds the sleep to them instead of starting
+///    a new window, any other boot starts one.
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_power.h"
+#include <esp_attr.h>
+#include <esp_freertos_hooks.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <svc_cli.h>
+#include <svc_config.h>
+#include <svc_display.h>
+#include <svc_log.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define TICK_US (portTICK_PERIOD_MS * 1000)
+#define HOURS_PER_DAY 24
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static void tickHook();
+
+static void accumulate(int64_t nowUs);
+
+static uint32_t displayFrames();
+
+static int findState(const char *name);
+
+static void printReport();
+
+static void commandPower(cmd *c);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+// Survive deep sleep, the window goes on across it
+static RTC_DATA_ATTR uint64_t residencyUs[SVC_POWER_STATE_COUNT];
+static RTC_DATA_ATTR uint64_t deepSleepUs = 0;  // Requested by the sleep the device is waking from
+static RTC_DATA_ATTR uint32_t earlierFrames = 0; // Flushed in the window before the last deep sleep
+
+static svcPowerState_t currentStates[SVC_POWER_DOMAIN_COUNT];
+static int64_t sinceUs[SVC_POWER_DOMAIN_COUNT];
+static uint32_t windowFirstFrame = 0;
+static portMUX_TYPE powerLock = portMUX_INITIALIZER_UNLOCKED;
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const svcPowerDomain_t stateDomains[SVC_POWER_STATE_COUNT] = {
+    SVC_POWER_CPU0, SVC_POWER_CPU0,
+    SVC_POWER_CPU1, SVC_POWER_CPU1,
+    SVC_POWER_BLE, SVC_POWER_BLE, SVC_POWER_BLE,
+    SVC_POWER_SCAN, SVC_POWER_SCAN,
+    SVC_POWER_WIFI, SVC_POWER_WIFI,
+    SVC_POWER_DISPLAY, SVC_POWER_DISPLAY,
+    SVC_POWER_AUDIO, SVC_POWER_AUDIO,
+    SVC_POWER_SLEEP, SVC_POWER_SLEEP, SVC_POWER_SLEEP
+};
+
+static const svcPowerState_t initialStates[SVC_POWER_DOMAIN_COUNT] = {
+    SVC_POWER_CPU0_ACTIVE,
+    SVC_POWER_CPU1_ACTIVE,
+    SVC_POWER_BLE_OFF,
+    SVC_POWER_SCAN_OFF,
+    SVC_POWER_WIFI_OFF,
+    SVC_POWER_DISPLAY_OFF,
+    SVC_POWER_AUDIO_OFF,
+    SVC_POWER_AWAKE
+};
+
+static const char *stateNames[SVC_POWER_STATE_COUNT] = {
+    "cpu0_active",
+    "cpu0_idle",
+    "cpu1_active",
+    "cpu1_idle",
+    "ble_off",
+    "ble_adv",
+    "ble_conn",
+    "scan_off",
+    "scan_on",
+    "wifi_off",
+    "wifi_on",
+    "display_off",
+    "display_on",
+    "audio_off",
+    "audio_on",
+    "awake",
+    "light_sleep",
+    "deep_sleep"
+};
+
+static_assert(SVC_POWER_STATE_COUNT == SVC_CONFIG_POWER_TABLE_SIZE, "One current per power state");
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+bool svcPowerInit() {
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER && deepSleepUs > 0) {
+        residencyUs[SVC_POWER_DEEP_SLEEP] += deepSleepUs;
+    } else {
+        memset(residencyUs, 0, sizeof(residencyUs));
+        earlierFrames = 0;
+    }
+    deepSleepUs = 0;
+
+    // From 0, the boot so far counts as awake
+    for (int domain = 0; domain < SVC_POWER_DOMAIN_COUNT; domain++) {
+        currentStates[domain] = initialStates[domain];
+        sinceUs[domain] = 0;
+    }
+
+    bool status = true;
+    for (UBaseType_t core = 0; core < portNUM_PROCESSORS; core++) {
+        status = esp_register_freertos_tick_hook_for_cpu(tickHook, core) == ESP_OK && status;
+    }
+
+    svcCliAddCmdHelp("power", "Show the power state residency and the average current "
+                              "[reset | current <state> <uA> | sleep <light | deep> <ms>]");
+    svcCliGetCli0()->addBoundlessCommand("power", commandPower);
+    return status;
+}
+
+void svcPowerEnter(svcPowerState_t state) {
+    if (state >= SVC_POWER_STATE_COUNT) {
+        return;
+    }
+    const svcPowerDomain_t domain = stateDomains[state];
+    if (domain == SVC_POWER_CPU0 || domain == SVC_POWER_CPU1) {
+        return;
+    }
+
+    const int64_t nowUs = esp_timer_get_time();
+    portENTER_CRITICAL(&powerLock);
+    residencyUs[currentStates[domain]] += nowUs - sinceUs[domain];
+    sinceUs[domain] = nowUs;
+    currentStates[domain] = state;
+    portEXIT_CRITICAL(&powerLock);
+}
+
+void svcPowerGetReport(svcPowerReport_t *report) {
+    const int64_t nowUs = esp_timer_get_time();
+    uint64_t residency[SVC_POWER_STATE_COUNT];
+    portENTER_CRITICAL(&powerLock);
+    memcpy(residency, residencyUs, sizeof(residency));
+    for (int domain = SVC_POWER_BLE; domain < SVC_POWER_DOMAIN_COUNT; domain++) {
+        residency[currentStates[domain]] += nowUs - sinceUs[domain];
+    }
+    portEXIT_CRITICAL(&powerLock);
+
+    // uA ms, a year at 1 A still fits
+    uint64_t charge = 0;
+    const uint32_t *currents = svcConfigGet()->powerCurrentsUa;
+    for (int state = 0; state < SVC_POWER_STATE_COUNT; state++) {
+        report->residencyMs[state] = residency[state] / 1000;
+        charge += report->residencyMs[state] * currents[state];
+    }
+    report->windowMs = report->residencyMs[SVC_POWER_AWAKE] + report->residencyMs[SVC_POWER_LIGHT_SLEEP] +
+                       report->residencyMs[SVC_POWER_DEEP_SLEEP];
+    report->averageUa = report->windowMs > 0 ? (uint32_t) (charge / report->windowMs) : 0;
+    report->displayFrames = earlierFrames + displayFrames() - windowFirstFrame;
+}
+
+void svcPowerReset() {
+    const int64_t nowUs = esp_timer_get_time();
+    portENTER_CRITICAL(&powerLock);
+    memset(residencyUs, 0, sizeof(residencyUs));
+    for (int domain = 0; domain < SVC_POWER_DOMAIN_COUNT; domain++) {
+        sinceUs[domain] = nowUs;
+    }
+    portEXIT_CRITICAL(&powerLock);
+    earlierFrames = 0;
+    windowFirstFrame = displayFrames();
+}
+
+bool svcPowerLightSleep(uint32_t durationMs) {
+    svcPowerEnter(SVC_POWER_LIGHT_SLEEP);
+    esp_sleep_enable_timer_wakeup((uint64_t) durationMs * 1000);
+    // The timer keeps counting through light sleep, the time spent shows up at the next transition
+    const bool slept = esp_light_sleep_start() == ESP_OK;
+    svcPowerEnter(SVC_POWER_AWAKE);
+    return slept;
+}
+
+void svcPowerDeepSleep(uint32_t durationMs) {
+    accumulate(esp_timer_get_time());
+    earlierFrames += displayFrames() - windowFirstFrame;
+    deepSleepUs = (uint64_t) durationMs * 1000;
+    esp_sleep_enable_timer_wakeup(deepSleepUs);
+    esp_deep_sleep_start();
+}
+
+const char *svcPowerStateToString(svcPowerState_t state) {
+    if (state >= SVC_POWER_STATE_COUNT) {
+        return "unknown";
+    }
+    return stateNames[state];
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+void IRAM_ATTR tickHook() {
+    const BaseType_t core = xPortGetCoreID();
+    const bool idle = xTaskGetCurrentTaskHandleForCPU(core) == xTaskGetIdleTaskHandleForCPU(core);
+    const svcPowerState_t state = core == 0 ? (idle ? SVC_POWER_CPU0_IDLE : SVC_POWER_CPU0_ACTIVE)
+                                            : (idle ? SVC_POWER_CPU1_IDLE : SVC_POWER_CPU1_ACTIVE);
+    portENTER_CRITICAL_ISR(&powerLock);
+    residencyUs[state] += TICK_US;
+    portEXIT_CRITICAL_ISR(&powerLock);
+}
+
+void accumulate(int64_t nowUs) {
+    portENTER_CRITICAL(&powerLock);
+    for (int domain = SVC_POWER_BLE; domain < SVC_POWER_DOMAIN_COUNT; domain++) {
+        residencyUs[currentStates[domain]] += nowUs - sinceUs[domain];
+        sinceUs[domain] = nowUs;
+    }
+    portEXIT_CRITICAL(&powerLock);
+}
+
+uint32_t displayFrames() {
+    svcDisplayFlushStats_t stats;
+    svcDisplayGetFlushStats(&stats);
+    return stats.frames;
+}
+
+int findState(const char *name) {
+    for (int state = 0; state < SVC_POWER_STATE_COUNT; state++) {
+        if (strcmp(stateNames[state], name) == 0) {
+            return state;
+        }
+    }
+    return -1;
+}
+
+void printReport() {
+    svcPowerReport_t report;
+    svcPowerGetReport(&report);
+    const uint32_t *currents = svcConfigGet()->powerCurrentsUa;
+
+    svcCliOut()->printf("Window %llu s, estimated average %lu.%01lu mA, %lu mAh per day\r\n",
+                        (unsigned long long) (report.windowMs / 1000), (unsigned long) (report.averageUa / 1000),
+                        (unsigned long) (report.averageUa % 1000 / 100),
+                        (unsigned long) ((uint64_t) report.averageUa * HOURS_PER_DAY / 1000));
+    svcCliOut()->printf("%-12s | %-10s | %-7s | %-8s\r\n", "State", "Time (s)", "Share", "Current");
+    for (int state = 0; state < SVC_POWER_STATE_COUNT; state++) {
+        const uint64_t ms = report.residencyMs[state];
+        const uint32_t permille = report.windowMs > 0 ? (uint32_t) (ms * 1000 / report.windowMs) : 0;
+        svcCliOut()->printf("%-12s | %-10llu | %3lu.%01lu %% | %lu.%01lu mA\r\n", stateNames[state],
+                            (unsigned long long) (ms / 1000), (unsigned long) (permille / 10),
+                            (unsigned long) (permille % 10), (unsigned long) (currents[state] / 1000),
+                            (unsigned long) (currents[state] % 1000 / 100));
+    }
+    const uint32_t centiHz = report.windowMs > 0 ? (uint32_t) ((uint64_t) report.displayFrames * 100000 /
+                                                                report.windowMs) : 0;
+    svcCliOut()->printf("Display refresh %lu.%02lu Hz, %lu frames\r\n", (unsigned long) (centiHz / 100),
+                        (unsigned long) (centiHz % 100), (unsigned long) report.displayFrames);
+}
+
+void commandPower(cmd *c) {
+    Command cmd(c);
+    svcCliOut()->write("\r\n");
+    const String action = cmd.countArgs() > 0 ? cmd.getArgument(0).getValue() : String("");
+
+    if (action == "" && cmd.countArgs() == 0) {
+        printReport();
+        return;
+    }
+    if (action == "reset" && cmd.countArgs() == 1) {
+        svcPowerReset();
+        svcCliOut()->println("New window started");
+        return;
+    }
+    if (action == "current" && cmd.countArgs() == 3) {
+        const int state = findState(cmd.getArgument(1).getValue().c_str());
+        char *end;
+        const long long current = strtoll(cmd.getArgument(2).getValue().c_str(), &end, 0);
+        if (state < 0 || *end != '\0' ||
+            !svcConfigSetTableEntry(SVC_CONFIG_POWER_CURRENTS, state, current)) {
+            svcCliOut()->println("Invalid state or current");
+            return;
+        }
+        svcCliOut()->printf("%s draws %lld uA\n", stateNames[state], current);
+        return;
+    }
+    if (action == "sleep" && cmd.countArgs() == 3) {
+        const String mode = cmd.getArgument(1).getValue();
+        const long durationMs = cmd.getArgument(2).getValue().toInt();
+        if (durationMs > 0 && mode == "light") {
+            // The UART stops while the chip sleeps
+            Serial.flush();
+            const bool slept = svcPowerLightSleep(durationMs);
+            svcCliOut()->println(slept ? "Awake" : "Light sleep rejected");
+            return;
+        }
+        if (durationMs > 0 && mode == "deep") {
+            SVC_LOG_INFO("Deep sleep for %lu ms", (unsigned long) durationMs);
+            // The log task needs a moment to write it out
+            vTaskDelay(pdMS_TO_TICKS(100));
+            svcPowerDeepSleep(durationMs);
+        }
+    }
+    svcCliOut()->println("Usage: power [reset | current <state> <uA> | sleep <light | deep> <ms>]");
+}
@@ -0,0 +1,127 @@
+/*===========================================================================*/
+/// \file svc_power.h
+///
+/// \brief
+///    Service for the power state residency and the energy estimate
+///
+/// \details
+///     The power of the device is split in domains (each CPU core, BLE, the BLE scan, Wi-Fi, the display, the audio
+///     output, sleep), each in exactly one state at a time. The modules report the transitions, the service adds the
+///     time spent in each state. The CPU cores are sampled by the tick interrupt instead, whether the idle task is
+///     running. Multiplied by the current of each state (the power_ua setting) this gives the average draw, to size
+///     the supply of a site and to compare firmware changes. The counters survive deep sleep.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_POWER_H
+#define SVC_POWER_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    SVC_POWER_CPU0,
+    SVC_POWER_CPU1,
+    SVC_POWER_BLE,
+    SVC_POWER_SCAN,
+    SVC_POWER_WIFI,
+    SVC_POWER_DISPLAY,
+    SVC_POWER_AUDIO,
+    SVC_POWER_SLEEP,
+    SVC_POWER_DOMAIN_COUNT
+} svcPowerDomain_t;
+
+/// Grouped by domain, the first state of a domain is the one it starts in
+typedef enum {
+    SVC_POWER_CPU0_ACTIVE,
+    SVC_POWER_CPU0_IDLE,
+    SVC_POWER_CPU1_ACTIVE,
+    SVC_POWER_CPU1_IDLE,
+    SVC_POWER_BLE_OFF,
+    SVC_POWER_BLE_ADVERTISING,
+    SVC_POWER_BLE_CONNECTED,
+    SVC_POWER_SCAN_OFF,
+    SVC_POWER_SCAN_ON,
+    SVC_POWER_WIFI_OFF,
+    SVC_POWER_WIFI_ON,
+    SVC_POWER_DISPLAY_OFF,
+    SVC_POWER_DISPLAY_ON,
+    SVC_POWER_AUDIO_OFF,
+    SVC_POWER_AUDIO_ON,
+    SVC_POWER_AWAKE,
+    SVC_POWER_LIGHT_SLEEP,
+    SVC_POWER_DEEP_SLEEP,
+    SVC_POWER_STATE_COUNT
+} svcPowerState_t;
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    uint64_t residencyMs[SVC_POWER_STATE_COUNT];
+    uint64_t windowMs;      // Since power on or the last reset, the residencies of the sleep domain add up to it
+    uint32_t displayFrames; // Frames flushed in the window, for the refresh rate
+    uint32_t averageUa;     // Estimated average current over the window
+} svcPowerReport_t;
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Start the accounting, called once the configuration is loaded
+/// \return true if the CPU sampling started, false otherwise
+bool svcPowerInit();
+
+/// \brief Report a transition, a state of a domain replaces the current state of that domain
+/// \param state The new state, not a CPU state
+void svcPowerEnter(svcPowerState_t state);
+
+/// \brief Get the residencies and the estimate over the current window
+/// \param report Filled with the snapshot
+void svcPowerGetReport(svcPowerReport_t *report);
+
+/// \brief Start a new window, the residencies are cleared
+void svcPowerReset();
+
+/// \brief Sleep in light sleep, accounted as such
+/// \param durationMs Time to sleep
+/// \return true if the chip slept, false if the sleep was rejected
+bool svcPowerLightSleep(uint32_t durationMs);
+
+/// \brief Sleep in deep sleep, the device boots again afterwards with the counters kept
+/// \param durationMs Time to sleep
+void svcPowerDeepSleep(uint32_t durationMs);
+
+/// \brief Get the printable name of a state, also its name in the CLI
+/// \param state The state to convert
+/// \return The name of the state
+const char *svcPowerStateToString(svcPowerState_t state);
+
+#endif // SVC_POWER_H
@@ -0,0 +1,288 @@
+/*===========================================================================*/
+/// \file svc_protocol.cpp
+///
+/// \brief
+///    Decoder of the timings protocol packets written by the mobile application
+///
+/// \details
+///    Check the length and the ranges of each packet type before decoding it
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_protocol.h"
+#include <string.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static svcProtocolStatus_t decodeNumberOfDays(const uint8_t *data, svcProtocolPacket_t *packet);
+
+static svcProtocolStatus_t decodeUpdateOfDays(const uint8_t *data, svcProtocolPacket_t *packet);
+
+static svcProtocolStatus_t decodePrayerTimings(const uint8_t *data, svcProtocolPacket_t *packet);
+
+static svcProtocolStatus_t decodeCurrentTime(const uint8_t *data, svcProtocolPacket_t *packet);
+
+static svcProtocolStatus_t decodeTimeExchange(const uint8_t *data, svcProtocolPacket_t *packet);
+
+static bool isClockTime(uint8_t hour, uint8_t minute);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const char *const statusNames[SVC_PROTOCOL_STATUS_COUNT] = {
+    "ok",
+    "empty",
+    "unknown header",
+    "too short",
+    "out of range"
+};
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+svcProtocolStatus_t svcProtocolDecode(const uint8_t *data, size_t length, svcProtocolPacket_t *packet) {
+    if (data == nullptr || length == 0) {
+        return SVC_PROTOCOL_EMPTY;
+    }
+
+    packet->header = data[0];
+    switch (data[0]) {
+        case NUMBER_OF_DAYS_HEADER:
+            if (length < SVC_PROTOCOL_NUMBER_OF_DAYS_SIZE) {
+                return SVC_PROTOCOL_TOO_SHORT;
+            }
+            return decodeNumberOfDays(data, packet);
+        case UPDATE_OF_DAYS_HEADER:
+            if (length < SVC_PROTOCOL_UPDATE_OF_DAYS_SIZE) {
+                return SVC_PROTOCOL_TOO_SHORT;
+            }
+            return decodeUpdateOfDays(data, packet);
+        case PRAYER_TIMINGS_HEADER:
+            if (length < SVC_PROTOCOL_PRAYER_TIMINGS_SIZE) {
+                return SVC_PROTOCOL_TOO_SHORT;
+            }
+            return decodePrayerTimings(data, packet);
+        case END_OF_TIMINGS_HEADER:
+            return SVC_PROTOCOL_OK;
+        case CURRENT_TIME_HEADER:
+            if (length < SVC_PROTOCOL_CURRENT_TIME_SIZE) {
+                return SVC_PROTOCOL_TOO_SHORT;
+            }
+            return decodeCurrentTime(data, packet);
+        case TIME_REQUEST_HEADER:
+        case TIME_RESULT_HEADER:
+            if (length < SVC_PROTOCOL_TIME_EXCHANGE_SIZE) {
+                return SVC_PROTOCOL_TOO_SHORT;
+            }
+            return decodeTimeExchange(data, packet);
+        default:
+            return SVC_PROTOCOL_UNKNOWN_HEADER;
+    }
+}
+
+size_t svcProtocolPacketSize(uint8_t header) {
+    switch (header) {
+        case NUMBER_OF_DAYS_HEADER:
+            return SVC_PROTOCOL_NUMBER_OF_DAYS_SIZE;
+        case UPDATE_OF_DAYS_HEADER:
+            return SVC_PROTOCOL_UPDATE_OF_DAYS_SIZE;
+        case PRAYER_TIMINGS_HEADER:
+            return SVC_PROTOCOL_PRAYER_TIMINGS_SIZE;
+        case END_OF_TIMINGS_HEADER:
+            return SVC_PROTOCOL_END_OF_TIMINGS_SIZE;
+        case CURRENT_TIME_HEADER:
+            return SVC_PROTOCOL_CURRENT_TIME_SIZE;
+        case TIME_REQUEST_HEADER:
+        case TIME_RESULT_HEADER:
+            return SVC_PROTOCOL_TIME_EXCHANGE_SIZE;
+        default:
+            return 0;
+    }
+}
+
+const char *svcProtocolStatusToString(svcProtocolStatus_t status) {
+    if (status >= SVC_PROTOCOL_STATUS_COUNT) {
+        return "unknown";
+    }
+    return statusNames[status];
+}
+
+void svcProtocolApplyTimings(const svcProtocolPacket_t *packet, PrayerTimings *timings) {
+    Prayer *prayers[SVC_PROTOCOL_PRAYER_COUNT] = {&timings->fajr, &timings->dhuhr, &timings->asr, &timings->maghrib,
+                                                  &timings->isha};
+    timings->day = packet->timings.day;
+    timings->month = packet->timings.month;
+    timings->year = packet->timings.year;
+    for (int i = 0; i < SVC_PROTOCOL_PRAYER_COUNT; i++) {
+        prayers[i]->hour = packet->timings.prayers[i].hour;
+        prayers[i]->minute = packet->timings.prayers[i].minute;
+        prayers[i]->name = (PrayerName) i;
+    }
+}
+
+void svcProtocolEncodeTimings(const PrayerTimings *timings, uint8_t *packet) {
+    const uint8_t encoded[SVC_PROTOCOL_PRAYER_TIMINGS_SIZE] = {
+        PRAYER_TIMINGS_HEADER, timings->day, timings->month,
+        (uint8_t) (timings->year / 100), (uint8_t) (timings->year % 100),
+        timings->fajr.hour, timings->fajr.minute,
+        timings->dhuhr.hour, timings->dhuhr.minute,
+        timings->asr.hour, timings->asr.minute,
+        timings->maghrib.hour, timings->maghrib.minute,
+        timings->isha.hour, timings->isha.minute
+    };
+    memcpy(packet, encoded, sizeof(encoded));
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+svcProtocolStatus_t decodeNumberOfDays(const uint8_t *data, svcProtocolPacket_t *packet) {
+    /*
+    Packet representation:
+    [0] - Header
+    [1] - Number of days in the month
+    */
+    if (data[1] == 0 || data[1] > SVC_PROTOCOL_MAX_DAYS) {
+        return SVC_PROTOCOL_OUT_OF_RANGE;
+    }
+
+    packet->numberOfDays = data[1];
+    return SVC_PROTOCOL_OK;
+}
+
+svcProtocolStatus_t decodeUpdateOfDays(const uint8_t *data, svcProtocolPacket_t *packet) {
+    /*
+    Packet representation:
+    [0] - Header
+    [1] - Number of days in the month
+    [2..5] - Timetable hash read from the manifest, only the days differing from it follow
+    */
+    if (data[1] == 0 || data[1] > SVC_PROTOCOL_MAX_DAYS) {
+        return SVC_PROTOCOL_OUT_OF_RANGE;
+    }
+
+    packet->update.numberOfDays = data[1];
+    memcpy(packet->update.base, &data[2], SVC_PROTOCOL_HASH_SIZE);
+    return SVC_PROTOCOL_OK;
+}
+
+svcProtocolStatus_t decodePrayerTimings(const uint8_t *data, svcProtocolPacket_t *packet) {
+    /*
+    Packet representation:
+    [0] - Header
+    [1] - Day
+    [2] - Month
+    [3] - Year pt 1
+    [4] - Year pt 2
+    [5] - Fajr Hour
+    [6] - Fajr Minute
+    [7] - Dhuhr Hour
+    [8] - Dhuhr Minute
+    [9] - Asr Hour
+    [10] - Asr Minute
+    [11] - Maghrib Hour
+    [12] - Maghrib Minute
+    [13] - Isha Hour
+    [14] - Isha Minute
+    */
+    if (data[1] == 0 || data[1] > SVC_PROTOCOL_MAX_DAYS || data[2] == 0 || data[2] > 12 || data[3] > 99 ||
+        data[4] > 99) {
+        return SVC_PROTOCOL_OUT_OF_RANGE;
+    }
+    for (int i = 0; i < SVC_PROTOCOL_PRAYER_COUNT; i++) {
+        if (!isClockTime(data[5 + i * 2], data[6 + i * 2])) {
+            return SVC_PROTOCOL_OUT_OF_RANGE;
+        }
+    }
+
+    packet->timings.day = data[1];
+    packet->timings.month = data[2];
+    packet->timings.year = data[3] * 100 + data[4];
+    for (int i = 0; i < SVC_PROTOCOL_PRAYER_COUNT; i++) {
+        packet->timings.prayers[i].hour = data[5 + i * 2];
+        packet->timings.prayers[i].minute = data[6 + i * 2];
+    }
+    return SVC_PROTOCOL_OK;
+}
+
+svcProtocolStatus_t decodeCurrentTime(const uint8_t *data, svcProtocolPacket_t *packet) {
+    /*
+    Packet representation:
+    [0] - Header
+    [1] - Hour
+    [2] - Minute
+    [3] - Second
+    [4] - Day
+    [5] - Month (0 - 11)
+    [6] - Year pt 1
+    [7] - Year pt 2
+    */
+    if (!isClockTime(data[1], data[2]) || data[3] > 59 || data[4] == 0 || data[4] > 31 || data[5] > 11 ||
+        data[6] > 99 || data[7] > 99) {
+        return SVC_PROTOCOL_OUT_OF_RANGE;
+    }
+
+    packet->time.hour = data[1];
+    packet->time.minute = data[2];
+    packet->time.second = data[3];
+    packet->time.day = data[4];
+    packet->time.month = data[5];
+    packet->time.year = data[6] * 100 + data[7];
+    return SVC_PROTOCOL_OK;
+}
+
+svcProtocolStatus_t decodeTimeExchange(const uint8_t *data, svcProtocolPacket_t *packet) {
+    /*
+    Packet representation, little endian:
+    [0] - Header, TIME_REQUEST_HEADER when the phone sends the request, TIME_RESULT_HEADER when it got the answer
+    [1] - Sequence number
+    [2..9] - Phone clock at that moment, microseconds since the epoch
+    */
+    uint64_t utcUs = 0;
+    for (int i = 7; i >= 0; i--) {
+        utcUs = utcUs << 8 | data[2 + i];
+    }
+    if ((int64_t) utcUs <= 0) {
+        return SVC_PROTOCOL_OUT_OF_RANGE;
+    }
+
+    packet->exchange.sequence = data[1];
+    packet->exchange.utcUs = (int64_t) utcUs;
+    return SVC_PROTOCOL_OK;
+}
+
+bool isClockTime(uint8_t hour, uint8_t minute) {
+    return hour < 24 && minute < 60;
+}
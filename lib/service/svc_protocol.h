@@ -0,0 +1,146 @@
+/*===========================================================================*/
+/// \file svc_protocol.h
+///
+/// \brief
+///    Decoder of the timings protocol packets written by the mobile application
+///
+/// \details
+///     Pure function over a byte span: every packet is checked for length and field ranges before anything is
+///     decoded, so malformed packets are rejected cheaply and never index past the buffer. Only plain C++ is used so
+///     the decoder can be replayed, fuzzed and benchmarked on a host.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_PROTOCOL_H
+#define SVC_PROTOCOL_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <mod_timings.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define NUMBER_OF_DAYS_HEADER 0x69
+#define UPDATE_OF_DAYS_HEADER 0x6A
+#define PRAYER_TIMINGS_HEADER 0x42
+#define END_OF_TIMINGS_HEADER 0x88
+#define CURRENT_TIME_HEADER 0x20
+#define TIME_REQUEST_HEADER 0x21
+#define TIME_RESULT_HEADER 0x22
+
+#define SVC_PROTOCOL_NUMBER_OF_DAYS_SIZE 2
+#define SVC_PROTOCOL_UPDATE_OF_DAYS_SIZE 6
+#define SVC_PROTOCOL_PRAYER_TIMINGS_SIZE 15
+#define SVC_PROTOCOL_END_OF_TIMINGS_SIZE 1
+#define SVC_PROTOCOL_CURRENT_TIME_SIZE 8
+#define SVC_PROTOCOL_TIME_EXCHANGE_SIZE 10
+
+#define SVC_PROTOCOL_PRAYER_COUNT 5
+#define SVC_PROTOCOL_MAX_DAYS 31
+// Truncated SHA-256 identifying a timetable or one of its days in the manifest
+#define SVC_PROTOCOL_HASH_SIZE 4
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    SVC_PROTOCOL_OK,
+    SVC_PROTOCOL_EMPTY,
+    SVC_PROTOCOL_UNKNOWN_HEADER,
+    SVC_PROTOCOL_TOO_SHORT,
+    SVC_PROTOCOL_OUT_OF_RANGE,
+    SVC_PROTOCOL_STATUS_COUNT
+} svcProtocolStatus_t;
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    uint8_t hour;
+    uint8_t minute;
+} svcProtocolTime_t;
+
+typedef struct {
+    uint8_t header;
+    union {
+        uint8_t numberOfDays;
+        struct {
+            uint8_t numberOfDays;
+            uint8_t base[SVC_PROTOCOL_HASH_SIZE]; // timetable hash of the manifest the update was computed against
+        } update;
+        struct {
+            uint8_t day;
+            uint8_t month;
+            uint16_t year;
+            svcProtocolTime_t prayers[SVC_PROTOCOL_PRAYER_COUNT]; // fajr, dhuhr, asr, maghrib, isha
+        } timings;
+        struct {
+            uint16_t year;
+            uint8_t month; // 0 - 11, as sent by the application
+            uint8_t day;
+            uint8_t hour;
+            uint8_t minute;
+            uint8_t second;
+        } time;
+        struct {
+            uint8_t sequence; // pairs the result with its request
+            int64_t utcUs;    // phone clock, microseconds since the epoch
+        } exchange;
+    };
+} svcProtocolPacket_t;
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Validate and decode one packet
+/// \param data The bytes written by the application
+/// \param length Number of bytes, trailing bytes after the packet are ignored
+/// \param packet Filled with the decoded packet, only meaningful when SVC_PROTOCOL_OK is returned
+/// \return SVC_PROTOCOL_OK if the packet is valid, the reason of the rejection otherwise
+svcProtocolStatus_t svcProtocolDecode(const uint8_t *data, size_t length, svcProtocolPacket_t *packet);
+
+/// \brief Get the size of a packet from its header
+/// \param header The first byte of the packet
+/// \return The number of bytes of the packet, 0 if the header is unknown
+size_t svcProtocolPacketSize(uint8_t header);
+
+/// \brief Get the printable name of a decode status
+/// \param status The status to convert
+/// \return The name of the status
+const char *svcProtocolStatusToString(svcProtocolStatus_t status);
+
+/// \brief Copy a decoded PRAYER_TIMINGS_HEADER packet into the day of a timetable
+/// \param packet The decoded packet
+/// \param timings Filled with the date and the prayers, named in their order
+void svcProtocolApplyTimings(const svcProtocolPacket_t *packet, PrayerTimings *timings);
+
+/// \brief Encode a day of a timetable as the PRAYER_TIMINGS_HEADER packet it was received as
+/// \param timings The day
+/// \param packet Filled with SVC_PROTOCOL_PRAYER_TIMINGS_SIZE bytes, the header first
+void svcProtocolEncodeTimings(const PrayerTimings *timings, uint8_t *packet);
+
+#endif // SVC_PROTOCOL_H
@@ -0,0 +1,149 @@
+/*===========================================================================*/
+/// \file svc_state.cpp
+///
+/// \brief
+///    Service sharing a consistent snapshot of what the device is doing
+///
+/// \details
+///    The sequence is odd while a publish is in progress. The snapshot is stored as words accessed atomically so a
+///    torn copy is only ever thrown away, never acted upon. The writer masks the interrupts of its core while
+///    publishing, a reader on that core can therefore never spin on a publish it interrupted.
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_state.h"
+#include <svc_cli.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SVC_STATE_WORDS (sizeof(svcState_t) / sizeof(uint32_t))
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+static_assert(sizeof(svcState_t) % sizeof(uint32_t) == 0, "The snapshot is copied word by word");
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static void commandStatus(cmd *c);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static uint32_t sequence = 0;
+static uint32_t snapshot[SVC_STATE_WORDS];
+static portMUX_TYPE writerLock = portMUX_INITIALIZER_UNLOCKED;
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const svcState_t initialState = {
+    {0, 0, NONE},
+    0,
+    SVC_CLOCK_SOURCE_NONE,
+    SYNC_NONE,
+    false,
+    0,
+    0
+};
+
+static const char *const prayerNames[] = {"Fajr", "Dhuhr", "Asr", "Maghrib", "Isha", "None"};
+
+static const char *const syncNames[] = {"none", "receiving", "done"};
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+bool svcStateInit() {
+    svcStatePublish(&initialState);
+
+    SimpleCLI *cli = svcCliGetCli0();
+    svcCliAddCmdHelp("status", "Show the next prayer, time source and timetable sync");
+    cli->addCommand("status", commandStatus);
+    return true;
+}
+
+void svcStatePublish(const svcState_t *state) {
+    uint32_t words[SVC_STATE_WORDS];
+    memcpy(words, state, sizeof(words));
+
+    portENTER_CRITICAL(&writerLock);
+    const uint32_t begin = __atomic_load_n(&sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&sequence, begin + 1, __ATOMIC_RELAXED);
+    // The odd sequence must be visible before any word changes
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (size_t i = 0; i < SVC_STATE_WORDS; i++) {
+        __atomic_store_n(&snapshot[i], words[i], __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&sequence, begin + 2, __ATOMIC_RELEASE);
+    portEXIT_CRITICAL(&writerLock);
+}
+
+bool svcStateRead(svcState_t *state) {
+    uint32_t words[SVC_STATE_WORDS];
+    for (uint8_t attempt = 0; attempt < SVC_STATE_READ_RETRIES; attempt++) {
+        const uint32_t begin = __atomic_load_n(&sequence, __ATOMIC_ACQUIRE);
+        if (begin & 1) {
+            continue;
+        }
+
+        for (size_t i = 0; i < SVC_STATE_WORDS; i++) {
+            words[i] = __atomic_load_n(&snapshot[i], __ATOMIC_RELAXED);
+        }
+        // The words must be read before the sequence is checked again
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&sequence, __ATOMIC_RELAXED) == begin) {
+            memcpy(state, words, sizeof(words));
+            return true;
+        }
+    }
+    return false;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+void commandStatus(cmd *c) {
+    svcState_t state;
+    svcCliOut()->write("\r\n");
+    if (!svcStateRead(&state)) {
+        svcCliOut()->println("State busy, try again");
+        return;
+    }
+
+    if (state.nextPrayer.name == NONE) {
+        svcCliOut()->println("Next prayer: none");
+    } else {
+        svcCliOut()->printf("Next prayer: %s at %02d:%02d, in %ld s\n", prayerNames[state.nextPrayer.name],
+                            state.nextPrayer.hour, state.nextPrayer.minute,
+                            (long) (state.nextPrayerUtc - svcClockNow()));
+    }
+    svcCliOut()->printf("Time source: %s\n", svcClockSourceToString(state.timeSource));
+    svcCliOut()->printf("Timetable: version %lu, %d days, sync %s, BLE %s\n", (unsigned long) state.timetableVersion,
+                        state.numberOfDays, syncNames[state.syncStatus],
+                        state.connected ? "connected" : "disconnected");
+}
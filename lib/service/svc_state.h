@@ -0,0 +1,82 @@
+/*===========================================================================*/
+/// \file svc_state.h
+///
+/// \brief
+///    Service sharing a consistent snapshot of what the device is doing
+///
+/// \details
+///     The prayer module is the only writer, it publishes the whole snapshot under a sequence lock. Readers copy it
+///     without taking any lock and retry when a publish overlapped the copy, so the CLI, the BLE status notification,
+///     other tasks and interrupt handlers all see one coherent snapshot and never block the writer or each other.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_STATE_H
+#define SVC_STATE_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+#include <mod_timings.h>
+#include <svc_clock.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+// Copies attempted by a reader before giving up, a publish only lasts a few hundred cycles
+#define SVC_STATE_READ_RETRIES 100
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    Prayer nextPrayer;           // name is NONE when no prayer is scheduled
+    int64_t nextPrayerUtc;       // seconds since the epoch
+    svcClockSource_t timeSource;
+    SyncStatus syncStatus;
+    bool connected;              // BLE central connected
+    uint8_t numberOfDays;        // days in the current timetable
+    uint32_t timetableVersion;   // incremented for each published timetable, 0 before the first one
+} svcState_t;
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Publish the initial snapshot and register the CLI commands
+/// \return true if the service was initialized successfully, false otherwise
+bool svcStateInit();
+
+/// \brief Replace the snapshot, only called from the prayer task
+/// \param state The new snapshot
+void svcStatePublish(const svcState_t *state);
+
+/// \brief Copy the snapshot without blocking, safe from any task or interrupt handler
+/// \param state Filled with the snapshot
+/// \return true if a consistent copy was made, false if publishes kept overlapping it
+bool svcStateRead(svcState_t *state);
+
+#endif // SVC_STATE_H
@@ -0,0 +1,187 @@
+/*===========================================================================*/
+/// \file svc_timetable_stream.cpp
+///
+/// \brief
+///    Incremental parser of timetable files received in arbitrary chunks
+///
+/// \details
+///    Frame the binary packets by their header and tokenize the JSON arrays one byte at a time, then run every
+///    record through the protocol decoder
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_timetable_stream.h"
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+// Largest value of any field, the year
+#define JSON_MAX_FIELD_VALUE 9999
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static bool feedBinary(svcTimetableStream_t *stream, uint8_t byte);
+
+static bool feedJson(svcTimetableStream_t *stream, uint8_t byte);
+
+static bool emitJsonRecord(svcTimetableStream_t *stream);
+
+static void emitPacket(svcTimetableStream_t *stream, const uint8_t *data, size_t length);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+void svcTimetableStreamBegin(svcTimetableStream_t *stream, svcTimetableStreamFormat_t format,
+                             svcTimetableStreamCallback_t callback, void *context) {
+    *stream = {};
+    stream->format = format;
+    stream->callback = callback;
+    stream->context = context;
+}
+
+bool svcTimetableStreamFeed(svcTimetableStream_t *stream, const uint8_t *data, size_t length) {
+    for (size_t i = 0; i < length && !stream->error; i++) {
+        const bool ok = stream->format == SVC_TIMETABLE_STREAM_JSON ? feedJson(stream, data[i])
+                                                                    : feedBinary(stream, data[i]);
+        stream->error = !ok;
+    }
+    return !stream->error;
+}
+
+bool svcTimetableStreamEnd(svcTimetableStream_t *stream) {
+    if (stream->format == SVC_TIMETABLE_STREAM_JSON) {
+        return !stream->error && stream->depth == 0;
+    }
+    return !stream->error && stream->packetLength == 0;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+bool feedBinary(svcTimetableStream_t *stream, uint8_t byte) {
+    if (stream->packetLength == 0) {
+        // An unknown header leaves no way to find the next packet boundary
+        stream->packetSize = svcProtocolPacketSize(byte);
+        if (stream->packetSize == 0) {
+            return false;
+        }
+    }
+
+    stream->packet[stream->packetLength++] = byte;
+    if (stream->packetLength == stream->packetSize) {
+        emitPacket(stream, stream->packet, stream->packetLength);
+        stream->packetLength = 0;
+    }
+    return true;
+}
+
+bool feedJson(svcTimetableStream_t *stream, uint8_t byte) {
+    if (byte >= '0' && byte <= '9') {
+        if (stream->depth != 2 || stream->fieldCount >= SVC_TIMETABLE_STREAM_JSON_FIELDS) {
+            return false;
+        }
+        uint16_t &field = stream->fields[stream->fieldCount];
+        if (!stream->inNumber) {
+            stream->inNumber = true;
+            field = 0;
+        }
+        field = field * 10 + (byte - '0');
+        return field <= JSON_MAX_FIELD_VALUE;
+    }
+
+    // Any other byte ends the number being read
+    if (stream->inNumber) {
+        stream->inNumber = false;
+        stream->fieldCount++;
+    }
+
+    switch (byte) {
+        case '[':
+            if (stream->depth == 2) {
+                return false;
+            }
+            stream->depth++;
+            stream->fieldCount = 0;
+            return true;
+        case ']':
+            if (stream->depth == 0) {
+                return false;
+            }
+            stream->depth--;
+            return stream->depth == 1 ? emitJsonRecord(stream) : true;
+        case ',':
+            return stream->depth > 0;
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool emitJsonRecord(svcTimetableStream_t *stream) {
+    if (stream->fieldCount != SVC_TIMETABLE_STREAM_JSON_FIELDS) {
+        return false;
+    }
+
+    // Same bytes as the PRAYER_TIMINGS_HEADER packet so both formats share the validation
+    const uint16_t *fields = stream->fields;
+    uint8_t packet[SVC_PROTOCOL_PRAYER_TIMINGS_SIZE];
+    packet[0] = PRAYER_TIMINGS_HEADER;
+    packet[1] = fields[0] > UINT8_MAX ? UINT8_MAX : fields[0];
+    packet[2] = fields[1] > UINT8_MAX ? UINT8_MAX : fields[1];
+    packet[3] = fields[2] / 100;
+    packet[4] = fields[2] % 100;
+    for (int i = 3; i < SVC_TIMETABLE_STREAM_JSON_FIELDS; i++) {
+        packet[i + 2] = fields[i] > UINT8_MAX ? UINT8_MAX : fields[i];
+    }
+    emitPacket(stream, packet, sizeof(packet));
+    return true;
+}
+
+void emitPacket(svcTimetableStream_t *stream, const uint8_t *data, size_t length) {
+    svcProtocolPacket_t packet;
+    if (svcProtocolDecode(data, length, &packet) != SVC_PROTOCOL_OK) {
+        stream->rejected++;
+        return;
+    }
+
+    stream->records++;
+    if (stream->callback != nullptr) {
+        stream->callback(&packet, stream->context);
+    }
+}
@@ -0,0 +1,107 @@
+/*===========================================================================*/
+/// \file svc_timetable_stream.h
+///
+/// \brief
+///    Incremental parser of timetable files received in arbitrary chunks
+///
+/// \details
+///     Two body formats are understood, both one record per day:
+///     - binary: the BLE protocol packets back to back, typically one PRAYER_TIMINGS_HEADER packet per day
+///     - JSON: an array of 13 integer arrays [day, month, year, fajr h, fajr m, ..., isha h, isha m]
+///     Each record is validated by the protocol decoder and handed to a callback as soon as it is complete, so a whole
+///     year can be parsed with a few bytes of state and no body buffer. Only plain C++ is used so the parser can run
+///     on a host.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_TIMETABLE_STREAM_H
+#define SVC_TIMETABLE_STREAM_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <svc_protocol.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SVC_TIMETABLE_STREAM_JSON_FIELDS 13
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    SVC_TIMETABLE_STREAM_BINARY,
+    SVC_TIMETABLE_STREAM_JSON
+} svcTimetableStreamFormat_t;
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/// \brief Called for each valid packet of the body
+typedef void (*svcTimetableStreamCallback_t)(const svcProtocolPacket_t *packet, void *context);
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    svcTimetableStreamFormat_t format;
+    svcTimetableStreamCallback_t callback;
+    void *context;
+    bool error;
+    uint32_t records;
+    uint32_t rejected;
+
+    // Binary framing
+    uint8_t packet[SVC_PROTOCOL_PRAYER_TIMINGS_SIZE];
+    uint8_t packetLength;
+    uint8_t packetSize;
+
+    // JSON tokenizer
+    uint8_t depth;
+    bool inNumber;
+    uint8_t fieldCount;
+    uint16_t fields[SVC_TIMETABLE_STREAM_JSON_FIELDS];
+} svcTimetableStream_t;
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Reset a parser before a new body
+/// \param stream The parser state
+/// \param format Format of the body
+/// \param callback Called for each valid packet
+/// \param context Passed back to the callback
+void svcTimetableStreamBegin(svcTimetableStream_t *stream, svcTimetableStreamFormat_t format,
+                             svcTimetableStreamCallback_t callback, void *context);
+
+/// \brief Parse the next chunk of the body
+/// \param stream The parser state
+/// \param data The chunk, it can end in the middle of a record
+/// \param length Number of bytes in the chunk
+/// \return false once the body is malformed, the rest of the body is then ignored
+bool svcTimetableStreamFeed(svcTimetableStream_t *stream, const uint8_t *data, size_t length);
+
+/// \brief Check that the body ended on a record boundary
+/// \param stream The parser state
+/// \return true if the whole body was well formed, false otherwise
+bool svcTimetableStreamEnd(svcTimetableStream_t *stream);
+
+#endif // SVC_TIMETABLE_STREAM_H
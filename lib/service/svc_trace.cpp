@@ -0,0 +1,197 @@
+/*===========================================================================*/
+/// \file svc_trace.cpp
+///
+/// \brief
+///    Service for recording timestamped tracepoints of the tasks
+///
+/// \details
+///    Writers claim a slot with an atomic increment and never wait, the dump stops the trace and sends the records
+///    oldest first followed by the names of the tracepoints and tasks they reference
+///
+/// \author
+///    Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "svc_trace.h"
+#include <svc_cli.h>
+#include <esp_timer.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+/*
+Dump representation, little endian:
+"PDTR" magic, version (1 byte), record count (4 bytes), overwritten records (4 bytes)
+Records of 16 bytes: time in us (4), name address (4), task handle (4), type (1), core (1), value (2)
+Then the names: kind (1, 0 tracepoint / 1 task), key (4), length (1), characters, ended by a kind of 0xFF
+*/
+#define SVC_TRACE_MAGIC "PDTR"
+#define SVC_TRACE_VERSION 1
+#define SVC_TRACE_NAME_TRACEPOINT 0
+#define SVC_TRACE_NAME_TASK 1
+#define SVC_TRACE_NAME_END 0xFF
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    uint32_t timeUs;
+    uint32_t name;
+    uint32_t task;
+    uint8_t type;
+    uint8_t core;
+    uint16_t value;
+} TraceRecord;
+
+// Naturally packed, the dump sends the records as they are in RAM
+static_assert(sizeof(TraceRecord) == 16, "trace records are 16 bytes in the dump format");
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static void dump();
+
+static void writeName(uint8_t kind, uint32_t key, const char *name);
+
+static bool isFirstReference(uint32_t first, uint32_t count, size_t offset, uint32_t key);
+
+static void commandTrace(cmd *c);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static TraceRecord records[SVC_TRACE_BUFFER_SIZE];
+static uint32_t recordCount = 0; // records written since the start, wraps the ring
+static volatile bool running = false;
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+bool svcTraceInit() {
+    svcCliAddCmdHelp("trace", "Record tracepoints [start|stop|dump]");
+    svcCliGetCli0()->addBoundlessCommand("trace", commandTrace);
+    return true;
+}
+
+void svcTraceStart() {
+    running = false;
+    __atomic_store_n(&recordCount, 0, __ATOMIC_RELEASE);
+    running = true;
+}
+
+void svcTraceStop() {
+    running = false;
+}
+
+void svcTraceRecord(svcTraceType_t type, const char *name, uint16_t value) {
+    if (!running) {
+        return;
+    }
+
+    const uint32_t index = __atomic_fetch_add(&recordCount, 1, __ATOMIC_RELAXED);
+    TraceRecord &record = records[index % SVC_TRACE_BUFFER_SIZE];
+    record.timeUs = (uint32_t) esp_timer_get_time();
+    record.name = (uint32_t) (uintptr_t) name;
+    record.task = (uint32_t) (uintptr_t) xTaskGetCurrentTaskHandle();
+    record.type = type;
+    record.core = xPortGetCoreID();
+    record.value = value;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+void dump() {
+    svcTraceStop();
+    // Let a writer that claimed its slot before the stop finish it
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    const uint32_t total = __atomic_load_n(&recordCount, __ATOMIC_ACQUIRE);
+    const uint32_t count = total < SVC_TRACE_BUFFER_SIZE ? total : SVC_TRACE_BUFFER_SIZE;
+    const uint32_t overwritten = total - count;
+    const uint32_t first = total - count;
+
+    Serial.write((const uint8_t *) SVC_TRACE_MAGIC, 4);
+    const uint8_t version = SVC_TRACE_VERSION;
+    Serial.write(&version, 1);
+    Serial.write((const uint8_t *) &count, 4);
+    Serial.write((const uint8_t *) &overwritten, 4);
+    for (uint32_t i = 0; i < count; i++) {
+        Serial.write((const uint8_t *) &records[(first + i) % SVC_TRACE_BUFFER_SIZE], sizeof(TraceRecord));
+    }
+
+    // Each name once, the ring is small enough for a quadratic search
+    for (uint32_t i = 0; i < count; i++) {
+        const TraceRecord &record = records[(first + i) % SVC_TRACE_BUFFER_SIZE];
+        if (isFirstReference(first, i, offsetof(TraceRecord, name), record.name)) {
+            writeName(SVC_TRACE_NAME_TRACEPOINT, record.name, (const char *) (uintptr_t) record.name);
+        }
+        if (isFirstReference(first, i, offsetof(TraceRecord, task), record.task)) {
+            writeName(SVC_TRACE_NAME_TASK, record.task, pcTaskGetName((TaskHandle_t) (uintptr_t) record.task));
+        }
+    }
+    const uint8_t end = SVC_TRACE_NAME_END;
+    Serial.write(&end, 1);
+}
+
+void writeName(uint8_t kind, uint32_t key, const char *name) {
+    const uint8_t length = name == nullptr ? 0 : strnlen(name, UINT8_MAX);
+    Serial.write(&kind, 1);
+    Serial.write((const uint8_t *) &key, 4);
+    Serial.write(&length, 1);
+    Serial.write((const uint8_t *) name, length);
+}
+
+bool isFirstReference(uint32_t first, uint32_t count, size_t offset, uint32_t key) {
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t value;
+        memcpy(&value, (const uint8_t *) &records[(first + i) % SVC_TRACE_BUFFER_SIZE] + offset, sizeof(value));
+        if (value == key) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void commandTrace(cmd *c) {
+    Command cmd(c);
+    const String action = cmd.countArgs() > 0 ? cmd.getArgument(0).getValue() : String("");
+    if (action == "start") {
+        svcTraceStart();
+    } else if (action == "stop") {
+        svcTraceStop();
+    } else if (action == "dump") {
+        svcCliOut()->write("\r\n");
+        dump();
+        return;
+    }
+
+    const uint32_t total = __atomic_load_n(&recordCount, __ATOMIC_RELAXED);
+    svcCliOut()->printf("\r\nTrace %s, %lu records (%lu overwritten), capacity %u\r\n", running ? "running" : "stopped",
+                        (unsigned long) (total < SVC_TRACE_BUFFER_SIZE ? total : SVC_TRACE_BUFFER_SIZE),
+                        (unsigned long) (total > SVC_TRACE_BUFFER_SIZE ? total - SVC_TRACE_BUFFER_SIZE : 0),
+                        SVC_TRACE_BUFFER_SIZE);
+}
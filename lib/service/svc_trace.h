@@ -0,0 +1,115 @@
+/*===========================================================================*/
+/// \file svc_trace.h
+///
+/// \brief
+///    Service for recording timestamped tracepoints of the tasks
+///
+/// \details
+///     Tracepoints write begin, end and instant records with the current task and core into a fixed RAM ring, the
+///     oldest records are overwritten. A stopped trace costs one load and a branch per tracepoint, building with
+///     SVC_TRACE_ENABLED=0 removes them. The trace command dumps the ring in binary, scripts/trace_to_perfetto.py
+///     turns the capture into a Chrome/Perfetto timeline. Tracepoint names must be string literals.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef SVC_TRACE_H
+#define SVC_TRACE_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#ifndef SVC_TRACE_ENABLED
+#define SVC_TRACE_ENABLED 1
+#endif
+
+// Records kept, a power of two
+#define SVC_TRACE_BUFFER_SIZE 512
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+#if SVC_TRACE_ENABLED
+#define SVC_TRACE_BEGIN(name) svcTraceRecord(SVC_TRACE_TYPE_BEGIN, name, 0)
+#define SVC_TRACE_END(name) svcTraceRecord(SVC_TRACE_TYPE_END, name, 0)
+#define SVC_TRACE_INSTANT(name, value) svcTraceRecord(SVC_TRACE_TYPE_INSTANT, name, value)
+// Begin now and end when the enclosing block exits, whatever the return path
+#define SVC_TRACE_SCOPE(name) TraceScope traceScope(name)
+#else
+#define SVC_TRACE_BEGIN(name) do {} while (0)
+#define SVC_TRACE_END(name) do {} while (0)
+#define SVC_TRACE_INSTANT(name, value) do {} while (0)
+#define SVC_TRACE_SCOPE(name) do {} while (0)
+#endif
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    SVC_TRACE_TYPE_BEGIN,
+    SVC_TRACE_TYPE_END,
+    SVC_TRACE_TYPE_INSTANT
+} svcTraceType_t;
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Register the trace CLI command
+/// \return true if the service was initialized successfully, false otherwise
+bool svcTraceInit();
+
+/// \brief Start recording, the ring is cleared first
+void svcTraceStart();
+
+/// \brief Stop recording, the ring keeps its records until the next start
+void svcTraceStop();
+
+/// \brief Store a record if the trace is running, use the SVC_TRACE_* macros instead
+/// \param type Begin, end or instant
+/// \param name Name of the tracepoint, must be a string literal
+/// \param value Free value shown with instant records
+void svcTraceRecord(svcTraceType_t type, const char *name, uint16_t value);
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+class TraceScope {
+public:
+    explicit TraceScope(const char *name) : name(name) {
+        svcTraceRecord(SVC_TRACE_TYPE_BEGIN, name, 0);
+    }
+
+    ~TraceScope() {
+        svcTraceRecord(SVC_TRACE_TYPE_END, name, 0);
+    }
+
+private:
+    const char *const name;
+};
+
+#endif // SVC_TRACE_H
@@ -0,0 +1,102 @@
+"""
+Compare the output of the bench command against a stored baseline.
+
+The input is a serial log holding the "bench,..." lines printed by the device, or the bench_output.txt of the host
+bench (other lines are ignored). Each case is compared on its median cycles per iteration, the script exits with 1
+when one of them is slower than the baseline by more than the threshold, or has no baseline, so it can gate a change.
+Several logs, or a log holding several passes of the bench, keep the best pass of each case: a pass slowed down by
+the rest of the machine says nothing about the code.
+
+python scripts/bench_compare.py bench.log                 compare against scripts/bench_baseline.json
+python scripts/bench_compare.py bench.log --update        store bench.log as the new baseline
+python scripts/bench_compare.py bench.log --threshold 5   allow 5 % instead of 10 %
+
+The host bench shares the machine, whole runs of it are slowed down at times. Run it a few times and compare the
+fastest repeats against a baseline recorded the same way on the same machine:
+python scripts/bench_compare.py bench_1.txt bench_2.txt bench_3.txt bench_4.txt bench_5.txt \
+    --baseline scripts/bench_baseline_host.json --metric min --threshold 20
+"""
+
+import argparse
+import json
+import os
+import sys
+
+DEFAULT_BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "bench_baseline.json")
+
+
+def parse_logs(paths):
+    cpu_mhz = None
+    results = {}
+    for path in paths:
+        with open(path, encoding="utf-8", errors="replace") as log:
+            for line in log:
+                fields = line.strip().split(",")
+                if fields[0] != "bench" or len(fields) < 3:
+                    continue
+                if fields[1] == "cpu_mhz":
+                    cpu_mhz = int(fields[2])
+                elif len(fields) == 5 and fields[1] != "name":
+                    case = {"iterations": int(fields[2]), "min": float(fields[3]), "median": float(fields[4])}
+                    best = results.setdefault(fields[1], case)
+                    best["min"] = min(best["min"], case["min"])
+                    best["median"] = min(best["median"], case["median"])
+    return cpu_mhz, results
+
+
+def compare(baseline, results, threshold, metric):
+    regressions = 0
+    print("%-22s %12s %12s %8s" % ("case", "baseline", "current", "change"))
+    for name, current in sorted(results.items()):
+        reference = baseline["cases"].get(name)
+        if reference is None:
+            # A case nobody recorded would never be gated
+            print("%-22s %12s %12.2f %8s  NO BASELINE" % (name, "-", current[metric], "new"))
+            regressions += 1
+            continue
+        change = (current[metric] - reference[metric]) * 100.0 / max(reference[metric], 0.01)
+        flag = ""
+        if change > threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        print("%-22s %12.2f %12.2f %+7.1f%%%s" % (name, reference[metric], current[metric], change, flag))
+    for name in sorted(set(baseline["cases"]) - set(results)):
+        print("%-22s %12.2f %12s %8s" % (name, baseline["cases"][name][metric], "-", "missing"))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("logs", nargs="+", help="serial logs or host outputs holding the bench lines")
+    parser.add_argument("--baseline", default=DEFAULT_BASELINE)
+    parser.add_argument("--threshold", type=float, default=10.0, help="allowed slowdown in percent")
+    parser.add_argument("--metric", choices=("median", "min"), default="median", help="figure compared")
+    parser.add_argument("--update", action="store_true", help="store the logs as the new baseline")
+    args = parser.parse_args()
+
+    cpu_mhz, results = parse_logs(args.logs)
+    if not results:
+        sys.exit("no bench lines in %s" % ", ".join(args.logs))
+
+    if args.update:
+        with open(args.baseline, "w", encoding="utf-8") as baseline:
+            json.dump({"cpu_mhz": cpu_mhz, "cases": results}, baseline, indent=2, sort_keys=True)
+            baseline.write("\n")
+        print("baseline written to %s" % args.baseline)
+        return
+
+    if not os.path.exists(args.baseline):
+        sys.exit("no baseline at %s, record one from logs of the same target with --update" % args.baseline)
+    with open(args.baseline, encoding="utf-8") as baseline_file:
+        baseline = json.load(baseline_file)
+    if baseline.get("cpu_mhz") != cpu_mhz:
+        print("warning: baseline at %s MHz, log at %s MHz" % (baseline.get("cpu_mhz"), cpu_mhz))
+
+    regressions = compare(baseline, results, args.threshold, args.metric)
+    if regressions:
+        sys.exit("%d case(s) slower than the baseline by more than %.1f %% or without a baseline"
+                 % (regressions, args.threshold))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,184 @@
+"""
+Generate the atlas of pre-shaped Arabic words and numerals drawn by the display.
+
+Run by PlatformIO before each build (see `extra_scripts` in platformio.ini). The font comes from the `custom_glyph_font`
+option of the environment (a TTF/OTF with Arabic coverage, e.g. Noto Naskh Arabic, relative to the project directory)
+and the pixel size from `custom_glyph_size`. Every word of the vocabulary is shaped and rendered here, with Pillow's
+raqm layout or, without it, `arabic_reshaper` and `python-bidi`, then thresholded to 1 bit and run length encoded (see
+svc_glyph.cpp for the format). The result is written to `$BUILD_DIR/generated/svc_glyph_atlas.h` and only rewritten
+when it changes. Without a font, or without Pillow, an empty atlas is written and the display keeps the Latin names.
+
+Can also be run by hand: python scripts/gen_glyph_atlas.py NotoNaskhArabic-Regular.ttf 16 > svc_glyph_atlas.h
+"""
+
+import os
+import sys
+
+# Same order as svcGlyph_t in lib/service/svc_glyph.h
+VOCABULARY = [
+    ("FAJR", "الفجر"),
+    ("DHUHR", "الظهر"),
+    ("ASR", "العصر"),
+    ("MAGHRIB", "المغرب"),
+    ("ISHA", "العشاء"),
+    ("NEXT_PRAYER", "الصلاة القادمة"),
+    ("REMAINING", "المتبقي"),
+] + [("DIGIT_%d" % digit, chr(0x0660 + digit)) for digit in range(10)] + [
+    ("COLON", ":"),
+]
+
+RUN_CONTINUE = 255
+THRESHOLD = 128
+MAX_WIDTH = 128  # SVC_DISPLAY_WIDTH
+
+
+def shape(text):
+    """Return the text in visual order with presentation forms, and the raqm arguments when raqm does it instead."""
+    from PIL import features
+
+    if features.check("raqm"):
+        return text, {"direction": "rtl", "language": "ar"}
+    import arabic_reshaper
+    from bidi.algorithm import get_display
+
+    return get_display(arabic_reshaper.reshape(text)), {}
+
+
+def rasterize(font_path, size):
+    """Render every word on a shared baseline, return a list of (width, height, rows of 0/1)."""
+    from PIL import Image, ImageDraw, ImageFont
+
+    font = ImageFont.truetype(font_path, size)
+    ascent, descent = font.getmetrics()
+    images = []
+    for _, text in VOCABULARY:
+        visual, options = shape(text)
+        left, _, right, _ = font.getbbox(visual, **options)
+        image = Image.new("L", (max(right - left, 1), ascent + descent), 0)
+        ImageDraw.Draw(image).text((-left, 0), visual, fill=255, font=font, **options)
+        images.append(image)
+
+    # Crop every word to the rows inked by any of them so they keep the same baseline and height
+    inked = [image.point(lambda value: 255 if value >= THRESHOLD else 0).getbbox() for image in images]
+    top = min(box[1] for box in inked if box)
+    bottom = max(box[3] for box in inked if box)
+
+    glyphs = []
+    for image, box in zip(images, inked):
+        left, right = (box[0], box[2]) if box else (0, 1)
+        image = image.crop((left, top, right, bottom))
+        width, height = image.size
+        pixels = image.load()
+        rows = [[1 if pixels[x, y] >= THRESHOLD else 0 for x in range(width)] for y in range(height)]
+        glyphs.append((width, height, rows))
+    return glyphs
+
+
+def encode(rows):
+    runs = []
+    color = 0
+    length = 0
+    for bit in (bit for row in rows for bit in row):
+        if bit == color:
+            length += 1
+            continue
+        runs += encode_run(length)
+        color = bit
+        length = 1
+    if color:
+        runs += encode_run(length)
+    return runs
+
+
+def encode_run(length):
+    runs = []
+    while length >= RUN_CONTINUE:
+        runs.append(RUN_CONTINUE)
+        length -= RUN_CONTINUE
+    runs.append(length)
+    return runs
+
+
+def render(glyphs, source):
+    lines = [
+        "// Generated by scripts/gen_glyph_atlas.py, do not edit",
+        "#ifndef SVC_GLYPH_ATLAS_H",
+        "#define SVC_GLYPH_ATLAS_H",
+        "",
+    ]
+    if not glyphs:
+        lines += [
+            "// No font configured, the display keeps the Latin names",
+            "#define SVC_GLYPH_ATLAS_COUNT 0",
+            "static const svcGlyphEntry_t svcGlyphAtlasEntries[] = {",
+            "    {0, 0, 0, 0},",
+            "};",
+            "static const uint8_t svcGlyphAtlasData[] = {0};",
+            "",
+            "#endif // SVC_GLYPH_ATLAS_H",
+            "",
+        ]
+        return "\n".join(lines)
+
+    data = []
+    entries = []
+    for (name, _), (width, height, rows) in zip(VOCABULARY, glyphs):
+        if width > MAX_WIDTH:
+            raise ValueError("%s is %d pixels wide, more than the display, use a smaller custom_glyph_size" % (name, width))
+        runs = encode(rows)
+        entries.append("    {%d, %d, %d, %d}, // %s" % (width, height, len(data), len(runs), name))
+        data += runs
+    if len(data) > 0xFFFF:
+        raise ValueError("atlas of %d bytes does not fit the 16 bit offsets" % len(data))
+
+    lines += [
+        "// %s, %d bytes of runs" % (source, len(data)),
+        "#define SVC_GLYPH_ATLAS_COUNT %d" % len(entries),
+        "",
+        "static const svcGlyphEntry_t svcGlyphAtlasEntries[] = {",
+    ]
+    lines += entries
+    lines += ["};", "", "static const uint8_t svcGlyphAtlasData[] = {"]
+    for start in range(0, len(data), 16):
+        lines.append("    " + " ".join("0x%02x," % run for run in data[start:start + 16]))
+    lines += ["};", "", "#endif // SVC_GLYPH_ATLAS_H", ""]
+    return "\n".join(lines)
+
+
+def generate(font_path, size):
+    """Return the header and a description of what was generated."""
+    if not font_path:
+        return render([], ""), "empty, custom_glyph_font is not set"
+    try:
+        glyphs = rasterize(font_path, size)
+    except ImportError as error:
+        return render([], ""), "empty, %s (pip install pillow arabic-reshaper python-bidi)" % error
+    source = "%s at %d px" % (os.path.basename(font_path), size)
+    return render(glyphs, source), source
+
+
+def write_if_changed(path, content):
+    if os.path.exists(path):
+        with open(path, encoding="utf-8") as file:
+            if file.read() == content:
+                return
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, "w", encoding="utf-8") as file:
+        file.write(content)
+
+
+if __name__ == "__main__":
+    header, _ = generate(sys.argv[1] if len(sys.argv) > 1 else "", int(sys.argv[2]) if len(sys.argv) > 2 else 16)
+    sys.stdout.write(header)
+else:
+    Import("env")  # noqa: F821 - provided by PlatformIO
+
+    font_option = env.GetProjectOption("custom_glyph_font", "")  # noqa: F821
+    font_path = os.path.join(env.subst("$PROJECT_DIR"), font_option) if font_option else ""  # noqa: F821
+    size = int(env.GetProjectOption("custom_glyph_size", "16"))  # noqa: F821
+    generated_dir = os.path.join(env.subst("$BUILD_DIR"), "generated")  # noqa: F821
+
+    header, description = generate(font_path, size)
+    write_if_changed(os.path.join(generated_dir, "svc_glyph_atlas.h"), header)
+    env.Append(CPPPATH=[generated_dir])  # noqa: F821
+    print("Glyph atlas generated: %s" % description)
@@ -0,0 +1,78 @@
+"""
+Generate the header holding the public key accepted for firmware updates.
+
+Run by PlatformIO before each build (see `extra_scripts` in platformio.ini). The key comes from the `custom_ota_public_key`
+option of the environment, a P-256 public key in PEM format relative to the project directory (see
+scripts/ota_sign.py keygen). The DER bytes are written to `$BUILD_DIR/generated/svc_ota_key.h` and only rewritten when
+they change. Without a key the header is empty and the firmware refuses every update.
+
+Can also be run by hand: python scripts/gen_ota_key.py ota_public.pem > svc_ota_key.h
+"""
+
+import base64
+import os
+import sys
+
+
+def read_der(pem_path):
+    with open(pem_path) as file:
+        lines = [line.strip() for line in file if line.strip()]
+    if lines[0] != "-----BEGIN PUBLIC KEY-----" or lines[-1] != "-----END PUBLIC KEY-----":
+        raise ValueError("%s is not a PEM public key" % pem_path)
+    return base64.b64decode("".join(lines[1:-1]))
+
+
+def render(der, source):
+    lines = [
+        "// Generated by scripts/gen_ota_key.py, do not edit",
+        "#ifndef SVC_OTA_KEY_H",
+        "#define SVC_OTA_KEY_H",
+        "",
+    ]
+    if der is None:
+        lines += [
+            "// No key configured, every update is refused",
+            "#define SVC_OTA_KEY_SIZE 0",
+            "static const uint8_t svcOtaPublicKey[] = {0};",
+        ]
+    else:
+        lines += [
+            "// %s" % source,
+            "#define SVC_OTA_KEY_SIZE %d" % len(der),
+            "static const uint8_t svcOtaPublicKey[] = {",
+        ]
+        for start in range(0, len(der), 16):
+            lines.append("    " + " ".join("0x%02x," % byte for byte in der[start:start + 16]))
+        lines.append("};")
+    lines += ["", "#endif // SVC_OTA_KEY_H", ""]
+    return "\n".join(lines)
+
+
+def write_if_changed(path, content):
+    if os.path.exists(path):
+        with open(path) as file:
+            if file.read() == content:
+                return
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, "w") as file:
+        file.write(content)
+
+
+if __name__ == "__main__":
+    path = sys.argv[1] if len(sys.argv) > 1 else ""
+    sys.stdout.write(render(read_der(path), os.path.basename(path)) if path else render(None, ""))
+else:
+    Import("env")  # noqa: F821 - provided by PlatformIO
+
+    key_option = env.GetProjectOption("custom_ota_public_key", "")  # noqa: F821
+    generated_dir = os.path.join(env.subst("$BUILD_DIR"), "generated")  # noqa: F821
+
+    if key_option:
+        key_path = os.path.join(env.subst("$PROJECT_DIR"), key_option)  # noqa: F821
+        header = render(read_der(key_path), key_option)
+        print("OTA public key generated from %s" % key_option)
+    else:
+        header = render(None, "")
+        print("OTA public key not set, updates are refused")
+    write_if_changed(os.path.join(generated_dir, "svc_ota_key.h"), header)
+    env.Append(CPPPATH=[generated_dir])  # noqa: F821
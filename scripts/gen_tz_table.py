@@ -0,0 +1,96 @@
+"""
+Generate the UTC offset transition table of the configured time zone.
+
+Run by PlatformIO before each build (see `extra_scripts` in platformio.ini). The zone and the covered years come from
+the `custom_tz_zone` and `custom_tz_years` options of the environment, the transitions from the host tzdata. The
+result is written to `$BUILD_DIR/generated/svc_clock_tz.h` and only rewritten when it changes.
+
+Can also be run by hand: python scripts/gen_tz_table.py Europe/Paris 2020-2050 > svc_clock_tz.h
+"""
+
+import datetime
+import os
+import sys
+from zoneinfo import ZoneInfo
+
+DAY = 86400
+
+
+def utc_offset(zone, timestamp):
+    moment = datetime.datetime.fromtimestamp(timestamp, tz=zone)
+    return int(moment.utcoffset().total_seconds())
+
+
+def find_transitions(zone_name, first_year, last_year):
+    zone = ZoneInfo(zone_name)
+    start = int(datetime.datetime(first_year, 1, 1, tzinfo=datetime.timezone.utc).timestamp())
+    end = int(datetime.datetime(last_year + 1, 1, 1, tzinfo=datetime.timezone.utc).timestamp())
+
+    transitions = [(0, utc_offset(zone, start))]
+    timestamp = start
+    offset = transitions[0][1]
+    while timestamp < end:
+        next_offset = utc_offset(zone, timestamp + DAY)
+        if next_offset != offset:
+            # Bisect down to the first second running on the new offset
+            low, high = timestamp, timestamp + DAY
+            while high - low > 1:
+                middle = (low + high) // 2
+                if utc_offset(zone, middle) == offset:
+                    low = middle
+                else:
+                    high = middle
+            transitions.append((high, next_offset))
+            offset = next_offset
+        timestamp += DAY
+    return transitions
+
+
+def render(zone_name, first_year, last_year):
+    transitions = find_transitions(zone_name, first_year, last_year)
+    lines = [
+        "// Generated by scripts/gen_tz_table.py, do not edit",
+        "#ifndef SVC_CLOCK_TZ_H",
+        "#define SVC_CLOCK_TZ_H",
+        "",
+        '#define SVC_CLOCK_TZ_NAME "%s"' % zone_name,
+        "#define SVC_CLOCK_TZ_FIRST_YEAR %d" % first_year,
+        "#define SVC_CLOCK_TZ_LAST_YEAR %d" % last_year,
+        "",
+        "static const svcClockTransition_t svcClockTzTransitions[] = {",
+    ]
+    for timestamp, offset in transitions:
+        label = datetime.datetime.fromtimestamp(timestamp, tz=datetime.timezone.utc).strftime("%Y-%m-%d %H:%M:%S")
+        lines.append("    {%dUL, %d}, // %s UTC" % (timestamp, offset, label))
+    lines += ["};", "", "#endif // SVC_CLOCK_TZ_H", ""]
+    return "\n".join(lines)
+
+
+def parse_years(years):
+    first, last = years.split("-")
+    return int(first), int(last)
+
+
+def write_if_changed(path, content):
+    if os.path.exists(path):
+        with open(path) as file:
+            if file.read() == content:
+                return
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, "w") as file:
+        file.write(content)
+
+
+if __name__ == "__main__":
+    first, last = parse_years(sys.argv[2] if len(sys.argv) > 2 else "2020-2050")
+    sys.stdout.write(render(sys.argv[1] if len(sys.argv) > 1 else "UTC", first, last))
+else:
+    Import("env")  # noqa: F821 - provided by PlatformIO
+
+    zone_name = env.GetProjectOption("custom_tz_zone", "UTC")  # noqa: F821
+    first, last = parse_years(env.GetProjectOption("custom_tz_years", "2020-2050"))  # noqa: F821
+    generated_dir = os.path.join(env.subst("$BUILD_DIR"), "generated")  # noqa: F821
+
+    write_if_changed(os.path.join(generated_dir, "svc_clock_tz.h"), render(zone_name, first, last))
+    env.Append(CPPPATH=[generated_dir])  # noqa: F821
+    print("Time zone table generated for %s (%d-%d)" % (zone_name, first, last))
@@ -0,0 +1,105 @@
+"""
+Decode a binary log capture (log mode binary) back into text lines.
+
+The device only sends the address of each format string, they are read from the firmware ELF of the same build
+(.pio/build/<env>/firmware.elf). %s arguments travel inline after their record.
+
+python scripts/log_decode.py .pio/build/esp32dev/firmware.elf capture.bin
+"""
+
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+LEVELS = ["NONE", "ERROR", "WARNING", "INFO", "DEBUG"]
+CONVERSION = re.compile(r"%([-+ #0]*)(\d+|\*)?(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcsp%])")
+SECTION_PROGBITS = 1
+
+
+class Elf32:
+    """Just enough of an ELF32 little endian reader to fetch strings by address."""
+
+    def __init__(self, path):
+        with open(path, "rb") as elf:
+            self.data = elf.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1:
+            sys.exit("%s is not an ELF32 file" % path)
+        section_offset, = struct.unpack_from("<I", self.data, 0x20)
+        section_size, section_count = struct.unpack_from("<HH", self.data, 0x2E)
+        self.sections = []
+        for index in range(section_count):
+            _, kind, _, address, offset, size = struct.unpack_from("<IIIIII", self.data,
+                                                                   section_offset + index * section_size)
+            if kind == SECTION_PROGBITS and address != 0:
+                self.sections.append((address, offset, size))
+
+    def string_at(self, address):
+        for start, offset, size in self.sections:
+            if start <= address < start + size:
+                begin = offset + address - start
+                end = self.data.index(b"\0", begin)
+                return self.data[begin:end].decode("utf-8", errors="replace")
+        return "<format 0x%08x not in the ELF>" % address
+
+
+def format_record(fmt, args, strings):
+    values = iter(args)
+    texts = iter(strings)
+
+    def convert(match):
+        flags, width, precision, length, kind = match.groups()
+        if kind == "%":
+            return "%"
+        value = next(values, 0)
+        if kind == "s":
+            value = next(texts, "")
+            spec = "s"
+        elif kind in "di":
+            value = value - (1 << 32) if value & 0x80000000 else value
+            spec = "d"
+        elif kind == "c":
+            value = chr(value & 0xFF)
+            spec = "s"
+        elif kind == "p":
+            return "0x%08x" % value
+        else:
+            spec = kind if kind in "xXo" else "d"
+        return ("%" + flags + (width or "") + ("." + precision if precision else "") + spec) % value
+
+    return CONVERSION.sub(convert, fmt).rstrip("\r\n")
+
+
+def string_count(fmt, arg_count):
+    kinds = [match.group(5) for match in CONVERSION.finditer(fmt) if match.group(5) != "%"]
+    return sum(1 for kind in kinds[:arg_count] if kind == "s")
+
+
+def decode(elf, capture):
+    position = 0
+    while position + 11 <= len(capture):
+        if capture[position] != SYNC:
+            position += 1
+            continue
+        level, arg_count = capture[position + 1], capture[position + 2]
+        time_ms, address = struct.unpack_from("<II", capture, position + 3)
+        position += 11
+        args = list(struct.unpack_from("<%dI" % arg_count, capture, position))
+        position += arg_count * 4
+
+        fmt = elf.string_at(address)
+        strings = []
+        for _ in range(string_count(fmt, arg_count)):
+            length = capture[position]
+            strings.append(capture[position + 1:position + 1 + length].decode("utf-8", errors="replace"))
+            position += 1 + length
+
+        level_name = LEVELS[level] if level < len(LEVELS) else str(level)
+        print("[%d.%03d] [%s] : %s" % (time_ms // 1000, time_ms % 1000, level_name, format_record(fmt, args, strings)))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        sys.exit("usage: log_decode.py <firmware.elf> <capture.bin>")
+    with open(sys.argv[2], "rb") as capture_file:
+        decode(Elf32(sys.argv[1]), capture_file.read())
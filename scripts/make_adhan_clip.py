@@ -0,0 +1,107 @@
+"""
+Encode a WAV file into the IMA-ADPCM clip played by the audio module.
+
+The input must be 16-bit PCM, stereo is mixed down to mono. The output is the 16 byte clip header of svc_audio.h
+followed by the blocks, flash it to the adhan partition of partitions.csv:
+
+python scripts/make_adhan_clip.py adhan.wav adhan.bin
+esptool.py write_flash 0x290000 adhan.bin
+"""
+
+import argparse
+import struct
+import sys
+import wave
+
+MAGIC = 0x43504441
+VERSION = 1
+HEADER = struct.Struct("<IBBHII")
+
+STEPS = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107,
+    118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894,
+    6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767,
+]
+INDEX_ADJUST = [-1, -1, -1, -1, 2, 4, 6, 8]
+
+
+def clamp(value, low, high):
+    return max(low, min(high, value))
+
+
+def encode_sample(sample, predictor, index):
+    """Same arithmetic as the decoder so both sides track the same predictor."""
+    step = STEPS[index]
+    delta = sample - predictor
+    nibble = 0
+    if delta < 0:
+        nibble = 8
+        delta = -delta
+    difference = step >> 3
+    if delta >= step:
+        nibble |= 4
+        delta -= step
+        difference += step
+    if delta >= step >> 1:
+        nibble |= 2
+        delta -= step >> 1
+        difference += step >> 1
+    if delta >= step >> 2:
+        nibble |= 1
+        difference += step >> 2
+    predictor = clamp(predictor - difference if nibble & 8 else predictor + difference, -32768, 32767)
+    index = clamp(index + INDEX_ADJUST[nibble & 7], 0, len(STEPS) - 1)
+    return nibble, predictor, index
+
+
+def encode(samples, block_size):
+    per_block = 1 + (block_size - 4) * 2
+    output = bytearray()
+    index = 0
+    for start in range(0, len(samples), per_block):
+        chunk = samples[start:start + per_block]
+        chunk += [chunk[-1]] * (per_block - len(chunk))
+        predictor = chunk[0]
+        output += struct.pack("<hBB", predictor, index, 0)
+        nibbles = []
+        for sample in chunk[1:]:
+            nibble, predictor, index = encode_sample(sample, predictor, index)
+            nibbles.append(nibble)
+        for low, high in zip(nibbles[0::2], nibbles[1::2]):
+            output.append(low | (high << 4))
+    return bytes(output)
+
+
+def read_wav(path):
+    with wave.open(path, "rb") as wav:
+        if wav.getsampwidth() != 2:
+            sys.exit("%s is not 16-bit PCM" % path)
+        channels = wav.getnchannels()
+        rate = wav.getframerate()
+        frames = wav.readframes(wav.getnframes())
+    values = struct.unpack("<%dh" % (len(frames) // 2), frames)
+    mono = [sum(values[i:i + channels]) // channels for i in range(0, len(values), channels)]
+    return mono, rate
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("wav")
+    parser.add_argument("clip")
+    parser.add_argument("--block-size", type=int, default=256, help="bytes per block, 512 at most")
+    args = parser.parse_args()
+    if not 8 <= args.block_size <= 512 or args.block_size % 4 != 0:
+        sys.exit("the block size must be a multiple of 4 between 8 and 512")
+
+    samples, rate = read_wav(args.wav)
+    data = encode(samples, args.block_size)
+    with open(args.clip, "wb") as clip:
+        clip.write(HEADER.pack(MAGIC, VERSION, 1, args.block_size, rate, len(data)))
+        clip.write(data)
+    print("%d samples at %d Hz, %d bytes (%.1f s)" % (len(samples), rate, HEADER.size + len(data), len(samples) / rate))
+
+
+if __name__ == "__main__":
+    main()
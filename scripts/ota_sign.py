@@ -0,0 +1,68 @@
+"""
+Create the release key and sign firmware images for the BLE update.
+
+    python scripts/ota_sign.py keygen ota_private.pem ota_public.pem
+    python scripts/ota_sign.py sign ota_private.pem .pio/build/esp32dev/firmware.bin firmware.ota
+
+The public key goes to `custom_ota_public_key` in platformio.ini, the private key stays off the repository. The
+signed file is what scripts/ota_upload.py (or the phone) sends: the "PDOT" magic, a version byte, the image size
+(4 bytes, little endian), its SHA-256, the signature length (1 byte), the DER ECDSA P-256 signature of the SHA-256 and
+the image itself. Relies on the openssl command line tool.
+"""
+
+import hashlib
+import struct
+import subprocess
+import sys
+import tempfile
+
+MAGIC = b"PDOT"
+VERSION = 1
+
+
+def keygen(private_path, public_path):
+    subprocess.run(["openssl", "ecparam", "-name", "prime256v1", "-genkey", "-noout", "-out", private_path],
+                   check=True)
+    subprocess.run(["openssl", "ec", "-in", private_path, "-pubout", "-out", public_path], check=True)
+
+
+def sign(private_path, image_path, output_path):
+    with open(image_path, "rb") as file:
+        image = file.read()
+    digest = hashlib.sha256(image).digest()
+
+    # pkeyutl signs its input as is, the device checks the signature against the digest it computed
+    with tempfile.NamedTemporaryFile() as digest_file:
+        digest_file.write(digest)
+        digest_file.flush()
+        signature = subprocess.run(["openssl", "pkeyutl", "-sign", "-inkey", private_path, "-in", digest_file.name],
+                                   check=True, capture_output=True).stdout
+
+    with open(output_path, "wb") as file:
+        file.write(MAGIC + struct.pack("<BI", VERSION, len(image)) + digest + struct.pack("<B", len(signature)))
+        file.write(signature + image)
+    print("%s: %d bytes, sha256 %s" % (output_path, len(image), digest.hex()))
+
+
+def load(path):
+    """Return (image size, digest, signature, image) of a signed file."""
+    with open(path, "rb") as file:
+        content = file.read()
+    if content[:4] != MAGIC or content[4] != VERSION:
+        raise ValueError("%s is not a signed image" % path)
+    size = struct.unpack_from("<I", content, 5)[0]
+    digest = content[9:41]
+    signature = content[42:42 + content[41]]
+    image = content[42 + content[41]:]
+    if len(image) != size or hashlib.sha256(image).digest() != digest:
+        raise ValueError("%s is damaged" % path)
+    return size, digest, signature, image
+
+
+if __name__ == "__main__":
+    if len(sys.argv) == 4 and sys.argv[1] == "keygen":
+        keygen(sys.argv[2], sys.argv[3])
+    elif len(sys.argv) == 5 and sys.argv[1] == "sign":
+        sign(sys.argv[2], sys.argv[3], sys.argv[4])
+    else:
+        sys.exit(__doc__)
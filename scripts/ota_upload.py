@@ -0,0 +1,111 @@
+"""
+Send a signed firmware image (see scripts/ota_sign.py) to the device over BLE.
+
+    pip install bleak
+    python scripts/ota_upload.py firmware.ota [--name PrayerDisplayer | --address XX:XX:XX:XX:XX:XX]
+
+The image is written in MTU sized chunks without response. When the connection drops the upload reconnects and sends
+the same begin again: the device answers with the offset it already has and the transfer carries on from there. At the
+end the device verifies the image, reports the throughput and restarts into it.
+"""
+
+import argparse
+import asyncio
+import struct
+import sys
+
+from bleak import BleakClient, BleakScanner
+from bleak.exc import BleakError
+
+import ota_sign
+
+CONTROL_UUID = "beb5483e-36e1-4688-b7f5-ea07361b26ab"
+DATA_UUID = "beb5483e-36e1-4688-b7f5-ea07361b26ac"
+
+OPCODE_BEGIN = 0x01
+OPCODE_END = 0x02
+OPCODE_DATA = 0x04
+
+# Same order as svcOtaStatus_t in lib/service/svc_ota.h
+STATUSES = ["ok", "resumed", "no session", "bad packet", "too large", "wrong offset", "incomplete", "flash error",
+            "hash mismatch", "bad signature"]
+OK, RESUMED, WRONG_OFFSET, INCOMPLETE = 0, 1, 5, 6
+
+ATT_HEADER_SIZE = 3
+DATA_HEADER_SIZE = 4
+RECONNECT_ATTEMPTS = 5
+
+
+class Upload:
+    def __init__(self, path):
+        self.size, self.digest, self.signature, self.image = ota_sign.load(path)
+        self.results = asyncio.Queue()
+
+    def on_result(self, _, value):
+        opcode, status, offset, bytes_per_second = struct.unpack("<BBII", bytes(value))
+        self.results.put_nowait((opcode, status, offset, bytes_per_second))
+
+    async def result(self, opcode):
+        while True:
+            result = await asyncio.wait_for(self.results.get(), timeout=30)
+            if result[0] == opcode:
+                return result
+
+    async def send(self, client):
+        await client.start_notify(CONTROL_UUID, self.on_result)
+        begin = struct.pack("<BI", OPCODE_BEGIN, self.size) + self.digest + self.signature
+        await client.write_gatt_char(CONTROL_UUID, begin, response=True)
+        _, status, offset, _ = await self.result(OPCODE_BEGIN)
+        if status not in (OK, RESUMED):
+            raise RuntimeError("begin refused: %s" % STATUSES[status])
+        print("%s at %d / %d" % ("Resuming" if status == RESUMED else "Starting", offset, self.size))
+
+        chunk_size = client.mtu_size - ATT_HEADER_SIZE - DATA_HEADER_SIZE
+        while offset < self.size:
+            chunk = self.image[offset:offset + chunk_size]
+            await client.write_gatt_char(DATA_UUID, struct.pack("<I", offset) + chunk, response=False)
+            offset += len(chunk)
+
+            # Only rejected chunks are answered, follow the offset the device asks for
+            while not self.results.empty():
+                opcode, status, expected, _ = self.results.get_nowait()
+                if opcode == OPCODE_DATA and status == WRONG_OFFSET:
+                    offset = expected
+                elif opcode == OPCODE_DATA:
+                    raise RuntimeError("chunk refused: %s" % STATUSES[status])
+            print("\r%d / %d" % (offset, self.size), end="")
+        print()
+
+        await client.write_gatt_char(CONTROL_UUID, bytes([OPCODE_END]), response=True)
+        _, status, offset, bytes_per_second = await self.result(OPCODE_END)
+        if status == INCOMPLETE:
+            # Chunks were lost at the very end, the next attempt resumes
+            raise BleakError("device only has %d bytes" % offset)
+        if status != OK:
+            raise RuntimeError("image refused: %s" % STATUSES[status])
+        print("Verified, %d B/s on the device, restarting into the new image" % bytes_per_second)
+
+
+async def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("image")
+    parser.add_argument("--name", default="PrayerDisplayer")
+    parser.add_argument("--address")
+    arguments = parser.parse_args()
+
+    upload = Upload(arguments.image)
+    for _ in range(RECONNECT_ATTEMPTS):
+        device = arguments.address or await BleakScanner.find_device_by_name(arguments.name)
+        if device is None:
+            sys.exit("%s not found" % arguments.name)
+        try:
+            async with BleakClient(device) as client:
+                await upload.send(client)
+                return
+        except (BleakError, asyncio.TimeoutError) as error:
+            print("\nConnection lost (%s), reconnecting" % error)
+    sys.exit("Giving up after %d attempts" % RECONNECT_ATTEMPTS)
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
@@ -0,0 +1,98 @@
+"""
+Decode telemetry snapshots, the value of the telemetry characteristic (...26af) or the output of the telemetry command.
+
+Each argument is a snapshot in hex, or a file whose lines are snapshots in hex, optionally prefixed by "telemetry,"
+(a serial capture) or by a device name and a comma (a gateway log). Other lines are skipped.
+
+python scripts/telemetry_decode.py 0100...
+python scripts/telemetry_decode.py capture.log --json
+"""
+
+import json
+import os
+import re
+import struct
+import sys
+
+VERSION = 1
+HEADER = struct.Struct("<BBIIIIIiIiBIIIIIIIIII")
+NEVER = 0xFFFFFFFF
+NO_TASK = 0xFFFF
+FIELDS = ["version", "task_count", "uptime_s", "free_heap", "min_free_heap", "timetable_age_s", "clock_sync_age_s",
+          "clock_offset_us", "clock_error_us", "clock_drift_ppb", "time_source", "boundary_swaps", "boundaries_late",
+          "boundaries_missed", "latency_last_us", "latency_max_us", "frames_flushed", "flush_errors", "flush_last_us",
+          "flush_max_us", "events_dropped"]
+# modTelemetryTask_t
+TASKS = ["cli", "log", "timings", "prayer", "display", "audio", "wifi_sync"]
+# svcClockSource_t
+TIME_SOURCES = ["none", "saved", "cli", "ble", "ble-exchange"]
+HEX_LINE = re.compile(r"^(?:([^,]*),)?\s*([0-9a-fA-F]+)\s*$")
+
+
+def decode(snapshot):
+    if len(snapshot) < HEADER.size:
+        raise ValueError("%d bytes, a snapshot has at least %d" % (len(snapshot), HEADER.size))
+    values = dict(zip(FIELDS, HEADER.unpack_from(snapshot)))
+    if values["version"] != VERSION:
+        raise ValueError("version %d, this decoder reads version %d" % (values["version"], VERSION))
+    count = values.pop("task_count")
+    if len(snapshot) != HEADER.size + 2 * count:
+        raise ValueError("%d bytes for %d task stacks" % (len(snapshot), count))
+
+    for field in ("timetable_age_s", "clock_sync_age_s"):
+        if values[field] == NEVER:
+            values[field] = None
+    source = values["time_source"]
+    values["time_source"] = TIME_SOURCES[source] if source < len(TIME_SOURCES) else str(source)
+
+    stacks = struct.unpack_from("<%dH" % count, snapshot, HEADER.size)
+    values["stack_free"] = {(TASKS[i] if i < len(TASKS) else "task%d" % i): (None if free == NO_TASK else free)
+                            for i, free in enumerate(stacks)}
+    return values
+
+
+def print_text(name, values):
+    if name:
+        print("%s:" % name)
+    for field, value in values.items():
+        if field == "stack_free":
+            running = ", ".join("%s %d" % (task, free) for task, free in value.items() if free is not None)
+            print("  %-18s %s" % ("stack_free", running))
+        else:
+            print("  %-18s %s" % (field, "never" if value is None else value))
+
+
+def snapshots(arguments):
+    for argument in arguments:
+        if not os.path.isfile(argument):
+            yield "", argument
+            continue
+        with open(argument) as capture:
+            for line in capture:
+                match = HEX_LINE.match(line.strip())
+                if match:
+                    prefix = match.group(1) or ""
+                    yield ("" if prefix == "telemetry" else prefix), match.group(2)
+
+
+if __name__ == "__main__":
+    arguments = [argument for argument in sys.argv[1:] if argument != "--json"]
+    as_json = len(arguments) != len(sys.argv) - 1
+    if not arguments:
+        sys.exit("usage: telemetry_decode.py <hex | file>... [--json]")
+
+    failed = False
+    for name, text in snapshots(arguments):
+        try:
+            values = decode(bytes.fromhex(text))
+        except ValueError as error:
+            print("%s%s" % (name + ": " if name else "", error), file=sys.stderr)
+            failed = True
+            continue
+        if as_json:
+            if name:
+                values = dict(device=name, **values)
+            print(json.dumps(values))
+        else:
+            print_text(name, values)
+    sys.exit(1 if failed else 0)
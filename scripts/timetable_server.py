@@ -0,0 +1,58 @@
+"""
+Serve a timetable file the way the Wi-Fi sync expects, as a local stand-in for the real endpoint.
+
+The file is sent with an ETag and a Last-Modified header and a 304 answers a matching If-None-Match or
+If-Modified-Since, so conditional fetches can be checked by touching or editing the file. A `.json` file is served as
+application/json, anything else as application/octet-stream (BLE packets back to back).
+
+python scripts/timetable_server.py timetable.json 8080
+then build the esp32dev-wifi environment with PRAYER_WIFI_URL=http://<host>:8080/
+"""
+
+import email.utils
+import hashlib
+import http.server
+import os
+import sys
+
+
+def make_handler(path):
+    class TimetableHandler(http.server.BaseHTTPRequestHandler):
+        def do_GET(self):
+            with open(path, "rb") as timetable:
+                body = timetable.read()
+            etag = '"%s"' % hashlib.sha1(body).hexdigest()[:16]
+            modified = int(os.path.getmtime(path))
+
+            if self.headers.get("If-None-Match") == etag or self.not_modified_since(modified):
+                self.send_response(304)
+                self.send_header("ETag", etag)
+                self.end_headers()
+                return
+
+            self.send_response(200)
+            self.send_header("Content-Type", "application/json" if path.endswith(".json")
+                             else "application/octet-stream")
+            self.send_header("Content-Length", str(len(body)))
+            self.send_header("ETag", etag)
+            self.send_header("Last-Modified", email.utils.formatdate(modified, usegmt=True))
+            self.end_headers()
+            self.wfile.write(body)
+
+        def not_modified_since(self, modified):
+            since = self.headers.get("If-Modified-Since")
+            if since is None or self.headers.get("If-None-Match") is not None:
+                return False
+            try:
+                return modified <= email.utils.parsedate_to_datetime(since).timestamp()
+            except (TypeError, ValueError):
+                return False
+
+    return TimetableHandler
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        sys.exit("usage: timetable_server.py <timetable file> [port]")
+    port = int(sys.argv[2]) if len(sys.argv) > 2 else 8080
+    http.server.HTTPServer(("", port), make_handler(sys.argv[1])).serve_forever()
@@ -0,0 +1,82 @@
+"""
+Convert a trace dump (trace dump command) into the Chrome trace event JSON read by Perfetto and chrome://tracing.
+
+The capture is the raw serial output, anything before the "PDTR" magic is skipped. Each task becomes a thread of the
+timeline, the core it ran on is kept in the arguments of every event.
+
+python scripts/trace_to_perfetto.py capture.bin trace.json
+"""
+
+import json
+import struct
+import sys
+
+MAGIC = b"PDTR"
+VERSION = 1
+RECORD = struct.Struct("<IIIBBH")
+NAME_TRACEPOINT = 0
+NAME_TASK = 1
+NAME_END = 0xFF
+PHASES = {0: "B", 1: "E", 2: "i"}
+PID = 1
+
+
+def parse(capture):
+    start = capture.find(MAGIC)
+    if start < 0:
+        sys.exit("no trace dump in the capture")
+    position = start + len(MAGIC)
+    version, count, overwritten = struct.unpack_from("<BII", capture, position)
+    if version != VERSION:
+        sys.exit("unsupported trace version %d" % version)
+    position += 9
+
+    records = []
+    for _ in range(count):
+        records.append(RECORD.unpack_from(capture, position))
+        position += RECORD.size
+
+    names = {NAME_TRACEPOINT: {}, NAME_TASK: {}}
+    while position < len(capture) and capture[position] != NAME_END:
+        kind, key, length = struct.unpack_from("<BIB", capture, position)
+        position += 6
+        names.setdefault(kind, {})[key] = capture[position:position + length].decode("utf-8", errors="replace")
+        position += length
+    return records, names, overwritten
+
+
+def to_events(records, names):
+    events = [{"name": "process_name", "ph": "M", "pid": PID, "args": {"name": "PrayerDisplayer"}}]
+    for task, name in names[NAME_TASK].items():
+        events.append({"name": "thread_name", "ph": "M", "pid": PID, "tid": task, "args": {"name": name}})
+
+    # The device keeps the low 32 bits of the microsecond timer, records are in order so a step back is a wrap
+    wraps = 0
+    previous = None
+    for time_us, name, task, kind, core, value in records:
+        if previous is not None and time_us < previous:
+            wraps += 1
+        previous = time_us
+        event = {
+            "name": names[NAME_TRACEPOINT].get(name, "0x%08x" % name),
+            "ph": PHASES.get(kind, "i"),
+            "ts": time_us + (wraps << 32),
+            "pid": PID,
+            "tid": task,
+            "args": {"core": core},
+        }
+        if kind == 2:
+            event["s"] = "t"
+            event["args"]["value"] = value
+        events.append(event)
+    return events
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        sys.exit("usage: trace_to_perfetto.py <capture.bin> <trace.json>")
+    with open(sys.argv[1], "rb") as capture_file:
+        trace_records, trace_names, lost = parse(capture_file.read())
+    with open(sys.argv[2], "w", encoding="utf-8") as output:
+        json.dump({"traceEvents": to_events(trace_records, trace_names), "displayTimeUnit": "ms"}, output)
+    print("%d records converted, %d overwritten before the dump" % (len(trace_records), lost))
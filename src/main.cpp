@@ -15,7 +15,20 @@
 #include "Wire.h"
 #include <mod_timings.h>
 #include <mod_prayer.h>
+#include <mod_display.h>
+#include <mod_audio.h>
+#include <mod_ota.h>
+#include <mod_wifi_sync.h>
+#include <mod_bench.h>
+#include <mod_telemetry.h>
 #include <svc_display.h>
+#include <svc_event.h>
+#include <svc_clock.h>
+#include <svc_config.h>
+#include <svc_log.h>
+#include <svc_power.h>
+#include <svc_state.h>
+#include <svc_trace.h>
 #include <mod_cli0.h>
 #include <svc_cli.h>
 /*=============================================================================
@@ -50,16 +63,15 @@ void commandTasks(cmd *c);
 
 // Task Handles
 static TaskHandle_t modCliTaskHandle = nullptr;
+static TaskHandle_t svcLogTaskHandle = nullptr;
 static TaskHandle_t modBTETaskHandle = nullptr;
 static TaskHandle_t modPrayerTaskHandle = nullptr;
-
-// Task Parameters
-static modBTEParams_t modBTEParams;
-static modPrayerParams_t modPrayerParams;
-
-static QueueHandle_t timingsQueue;
-
-static SemaphoreHandle_t prayerSemaphore;
+static TaskHandle_t modDisplayTaskHandle = nullptr;
+static TaskHandle_t modAudioTaskHandle = nullptr;
+static TaskHandle_t modOtaTaskHandle = nullptr;
+#ifdef MOD_WIFI_SYNC
+static TaskHandle_t modWifiSyncTaskHandle = nullptr;
+#endif
 
 /*=============================================================================
                                 Private Constants
@@ -69,7 +81,7 @@ static const TaskParameters_t modBTETaskParams = {
     modBTETaskProcess,
     "modTimingsTask",
     8192,
-    (void *) &modBTEParams,
+    nullptr,
     5
 };
 
@@ -77,10 +89,54 @@ static const TaskParameters_t modPrayerTaskParams = {
     modPrayerTaskProcess,
     "modPrayerTask",
     8192,
-    (void *) &modPrayerParams,
+    nullptr,
     5
 };
 
+static const TaskParameters_t modDisplayTaskParams = {
+    modDisplayTaskProcess,
+    "modDisplayTask",
+    4096,
+    nullptr,
+    4
+};
+
+// Below the display and BLE tasks, the decoding only fills the gaps they leave
+static const TaskParameters_t modAudioTaskParams = {
+    modAudioTaskProcess,
+    "modAudioTask",
+    4096,
+    nullptr,
+    2
+};
+
+// Below the display, flash erases during an update must not delay the next prayer
+static const TaskParameters_t modOtaTaskParams = {
+    modOtaTaskProcess,
+    "modOtaTask",
+    6144,
+    nullptr,
+    3
+};
+
+#ifdef MOD_WIFI_SYNC
+static const TaskParameters_t modWifiSyncTaskParams = {
+    modWifiSyncTaskProcess,
+    "modWifiSyncTask",
+    6144,
+    nullptr,
+    3
+};
+#endif
+
+static const TaskParameters_t svcLogTaskParams = {
+    svcLogTaskProcess,
+    "svcLogTask",
+    3072,
+    nullptr,
+    1
+};
+
 static const TaskParameters_t modCliParameters = {
     modCli0EntryPoint,
     "CLI0",
@@ -97,27 +153,69 @@ static const TaskParameters_t modCliParameters = {
 void setup() {
     Serial.begin(115200);
 
-    prayerSemaphore = xSemaphoreCreateBinary();
-
-    timingsQueue = xQueueCreate(MAX_DAYS, sizeof(PrayerTimings));
-
     bool status = modCli0Init();
     appMainRegisterCommands();
     mainCreateTask(&modCliParameters, &modCliTaskHandle);
     Serial.printf("[%s] CLI service \n", status ? "O" : "X");
 
+    // Before the services reading their settings
+    status = svcConfigInit();
+    Serial.printf("[%s] Config service \n", status ? "O" : "X");
+
+    status = svcLogInit() && mainCreateTask(&svcLogTaskParams, &svcLogTaskHandle);
+    Serial.printf("[%s] Log service \n", status ? "O" : "X");
+
+    status = svcTraceInit();
+    Serial.printf("[%s] Trace service \n", status ? "O" : "X");
+
+    // Before the services reporting their power states
+    status = svcPowerInit();
+    Serial.printf("[%s] Power service \n", status ? "O" : "X");
+
+    status = svcClockInit();
+    Serial.printf("[%s] Clock service (%s) \n", status ? "O" : "X", svcClockZoneName());
+
+    status = svcEventInit();
+    Serial.printf("[%s] Event service \n", status ? "O" : "X");
+
+    status = svcStateInit();
+    Serial.printf("[%s] State service \n", status ? "O" : "X");
+
     status = svcDisplayInit();
     Serial.printf("[%s] Display service \n", status ? "O" : "X");
 
-    modBTEParams.timingsQueue = timingsQueue;
-    modBTEParams.prayerSemaphore = prayerSemaphore;
+    status = modBenchInit();
+    Serial.printf("[%s] Bench module \n", status ? "O" : "X");
+
+    status = mainCreateTask(&modDisplayTaskParams, &modDisplayTaskHandle);
+    Serial.printf("[%s] Display module \n", status ? "O" : "X");
+
+    status = mainCreateTask(&modAudioTaskParams, &modAudioTaskHandle);
+    Serial.printf("[%s] Audio module \n", status ? "O" : "X");
+
+    // Before the BLE stack starts, its writes are queued to this task
+    status = mainCreateTask(&modOtaTaskParams, &modOtaTaskHandle);
+    Serial.printf("[%s] OTA module \n", status ? "O" : "X");
+
     status = mainCreateTask(&modBTETaskParams, &modBTETaskHandle);
     Serial.printf("[%s] BTE module \n", status ? "O" : "X");
 
-    modPrayerParams.prayersQueue = timingsQueue;
-    modPrayerParams.prayerSemaphore = prayerSemaphore;
     status = mainCreateTask(&modPrayerTaskParams, &modPrayerTaskHandle);
     Serial.printf("[%s] Prayer module \n", status ? "O" : "X");
+
+#ifdef MOD_WIFI_SYNC
+    status = mainCreateTask(&modWifiSyncTaskParams, &modWifiSyncTaskHandle);
+    Serial.printf("[%s] Wi-Fi sync module \n", status ? "O" : "X");
+    modTelemetrySetTask(MOD_TELEMETRY_TASK_WIFI_SYNC, modWifiSyncTaskHandle);
+#endif
+
+    // Stack high-water marks of the telemetry snapshot
+    modTelemetrySetTask(MOD_TELEMETRY_TASK_CLI, modCliTaskHandle);
+    modTelemetrySetTask(MOD_TELEMETRY_TASK_LOG, svcLogTaskHandle);
+    modTelemetrySetTask(MOD_TELEMETRY_TASK_TIMINGS, modBTETaskHandle);
+    modTelemetrySetTask(MOD_TELEMETRY_TASK_PRAYER, modPrayerTaskHandle);
+    modTelemetrySetTask(MOD_TELEMETRY_TASK_DISPLAY, modDisplayTaskHandle);
+    modTelemetrySetTask(MOD_TELEMETRY_TASK_AUDIO, modAudioTaskHandle);
 }
 
 void loop() {
@@ -150,26 +248,33 @@ void commandTasks(cmd *c) {
 
     const TaskHandle_t taskHandleList[] = {
         modCliTaskHandle,
+        svcLogTaskHandle,
         modBTETaskHandle,
-        modPrayerTaskHandle
+        modPrayerTaskHandle,
+        modDisplayTaskHandle,
+        modAudioTaskHandle,
+        modOtaTaskHandle,
+#ifdef MOD_WIFI_SYNC
+        modWifiSyncTaskHandle,
+#endif
     };
 
-    Serial.write("\r\n--------------------------------------------------------------------------\r\n");
-    Serial.printf("%-15s | %-8s | %-10s | %-15s | %-10s\r\n", "Task Name", "State", "Priority",
-                  "High Watermark", "Handle");
-    Serial.printf("%-15s | %-8s | %-10s | %-15s | %-10s\r\n", "", "0-5", "",
-                  "(bytes)", "");
-    Serial.printf("--------------------------------------------------------------------------\r\n");
+    svcCliOut()->write("\r\n--------------------------------------------------------------------------\r\n");
+    svcCliOut()->printf("%-15s | %-8s | %-10s | %-15s | %-10s\r\n", "Task Name", "State", "Priority",
+                        "High Watermark", "Handle");
+    svcCliOut()->printf("%-15s | %-8s | %-10s | %-15s | %-10s\r\n", "", "0-5", "",
+                        "(bytes)", "");
+    svcCliOut()->printf("--------------------------------------------------------------------------\r\n");
 
     for (int i = 0; i < sizeof(taskHandleList) / sizeof(taskHandleList[0]); i++) {
-        Serial.printf("%-15s | %-8d | %-10d | %-15d | %-10p\r\n",
-                      pcTaskGetName(taskHandleList[i]),
-                      eTaskGetState(taskHandleList[i]),
-                      uxTaskPriorityGet(taskHandleList[i]),
-                      uxTaskGetStackHighWaterMark(taskHandleList[i]),
-                      taskHandleList[i]);
+        svcCliOut()->printf("%-15s | %-8d | %-10d | %-15d | %-10p\r\n",
+                            pcTaskGetName(taskHandleList[i]),
+                            eTaskGetState(taskHandleList[i]),
+                            uxTaskPriorityGet(taskHandleList[i]),
+                            uxTaskGetStackHighWaterMark(taskHandleList[i]),
+                            taskHandleList[i]);
     }
-    Serial.write("--------------------------------------------------------------------------\r\n");
+    svcCliOut()->write("--------------------------------------------------------------------------\r\n");
 }
 
 bool mainCreateTask(const TaskParameters_t *taskParameters, TaskHandle_t *taskHandle) {
@@ -181,7 +286,7 @@ bool mainCreateTask(const TaskParameters_t *taskParameters, TaskHandle_t *taskHa
                                              taskHandle);
 
     if (xReturned != pdPASS) {
-        Serial.printf("Failed to create task %s\n", taskParameters->pcName);
+        svcCliOut()->printf("Failed to create task %s\n", taskParameters->pcName);
         return false;
     }
 
@@ -0,0 +1,138 @@
+/*===========================================================================*/
+/// \file fuzz_protocol.cpp
+///
+/// \brief
+///    libFuzzer target of the BLE packet decoder
+///
+/// \details
+///     Every input is handed to svcProtocolDecode() in a buffer of its exact size, so AddressSanitizer reports any
+///     read past the packet. An accepted packet must also be long enough for its header and hold only the ranges the
+///     firmware relies on afterwards (the day indexes the timetable, the times go to the calendar code).
+///
+///     clang++ -g -O1 -fsanitize=fuzzer,address,undefined -Ilib/service -Ilib/module -Itest/mock
+///         test/fuzz/fuzz_protocol.cpp lib/service/svc_protocol.cpp -o fuzz_protocol
+///     ./fuzz_protocol -max_len=64 test/fuzz/corpus
+///
+///     Without clang, -DFUZZ_STANDALONE and g++ -fsanitize=address,undefined build a runner replaying the files
+///     given on the command line, such as the corpus or a crash found elsewhere.
+///     The timetable types of the decoder header come from lib/module, test/mock stands in for the Arduino core.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <svc_protocol.h>
+#include <vector>
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+#define FUZZ_CHECK(condition)                                                                                      \
+    do {                                                                                                           \
+        if (!(condition)) {                                                                                        \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition);                                        \
+            abort();                                                                                               \
+        }                                                                                                          \
+    } while (0)
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static void checkPacket(const svcProtocolPacket_t *packet, size_t length);
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    svcProtocolPacket_t packet;
+    const svcProtocolStatus_t status = svcProtocolDecode(size > 0 ? data : nullptr, size, &packet);
+    FUZZ_CHECK(status < SVC_PROTOCOL_STATUS_COUNT);
+    FUZZ_CHECK(strcmp(svcProtocolStatusToString(status), "unknown") != 0);
+    FUZZ_CHECK((status == SVC_PROTOCOL_EMPTY) == (size == 0));
+
+    if (status == SVC_PROTOCOL_OK) {
+        checkPacket(&packet, size);
+    } else if (status == SVC_PROTOCOL_UNKNOWN_HEADER) {
+        FUZZ_CHECK(svcProtocolPacketSize(data[0]) == 0);
+    } else if (status == SVC_PROTOCOL_TOO_SHORT) {
+        FUZZ_CHECK(size < svcProtocolPacketSize(data[0]));
+    }
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        FILE *file = fopen(argv[i], "rb");
+        if (file == nullptr) {
+            perror(argv[i]);
+            return 1;
+        }
+        std::vector<uint8_t> input;
+        uint8_t chunk[256];
+        size_t length;
+        while ((length = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            input.insert(input.end(), chunk, chunk + length);
+        }
+        fclose(file);
+
+        // Exact size copy, so a read past the input is reported like under libFuzzer
+        uint8_t *exact = (uint8_t *) malloc(input.size() > 0 ? input.size() : 1);
+        if (!input.empty()) {
+            memcpy(exact, input.data(), input.size());
+        }
+        LLVMFuzzerTestOneInput(exact, input.size());
+        free(exact);
+    }
+    printf("%d inputs replayed\n", argc - 1);
+    return 0;
+}
+#endif
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+void checkPacket(const svcProtocolPacket_t *packet, size_t length) {
+    FUZZ_CHECK(length >= svcProtocolPacketSize(packet->header));
+
+    switch (packet->header) {
+        case NUMBER_OF_DAYS_HEADER:
+            FUZZ_CHECK(packet->numberOfDays >= 1 && packet->numberOfDays <= SVC_PROTOCOL_MAX_DAYS);
+            break;
+        case UPDATE_OF_DAYS_HEADER:
+            FUZZ_CHECK(packet->update.numberOfDays >= 1 && packet->update.numberOfDays <= SVC_PROTOCOL_MAX_DAYS);
+            break;
+        case PRAYER_TIMINGS_HEADER:
+            FUZZ_CHECK(packet->timings.day >= 1 && packet->timings.day <= SVC_PROTOCOL_MAX_DAYS);
+            FUZZ_CHECK(packet->timings.month >= 1 && packet->timings.month <= 12 && packet->timings.year <= 9999);
+            for (int i = 0; i < SVC_PROTOCOL_PRAYER_COUNT; i++) {
+                FUZZ_CHECK(packet->timings.prayers[i].hour < 24 && packet->timings.prayers[i].minute < 60);
+            }
+            break;
+        case CURRENT_TIME_HEADER:
+            FUZZ_CHECK(packet->time.hour < 24 && packet->time.minute < 60 && packet->time.second < 60);
+            FUZZ_CHECK(packet->time.day >= 1 && packet->time.day <= 31 && packet->time.month <= 11);
+            FUZZ_CHECK(packet->time.year <= 9999);
+            break;
+        case TIME_REQUEST_HEADER:
+        case TIME_RESULT_HEADER:
+            FUZZ_CHECK(packet->exchange.utcUs > 0);
+            break;
+        case END_OF_TIMINGS_HEADER:
+            break;
+        default:
+            FUZZ_CHECK(!"accepted an unknown header");
+    }
+}
@@ -0,0 +1,132 @@
+/*===========================================================================*/
+/// \file Adafruit_GFX.h
+///
+/// \brief
+///    Host stand-in for the Adafruit GFX library
+///
+/// \details
+///     The primitives the firmware uses, drawn through drawPixel() like the library does. Text is drawn as a filled
+///     box per character in the cell of the classic 6x8 font, or above the baseline with a GFXfont, so the frames
+///     are not blank and change with their text without the glyph data of the library.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_ADAFRUIT_GFX_H
+#define MOCK_ADAFRUIT_GFX_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    uint16_t bitmapOffset;
+    uint8_t width;
+    uint8_t height;
+    uint8_t xAdvance;
+    int8_t xOffset;
+    int8_t yOffset;
+} GFXglyph;
+
+typedef struct {
+    uint8_t *bitmap;
+    GFXglyph *glyph;
+    uint16_t first;
+    uint16_t last;
+    uint8_t yAdvance;
+} GFXfont;
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+class Adafruit_GFX : public Print {
+public:
+    Adafruit_GFX(int16_t w, int16_t h);
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+    virtual void fillScreen(uint16_t color);
+
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+    void setCursor(int16_t x, int16_t y) {
+        cursor_x = x;
+        cursor_y = y;
+    }
+
+    void setTextColor(uint16_t color) {
+        textcolor = color;
+    }
+
+    void setTextColor(uint16_t color, uint16_t background) {
+        textcolor = color;
+    }
+
+    void setTextSize(uint8_t size) {
+        textsize = size > 0 ? size : 1;
+    }
+
+    void setTextWrap(bool wrap) {
+        this->wrap = wrap;
+    }
+
+    void setFont(const GFXfont *font = nullptr) {
+        gfxFont = font;
+    }
+
+    void getTextBounds(const char *text, int16_t x, int16_t y, int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h);
+
+    void getTextBounds(const String &text, int16_t x, int16_t y, int16_t *x1, int16_t *y1, uint16_t *w,
+                       uint16_t *h) {
+        getTextBounds(text.c_str(), x, y, x1, y1, w, h);
+    }
+
+    size_t write(uint8_t c) override;
+
+    using Print::write;
+
+    int16_t width() const {
+        return _width;
+    }
+
+    int16_t height() const {
+        return _height;
+    }
+
+    int16_t getCursorX() const {
+        return cursor_x;
+    }
+
+    int16_t getCursorY() const {
+        return cursor_y;
+    }
+
+protected:
+    const int16_t WIDTH;
+    const int16_t HEIGHT;
+    int16_t _width;
+    int16_t _height;
+    int16_t cursor_x = 0;
+    int16_t cursor_y = 0;
+    uint16_t textcolor = 0xFFFF;
+    uint8_t textsize = 1;
+    bool wrap = true;
+    const GFXfont *gfxFont = nullptr;
+};
+
+#endif // MOCK_ADAFRUIT_GFX_H
@@ -0,0 +1,374 @@
+/*===========================================================================*/
+/// \file Arduino.h
+///
+/// \brief
+///    Host stand-in for the Arduino core of the ESP32
+///
+/// \details
+///     Only what the firmware and SimpleCLI use: String, Print, Stream, Serial on the standard output, the ESP
+///     object, the time functions on the virtual clock of the FreeRTOS mock and the GPIO writes, which do nothing.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_ARDUINO_H
+#define MOCK_ARDUINO_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/time.h>
+#include <time.h>
+#include <algorithm>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define PROGMEM
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+#define pgm_read_byte(address) (*(const uint8_t *) (address))
+#define pgm_read_word(address) (*(const uint16_t *) (address))
+#define pgm_read_pointer(address) (*(void *const *) (address))
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+/// Arduino String over std::string
+class String {
+public:
+    String(const char *text = "") : value(text != nullptr ? text : "") {
+    }
+
+    String(const std::string &text) : value(text) {
+    }
+
+    explicit String(char c) : value(1, c) {
+    }
+
+    explicit String(int number, unsigned char base = 10);
+
+    explicit String(unsigned int number, unsigned char base = 10);
+
+    explicit String(long number, unsigned char base = 10);
+
+    explicit String(unsigned long number, unsigned char base = 10);
+
+    explicit String(double number, unsigned int decimals = 2);
+
+    const char *c_str() const {
+        return value.c_str();
+    }
+
+    unsigned int length() const {
+        return (unsigned int) value.size();
+    }
+
+    bool isEmpty() const {
+        return value.empty();
+    }
+
+    bool reserve(unsigned int size) {
+        value.reserve(size);
+        return true;
+    }
+
+    char charAt(unsigned int index) const {
+        return index < value.size() ? value[index] : '\0';
+    }
+
+    char operator[](unsigned int index) const {
+        return charAt(index);
+    }
+
+    char &operator[](unsigned int index) {
+        return value[index];
+    }
+
+    int indexOf(char c, unsigned int from = 0) const;
+
+    int indexOf(const String &text, unsigned int from = 0) const;
+
+    int lastIndexOf(char c) const;
+
+    String substring(unsigned int begin) const;
+
+    String substring(unsigned int begin, unsigned int end) const;
+
+    bool equals(const String &other) const {
+        return value == other.value;
+    }
+
+    bool equalsIgnoreCase(const String &other) const;
+
+    bool startsWith(const String &prefix) const;
+
+    bool endsWith(const String &suffix) const;
+
+    void toLowerCase();
+
+    void toUpperCase();
+
+    void trim();
+
+    void replace(const String &from, const String &to);
+
+    long toInt() const {
+        return strtol(value.c_str(), nullptr, 10);
+    }
+
+    float toFloat() const {
+        return strtof(value.c_str(), nullptr);
+    }
+
+    bool concat(const String &other) {
+        value += other.value;
+        return true;
+    }
+
+    String &operator+=(const String &other) {
+        value += other.value;
+        return *this;
+    }
+
+    String &operator+=(const char *other) {
+        value += other;
+        return *this;
+    }
+
+    String &operator+=(char c) {
+        value += c;
+        return *this;
+    }
+
+    bool operator==(const String &other) const {
+        return value == other.value;
+    }
+
+    bool operator==(const char *other) const {
+        return value == other;
+    }
+
+    bool operator!=(const String &other) const {
+        return value != other.value;
+    }
+
+    bool operator!=(const char *other) const {
+        return value != other;
+    }
+
+    bool operator<(const String &other) const {
+        return value < other.value;
+    }
+
+    friend String operator+(const String &left, const String &right) {
+        return String(left.value + right.value);
+    }
+
+    friend String operator+(const String &left, const char *right) {
+        return String(left.value + right);
+    }
+
+    friend String operator+(const char *left, const String &right) {
+        return String(left + right.value);
+    }
+
+private:
+    std::string value;
+};
+
+/// Text output, the subclasses only provide the byte writes
+class Print {
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t c) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size);
+
+    size_t write(const char *text) {
+        return text != nullptr ? write((const uint8_t *) text, strlen(text)) : 0;
+    }
+
+    size_t write(const char *buffer, size_t size) {
+        return write((const uint8_t *) buffer, size);
+    }
+
+    virtual int availableForWrite() {
+        return 0;
+    }
+
+    virtual void flush() {
+    }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+    size_t print(const String &text) {
+        return write(text.c_str(), text.length());
+    }
+
+    size_t print(const char *text) {
+        return write(text);
+    }
+
+    size_t print(char c) {
+        return write((uint8_t) c);
+    }
+
+    size_t print(int number, int base = 10);
+
+    size_t print(unsigned int number, int base = 10);
+
+    size_t print(long number, int base = 10);
+
+    size_t print(unsigned long number, int base = 10);
+
+    size_t print(double number, int decimals = 2);
+
+    size_t println() {
+        return write("\r\n");
+    }
+
+    template<typename T>
+    size_t println(const T &value) {
+        const size_t written = print(value);
+        return written + println();
+    }
+};
+
+/// Byte input on top of Print
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+
+    virtual int read() = 0;
+
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeoutMs) {
+    }
+
+    size_t readBytes(uint8_t *buffer, size_t length);
+
+    size_t readBytes(char *buffer, size_t length) {
+        return readBytes((uint8_t *) buffer, length);
+    }
+};
+
+/// The console: writes go to the standard output, nothing is ever received
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) {
+    }
+
+    void end() {
+    }
+
+    int available() override {
+        return 0;
+    }
+
+    int read() override {
+        return -1;
+    }
+
+    int peek() override {
+        return -1;
+    }
+
+    int availableForWrite() override {
+        // Never makes the writers drop or wait, unlike the 128 bytes of the UART FIFO
+        return 4096;
+    }
+
+    void flush() override;
+
+    size_t write(uint8_t c) override;
+
+    size_t write(const uint8_t *buffer, size_t size) override;
+
+    using Print::write;
+
+    explicit operator bool() const {
+        return true;
+    }
+};
+
+/// The chip: fixed heap figures, the cycle counter on the wall clock for the benches
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+
+    uint32_t getMinFreeHeap();
+
+    uint32_t getHeapSize();
+
+    uint32_t getCycleCount();
+
+    uint32_t getCpuFreqMHz();
+
+    uint32_t getSketchSize();
+
+    uint32_t getFreeSketchSpace();
+
+    /// \brief Counted for the tests, the calling task then never runs again like after the reset
+    void restart();
+};
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+extern HardwareSerial Serial;
+
+extern EspClass ESP;
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+unsigned long millis();
+
+unsigned long micros();
+
+void delay(uint32_t ms);
+
+void delayMicroseconds(uint32_t us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+
+void digitalWrite(uint8_t pin, uint8_t value);
+
+int digitalRead(uint8_t pin);
+
+using std::max;
+using std::min;
+
+#endif // MOCK_ARDUINO_H
@@ -0,0 +1,27 @@
+/*===========================================================================*/
+/// \file FreeSerif9pt7b.h
+///
+/// \brief
+///    Host stand-in for the FreeSerif 9 pt font of Adafruit GFX, the metrics without the glyphs
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_FREESERIF9PT7B_H
+#define MOCK_FREESERIF9PT7B_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "../Adafruit_GFX.h"
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+static const GFXfont FreeSerif9pt7b = {nullptr, nullptr, 0x20, 0x7E, 22};
+
+#endif // MOCK_FREESERIF9PT7B_H
@@ -0,0 +1,107 @@
+/*===========================================================================*/
+/// \file Preferences.h
+///
+/// \brief
+///    Host stand-in for the Preferences library of the ESP32 core, the NVS store kept in memory
+///
+/// \details
+///     The namespaces are shared by every instance and survive end(), like the NVS partition across a reset. The
+///     values keep their type, a get of another type finds nothing like on the chip.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_PREFERENCES_H
+#define MOCK_PREFERENCES_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+#include <string>
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    PT_I8,
+    PT_U8,
+    PT_I16,
+    PT_U16,
+    PT_I32,
+    PT_U32,
+    PT_I64,
+    PT_U64,
+    PT_STR,
+    PT_BLOB,
+    PT_INVALID
+} PreferenceType;
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+class Preferences {
+public:
+    bool begin(const char *name, bool readOnly = false, const char *partitionLabel = nullptr);
+
+    void end();
+
+    bool clear();
+
+    bool remove(const char *key);
+
+    bool isKey(const char *key);
+
+    PreferenceType getType(const char *key);
+
+    size_t putBool(const char *key, bool value);
+
+    size_t putUChar(const char *key, uint8_t value);
+
+    size_t putUShort(const char *key, uint16_t value);
+
+    size_t putInt(const char *key, int32_t value);
+
+    size_t putUInt(const char *key, uint32_t value);
+
+    size_t putLong64(const char *key, int64_t value);
+
+    size_t putString(const char *key, const char *value);
+
+    size_t putBytes(const char *key, const void *value, size_t length);
+
+    bool getBool(const char *key, bool defaultValue = false);
+
+    uint8_t getUChar(const char *key, uint8_t defaultValue = 0);
+
+    uint16_t getUShort(const char *key, uint16_t defaultValue = 0);
+
+    int32_t getInt(const char *key, int32_t defaultValue = 0);
+
+    uint32_t getUInt(const char *key, uint32_t defaultValue = 0);
+
+    int64_t getLong64(const char *key, int64_t defaultValue = 0);
+
+    /// \return The length including the terminator, 0 if the key is missing or the value does not fit
+    size_t getString(const char *key, char *value, size_t maxLength);
+
+    size_t getBytesLength(const char *key);
+
+    size_t getBytes(const char *key, void *value, size_t maxLength);
+
+private:
+    size_t put(const char *key, PreferenceType type, const void *value, size_t length);
+
+    bool get(const char *key, PreferenceType type, void *value, size_t length);
+
+    std::string space;
+    bool started = false;
+    bool readOnly = false;
+};
+
+#endif // MOCK_PREFERENCES_H
@@ -0,0 +1,79 @@
+/*===========================================================================*/
+/// \file SPI.h
+///
+/// \brief
+///    Host stand-in for the SPI library of the ESP32 core, the written bytes are dropped
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_SPI_H
+#define MOCK_SPI_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define SPI_MODE0 0
+#define SPI_MODE1 1
+#define SPI_MODE2 2
+#define SPI_MODE3 3
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+class SPISettings {
+public:
+    SPISettings(uint32_t clock = 1000000, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0)
+        : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {
+    }
+
+    uint32_t clock;
+    uint8_t bitOrder;
+    uint8_t dataMode;
+};
+
+class SPIClass {
+public:
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {
+    }
+
+    void end() {
+    }
+
+    void beginTransaction(SPISettings settings) {
+    }
+
+    void endTransaction() {
+    }
+
+    uint8_t transfer(uint8_t data) {
+        return 0;
+    }
+
+    void write(uint8_t data) {
+    }
+
+    void writeBytes(const uint8_t *data, uint32_t size) {
+    }
+};
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+extern SPIClass SPI;
+
+#endif // MOCK_SPI_H
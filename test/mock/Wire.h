@@ -0,0 +1,90 @@
+/*===========================================================================*/
+/// \file Wire.h
+///
+/// \brief
+///    Host stand-in for the I2C library of the ESP32 core, with SSD1306 panels on the bus
+///
+/// \details
+///     Each present address holds an emulated SSD1306 that parses the commands and fills its graphic RAM, 0x3C is
+///     present from the start. The addresses of the TCA9548A multiplexers (0x70 to 0x77) always acknowledge and
+///     select nothing, every panel is reachable whatever the channel. A missing address NACKs like on the bus.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_WIRE_H
+#define MOCK_WIRE_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+// Same as the core, a transmission longer than this is cut
+#define I2C_BUFFER_LENGTH 128
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+class TwoWire : public Stream {
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+
+    bool setClock(uint32_t frequency);
+
+    void beginTransmission(uint8_t address);
+
+    /// \return 0 on success, 2 when the address is not acknowledged
+    uint8_t endTransmission(bool sendStop = true);
+
+    uint8_t requestFrom(uint8_t address, uint8_t size, bool sendStop = true);
+
+    size_t write(uint8_t c) override;
+
+    size_t write(const uint8_t *data, size_t size) override;
+
+    // The literal arguments would be ambiguous with write(const char *) otherwise, as in the core
+    size_t write(int n) {
+        return write((uint8_t) n);
+    }
+
+    size_t write(unsigned int n) {
+        return write((uint8_t) n);
+    }
+
+    using Print::write;
+
+    int available() override {
+        return 0;
+    }
+
+    int read() override {
+        return -1;
+    }
+
+    int peek() override {
+        return -1;
+    }
+
+private:
+    uint8_t address = 0;
+    uint8_t buffer[I2C_BUFFER_LENGTH];
+    size_t length = 0;
+    bool transmitting = false;
+};
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+extern TwoWire Wire;
+
+#endif // MOCK_WIRE_H
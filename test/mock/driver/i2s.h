@@ -0,0 +1,115 @@
+/*===========================================================================*/
+/// \file i2s.h
+///
+/// \brief
+///    Host stand-in for the legacy I2S driver of the ESP-IDF 4.4, every call succeeds and the samples are dropped
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_DRIVER_I2S_H
+#define MOCK_DRIVER_I2S_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+#define ESP_IDF_VERSION ESP_IDF_VERSION_VAL(4, 4, 5)
+#define SOC_I2S_SUPPORTS_DAC 1
+#define ESP_INTR_FLAG_LEVEL1 (1 << 1)
+#define I2S_PIN_NO_CHANGE (-1)
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    I2S_NUM_0 = 0,
+    I2S_NUM_1 = 1,
+} i2s_port_t;
+
+typedef enum {
+    I2S_MODE_MASTER = 1 << 0,
+    I2S_MODE_SLAVE = 1 << 1,
+    I2S_MODE_TX = 1 << 2,
+    I2S_MODE_RX = 1 << 3,
+    I2S_MODE_DAC_BUILT_IN = 1 << 4,
+} i2s_mode_t;
+
+typedef enum {
+    I2S_BITS_PER_SAMPLE_16BIT = 16,
+} i2s_bits_per_sample_t;
+
+typedef enum {
+    I2S_CHANNEL_FMT_RIGHT_LEFT,
+    I2S_CHANNEL_FMT_ALL_RIGHT,
+    I2S_CHANNEL_FMT_ALL_LEFT,
+    I2S_CHANNEL_FMT_ONLY_RIGHT,
+    I2S_CHANNEL_FMT_ONLY_LEFT,
+} i2s_channel_fmt_t;
+
+typedef enum {
+    I2S_COMM_FORMAT_STAND_I2S = 0x01,
+    I2S_COMM_FORMAT_STAND_MSB = 0x02,
+} i2s_comm_format_t;
+
+typedef enum {
+    I2S_DAC_CHANNEL_DISABLE = 0,
+    I2S_DAC_CHANNEL_RIGHT_EN = 1,
+    I2S_DAC_CHANNEL_LEFT_EN = 2,
+    I2S_DAC_CHANNEL_BOTH_EN = 3,
+} i2s_dac_mode_t;
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    i2s_mode_t mode;
+    uint32_t sample_rate;
+    i2s_bits_per_sample_t bits_per_sample;
+    i2s_channel_fmt_t channel_format;
+    i2s_comm_format_t communication_format;
+    int intr_alloc_flags;
+    int dma_buf_count;
+    int dma_buf_len;
+    bool use_apll;
+    bool tx_desc_auto_clear;
+    int fixed_mclk;
+} i2s_config_t;
+
+typedef struct {
+    int mck_io_num;
+    int bck_io_num;
+    int ws_io_num;
+    int data_out_num;
+    int data_in_num;
+} i2s_pin_config_t;
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+esp_err_t i2s_driver_install(i2s_port_t port, const i2s_config_t *config, int queueSize, void *queue);
+
+esp_err_t i2s_driver_uninstall(i2s_port_t port);
+
+esp_err_t i2s_set_pin(i2s_port_t port, const i2s_pin_config_t *pins);
+
+esp_err_t i2s_set_dac_mode(i2s_dac_mode_t mode);
+
+esp_err_t i2s_write(i2s_port_t port, const void *data, size_t size, size_t *written, TickType_t ticks);
+
+#endif // MOCK_DRIVER_I2S_H
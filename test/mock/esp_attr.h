@@ -0,0 +1,26 @@
+/*===========================================================================*/
+/// \file esp_attr.h
+///
+/// \brief
+///    Host stand-in for the placement attributes of the ESP-IDF, the host has a single memory
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_ESP_ATTR_H
+#define MOCK_ESP_ATTR_H
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_FAST_ATTR
+#define RTC_SLOW_ATTR
+
+#endif // MOCK_ESP_ATTR_H
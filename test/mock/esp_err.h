@@ -0,0 +1,33 @@
+/*===========================================================================*/
+/// \file esp_err.h
+///
+/// \brief
+///    Host stand-in for the error codes of the ESP-IDF
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_ESP_ERR_H
+#define MOCK_ESP_ERR_H
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_INVALID_SIZE 0x104
+#define ESP_ERR_NOT_FOUND 0x105
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+typedef int esp_err_t;
+
+#endif // MOCK_ESP_ERR_H
@@ -0,0 +1,38 @@
+/*===========================================================================*/
+/// \file esp_freertos_hooks.h
+///
+/// \brief
+///    Host stand-in for the FreeRTOS hooks of the ESP-IDF, the mock has no tick interrupt so they are never called
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_ESP_FREERTOS_HOOKS_H
+#define MOCK_ESP_FREERTOS_HOOKS_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+typedef void (*esp_freertos_tick_cb_t)();
+
+typedef bool (*esp_freertos_idle_cb_t)();
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+esp_err_t esp_register_freertos_tick_hook_for_cpu(esp_freertos_tick_cb_t callback, UBaseType_t core);
+
+esp_err_t esp_register_freertos_idle_hook_for_cpu(esp_freertos_idle_cb_t callback, UBaseType_t core);
+
+#endif // MOCK_ESP_FREERTOS_HOOKS_H
@@ -0,0 +1,56 @@
+/*===========================================================================*/
+/// \file esp_ota_ops.h
+///
+/// \brief
+///    Host stand-in for the OTA API of the ESP-IDF
+///
+/// \details
+///     The firmware runs from app0 with a valid image, the updates go to app1. Setting the boot partition is only
+///     recorded, the tests read it back with esp_ota_get_boot_partition().
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_ESP_OTA_OPS_H
+#define MOCK_ESP_OTA_OPS_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "esp_partition.h"
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    ESP_OTA_IMG_NEW = 0x0,
+    ESP_OTA_IMG_PENDING_VERIFY = 0x1,
+    ESP_OTA_IMG_VALID = 0x2,
+    ESP_OTA_IMG_INVALID = 0x3,
+    ESP_OTA_IMG_ABORTED = 0x4,
+    ESP_OTA_IMG_UNDEFINED = 0xFFFFFFFF,
+} esp_ota_img_states_t;
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+const esp_partition_t *esp_ota_get_running_partition();
+
+const esp_partition_t *esp_ota_get_boot_partition();
+
+const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *start);
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t *partition);
+
+esp_err_t esp_ota_get_state_partition(const esp_partition_t *partition, esp_ota_img_states_t *state);
+
+esp_err_t esp_ota_mark_app_valid_cancel_rollback();
+
+esp_err_t esp_ota_mark_app_invalid_rollback_and_reboot();
+
+#endif // MOCK_ESP_OTA_OPS_H
@@ -0,0 +1,77 @@
+/*===========================================================================*/
+/// \file esp_partition.h
+///
+/// \brief
+///    Host stand-in for the partition API of the ESP-IDF
+///
+/// \details
+///     The partitions of partitions.csv that the firmware opens are kept in memory and behave like NOR flash: an
+///     erase sets whole 4 KiB sectors to 0xFF and a write can only clear bits.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_ESP_PARTITION_H
+#define MOCK_ESP_PARTITION_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "esp_err.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SPI_FLASH_SEC_SIZE 4096
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+typedef enum {
+    ESP_PARTITION_SUBTYPE_APP_FACTORY = 0x00,
+    ESP_PARTITION_SUBTYPE_APP_OTA_0 = 0x10,
+    ESP_PARTITION_SUBTYPE_APP_OTA_1 = 0x11,
+    ESP_PARTITION_SUBTYPE_DATA_OTA = 0x00,
+    ESP_PARTITION_SUBTYPE_DATA_NVS = 0x02,
+    ESP_PARTITION_SUBTYPE_ANY = 0xff,
+} esp_partition_subtype_t;
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+    bool encrypted;
+} esp_partition_t;
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label);
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t offset, void *data, size_t size);
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t offset, const void *data, size_t size);
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size);
+
+#endif // MOCK_ESP_PARTITION_H
@@ -0,0 +1,50 @@
+/*===========================================================================*/
+/// \file esp_sleep.h
+///
+/// \brief
+///    Host stand-in for the sleep modes of the ESP-IDF
+///
+/// \details
+///     A light sleep is time passing with the calling task still holding the CPU, like on the chip where the other
+///     tasks do not run meanwhile. A deep sleep ends the program for the calling task, the next boot is up to the test.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_ESP_SLEEP_H
+#define MOCK_ESP_SLEEP_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "esp_err.h"
+#include <stdint.h>
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    ESP_SLEEP_WAKEUP_UNDEFINED,
+    ESP_SLEEP_WAKEUP_ALL,
+    ESP_SLEEP_WAKEUP_EXT0,
+    ESP_SLEEP_WAKEUP_EXT1,
+    ESP_SLEEP_WAKEUP_TIMER,
+} esp_sleep_wakeup_cause_t;
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs);
+
+esp_err_t esp_light_sleep_start();
+
+[[noreturn]] void esp_deep_sleep_start();
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause();
+
+#endif // MOCK_ESP_SLEEP_H
@@ -0,0 +1,29 @@
+/*===========================================================================*/
+/// \file esp_system.h
+///
+/// \brief
+///    Host stand-in for the system calls of the ESP-IDF
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_ESP_SYSTEM_H
+#define MOCK_ESP_SYSTEM_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <stdint.h>
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Get a random word, from a generator seeded the same way on every run so the tests repeat
+/// \return The random word
+uint32_t esp_random();
+
+#endif // MOCK_ESP_SYSTEM_H
@@ -0,0 +1,29 @@
+/*===========================================================================*/
+/// \file esp_timer.h
+///
+/// \brief
+///    Host stand-in for the high resolution timer of the ESP-IDF, on the virtual clock of the FreeRTOS mock
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_ESP_TIMER_H
+#define MOCK_ESP_TIMER_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <stdint.h>
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Get the time since boot, each read advances it by a microsecond
+/// \return Microseconds since boot
+int64_t esp_timer_get_time();
+
+#endif // MOCK_ESP_TIMER_H
@@ -0,0 +1,116 @@
+/*===========================================================================*/
+/// \file FreeRTOS.h
+///
+/// \brief
+///    Host stand-in for the FreeRTOS kernel of the ESP32 core
+///
+/// \details
+///     Every task is a thread but only one of them runs at a time, the highest priority ready one, like on a single
+///     core. Time is virtual: it only moves when every task is blocked, straight to the earliest timeout, so a year
+///     of waits runs in seconds and the wake-ups land exactly on their tick. Reading the timer costs a microsecond,
+///     which lets the busy waits of the firmware end. Critical sections only hold back a switch, nothing else runs
+///     concurrently. The first thread calling the kernel becomes a task of priority 1, like the Arduino loop task.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_FREERTOS_H
+#define MOCK_FREERTOS_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define configTICK_RATE_HZ 1000
+#define configMAX_PRIORITIES 25
+#define configTIMER_TASK_PRIORITY 1
+#define portNUM_PROCESSORS 2
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY ((TickType_t) 0xFFFFFFFF)
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+// The C11 keyword of the task entry points, newlib defines it for C++ but glibc does not
+#ifndef _Noreturn
+#define _Noreturn __attribute__((__noreturn__))
+#endif
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+#define pdMS_TO_TICKS(ms) ((TickType_t) (((TickType_t) (ms) * (TickType_t) configTICK_RATE_HZ) / (TickType_t) 1000U))
+#define pdTICKS_TO_MS(ticks) ((TickType_t) (((TickType_t) (ticks) * (TickType_t) 1000U) / (TickType_t) configTICK_RATE_HZ))
+
+#define portENTER_CRITICAL(mux) mockEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) mockExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) mockEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) mockExitCritical(mux)
+#define portENTER_CRITICAL_SAFE(mux) mockEnterCritical(mux)
+#define portEXIT_CRITICAL_SAFE(mux) mockExitCritical(mux)
+#define portYIELD_FROM_ISR(...) mockYield()
+#define taskYIELD() mockYield()
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+typedef struct MockTask *TaskHandle_t;
+typedef struct MockQueue *QueueHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    volatile uint32_t owner; // Nesting of the task holding it, only for the asserts of a debugger
+} portMUX_TYPE;
+
+typedef struct {
+    TaskFunction_t pvTaskCode;
+    const char *pcName;
+    uint32_t usStackDepth;
+    void *pvParameters;
+    UBaseType_t uxPriority;
+    StackType_t *puxStackBuffer;
+} TaskParameters_t;
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Enter a critical section, the running task is not switched out until the matching exit
+void mockEnterCritical(portMUX_TYPE *mux);
+
+void mockExitCritical(portMUX_TYPE *mux);
+
+/// \brief Let the ready tasks of the same or a higher priority run
+void mockYield();
+
+/// \brief There is no interrupt on the host, the ISR variants run in the calling task
+BaseType_t xPortInIsrContext();
+
+/// \brief Tasks all run on core 0
+BaseType_t xPortGetCoreID();
+
+#endif // MOCK_FREERTOS_H
@@ -0,0 +1,47 @@
+/*===========================================================================*/
+/// \file queue.h
+///
+/// \brief
+///    Host stand-in for the FreeRTOS queue API, see FreeRTOS.h
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_FREERTOS_QUEUE_H
+#define MOCK_FREERTOS_QUEUE_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "FreeRTOS.h"
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+
+void vQueueDelete(QueueHandle_t queue);
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks);
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void *item, TickType_t ticks);
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *higherPriorityTaskWoken);
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item);
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t ticks);
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+UBaseType_t uxQueueMessagesWaitingFromISR(QueueHandle_t queue);
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue);
+
+#endif // MOCK_FREERTOS_QUEUE_H
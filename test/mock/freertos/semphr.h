@@ -0,0 +1,45 @@
+/*===========================================================================*/
+/// \file semphr.h
+///
+/// \brief
+///    Host stand-in for the FreeRTOS semaphores, queues of empty items as in the kernel
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_FREERTOS_SEMPHR_H
+#define MOCK_FREERTOS_SEMPHR_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "queue.h"
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+#define xSemaphoreTake(semaphore, ticks) xQueueReceive((semaphore), nullptr, (ticks))
+#define xSemaphoreGive(semaphore) xQueueSend((semaphore), nullptr, 0)
+#define xSemaphoreGiveFromISR(semaphore, woken) xQueueSendFromISR((semaphore), nullptr, (woken))
+#define vSemaphoreDelete(semaphore) vQueueDelete(semaphore)
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+SemaphoreHandle_t xSemaphoreCreateBinary();
+
+/// \brief Without priority inheritance, only one task runs at a time anyway
+SemaphoreHandle_t xSemaphoreCreateMutex();
+
+#endif // MOCK_FREERTOS_SEMPHR_H
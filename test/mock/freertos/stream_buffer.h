@@ -0,0 +1,42 @@
+/*===========================================================================*/
+/// \file stream_buffer.h
+///
+/// \brief
+///    Host stand-in for the FreeRTOS stream buffers, see FreeRTOS.h
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_FREERTOS_STREAM_BUFFER_H
+#define MOCK_FREERTOS_STREAM_BUFFER_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "FreeRTOS.h"
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+typedef struct MockStreamBuffer *StreamBufferHandle_t;
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Create a stream buffer, the trigger level is ignored: a blocked reader wakes up on the first byte
+StreamBufferHandle_t xStreamBufferCreate(size_t size, size_t triggerLevel);
+
+void vStreamBufferDelete(StreamBufferHandle_t buffer);
+
+size_t xStreamBufferSend(StreamBufferHandle_t buffer, const void *data, size_t length, TickType_t ticks);
+
+size_t xStreamBufferReceive(StreamBufferHandle_t buffer, void *data, size_t size, TickType_t ticks);
+
+size_t xStreamBufferBytesAvailable(StreamBufferHandle_t buffer);
+
+#endif // MOCK_FREERTOS_STREAM_BUFFER_H
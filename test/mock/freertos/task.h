@@ -0,0 +1,77 @@
+/*===========================================================================*/
+/// \file task.h
+///
+/// \brief
+///    Host stand-in for the FreeRTOS task API, see FreeRTOS.h
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_FREERTOS_TASK_H
+#define MOCK_FREERTOS_TASK_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "FreeRTOS.h"
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    eRunning,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted,
+    eInvalid
+} eTaskState;
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name, uint32_t stackDepth, void *parameters,
+                       UBaseType_t priority, TaskHandle_t *handle);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stackDepth, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+
+/// \brief Delete a task, nullptr for the calling one which then never returns
+void vTaskDelete(TaskHandle_t task);
+
+void vTaskDelay(TickType_t ticks);
+
+void vTaskDelayUntil(TickType_t *previousWake, TickType_t period);
+
+TickType_t xTaskGetTickCount();
+
+TaskHandle_t xTaskGetCurrentTaskHandle();
+
+TaskHandle_t xTaskGetCurrentTaskHandleForCPU(BaseType_t core);
+
+/// \brief The idle tasks are not run, their handles only identify them
+TaskHandle_t xTaskGetIdleTaskHandleForCPU(UBaseType_t core);
+
+const char *pcTaskGetName(TaskHandle_t task);
+
+eTaskState eTaskGetState(TaskHandle_t task);
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+
+/// \brief The stack of a host thread says nothing about the one of the device, the whole depth is returned
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+void vTaskSuspendAll();
+
+BaseType_t xTaskResumeAll();
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+
+#endif // MOCK_FREERTOS_TASK_H
@@ -0,0 +1,50 @@
+/*===========================================================================*/
+/// \file timers.h
+///
+/// \brief
+///    Host stand-in for the FreeRTOS software timers
+///
+/// \details
+///     The callbacks run in a timer service task of priority configTIMER_TASK_PRIORITY, created with the first timer
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_FREERTOS_TIMERS_H
+#define MOCK_FREERTOS_TIMERS_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "FreeRTOS.h"
+
+/*=============================================================================
+                                 Type definitions
+=============================================================================*/
+
+typedef struct MockTimer *TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer);
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t autoReload, void *id,
+                           TimerCallbackFunction_t callback);
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticks);
+
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t ticks);
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks);
+
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t ticks);
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer);
+
+void *pvTimerGetTimerID(TimerHandle_t timer);
+
+#endif // MOCK_FREERTOS_TIMERS_H
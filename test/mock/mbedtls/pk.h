@@ -0,0 +1,62 @@
+/*===========================================================================*/
+/// \file pk.h
+///
+/// \brief
+///    Host stand-in for the public key API of mbedTLS
+///
+/// \details
+///     No key parses, so every signature is refused like with an empty release key. The tests of the update logic
+///     verify through their own svcOtaVerifier_t instead.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_MBEDTLS_PK_H
+#define MOCK_MBEDTLS_PK_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <stddef.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define MBEDTLS_ERR_PK_KEY_INVALID_FORMAT -0x3D00
+#define MBEDTLS_ERR_PK_BAD_INPUT_DATA -0x3E80
+
+/*=============================================================================
+                                      Enums
+=============================================================================*/
+
+typedef enum {
+    MBEDTLS_MD_NONE = 0,
+    MBEDTLS_MD_SHA256 = 6,
+} mbedtls_md_type_t;
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    const void *info;
+} mbedtls_pk_context;
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+void mbedtls_pk_init(mbedtls_pk_context *context);
+
+void mbedtls_pk_free(mbedtls_pk_context *context);
+
+int mbedtls_pk_parse_public_key(mbedtls_pk_context *context, const unsigned char *key, size_t keyLength);
+
+int mbedtls_pk_verify(mbedtls_pk_context *context, mbedtls_md_type_t type, const unsigned char *hash,
+                      size_t hashLength, const unsigned char *signature, size_t signatureLength);
+
+#endif // MOCK_MBEDTLS_PK_H
@@ -0,0 +1,52 @@
+/*===========================================================================*/
+/// \file sha256.h
+///
+/// \brief
+///    Host stand-in for the SHA-256 API of mbedTLS 2.28, the version of ESP-IDF 4.4
+///
+/// \details
+///     A software implementation with the same calls, the device hashes on its SHA accelerator instead
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_MBEDTLS_SHA256_H
+#define MOCK_MBEDTLS_SHA256_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t length; // bytes hashed so far
+    unsigned char block[64];
+} mbedtls_sha256_context;
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+void mbedtls_sha256_init(mbedtls_sha256_context *context);
+
+void mbedtls_sha256_free(mbedtls_sha256_context *context);
+
+/// \param is224 Only 0, SHA-224 is not emulated
+int mbedtls_sha256_starts_ret(mbedtls_sha256_context *context, int is224);
+
+int mbedtls_sha256_update_ret(mbedtls_sha256_context *context, const unsigned char *input, size_t length);
+
+int mbedtls_sha256_finish_ret(mbedtls_sha256_context *context, unsigned char output[32]);
+
+int mbedtls_sha256_ret(const unsigned char *input, size_t length, unsigned char output[32], int is224);
+
+#endif // MOCK_MBEDTLS_SHA256_H
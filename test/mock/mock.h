@@ -0,0 +1,89 @@
+/*===========================================================================*/
+/// \file mock.h
+///
+/// \brief
+///    Hooks of the host mocks for the tests
+///
+/// \details
+///     The mocks stand in for the ESP32 core, the SDK and the board libraries in the native environment. The tests
+///     drive time, look at the emulated panels and inject the failures through these functions, the firmware never
+///     calls them.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_H
+#define MOCK_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+// Graphic RAM of an SSD1306: 8 pages of 128 columns, one byte holds 8 rows
+#define MOCK_SSD1306_PAGES 8
+#define MOCK_SSD1306_COLUMNS 128
+#define MOCK_SSD1306_GDDRAM_SIZE (MOCK_SSD1306_PAGES * MOCK_SSD1306_COLUMNS)
+
+// The panel answering on the bus before any test changes it
+#define MOCK_I2C_DEFAULT_PANEL 0x3C
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Get the virtual time, without the microsecond a timer read costs
+/// \return Microseconds since the start of the process
+uint64_t mockTimeUs();
+
+/// \brief Read the virtual time like esp_timer_get_time(), the read itself takes a microsecond
+/// \return Microseconds since the start of the process
+int64_t mockTimerRead();
+
+/// \brief Let time pass while the calling task keeps running, for the busy waits and the sleeps
+/// \param us Microseconds to add
+void mockAdvanceUs(uint64_t us);
+
+/// \brief Block the calling task for good, what a reset or a deep sleep looks like to it
+void mockSuspendForever();
+
+/// \brief Get the number of ESP.restart() calls
+uint32_t mockRestartCount();
+
+/// \brief Make an I2C address acknowledge or not, an SSD1306 is emulated behind each present address
+/// \param address 7-bit address
+/// \param present true to answer, false to NACK
+void mockI2cSetPresent(uint8_t address, bool present);
+
+/// \brief NACK the next transmissions to any address
+/// \param count Transmissions to fail
+void mockI2cFailNext(uint32_t count);
+
+/// \brief Get the graphic RAM of the panel at an I2C address
+/// \param address 7-bit address
+/// \return MOCK_SSD1306_GDDRAM_SIZE bytes in page order, nullptr if no panel is present there
+const uint8_t *mockSsd1306Gddram(uint8_t address);
+
+/// \brief Get the data bytes written to the panel at an I2C address since it was made present
+/// \param address 7-bit address
+/// \return The byte count, 0 if no panel is present there
+size_t mockSsd1306DataBytes(uint8_t address);
+
+/// \brief Get the content of a flash partition, for the tests to load or inspect it
+/// \param label Name in partitions.csv: app0, app1 or adhan
+/// \param size Filled with the partition size
+/// \return The partition bytes, nullptr for an unknown label
+uint8_t *mockPartitionData(const char *label, size_t *size);
+
+/// \brief Drop the stored preferences, like an erased NVS partition
+void mockPreferencesClear();
+
+#endif // MOCK_H
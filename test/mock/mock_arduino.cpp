@@ -0,0 +1,302 @@
+/*===========================================================================*/
+/// \file mock_arduino.cpp
+///
+/// \brief
+///    Host stand-in for the Arduino core of the ESP32
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "Arduino.h"
+#include "esp_timer.h"
+#include "mock.h"
+#include <chrono>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define MOCK_CPU_FREQ_MHZ 240
+#define MOCK_HEAP_SIZE 327680
+#define MOCK_FREE_HEAP 180000
+#define MOCK_MIN_FREE_HEAP 150000
+#define MOCK_SKETCH_SIZE 1048576
+#define MOCK_SKETCH_SPACE 1310720
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static std::string formatNumber(unsigned long long number, int base, bool negative);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static uint32_t restartCount = 0;
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+HardwareSerial Serial;
+
+EspClass ESP;
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+String::String(int number, unsigned char base)
+    : value(formatNumber(number < 0 ? -(long long) number : number, base, number < 0)) {
+}
+
+String::String(unsigned int number, unsigned char base) : value(formatNumber(number, base, false)) {
+}
+
+String::String(long number, unsigned char base)
+    : value(formatNumber(number < 0 ? -(long long) number : number, base, number < 0)) {
+}
+
+String::String(unsigned long number, unsigned char base) : value(formatNumber(number, base, false)) {
+}
+
+String::String(double number, unsigned int decimals) {
+    char text[64];
+    snprintf(text, sizeof(text), "%.*f", (int) decimals, number);
+    value = text;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    const size_t index = value.find(c, from);
+    return index == std::string::npos ? -1 : (int) index;
+}
+
+int String::indexOf(const String &text, unsigned int from) const {
+    const size_t index = value.find(text.value, from);
+    return index == std::string::npos ? -1 : (int) index;
+}
+
+int String::lastIndexOf(char c) const {
+    const size_t index = value.rfind(c);
+    return index == std::string::npos ? -1 : (int) index;
+}
+
+String String::substring(unsigned int begin) const {
+    return substring(begin, length());
+}
+
+String String::substring(unsigned int begin, unsigned int end) const {
+    if (begin > end) {
+        std::swap(begin, end);
+    }
+    if (begin >= value.size()) {
+        return String();
+    }
+    return String(value.substr(begin, std::min<size_t>(end, value.size()) - begin));
+}
+
+bool String::equalsIgnoreCase(const String &other) const {
+    return value.size() == other.value.size() && strcasecmp(value.c_str(), other.value.c_str()) == 0;
+}
+
+bool String::startsWith(const String &prefix) const {
+    return value.compare(0, prefix.value.size(), prefix.value) == 0;
+}
+
+bool String::endsWith(const String &suffix) const {
+    return value.size() >= suffix.value.size() &&
+           value.compare(value.size() - suffix.value.size(), suffix.value.size(), suffix.value) == 0;
+}
+
+void String::toLowerCase() {
+    for (char &c: value) {
+        c = (char) tolower((unsigned char) c);
+    }
+}
+
+void String::toUpperCase() {
+    for (char &c: value) {
+        c = (char) toupper((unsigned char) c);
+    }
+}
+
+void String::trim() {
+    const size_t begin = value.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        value.clear();
+        return;
+    }
+    value = value.substr(begin, value.find_last_not_of(" \t\r\n") - begin + 1);
+}
+
+void String::replace(const String &from, const String &to) {
+    if (from.value.empty()) {
+        return;
+    }
+    for (size_t index = value.find(from.value); index != std::string::npos;
+         index = value.find(from.value, index + to.value.size())) {
+        value.replace(index, from.value.size(), to.value);
+    }
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+    size_t written = 0;
+    while (written < size && write(buffer[written]) == 1) {
+        written++;
+    }
+    return written;
+}
+
+size_t Print::printf(const char *format, ...) {
+    char small[128];
+    va_list args;
+    va_start(args, format);
+    const int length = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (length < 0) {
+        return 0;
+    }
+    if ((size_t) length < sizeof(small)) {
+        return write((const uint8_t *) small, length);
+    }
+
+    std::string large(length + 1, '\0');
+    va_start(args, format);
+    vsnprintf(&large[0], large.size(), format, args);
+    va_end(args);
+    return write((const uint8_t *) large.data(), length);
+}
+
+size_t Print::print(int number, int base) {
+    return print(String(number, (unsigned char) base));
+}
+
+size_t Print::print(unsigned int number, int base) {
+    return print(String(number, (unsigned char) base));
+}
+
+size_t Print::print(long number, int base) {
+    return print(String(number, (unsigned char) base));
+}
+
+size_t Print::print(unsigned long number, int base) {
+    return print(String(number, (unsigned char) base));
+}
+
+size_t Print::print(double number, int decimals) {
+    return print(String(number, (unsigned int) decimals));
+}
+
+size_t Stream::readBytes(uint8_t *buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        const int c = read();
+        if (c < 0) {
+            break;
+        }
+        buffer[count++] = (uint8_t) c;
+    }
+    return count;
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+    return fwrite(buffer, 1, size, stdout);
+}
+
+uint32_t EspClass::getFreeHeap() {
+    return MOCK_FREE_HEAP;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    return MOCK_MIN_FREE_HEAP;
+}
+
+uint32_t EspClass::getHeapSize() {
+    return MOCK_HEAP_SIZE;
+}
+
+uint32_t EspClass::getCycleCount() {
+    // Wall clock, the benches measure the host and not the virtual time
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return (uint32_t) (std::chrono::duration_cast<std::chrono::nanoseconds>(now).count() * MOCK_CPU_FREQ_MHZ / 1000);
+}
+
+uint32_t EspClass::getCpuFreqMHz() {
+    return MOCK_CPU_FREQ_MHZ;
+}
+
+uint32_t EspClass::getSketchSize() {
+    return MOCK_SKETCH_SIZE;
+}
+
+uint32_t EspClass::getFreeSketchSpace() {
+    return MOCK_SKETCH_SPACE;
+}
+
+void EspClass::restart() {
+    restartCount++;
+    fflush(stdout);
+    mockSuspendForever();
+}
+
+uint32_t mockRestartCount() {
+    return restartCount;
+}
+
+unsigned long millis() {
+    return (unsigned long) (esp_timer_get_time() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long) esp_timer_get_time();
+}
+
+void delay(uint32_t ms) {
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    mockAdvanceUs(us);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+}
+
+int digitalRead(uint8_t pin) {
+    return LOW;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+std::string formatNumber(unsigned long long number, int base, bool negative) {
+    if (base < 2 || base > 36) {
+        base = 10;
+    }
+    std::string digits;
+    do {
+        const int digit = (int) (number % base);
+        digits.insert(digits.begin(), (char) (digit < 10 ? '0' + digit : 'a' + digit - 10));
+        number /= base;
+    } while (number > 0);
+    return negative ? "-" + digits : digits;
+}
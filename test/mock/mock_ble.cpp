@@ -0,0 +1,118 @@
+/*===========================================================================*/
+/// \file mock_ble.cpp
+///
+/// \brief
+///    Host backend of the BLE transport
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "mock_ble.h"
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static MockBleTransport transport;
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+bool MockBleTransport::begin(const char *name, BleTransportHandler *handler) {
+    deviceName = name;
+    this->handler = handler;
+    return true;
+}
+
+void MockBleTransport::setValue(svcBleCharacteristic_t characteristic, const uint8_t *data, size_t length) {
+    values[characteristic].assign(data, data + length);
+}
+
+void MockBleTransport::notify(svcBleCharacteristic_t characteristic) {
+    // Like the stacks, nothing is sent without a client or to a characteristic that does not notify
+    if (!connected || (svcBleCharacteristics[characteristic].properties & SVC_BLE_PROPERTY_NOTIFY) == 0) {
+        return;
+    }
+    sent.push_back({characteristic, values[characteristic]});
+}
+
+bool MockBleTransport::isConnected() const {
+    return connected;
+}
+
+void MockBleTransport::setLinkProfile(svcBleLinkProfile_t profile) {
+    this->profile = profile;
+}
+
+uint16_t MockBleTransport::connectionInterval() const {
+    return connected ? svcBleLinkProfiles[profile].maxInterval : 0;
+}
+
+bool MockBleTransport::dataLengthExtended() const {
+    return connected;
+}
+
+void MockBleTransport::setBroadcastData(const uint8_t *data, size_t length) {
+    if (data == nullptr) {
+        broadcast.clear();
+        return;
+    }
+    broadcast.assign(data, data + length);
+}
+
+bool MockBleTransport::observe(svcBleBroadcastCallback_t callback) {
+    observer = callback;
+    return handler != nullptr;
+}
+
+void MockBleTransport::connect() {
+    if (handler == nullptr || connected) {
+        return;
+    }
+    connected = true;
+    profile = SVC_BLE_LINK_IDLE;
+    handler->onConnect();
+}
+
+void MockBleTransport::disconnect() {
+    if (!connected) {
+        return;
+    }
+    connected = false;
+    handler->onDisconnect();
+}
+
+bool MockBleTransport::write(svcBleCharacteristic_t characteristic, const uint8_t *data, size_t length) {
+    const uint8_t writable = SVC_BLE_PROPERTY_WRITE | SVC_BLE_PROPERTY_WRITE_NR;
+    if (handler == nullptr || (svcBleCharacteristics[characteristic].properties & writable) == 0) {
+        return false;
+    }
+    values[characteristic].assign(data, data + length);
+    handler->onWrite(characteristic, data, length);
+    return true;
+}
+
+void MockBleTransport::advertise(const uint8_t *data, size_t length) {
+    if (observer != nullptr) {
+        observer(data, length);
+    }
+}
+
+void MockBleTransport::clearNotifications() {
+    sent.clear();
+}
+
+MockBleTransport *mockBleTransport() {
+    return &transport;
+}
+
+BleTransport *svcBleTransportGet() {
+    return &transport;
+}
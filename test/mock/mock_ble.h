@@ -0,0 +1,118 @@
+/*===========================================================================*/
+/// \file mock_ble.h
+///
+/// \brief
+///    Host backend of the BLE transport
+///
+/// \details
+///     Replaces the Bluedroid and NimBLE backends in the native environment. The tests play the phone: they connect,
+///     write the characteristics and feed advertisements, and read back the values and the notifications the
+///     firmware produced. The calls of the tests run in their own task, where the stack task runs them on the chip.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+#ifndef MOCK_BLE_H
+#define MOCK_BLE_H
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <svc_ble_transport.h>
+#include <vector>
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    svcBleCharacteristic_t characteristic;
+    std::vector<uint8_t> value;
+} mockBleNotification_t;
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+class MockBleTransport : public BleTransport {
+public:
+    bool begin(const char *name, BleTransportHandler *handler) override;
+
+    void setValue(svcBleCharacteristic_t characteristic, const uint8_t *data, size_t length) override;
+
+    void notify(svcBleCharacteristic_t characteristic) override;
+
+    bool isConnected() const override;
+
+    void setLinkProfile(svcBleLinkProfile_t profile) override;
+
+    uint16_t connectionInterval() const override;
+
+    bool dataLengthExtended() const override;
+
+    void setBroadcastData(const uint8_t *data, size_t length) override;
+
+    bool observe(svcBleBroadcastCallback_t callback) override;
+
+    /// \brief Connect a client, a no-op before begin()
+    void connect();
+
+    void disconnect();
+
+    /// \brief Write a characteristic like the client would
+    /// \return false if the stack is not started or the characteristic is not writable
+    bool write(svcBleCharacteristic_t characteristic, const uint8_t *data, size_t length);
+
+    /// \brief Deliver an advertisement seen by the scan
+    /// \param data Manufacturer data, company id first
+    void advertise(const uint8_t *data, size_t length);
+
+    /// \brief Drop the recorded notifications
+    void clearNotifications();
+
+    bool started() const {
+        return handler != nullptr;
+    }
+
+    const char *name() const {
+        return deviceName;
+    }
+
+    const std::vector<uint8_t> &value(svcBleCharacteristic_t characteristic) const {
+        return values[characteristic];
+    }
+
+    const std::vector<mockBleNotification_t> &notifications() const {
+        return sent;
+    }
+
+    svcBleLinkProfile_t linkProfile() const {
+        return profile;
+    }
+
+    const std::vector<uint8_t> &broadcastData() const {
+        return broadcast;
+    }
+
+private:
+    BleTransportHandler *handler = nullptr;
+    const char *deviceName = nullptr;
+    bool connected = false;
+    svcBleLinkProfile_t profile = SVC_BLE_LINK_IDLE;
+    std::vector<uint8_t> values[SVC_BLE_CHAR_COUNT];
+    std::vector<mockBleNotification_t> sent;
+    std::vector<uint8_t> broadcast;
+    svcBleBroadcastCallback_t observer = nullptr;
+};
+
+/*=============================================================================
+                            Public Function Prototypes
+=============================================================================*/
+
+/// \brief Get the backend returned by svcBleTransportGet()
+MockBleTransport *mockBleTransport();
+
+#endif // MOCK_BLE_H
@@ -0,0 +1,266 @@
+/*===========================================================================*/
+/// \file mock_esp.cpp
+///
+/// \brief
+///    Host stand-in for the ESP-IDF calls of the firmware: timer, random, sleep, hooks, flash partitions, OTA, I2S
+///
+/// \details
+///     The C library clock is replaced too, the firmware sets it and must not change the time of the host. Like the
+///     RTC of the chip it starts at the epoch and runs on the virtual clock.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "driver/i2s.h"
+#include "esp_freertos_hooks.h"
+#include "esp_ota_ops.h"
+#include "esp_sleep.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "mock.h"
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+#include <sys/time.h>
+#include <vector>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define MOCK_PARTITION_COUNT 3
+#define MOCK_RUNNING_PARTITION 0
+#define MOCK_UPDATE_PARTITION 1
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static std::vector<uint8_t> &partitionData(const esp_partition_t *partition);
+
+static bool inRange(const esp_partition_t *partition, size_t offset, size_t size);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static uint64_t wakeupTimeUs = 0;
+static esp_sleep_wakeup_cause_t wakeupCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+
+// Offset of the C library clock from the virtual time
+static int64_t rtcOffsetUs = 0;
+
+static std::vector<uint8_t> partitionContent[MOCK_PARTITION_COUNT];
+static const esp_partition_t *bootPartition = nullptr;
+
+static uint32_t i2sSampleRate = 0;
+static uint64_t i2sPendingUs = 0;
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+// Same layout as partitions.csv
+static const esp_partition_t partitions[MOCK_PARTITION_COUNT] = {
+    {ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_0, 0x10000, 0x140000, "app0", false},
+    {ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_1, 0x150000, 0x140000, "app1", false},
+    {ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t) 0x40, 0x290000, 0x160000, "adhan", false},
+};
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+int64_t esp_timer_get_time() {
+    return mockTimerRead();
+}
+
+uint32_t esp_random() {
+    static std::mt19937 generator;
+    return (uint32_t) generator();
+}
+
+extern "C" int gettimeofday(struct timeval *tv, void *tz) {
+    const int64_t utcUs = (int64_t) mockTimeUs() + rtcOffsetUs;
+    tv->tv_sec = (time_t) (utcUs / 1000000);
+    tv->tv_usec = (suseconds_t) (utcUs % 1000000);
+    return 0;
+}
+
+extern "C" int settimeofday(const struct timeval *tv, const struct timezone *tz) {
+    rtcOffsetUs = (int64_t) tv->tv_sec * 1000000 + tv->tv_usec - (int64_t) mockTimeUs();
+    return 0;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs) {
+    wakeupTimeUs = timeUs;
+    return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start() {
+    mockAdvanceUs(wakeupTimeUs);
+    wakeupCause = ESP_SLEEP_WAKEUP_TIMER;
+    return ESP_OK;
+}
+
+void esp_deep_sleep_start() {
+    mockSuspendForever();
+    abort();
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+    return wakeupCause;
+}
+
+esp_err_t esp_register_freertos_tick_hook_for_cpu(esp_freertos_tick_cb_t callback, UBaseType_t core) {
+    return ESP_OK;
+}
+
+esp_err_t esp_register_freertos_idle_hook_for_cpu(esp_freertos_idle_cb_t callback, UBaseType_t core) {
+    return ESP_OK;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label) {
+    for (const esp_partition_t &partition: partitions) {
+        if (partition.type == type && (subtype == ESP_PARTITION_SUBTYPE_ANY || partition.subtype == subtype) &&
+            (label == nullptr || strcmp(partition.label, label) == 0)) {
+            return &partition;
+        }
+    }
+    return nullptr;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t offset, void *data, size_t size) {
+    if (!inRange(partition, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(data, &partitionData(partition)[offset], size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t offset, const void *data, size_t size) {
+    if (!inRange(partition, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    // NOR flash only clears bits, writing over unerased data corrupts it like on the chip
+    std::vector<uint8_t> &content = partitionData(partition);
+    for (size_t i = 0; i < size; i++) {
+        content[offset + i] &= ((const uint8_t *) data)[i];
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size) {
+    if (offset % SPI_FLASH_SEC_SIZE != 0 || size % SPI_FLASH_SEC_SIZE != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!inRange(partition, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memset(&partitionData(partition)[offset], 0xFF, size);
+    return ESP_OK;
+}
+
+const esp_partition_t *esp_ota_get_running_partition() {
+    return &partitions[MOCK_RUNNING_PARTITION];
+}
+
+const esp_partition_t *esp_ota_get_boot_partition() {
+    return bootPartition != nullptr ? bootPartition : &partitions[MOCK_RUNNING_PARTITION];
+}
+
+const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *start) {
+    return &partitions[MOCK_UPDATE_PARTITION];
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t *partition) {
+    if (partition == nullptr || partition->type != ESP_PARTITION_TYPE_APP) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    bootPartition = partition;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_get_state_partition(const esp_partition_t *partition, esp_ota_img_states_t *state) {
+    *state = ESP_OTA_IMG_VALID;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_valid_cancel_rollback() {
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_invalid_rollback_and_reboot() {
+    mockSuspendForever();
+    return ESP_FAIL;
+}
+
+esp_err_t i2s_driver_install(i2s_port_t port, const i2s_config_t *config, int queueSize, void *queue) {
+    i2sSampleRate = config->sample_rate;
+    i2sPendingUs = 0;
+    return ESP_OK;
+}
+
+esp_err_t i2s_driver_uninstall(i2s_port_t port) {
+    i2sSampleRate = 0;
+    return ESP_OK;
+}
+
+esp_err_t i2s_set_pin(i2s_port_t port, const i2s_pin_config_t *pins) {
+    return ESP_OK;
+}
+
+esp_err_t i2s_set_dac_mode(i2s_dac_mode_t mode) {
+    return ESP_OK;
+}
+
+esp_err_t i2s_write(i2s_port_t port, const void *data, size_t size, size_t *written, TickType_t ticks) {
+    if (i2sSampleRate == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // Played at the sample rate, the writer waits like on a full DMA queue
+    i2sPendingUs += (uint64_t) size / sizeof(int16_t) * 1000000 / i2sSampleRate;
+    const uint64_t pendingMs = i2sPendingUs / 1000;
+    if (pendingMs > 0) {
+        i2sPendingUs -= pendingMs * 1000;
+        vTaskDelay(pdMS_TO_TICKS(pendingMs));
+    }
+    *written = size;
+    return ESP_OK;
+}
+
+uint8_t *mockPartitionData(const char *label, size_t *size) {
+    for (const esp_partition_t &partition: partitions) {
+        if (strcmp(partition.label, label) == 0) {
+            *size = partition.size;
+            return partitionData(&partition).data();
+        }
+    }
+    return nullptr;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+std::vector<uint8_t> &partitionData(const esp_partition_t *partition) {
+    std::vector<uint8_t> &content = partitionContent[partition - partitions];
+    if (content.empty()) {
+        // Erased flash
+        content.assign(partition->size, 0xFF);
+    }
+    return content;
+}
+
+bool inRange(const esp_partition_t *partition, size_t offset, size_t size) {
+    return partition >= partitions && partition < partitions + MOCK_PARTITION_COUNT && offset <= partition->size &&
+           size <= partition->size - offset;
+}
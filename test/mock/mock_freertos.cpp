@@ -0,0 +1,783 @@
+/*===========================================================================*/
+/// \file mock_freertos.cpp
+///
+/// \brief
+///    Host stand-in for the FreeRTOS kernel of the ESP32 core
+///
+/// \details
+///     One lock guards the whole kernel state. A task only runs while it is the running task, every other task thread
+///     waits on its condition variable, so the firmware sees the same one-at-a-time execution as on a single core
+///     and critical sections need no lock of their own. See FreeRTOS.h for the timing model.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/stream_buffer.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+#include "mock.h"
+#include <condition_variable>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define MOCK_NO_TIMEOUT UINT64_MAX
+// Priority of the thread adopted as a task, the one of the Arduino loop task
+#define MOCK_MAIN_PRIORITY 1
+#define MOCK_MAIN_STACK_DEPTH 8192
+#define MOCK_TASK_NAME_SIZE 16
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+struct MockTask {
+    char name[MOCK_TASK_NAME_SIZE];
+    TaskFunction_t code;
+    void *parameters;
+    UBaseType_t priority;
+    uint32_t stackDepth;
+    std::condition_variable wake;
+    eTaskState state;
+    const void *waitingOn;  // Object whose change ends the wait, nullptr when not blocked on one
+    uint64_t timeoutUs;     // End of the wait, MOCK_NO_TIMEOUT for none
+    bool timedOut;
+    uint64_t lastRun;       // Switch count when it last got the CPU, the oldest of a priority goes first
+    uint32_t notifications;
+    uint32_t criticalNesting;
+    bool switchPending;     // A higher priority task got ready inside a critical section
+};
+
+struct MockQueue {
+    uint8_t *items;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    UBaseType_t count;
+    UBaseType_t head;
+};
+
+struct MockStreamBuffer {
+    uint8_t *data;
+    size_t size;
+    size_t count;
+    size_t head;
+};
+
+struct MockTimer {
+    char name[MOCK_TASK_NAME_SIZE];
+    TickType_t period;
+    bool autoReload;
+    void *id;
+    TimerCallbackFunction_t callback;
+    bool active;
+    uint64_t expiryUs;
+};
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static MockTask *currentLocked();
+
+static MockTask *createTaskLocked(TaskFunction_t code, const char *name, uint32_t stackDepth, void *parameters,
+                                  UBaseType_t priority);
+
+static void taskEntry(MockTask *task);
+
+static void expireLocked();
+
+static MockTask *pickNextLocked();
+
+static void scheduleLocked(std::unique_lock<std::mutex> &lock);
+
+static void preemptLocked(std::unique_lock<std::mutex> &lock);
+
+static bool blockLocked(std::unique_lock<std::mutex> &lock, const void *object, uint64_t timeoutUs);
+
+static bool wakeLocked(const void *object);
+
+static uint64_t deadlineLocked(TickType_t ticks);
+
+template<typename Ready>
+static bool waitForLocked(std::unique_lock<std::mutex> &lock, const void *object, TickType_t ticks, Ready ready);
+
+static void reportDeadlock();
+
+static BaseType_t sendLocked(std::unique_lock<std::mutex> &lock, MockQueue *queue, const void *item,
+                             TickType_t ticks, bool preempt, BaseType_t *woken);
+
+static void timerServiceTask(void *parameters);
+
+static void armTimerLocked(MockTimer *timer);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+// Never destroyed, the task threads still wait on it while the process exits
+static std::mutex &kernel = *new std::mutex();
+static std::vector<MockTask *> tasks;
+static MockTask *running = nullptr;
+static thread_local MockTask *self = nullptr;
+static uint64_t nowUs = 0;
+static uint64_t switchCount = 0;
+
+static std::vector<MockTimer *> timers;
+static MockTask *timerTask = nullptr;
+
+static MockTask idleTasks[portNUM_PROCESSORS];
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+// Blocked on by the delays, nothing ever signals it
+static const char delayToken = 0;
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+uint64_t mockTimeUs() {
+    std::lock_guard<std::mutex> guard(kernel);
+    return nowUs;
+}
+
+int64_t mockTimerRead() {
+    std::lock_guard<std::mutex> guard(kernel);
+    // A read takes time too, so the busy waits of the firmware get to their end
+    return (int64_t) ++nowUs;
+}
+
+void mockAdvanceUs(uint64_t us) {
+    std::lock_guard<std::mutex> guard(kernel);
+    // The calling task keeps the CPU, the tasks whose timeout passed run at its next switch
+    nowUs += us;
+}
+
+void mockSuspendForever() {
+    std::unique_lock<std::mutex> lock(kernel);
+    currentLocked()->criticalNesting = 0;
+    blockLocked(lock, &delayToken, MOCK_NO_TIMEOUT);
+}
+
+void mockEnterCritical(portMUX_TYPE *mux) {
+    std::lock_guard<std::mutex> guard(kernel);
+    currentLocked()->criticalNesting++;
+    mux->owner++;
+}
+
+void mockExitCritical(portMUX_TYPE *mux) {
+    std::unique_lock<std::mutex> lock(kernel);
+    MockTask *me = currentLocked();
+    mux->owner--;
+    if (--me->criticalNesting == 0 && me->switchPending) {
+        me->switchPending = false;
+        preemptLocked(lock);
+    }
+}
+
+void mockYield() {
+    std::unique_lock<std::mutex> lock(kernel);
+    MockTask *me = currentLocked();
+    if (me->criticalNesting > 0) {
+        me->switchPending = true;
+        return;
+    }
+    scheduleLocked(lock);
+}
+
+BaseType_t xPortInIsrContext() {
+    return pdFALSE;
+}
+
+BaseType_t xPortGetCoreID() {
+    return 0;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name, uint32_t stackDepth, void *parameters,
+                       UBaseType_t priority, TaskHandle_t *handle) {
+    std::unique_lock<std::mutex> lock(kernel);
+    currentLocked();
+    MockTask *task = createTaskLocked(code, name, stackDepth, parameters, priority);
+    if (handle != nullptr) {
+        *handle = task;
+    }
+    preemptLocked(lock);
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stackDepth, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+    return xTaskCreate(code, name, stackDepth, parameters, priority, handle);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    std::unique_lock<std::mutex> lock(kernel);
+    MockTask *me = currentLocked();
+    MockTask *target = task != nullptr ? task : me;
+    target->state = eDeleted;
+    target->waitingOn = nullptr;
+    if (target == me) {
+        // Never scheduled again, the thread stays parked until the process exits
+        me->criticalNesting = 0;
+        scheduleLocked(lock);
+    }
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(kernel);
+    currentLocked();
+    if (ticks == 0) {
+        scheduleLocked(lock);
+        return;
+    }
+    blockLocked(lock, &delayToken, deadlineLocked(ticks));
+}
+
+void vTaskDelayUntil(TickType_t *previousWake, TickType_t period) {
+    std::unique_lock<std::mutex> lock(kernel);
+    currentLocked();
+    *previousWake += period;
+    const uint64_t wakeUs = (uint64_t) *previousWake * 1000000 / configTICK_RATE_HZ;
+    if (wakeUs > nowUs) {
+        blockLocked(lock, &delayToken, wakeUs);
+    }
+}
+
+TickType_t xTaskGetTickCount() {
+    std::lock_guard<std::mutex> guard(kernel);
+    return (TickType_t) (nowUs * configTICK_RATE_HZ / 1000000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    std::lock_guard<std::mutex> guard(kernel);
+    return currentLocked();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandleForCPU(BaseType_t core) {
+    std::lock_guard<std::mutex> guard(kernel);
+    return core == 0 ? currentLocked() : &idleTasks[core];
+}
+
+TaskHandle_t xTaskGetIdleTaskHandleForCPU(UBaseType_t core) {
+    std::lock_guard<std::mutex> guard(kernel);
+    if (idleTasks[core].name[0] == '\0') {
+        snprintf(idleTasks[core].name, sizeof(idleTasks[core].name), "IDLE%u", core);
+        idleTasks[core].state = eReady;
+    }
+    return &idleTasks[core];
+}
+
+const char *pcTaskGetName(TaskHandle_t task) {
+    std::lock_guard<std::mutex> guard(kernel);
+    return task != nullptr ? task->name : currentLocked()->name;
+}
+
+eTaskState eTaskGetState(TaskHandle_t task) {
+    std::lock_guard<std::mutex> guard(kernel);
+    return task == nullptr ? eInvalid : task->state;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task) {
+    std::lock_guard<std::mutex> guard(kernel);
+    return task != nullptr ? task->priority : currentLocked()->priority;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    std::lock_guard<std::mutex> guard(kernel);
+    return task != nullptr ? task->stackDepth : currentLocked()->stackDepth;
+}
+
+void vTaskSuspendAll() {
+    std::lock_guard<std::mutex> guard(kernel);
+    currentLocked()->criticalNesting++;
+}
+
+BaseType_t xTaskResumeAll() {
+    std::unique_lock<std::mutex> lock(kernel);
+    MockTask *me = currentLocked();
+    if (--me->criticalNesting == 0 && me->switchPending) {
+        me->switchPending = false;
+        preemptLocked(lock);
+        return pdTRUE;
+    }
+    return pdFALSE;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    std::unique_lock<std::mutex> lock(kernel);
+    currentLocked();
+    task->notifications++;
+    wakeLocked(&task->notifications);
+    preemptLocked(lock);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(kernel);
+    MockTask *me = currentLocked();
+    waitForLocked(lock, &me->notifications, ticks, [me] { return me->notifications > 0; });
+    const uint32_t value = me->notifications;
+    if (value > 0) {
+        me->notifications = clearOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    MockQueue *queue = new MockQueue();
+    queue->items = itemSize > 0 ? new uint8_t[length * itemSize] : nullptr;
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete[] queue->items;
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(kernel);
+    currentLocked();
+    return sendLocked(lock, queue, item, ticks, true, nullptr);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void *item, TickType_t ticks) {
+    return xQueueSend(queue, item, ticks);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *higherPriorityTaskWoken) {
+    std::unique_lock<std::mutex> lock(kernel);
+    currentLocked();
+    // The switch is left to portYIELD_FROM_ISR() like in a real interrupt
+    return sendLocked(lock, queue, item, 0, false, higherPriorityTaskWoken);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item) {
+    std::unique_lock<std::mutex> lock(kernel);
+    currentLocked();
+    if (queue->count == queue->length) {
+        queue->count--;
+    }
+    return sendLocked(lock, queue, item, 0, true, nullptr);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(kernel);
+    currentLocked();
+    if (!waitForLocked(lock, queue, ticks, [queue] { return queue->count > 0; })) {
+        return pdFALSE;
+    }
+    if (item != nullptr && queue->itemSize > 0) {
+        memcpy(item, &queue->items[queue->head * queue->itemSize], queue->itemSize);
+    }
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    if (wakeLocked(queue)) {
+        preemptLocked(lock);
+    }
+    return pdTRUE;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(kernel);
+    currentLocked();
+    if (!waitForLocked(lock, queue, ticks, [queue] { return queue->count > 0; })) {
+        return pdFALSE;
+    }
+    if (item != nullptr && queue->itemSize > 0) {
+        memcpy(item, &queue->items[queue->head * queue->itemSize], queue->itemSize);
+    }
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> guard(kernel);
+    return queue->count;
+}
+
+UBaseType_t uxQueueMessagesWaitingFromISR(QueueHandle_t queue) {
+    return uxQueueMessagesWaiting(queue);
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> guard(kernel);
+    return queue->length - queue->count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return xQueueCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    SemaphoreHandle_t mutex = xQueueCreate(1, 0);
+    mutex->count = 1;
+    return mutex;
+}
+
+StreamBufferHandle_t xStreamBufferCreate(size_t size, size_t triggerLevel) {
+    MockStreamBuffer *buffer = new MockStreamBuffer();
+    buffer->data = new uint8_t[size];
+    buffer->size = size;
+    return buffer;
+}
+
+void vStreamBufferDelete(StreamBufferHandle_t buffer) {
+    delete[] buffer->data;
+    delete buffer;
+}
+
+size_t xStreamBufferSend(StreamBufferHandle_t buffer, const void *data, size_t length, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(kernel);
+    currentLocked();
+    waitForLocked(lock, buffer, ticks, [buffer, length] { return buffer->size - buffer->count >= length; });
+
+    const size_t room = buffer->size - buffer->count;
+    const size_t sent = length < room ? length : room;
+    for (size_t i = 0; i < sent; i++) {
+        buffer->data[(buffer->head + buffer->count + i) % buffer->size] = ((const uint8_t *) data)[i];
+    }
+    buffer->count += sent;
+    if (sent > 0 && wakeLocked(buffer)) {
+        preemptLocked(lock);
+    }
+    return sent;
+}
+
+size_t xStreamBufferReceive(StreamBufferHandle_t buffer, void *data, size_t size, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(kernel);
+    currentLocked();
+    waitForLocked(lock, buffer, ticks, [buffer] { return buffer->count > 0; });
+
+    const size_t received = size < buffer->count ? size : buffer->count;
+    for (size_t i = 0; i < received; i++) {
+        ((uint8_t *) data)[i] = buffer->data[(buffer->head + i) % buffer->size];
+    }
+    buffer->head = (buffer->head + received) % buffer->size;
+    buffer->count -= received;
+    if (received > 0 && wakeLocked(buffer)) {
+        preemptLocked(lock);
+    }
+    return received;
+}
+
+size_t xStreamBufferBytesAvailable(StreamBufferHandle_t buffer) {
+    std::lock_guard<std::mutex> guard(kernel);
+    return buffer->count;
+}
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t autoReload, void *id,
+                           TimerCallbackFunction_t callback) {
+    std::unique_lock<std::mutex> lock(kernel);
+    currentLocked();
+    if (timerTask == nullptr) {
+        timerTask = createTaskLocked(timerServiceTask, "Tmr Svc", 4096, nullptr, configTIMER_TASK_PRIORITY);
+    }
+
+    MockTimer *timer = new MockTimer();
+    snprintf(timer->name, sizeof(timer->name), "%s", name);
+    timer->period = period;
+    timer->autoReload = autoReload != pdFALSE;
+    timer->id = id;
+    timer->callback = callback;
+    timers.push_back(timer);
+    return timer;
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(kernel);
+    currentLocked();
+    armTimerLocked(timer);
+    return pdPASS;
+}
+
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t ticks) {
+    return xTimerStart(timer, ticks);
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(kernel);
+    currentLocked();
+    timer->active = false;
+    wakeLocked(&timers);
+    return pdPASS;
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(kernel);
+    currentLocked();
+    timer->period = period;
+    armTimerLocked(timer);
+    return pdPASS;
+}
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer) {
+    std::lock_guard<std::mutex> guard(kernel);
+    return timer->active ? pdTRUE : pdFALSE;
+}
+
+void *pvTimerGetTimerID(TimerHandle_t timer) {
+    return timer->id;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+MockTask *currentLocked() {
+    if (self != nullptr) {
+        return self;
+    }
+    if (running != nullptr) {
+        fprintf(stderr, "mock: the kernel was called from a thread that is not a task\n");
+        abort();
+    }
+
+    // The first caller, usually main(), becomes a task like the Arduino loop task
+    self = new MockTask();
+    snprintf(self->name, sizeof(self->name), "main");
+    self->priority = MOCK_MAIN_PRIORITY;
+    self->stackDepth = MOCK_MAIN_STACK_DEPTH;
+    self->state = eRunning;
+    self->timeoutUs = MOCK_NO_TIMEOUT;
+    self->lastRun = ++switchCount;
+    tasks.push_back(self);
+    running = self;
+    return self;
+}
+
+MockTask *createTaskLocked(TaskFunction_t code, const char *name, uint32_t stackDepth, void *parameters,
+                           UBaseType_t priority) {
+    MockTask *task = new MockTask();
+    snprintf(task->name, sizeof(task->name), "%s", name);
+    task->code = code;
+    task->parameters = parameters;
+    task->priority = priority;
+    task->stackDepth = stackDepth;
+    task->state = eReady;
+    task->timeoutUs = MOCK_NO_TIMEOUT;
+    tasks.push_back(task);
+    std::thread(taskEntry, task).detach();
+    return task;
+}
+
+void taskEntry(MockTask *task) {
+    {
+        std::unique_lock<std::mutex> lock(kernel);
+        self = task;
+        while (running != task) {
+            task->wake.wait(lock);
+        }
+    }
+    task->code(task->parameters);
+    // Returning from a task is a bug on the device, here it only ends the task
+    vTaskDelete(nullptr);
+}
+
+void expireLocked() {
+    for (MockTask *task: tasks) {
+        if (task->state == eBlocked && task->timeoutUs <= nowUs) {
+            task->state = eReady;
+            task->waitingOn = nullptr;
+            task->timeoutUs = MOCK_NO_TIMEOUT;
+            task->timedOut = true;
+        }
+    }
+}
+
+MockTask *pickNextLocked() {
+    while (true) {
+        expireLocked();
+
+        MockTask *next = nullptr;
+        for (MockTask *task: tasks) {
+            if (task->state != eReady && task->state != eRunning) {
+                continue;
+            }
+            if (next == nullptr || task->priority > next->priority ||
+                (task->priority == next->priority && task->lastRun < next->lastRun)) {
+                next = task;
+            }
+        }
+        if (next != nullptr) {
+            return next;
+        }
+
+        // Every task waits: time jumps to the first timeout, as the idle task would have seen it pass
+        uint64_t earliest = MOCK_NO_TIMEOUT;
+        for (MockTask *task: tasks) {
+            if (task->state == eBlocked && task->timeoutUs < earliest) {
+                earliest = task->timeoutUs;
+            }
+        }
+        if (earliest == MOCK_NO_TIMEOUT) {
+            reportDeadlock();
+            abort();
+        }
+        nowUs = earliest;
+    }
+}
+
+void scheduleLocked(std::unique_lock<std::mutex> &lock) {
+    MockTask *me = self;
+    MockTask *next = pickNextLocked();
+    if (next == me) {
+        me->state = eRunning;
+        return;
+    }
+
+    if (me->state == eRunning) {
+        me->state = eReady;
+    }
+    next->state = eRunning;
+    next->lastRun = ++switchCount;
+    running = next;
+    next->wake.notify_one();
+    while (running != me) {
+        me->wake.wait(lock);
+    }
+}
+
+void preemptLocked(std::unique_lock<std::mutex> &lock) {
+    MockTask *me = self;
+    for (MockTask *task: tasks) {
+        if (task->state == eReady && task->priority > me->priority) {
+            if (me->criticalNesting > 0) {
+                me->switchPending = true;
+                return;
+            }
+            scheduleLocked(lock);
+            return;
+        }
+    }
+}
+
+bool blockLocked(std::unique_lock<std::mutex> &lock, const void *object, uint64_t timeoutUs) {
+    MockTask *me = self;
+    if (me->criticalNesting > 0) {
+        fprintf(stderr, "mock: task %s blocks inside a critical section\n", me->name);
+        abort();
+    }
+    me->state = eBlocked;
+    me->waitingOn = object;
+    me->timeoutUs = timeoutUs;
+    me->timedOut = false;
+    scheduleLocked(lock);
+    return !me->timedOut;
+}
+
+bool wakeLocked(const void *object) {
+    bool woken = false;
+    for (MockTask *task: tasks) {
+        if (task->state == eBlocked && task->waitingOn == object) {
+            task->state = eReady;
+            task->waitingOn = nullptr;
+            task->timeoutUs = MOCK_NO_TIMEOUT;
+            woken = true;
+        }
+    }
+    return woken;
+}
+
+uint64_t deadlineLocked(TickType_t ticks) {
+    if (ticks == portMAX_DELAY) {
+        return MOCK_NO_TIMEOUT;
+    }
+    // Counted from the current tick like the kernel does, the wait ends on a tick boundary
+    const uint64_t tickUs = 1000000 / configTICK_RATE_HZ;
+    return (nowUs / tickUs + ticks) * tickUs;
+}
+
+template<typename Ready>
+bool waitForLocked(std::unique_lock<std::mutex> &lock, const void *object, TickType_t ticks, Ready ready) {
+    const uint64_t timeoutUs = deadlineLocked(ticks);
+    while (!ready()) {
+        if (ticks == 0 || !blockLocked(lock, object, timeoutUs)) {
+            return ready();
+        }
+    }
+    return true;
+}
+
+void reportDeadlock() {
+    fprintf(stderr, "mock: every task is blocked without a timeout at %llu us\n", (unsigned long long) nowUs);
+    for (const MockTask *task: tasks) {
+        fprintf(stderr, "mock:   %-16s priority %u, state %d, waiting on %p\n", task->name, task->priority,
+                task->state, task->waitingOn);
+    }
+}
+
+BaseType_t sendLocked(std::unique_lock<std::mutex> &lock, MockQueue *queue, const void *item, TickType_t ticks,
+                      bool preempt, BaseType_t *woken) {
+    if (!waitForLocked(lock, queue, ticks, [queue] { return queue->count < queue->length; })) {
+        return pdFALSE;
+    }
+    if (item != nullptr && queue->itemSize > 0) {
+        const UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(&queue->items[tail * queue->itemSize], item, queue->itemSize);
+    }
+    queue->count++;
+
+    if (!wakeLocked(queue)) {
+        return pdTRUE;
+    }
+    if (preempt) {
+        preemptLocked(lock);
+    } else if (woken != nullptr) {
+        for (const MockTask *task: tasks) {
+            if (task->state == eReady && task->priority > self->priority) {
+                *woken = pdTRUE;
+            }
+        }
+    }
+    return pdTRUE;
+}
+
+void timerServiceTask(void *parameters) {
+    std::unique_lock<std::mutex> lock(kernel);
+    while (true) {
+        MockTimer *due = nullptr;
+        for (MockTimer *timer: timers) {
+            if (timer->active && (due == nullptr || timer->expiryUs < due->expiryUs)) {
+                due = timer;
+            }
+        }
+        if (due == nullptr || due->expiryUs > nowUs) {
+            blockLocked(lock, &timers, due != nullptr ? due->expiryUs : MOCK_NO_TIMEOUT);
+            continue;
+        }
+
+        if (due->autoReload && due->period > 0) {
+            due->expiryUs += (uint64_t) due->period * 1000000 / configTICK_RATE_HZ;
+        } else {
+            due->active = false;
+        }
+        lock.unlock();
+        due->callback(due);
+        lock.lock();
+    }
+}
+
+void armTimerLocked(MockTimer *timer) {
+    timer->active = true;
+    timer->expiryUs = deadlineLocked(timer->period);
+    wakeLocked(&timers);
+}
@@ -0,0 +1,123 @@
+/*===========================================================================*/
+/// \file mock_gfx.cpp
+///
+/// \brief
+///    Host stand-in for the Adafruit GFX library
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "Adafruit_GFX.h"
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+// Cell of the classic font, the box leaves the last column and row free like the glyphs do
+#define MOCK_GFX_CHAR_WIDTH 6
+#define MOCK_GFX_CHAR_HEIGHT 8
+// Advance and height above the baseline with a GFXfont
+#define MOCK_GFX_FONT_ADVANCE 9
+#define MOCK_GFX_FONT_ASCENT 12
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h), _width(w), _height(h) {
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    for (int16_t i = 0; i < h; i++) {
+        drawPixel(x, (int16_t) (y + i), color);
+    }
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    for (int16_t i = 0; i < w; i++) {
+        drawPixel((int16_t) (x + i), y, color);
+    }
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    for (int16_t i = 0; i < w; i++) {
+        drawFastVLine((int16_t) (x + i), y, h, color);
+    }
+}
+
+void Adafruit_GFX::fillScreen(uint16_t color) {
+    fillRect(0, 0, _width, _height, color);
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, (int16_t) (y + h - 1), w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine((int16_t) (x + w - 1), y, h, color);
+}
+
+void Adafruit_GFX::getTextBounds(const char *text, int16_t x, int16_t y, int16_t *x1, int16_t *y1, uint16_t *w,
+                                 uint16_t *h) {
+    uint16_t longest = 0;
+    uint16_t current = 0;
+    uint16_t lines = 1;
+    for (const char *c = text; *c != '\0'; c++) {
+        if (*c == '\n') {
+            lines++;
+            current = 0;
+        } else if (*c != '\r') {
+            current++;
+            longest = current > longest ? current : longest;
+        }
+    }
+
+    if (gfxFont != nullptr) {
+        *x1 = x;
+        *y1 = (int16_t) (y - MOCK_GFX_FONT_ASCENT * textsize);
+        *w = (uint16_t) (longest * MOCK_GFX_FONT_ADVANCE * textsize);
+        *h = (uint16_t) ((MOCK_GFX_FONT_ASCENT + (lines - 1) * gfxFont->yAdvance) * textsize);
+    } else {
+        *x1 = x;
+        *y1 = y;
+        *w = (uint16_t) (longest * MOCK_GFX_CHAR_WIDTH * textsize);
+        *h = (uint16_t) (lines * MOCK_GFX_CHAR_HEIGHT * textsize);
+    }
+    if (longest == 0) {
+        *w = 0;
+        *h = 0;
+    }
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+    const int16_t advance = (int16_t) ((gfxFont != nullptr ? MOCK_GFX_FONT_ADVANCE : MOCK_GFX_CHAR_WIDTH) * textsize);
+    if (c == '\n') {
+        cursor_x = 0;
+        cursor_y = (int16_t) (cursor_y + (gfxFont != nullptr ? gfxFont->yAdvance : MOCK_GFX_CHAR_HEIGHT) * textsize);
+        return 1;
+    }
+    if (c == '\r') {
+        return 1;
+    }
+    if (wrap && cursor_x + advance > _width) {
+        cursor_x = 0;
+        cursor_y = (int16_t) (cursor_y + (gfxFont != nullptr ? gfxFont->yAdvance : MOCK_GFX_CHAR_HEIGHT) * textsize);
+    }
+
+    if (c != ' ') {
+        if (gfxFont != nullptr) {
+            fillRect(cursor_x, (int16_t) (cursor_y - MOCK_GFX_FONT_ASCENT * textsize), (int16_t) (advance - textsize),
+                     (int16_t) (MOCK_GFX_FONT_ASCENT * textsize), textcolor);
+        } else {
+            fillRect(cursor_x, cursor_y, (int16_t) (advance - textsize),
+                     (int16_t) ((MOCK_GFX_CHAR_HEIGHT - 1) * textsize), textcolor);
+        }
+    }
+    cursor_x = (int16_t) (cursor_x + advance);
+    return 1;
+}
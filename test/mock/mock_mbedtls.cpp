@@ -0,0 +1,193 @@
+/*===========================================================================*/
+/// \file mock_mbedtls.cpp
+///
+/// \brief
+///    Host stand-in for the mbedTLS calls of the firmware: SHA-256 in software, public keys that never parse
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "mbedtls/pk.h"
+#include "mbedtls/sha256.h"
+#include <string.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define MOCK_SHA256_BLOCK_SIZE 64
+
+/*=============================================================================
+                                     Macros
+=============================================================================*/
+
+#define ROTR(value, count) (((value) >> (count)) | ((value) << (32 - (count))))
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static void compress(uint32_t *state, const uint8_t *block);
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const uint32_t initialState[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static const uint32_t roundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+void mbedtls_sha256_init(mbedtls_sha256_context *context) {
+    memset(context, 0, sizeof(*context));
+}
+
+void mbedtls_sha256_free(mbedtls_sha256_context *context) {
+    memset(context, 0, sizeof(*context));
+}
+
+int mbedtls_sha256_starts_ret(mbedtls_sha256_context *context, int is224) {
+    memcpy(context->state, initialState, sizeof(initialState));
+    context->length = 0;
+    return 0;
+}
+
+int mbedtls_sha256_update_ret(mbedtls_sha256_context *context, const unsigned char *data, size_t length) {
+    size_t used = context->length % MOCK_SHA256_BLOCK_SIZE;
+    context->length += length;
+
+    // Complete the pending block first, then hash whole blocks straight from the input
+    if (used > 0) {
+        const size_t fill = length < MOCK_SHA256_BLOCK_SIZE - used ? length : MOCK_SHA256_BLOCK_SIZE - used;
+        memcpy(&context->block[used], data, fill);
+        data += fill;
+        length -= fill;
+        used += fill;
+        if (used < MOCK_SHA256_BLOCK_SIZE) {
+            return 0;
+        }
+        compress(context->state, context->block);
+    }
+    while (length >= MOCK_SHA256_BLOCK_SIZE) {
+        compress(context->state, data);
+        data += MOCK_SHA256_BLOCK_SIZE;
+        length -= MOCK_SHA256_BLOCK_SIZE;
+    }
+    memcpy(context->block, data, length);
+    return 0;
+}
+
+int mbedtls_sha256_finish_ret(mbedtls_sha256_context *context, unsigned char *digest) {
+    const uint64_t bits = context->length * 8;
+    size_t used = context->length % MOCK_SHA256_BLOCK_SIZE;
+
+    // A 1 bit, zeros up to 56 bytes in the last block, then the message length in bits big endian
+    context->block[used++] = 0x80;
+    if (used > MOCK_SHA256_BLOCK_SIZE - 8) {
+        memset(&context->block[used], 0, MOCK_SHA256_BLOCK_SIZE - used);
+        compress(context->state, context->block);
+        used = 0;
+    }
+    memset(&context->block[used], 0, MOCK_SHA256_BLOCK_SIZE - 8 - used);
+    for (int i = 0; i < 8; i++) {
+        context->block[MOCK_SHA256_BLOCK_SIZE - 1 - i] = (uint8_t) (bits >> (i * 8));
+    }
+    compress(context->state, context->block);
+
+    for (int i = 0; i < 8; i++) {
+        digest[i * 4] = (uint8_t) (context->state[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t) (context->state[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t) (context->state[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t) context->state[i];
+    }
+    return 0;
+}
+
+int mbedtls_sha256_ret(const unsigned char *input, size_t length, unsigned char output[32], int is224) {
+    mbedtls_sha256_context context;
+    mbedtls_sha256_init(&context);
+    mbedtls_sha256_starts_ret(&context, is224);
+    mbedtls_sha256_update_ret(&context, input, length);
+    mbedtls_sha256_finish_ret(&context, output);
+    mbedtls_sha256_free(&context);
+    return 0;
+}
+
+void mbedtls_pk_init(mbedtls_pk_context *context) {
+    context->info = nullptr;
+}
+
+void mbedtls_pk_free(mbedtls_pk_context *context) {
+    context->info = nullptr;
+}
+
+int mbedtls_pk_parse_public_key(mbedtls_pk_context *context, const unsigned char *key, size_t keyLength) {
+    return MBEDTLS_ERR_PK_KEY_INVALID_FORMAT;
+}
+
+int mbedtls_pk_verify(mbedtls_pk_context *context, mbedtls_md_type_t type, const unsigned char *hash,
+                      size_t hashLength, const unsigned char *signature, size_t signatureLength) {
+    return MBEDTLS_ERR_PK_BAD_INPUT_DATA;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+void compress(uint32_t *state, const uint8_t *block) {
+    uint32_t schedule[64];
+    for (int i = 0; i < 16; i++) {
+        schedule[i] = (uint32_t) block[i * 4] << 24 | (uint32_t) block[i * 4 + 1] << 16 |
+                      (uint32_t) block[i * 4 + 2] << 8 | block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        const uint32_t s0 = ROTR(schedule[i - 15], 7) ^ ROTR(schedule[i - 15], 18) ^ (schedule[i - 15] >> 3);
+        const uint32_t s1 = ROTR(schedule[i - 2], 17) ^ ROTR(schedule[i - 2], 19) ^ (schedule[i - 2] >> 10);
+        schedule[i] = schedule[i - 16] + s0 + schedule[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+        const uint32_t t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + ((e & f) ^ (~e & g)) + roundConstants[i] +
+                            schedule[i];
+        const uint32_t t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
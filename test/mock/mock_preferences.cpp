@@ -0,0 +1,217 @@
+/*===========================================================================*/
+/// \file mock_preferences.cpp
+///
+/// \brief
+///    Host stand-in for the Preferences library of the ESP32 core
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "Preferences.h"
+#include "mock.h"
+#include <map>
+#include <vector>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+// NVS limits of the IDF
+#define MOCK_NVS_NAME_SIZE 15
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    PreferenceType type;
+    std::vector<uint8_t> bytes;
+} mockPreference_t;
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static std::map<std::string, mockPreference_t> &namespaceOf(const std::string &name);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static std::map<std::string, std::map<std::string, mockPreference_t>> stores;
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+bool Preferences::begin(const char *name, bool readOnly, const char *partitionLabel) {
+    if (started || name == nullptr || strlen(name) > MOCK_NVS_NAME_SIZE) {
+        return false;
+    }
+    space = name;
+    this->readOnly = readOnly;
+    started = true;
+    return true;
+}
+
+void Preferences::end() {
+    started = false;
+}
+
+bool Preferences::clear() {
+    if (!started || readOnly) {
+        return false;
+    }
+    namespaceOf(space).clear();
+    return true;
+}
+
+bool Preferences::remove(const char *key) {
+    if (!started || readOnly) {
+        return false;
+    }
+    return namespaceOf(space).erase(key) > 0;
+}
+
+bool Preferences::isKey(const char *key) {
+    return getType(key) != PT_INVALID;
+}
+
+PreferenceType Preferences::getType(const char *key) {
+    if (!started) {
+        return PT_INVALID;
+    }
+    const std::map<std::string, mockPreference_t> &values = namespaceOf(space);
+    const auto found = values.find(key);
+    return found != values.end() ? found->second.type : PT_INVALID;
+}
+
+size_t Preferences::putBool(const char *key, bool value) {
+    const uint8_t byte = value ? 1 : 0;
+    return put(key, PT_U8, &byte, sizeof(byte));
+}
+
+size_t Preferences::putUChar(const char *key, uint8_t value) {
+    return put(key, PT_U8, &value, sizeof(value));
+}
+
+size_t Preferences::putUShort(const char *key, uint16_t value) {
+    return put(key, PT_U16, &value, sizeof(value));
+}
+
+size_t Preferences::putInt(const char *key, int32_t value) {
+    return put(key, PT_I32, &value, sizeof(value));
+}
+
+size_t Preferences::putUInt(const char *key, uint32_t value) {
+    return put(key, PT_U32, &value, sizeof(value));
+}
+
+size_t Preferences::putLong64(const char *key, int64_t value) {
+    return put(key, PT_I64, &value, sizeof(value));
+}
+
+size_t Preferences::putString(const char *key, const char *value) {
+    // The terminator is stored, the returned length leaves it out
+    const size_t length = strlen(value);
+    return put(key, PT_STR, value, length + 1) > 0 ? length : 0;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t length) {
+    return put(key, PT_BLOB, value, length);
+}
+
+bool Preferences::getBool(const char *key, bool defaultValue) {
+    return getUChar(key, defaultValue ? 1 : 0) != 0;
+}
+
+uint8_t Preferences::getUChar(const char *key, uint8_t defaultValue) {
+    uint8_t value = defaultValue;
+    get(key, PT_U8, &value, sizeof(value));
+    return value;
+}
+
+uint16_t Preferences::getUShort(const char *key, uint16_t defaultValue) {
+    uint16_t value = defaultValue;
+    get(key, PT_U16, &value, sizeof(value));
+    return value;
+}
+
+int32_t Preferences::getInt(const char *key, int32_t defaultValue) {
+    int32_t value = defaultValue;
+    get(key, PT_I32, &value, sizeof(value));
+    return value;
+}
+
+uint32_t Preferences::getUInt(const char *key, uint32_t defaultValue) {
+    uint32_t value = defaultValue;
+    get(key, PT_U32, &value, sizeof(value));
+    return value;
+}
+
+int64_t Preferences::getLong64(const char *key, int64_t defaultValue) {
+    int64_t value = defaultValue;
+    get(key, PT_I64, &value, sizeof(value));
+    return value;
+}
+
+size_t Preferences::getString(const char *key, char *value, size_t maxLength) {
+    if (getType(key) != PT_STR) {
+        return 0;
+    }
+    const std::vector<uint8_t> &bytes = namespaceOf(space)[key].bytes;
+    if (bytes.size() > maxLength) {
+        return 0;
+    }
+    memcpy(value, bytes.data(), bytes.size());
+    return bytes.size();
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+    return getType(key) == PT_BLOB ? namespaceOf(space)[key].bytes.size() : 0;
+}
+
+size_t Preferences::getBytes(const char *key, void *value, size_t maxLength) {
+    const size_t length = getBytesLength(key);
+    if (length == 0 || length > maxLength) {
+        return 0;
+    }
+    memcpy(value, namespaceOf(space)[key].bytes.data(), length);
+    return length;
+}
+
+void mockPreferencesClear() {
+    stores.clear();
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+size_t Preferences::put(const char *key, PreferenceType type, const void *value, size_t length) {
+    if (!started || readOnly || strlen(key) > MOCK_NVS_NAME_SIZE) {
+        return 0;
+    }
+    mockPreference_t &entry = namespaceOf(space)[key];
+    entry.type = type;
+    entry.bytes.assign((const uint8_t *) value, (const uint8_t *) value + length);
+    return length;
+}
+
+bool Preferences::get(const char *key, PreferenceType type, void *value, size_t length) {
+    if (getType(key) != type) {
+        return false;
+    }
+    memcpy(value, namespaceOf(space)[key].bytes.data(), length);
+    return true;
+}
+
+std::map<std::string, mockPreference_t> &namespaceOf(const std::string &name) {
+    return stores[name];
+}
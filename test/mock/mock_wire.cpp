@@ -0,0 +1,252 @@
+/*===========================================================================*/
+/// \file mock_wire.cpp
+///
+/// \brief
+///    Host stand-in for the I2C and SPI libraries of the ESP32 core, with SSD1306 panels on the I2C bus
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include "SPI.h"
+#include "Wire.h"
+#include "mock.h"
+#include <map>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SSD1306_CONTROL_COMMAND 0x00
+#define SSD1306_CONTROL_DATA 0x40
+#define SSD1306_COLUMN_ADDRESS 0x21
+#define SSD1306_PAGE_ADDRESS 0x22
+
+#define MOCK_I2C_NACK_ADDRESS 2
+#define MOCK_MUX_FIRST 0x70
+#define MOCK_MUX_LAST 0x77
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    uint8_t gddram[MOCK_SSD1306_GDDRAM_SIZE];
+    uint8_t command;       // Command waiting for its arguments
+    uint8_t arguments[6];
+    uint8_t argumentCount;
+    uint8_t expected;
+    uint8_t columnStart;
+    uint8_t columnEnd;
+    uint8_t pageStart;
+    uint8_t pageEnd;
+    uint8_t column;
+    uint8_t page;
+    size_t dataBytes;
+} mockSsd1306_t;
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static std::map<uint8_t, mockSsd1306_t> &panels();
+
+static void resetPanel(mockSsd1306_t *panel);
+
+static uint8_t argumentCount(uint8_t command);
+
+static void panelCommand(mockSsd1306_t *panel, uint8_t byte);
+
+static void panelData(mockSsd1306_t *panel, uint8_t byte);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static uint32_t failCount = 0;
+
+/*=============================================================================
+                                Public Constants
+=============================================================================*/
+
+TwoWire Wire;
+
+SPIClass SPI;
+
+/*=============================================================================
+                                Public Functions
+=============================================================================*/
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+    return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency) {
+    return true;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    this->address = address;
+    length = 0;
+    transmitting = true;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    transmitting = false;
+    if (failCount > 0) {
+        failCount--;
+        return MOCK_I2C_NACK_ADDRESS;
+    }
+    if (address >= MOCK_MUX_FIRST && address <= MOCK_MUX_LAST) {
+        return 0;
+    }
+    const auto found = panels().find(address);
+    if (found == panels().end()) {
+        return MOCK_I2C_NACK_ADDRESS;
+    }
+
+    // The control byte gives the kind of the whole transmission, the continuation bit is not used by the firmware
+    mockSsd1306_t *panel = &found->second;
+    if (length == 0) {
+        return 0;
+    }
+    for (size_t i = 1; i < length; i++) {
+        if (buffer[0] == SSD1306_CONTROL_DATA) {
+            panelData(panel, buffer[i]);
+        } else if (buffer[0] == SSD1306_CONTROL_COMMAND) {
+            panelCommand(panel, buffer[i]);
+        }
+    }
+    return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t size, bool sendStop) {
+    return 0;
+}
+
+size_t TwoWire::write(uint8_t c) {
+    if (!transmitting || length >= sizeof(buffer)) {
+        return 0;
+    }
+    buffer[length++] = c;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t size) {
+    size_t written = 0;
+    while (written < size && write(data[written]) == 1) {
+        written++;
+    }
+    return written;
+}
+
+void mockI2cSetPresent(uint8_t address, bool present) {
+    if (!present) {
+        panels().erase(address);
+        return;
+    }
+    resetPanel(&panels()[address]);
+}
+
+void mockI2cFailNext(uint32_t count) {
+    failCount = count;
+}
+
+const uint8_t *mockSsd1306Gddram(uint8_t address) {
+    const auto found = panels().find(address);
+    return found != panels().end() ? found->second.gddram : nullptr;
+}
+
+size_t mockSsd1306DataBytes(uint8_t address) {
+    const auto found = panels().find(address);
+    return found != panels().end() ? found->second.dataBytes : 0;
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+std::map<uint8_t, mockSsd1306_t> &panels() {
+    static std::map<uint8_t, mockSsd1306_t> bus;
+    static bool populated = false;
+    if (!populated) {
+        populated = true;
+        resetPanel(&bus[MOCK_I2C_DEFAULT_PANEL]);
+    }
+    return bus;
+}
+
+void resetPanel(mockSsd1306_t *panel) {
+    memset(panel, 0, sizeof(*panel));
+    panel->columnEnd = MOCK_SSD1306_COLUMNS - 1;
+    panel->pageEnd = MOCK_SSD1306_PAGES - 1;
+}
+
+uint8_t argumentCount(uint8_t command) {
+    switch (command) {
+        case SSD1306_COLUMN_ADDRESS:
+        case SSD1306_PAGE_ADDRESS:
+        case 0xA3:
+            return 2;
+        case 0x20:
+        case 0x81:
+        case 0x8D:
+        case 0xA8:
+        case 0xD3:
+        case 0xD5:
+        case 0xD9:
+        case 0xDA:
+        case 0xDB:
+            return 1;
+        case 0x26:
+        case 0x27:
+            return 6;
+        case 0x29:
+        case 0x2A:
+            return 5;
+        default:
+            return 0;
+    }
+}
+
+void panelCommand(mockSsd1306_t *panel, uint8_t byte) {
+    if (panel->expected == 0) {
+        panel->command = byte;
+        panel->argumentCount = 0;
+        panel->expected = argumentCount(byte);
+        return;
+    }
+
+    panel->arguments[panel->argumentCount++] = byte;
+    if (panel->argumentCount < panel->expected) {
+        return;
+    }
+    panel->expected = 0;
+    // Only the addressing commands change what the data writes do
+    if (panel->command == SSD1306_COLUMN_ADDRESS) {
+        panel->columnStart = panel->arguments[0] & 0x7F;
+        panel->columnEnd = panel->arguments[1] & 0x7F;
+        panel->column = panel->columnStart;
+    } else if (panel->command == SSD1306_PAGE_ADDRESS) {
+        panel->pageStart = panel->arguments[0] & 0x07;
+        panel->pageEnd = panel->arguments[1] & 0x07;
+        panel->page = panel->pageStart;
+    }
+}
+
+void panelData(mockSsd1306_t *panel, uint8_t byte) {
+    // Horizontal addressing: along the column window, then the next page of the page window
+    panel->gddram[panel->page * MOCK_SSD1306_COLUMNS + panel->column] = byte;
+    panel->dataBytes++;
+    if (panel->column < panel->columnEnd) {
+        panel->column++;
+        return;
+    }
+    panel->column = panel->columnStart;
+    panel->page = panel->page < panel->pageEnd ? panel->page + 1 : panel->pageStart;
+}
@@ -0,0 +1,324 @@
+/*===========================================================================*/
+/// \file test_main.cpp
+///
+/// \brief
+///    IMA-ADPCM decoding against reference PCM and the block buffering against a file sink
+///
+/// \details
+///     The reference blocks were encoded and decoded by the audioop module of Python 3.11, an implementation of
+///     IMA-ADPCM independent from this one; the nibbles are swapped to the WAV order (low nibble first). The first
+///     block is a chirp, the second a full scale square wave that drives the step index up and clamps the predictor.
+///     The player runs between a clip in a temporary file and a sink writing the PCM to another one.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <stdio.h>
+#include <string.h>
+#include <svc_audio.h>
+#include <unity.h>
+#include <vector>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define REFERENCE_BLOCKS 2
+#define REFERENCE_BLOCK_SIZE 36
+#define REFERENCE_SAMPLES SVC_AUDIO_BLOCK_SAMPLES(REFERENCE_BLOCK_SIZE)
+#define REFERENCE_SAMPLE_RATE 8000
+// Times the reference blocks are repeated in the clips played to the file sink
+#define CLIP_REPEATS 3
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+/// Clip stored in a temporary file, like the adhan partition
+class FileAudioSource : public AudioSource {
+public:
+    explicit FileAudioSource(const std::vector<uint8_t> &clip) : file(tmpfile()) {
+        fwrite(clip.data(), 1, clip.size(), file);
+    }
+
+    ~FileAudioSource() override {
+        fclose(file);
+    }
+
+    bool read(uint32_t offset, uint8_t *data, size_t length) override {
+        return fseek(file, offset, SEEK_SET) == 0 && fread(data, 1, length, file) == length;
+    }
+
+private:
+    FILE *file;
+};
+
+/// Writes the samples to a temporary file and checks that a buffer is not touched while it is being "sent"
+class FileAudioSink : public AudioSink {
+public:
+    FileAudioSink() : file(tmpfile()) {
+    }
+
+    ~FileAudioSink() override {
+        fclose(file);
+    }
+
+    bool begin(uint32_t sampleRate) override {
+        begins++;
+        rate = sampleRate;
+        return true;
+    }
+
+    bool write(int16_t *samples, size_t count) override {
+        // Like a DMA transfer, the previous buffer is read until this write: it must not have changed meanwhile
+        if (sending != nullptr) {
+            if (memcmp(sending, sent.data(), sent.size() * sizeof(int16_t)) != 0 || samples == sending) {
+                overwrites++;
+            }
+        }
+        sending = samples;
+        sent.assign(samples, samples + count);
+
+        fwrite(samples, sizeof(int16_t), count, file);
+        writes++;
+        if (stopAfter > 0 && writes == stopAfter) {
+            stop = true;
+        }
+        return !failWrites;
+    }
+
+    void end() override {
+        ends++;
+        sending = nullptr;
+    }
+
+    std::vector<int16_t> pcm() {
+        std::vector<int16_t> samples(ftell(file) / sizeof(int16_t));
+        rewind(file);
+        const size_t count = fread(samples.data(), sizeof(int16_t), samples.size(), file);
+        samples.resize(count);
+        return samples;
+    }
+
+    uint32_t rate = 0;
+    uint32_t begins = 0;
+    uint32_t writes = 0;
+    uint32_t ends = 0;
+    uint32_t overwrites = 0;
+    uint32_t stopAfter = 0;
+    bool failWrites = false;
+    volatile bool stop = false;
+
+private:
+    FILE *file;
+    const int16_t *sending = nullptr;
+    std::vector<int16_t> sent;
+};
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static std::vector<uint8_t> buildClip(size_t repeats, size_t trailingBytes);
+
+static uint32_t fakeCounter();
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static uint32_t counterValue = 0;
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const uint8_t referenceBlocks[REFERENCE_BLOCKS * REFERENCE_BLOCK_SIZE] = {
+    0x00, 0x00, 0x00, 0x00, 0x77, 0x77, 0x77, 0x77, 0xF0, 0xAC, 0x30, 0x26,
+    0xC0, 0x8C, 0x43, 0xC8, 0x3A, 0x94, 0x0D, 0x84, 0x1C, 0xB3, 0x59, 0xA9,
+    0x94, 0x4A, 0x8A, 0xD3, 0x93, 0x39, 0x4C, 0x2B, 0x2A, 0x09, 0x80, 0x18,
+    0xFF, 0x7F, 0x4B, 0x00, 0xFF, 0x09, 0x88, 0x27, 0x00, 0x00, 0xBF, 0x80,
+    0x08, 0x37, 0x00, 0x00, 0xBF, 0x80, 0x08, 0x37, 0x00, 0x00, 0xBF, 0x80,
+    0x08, 0x37, 0x00, 0x00, 0xBF, 0x80, 0x08, 0x37, 0x00, 0x00, 0xBF, 0x80
+};
+
+static const int16_t referencePcm[REFERENCE_BLOCKS * REFERENCE_SAMPLES] = {
+    0, 11, 41, 104, 240, 533, 1164, 2521, 5431, 5846, 176, -7118,
+    -12020, -11129, -5456, 4121, 10647, 11833, 2125, -9622, -11201, -1152, 10595, 9016,
+    -3906, -12592, -1538, 11384, 6173, -11199, -8887, 10033, 7490, -13322, -4928, 12877,
+    -3310, -9616, 11406, 3012, -9706, 11106, 2712, -10006, 10806, -3184, -5727, 10460,
+    -12664, 8879, 485, -7145, 9042, -9878, 13015, -8528, 5462, -7256, 4306, -2000,
+    -89, 1648, 69, -1366, 2549, 32767, 14969, -23186, -32768, -29044, -32429, -32768,
+    9203, 29681, 32767, 32767, 32767, 32767, -5388, -32768, -29044, -32429, -32768, -29970,
+    8185, 32767, 32767, 32767, 32767, 32767, -5388, -32768, -29044, -32429, -32768, -29970,
+    8185, 32767, 32767, 32767, 32767, 32767, -5388, -32768, -29044, -32429, -32768, -29970,
+    8185, 32767, 32767, 32767, 32767, 32767, -5388, -32768, -29044, -32429, -32768, -29970,
+    8185, 32767, 32767, 32767, 32767, 32767, -5388, -32768, -29044, -32429
+};
+
+/*=============================================================================
+                                      Tests
+=============================================================================*/
+
+void setUp() {
+    counterValue = 0;
+}
+
+void tearDown() {
+}
+
+void test_blocks_decode_to_the_reference() {
+    for (int block = 0; block < REFERENCE_BLOCKS; block++) {
+        int16_t samples[REFERENCE_SAMPLES];
+        TEST_ASSERT_EQUAL_size_t(REFERENCE_SAMPLES, svcAudioDecodeBlock(&referenceBlocks[block * REFERENCE_BLOCK_SIZE],
+                                                                        REFERENCE_BLOCK_SIZE, samples));
+        TEST_ASSERT_EQUAL_INT16_ARRAY(&referencePcm[block * REFERENCE_SAMPLES], samples, REFERENCE_SAMPLES);
+    }
+}
+
+void test_nibbles_by_hand() {
+    // Predictor 0, step index 0 (step 7): +7 gives 11 and index 8 (step 16), -7 gives -19 and index 16 (step 34),
+    // +0 gives -15 and index 15 (step 31), -0 gives -18
+    const uint8_t block[] = {0x00, 0x00, 0x00, 0x00, 0xF7, 0x80};
+    const int16_t expected[] = {0, 11, -19, -15, -18};
+    int16_t samples[SVC_AUDIO_BLOCK_SAMPLES(sizeof(block))];
+    TEST_ASSERT_EQUAL_size_t(5, svcAudioDecodeBlock(block, sizeof(block), samples));
+    TEST_ASSERT_EQUAL_INT16_ARRAY(expected, samples, 5);
+}
+
+void test_step_index_out_of_range_is_clamped() {
+    uint8_t block[REFERENCE_BLOCK_SIZE];
+    memcpy(block, &referenceBlocks[REFERENCE_BLOCK_SIZE], sizeof(block));
+    int16_t clamped[REFERENCE_SAMPLES];
+    int16_t highest[REFERENCE_SAMPLES];
+    block[2] = 200;
+    svcAudioDecodeBlock(block, sizeof(block), clamped);
+    block[2] = 88;
+    svcAudioDecodeBlock(block, sizeof(block), highest);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(highest, clamped, REFERENCE_SAMPLES);
+}
+
+void test_clip_plays_to_the_file_sink() {
+    // A partial block at the end of the data is not played
+    FileAudioSource source(buildClip(CLIP_REPEATS, REFERENCE_BLOCK_SIZE / 2));
+    FileAudioSink sink;
+    svcAudioStats_t stats;
+    TEST_ASSERT_TRUE(svcAudioPlay(&source, &sink, &sink.stop, fakeCounter, &stats));
+
+    TEST_ASSERT_EQUAL_UINT32(REFERENCE_SAMPLE_RATE, sink.rate);
+    TEST_ASSERT_EQUAL_UINT32(1, sink.begins);
+    TEST_ASSERT_EQUAL_UINT32(1, sink.ends);
+    TEST_ASSERT_EQUAL_UINT32(CLIP_REPEATS * REFERENCE_BLOCKS, stats.blocks);
+    TEST_ASSERT_EQUAL_UINT32(CLIP_REPEATS * REFERENCE_BLOCKS * REFERENCE_SAMPLES, stats.samples);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.sinkErrors);
+    // Two reads of the counter per block, it moves by one on each
+    TEST_ASSERT_EQUAL_UINT32(1, stats.maxDecodeTime);
+
+    const std::vector<int16_t> pcm = sink.pcm();
+    TEST_ASSERT_EQUAL_size_t(CLIP_REPEATS * REFERENCE_BLOCKS * REFERENCE_SAMPLES, pcm.size());
+    for (int repeat = 0; repeat < CLIP_REPEATS; repeat++) {
+        TEST_ASSERT_EQUAL_INT16_ARRAY(referencePcm, &pcm[repeat * REFERENCE_BLOCKS * REFERENCE_SAMPLES],
+                                      REFERENCE_BLOCKS * REFERENCE_SAMPLES);
+    }
+}
+
+void test_decoding_never_touches_the_buffer_being_sent() {
+    FileAudioSource source(buildClip(CLIP_REPEATS, 0));
+    FileAudioSink sink;
+    TEST_ASSERT_TRUE(svcAudioPlay(&source, &sink, nullptr, nullptr, nullptr));
+    TEST_ASSERT_EQUAL_UINT32(CLIP_REPEATS * REFERENCE_BLOCKS, sink.writes);
+    TEST_ASSERT_EQUAL_UINT32(0, sink.overwrites);
+}
+
+void test_stop_ends_playback_early() {
+    FileAudioSource source(buildClip(CLIP_REPEATS, 0));
+    FileAudioSink sink;
+    sink.stopAfter = 2;
+    svcAudioStats_t stats;
+    TEST_ASSERT_FALSE(svcAudioPlay(&source, &sink, &sink.stop, nullptr, &stats));
+    TEST_ASSERT_EQUAL_UINT32(2, stats.blocks);
+    TEST_ASSERT_EQUAL_UINT32(1, sink.ends);
+    TEST_ASSERT_EQUAL_size_t(2 * REFERENCE_SAMPLES, sink.pcm().size());
+}
+
+void test_truncated_clip_and_sink_errors() {
+    // The header announces one more block than the file holds
+    std::vector<uint8_t> clip = buildClip(1, 0);
+    clip[12] += REFERENCE_BLOCK_SIZE;
+    FileAudioSource truncated(clip);
+    FileAudioSink sink;
+    svcAudioStats_t stats;
+    TEST_ASSERT_FALSE(svcAudioPlay(&truncated, &sink, nullptr, nullptr, &stats));
+    TEST_ASSERT_EQUAL_UINT32(REFERENCE_BLOCKS, stats.blocks);
+    TEST_ASSERT_EQUAL_UINT32(1, sink.ends);
+
+    // A sink that cannot keep up loses blocks, the clip still plays to its end
+    FileAudioSource source(buildClip(1, 0));
+    FileAudioSink failing;
+    failing.failWrites = true;
+    TEST_ASSERT_TRUE(svcAudioPlay(&source, &failing, nullptr, nullptr, &stats));
+    TEST_ASSERT_EQUAL_UINT32(REFERENCE_BLOCKS, stats.sinkErrors);
+}
+
+void test_bad_headers_are_refused() {
+    // Magic, version, channels, block size too small and too large
+    const size_t offsets[] = {0, 4, 5, 6, 7};
+    const uint8_t values[] = {'X', SVC_AUDIO_CLIP_VERSION + 1, 2, 4, (SVC_AUDIO_MAX_BLOCK_SIZE + 256) >> 8};
+    for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+        std::vector<uint8_t> clip = buildClip(1, 0);
+        clip[offsets[i]] = values[i];
+        FileAudioSource source(clip);
+        FileAudioSink sink;
+        svcAudioClip_t header;
+        TEST_ASSERT_FALSE(svcAudioReadClip(&source, &header));
+        TEST_ASSERT_FALSE(svcAudioPlay(&source, &sink, nullptr, nullptr, nullptr));
+        TEST_ASSERT_EQUAL_UINT32(0, sink.begins);
+    }
+}
+
+/*=============================================================================
+                                Library Entry Point
+=============================================================================*/
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_blocks_decode_to_the_reference);
+    RUN_TEST(test_nibbles_by_hand);
+    RUN_TEST(test_step_index_out_of_range_is_clamped);
+    RUN_TEST(test_clip_plays_to_the_file_sink);
+    RUN_TEST(test_decoding_never_touches_the_buffer_being_sent);
+    RUN_TEST(test_stop_ends_playback_early);
+    RUN_TEST(test_truncated_clip_and_sink_errors);
+    RUN_TEST(test_bad_headers_are_refused);
+    return UNITY_END();
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+std::vector<uint8_t> buildClip(size_t repeats, size_t trailingBytes) {
+    // Header of svc_audio.h, the reference blocks repeated, then bytes short of a block
+    const uint32_t dataLength = repeats * sizeof(referenceBlocks) + trailingBytes;
+    const uint8_t header[SVC_AUDIO_HEADER_SIZE] = {
+        'A', 'D', 'P', 'C', SVC_AUDIO_CLIP_VERSION, 1, REFERENCE_BLOCK_SIZE, 0,
+        REFERENCE_SAMPLE_RATE & 0xFF, REFERENCE_SAMPLE_RATE >> 8, 0, 0,
+        (uint8_t) dataLength, (uint8_t) (dataLength >> 8), 0, 0
+    };
+    std::vector<uint8_t> clip(header, header + sizeof(header));
+    for (size_t i = 0; i < repeats; i++) {
+        clip.insert(clip.end(), referenceBlocks, referenceBlocks + sizeof(referenceBlocks));
+    }
+    clip.insert(clip.end(), trailingBytes, 0x55);
+    return clip;
+}
+
+uint32_t fakeCounter() {
+    return counterValue++;
+}
@@ -0,0 +1,148 @@
+/*===========================================================================*/
+/// \file test_main.cpp
+///
+/// \brief
+///    The bench command on the host, for the paths that do not touch the hardware
+///
+/// \details
+///     Runs the cases of mod_bench like the bench CLI command does, with the cycle counter of the mock following the
+///     wall clock of the host at the frequency the mock reports. The "bench," lines go to the console and to
+///     bench_output.txt (BENCH_OUTPUT names another file), the input of scripts/bench_compare.py. The whole bench
+///     runs BENCH_PASSES times, the script keeps the best pass of each case: a pass slowed down by the rest of the
+///     machine does not count, the figures are only compared with a baseline recorded on the same machine.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+#include <mod_bench.h>
+#include <mod_cli0.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <svc_cli.h>
+#include <svc_clock.h>
+#include <svc_config.h>
+#include <svc_display.h>
+#include <unity.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define BENCH_DEFAULT_OUTPUT "bench_output.txt"
+#define BENCH_PASSES 5
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+/// Output of the bench command, kept for the checks and copied to the console and the output file
+class BenchOutput : public Print {
+public:
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+        text.append((const char *) buffer, size);
+        fwrite(buffer, 1, size, stdout);
+        if (file != nullptr) {
+            fwrite(buffer, 1, size, file);
+        }
+        return size;
+    }
+
+    FILE *file = nullptr;
+    std::string text;
+};
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static BenchOutput output;
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+// Every case of mod_bench that runs on the host
+static const char *const benchCases[] = {
+    "protocol.decode",
+    "clock.local_to_utc",
+    "clock.to_datetime",
+    "prayer.day_lookup",
+    "prayer.find_next",
+    "display.render",
+    "cli.dispatch",
+};
+
+/*=============================================================================
+                                      Tests
+=============================================================================*/
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_every_case_is_measured() {
+    svcCliSetOut(&output);
+    for (int pass = 0; pass < BENCH_PASSES; pass++) {
+        svcCliGetCli0()->parse("bench");
+    }
+    svcCliSetOut(nullptr);
+
+    TEST_ASSERT_NOT_NULL(strstr(output.text.c_str(), "bench,cpu_mhz,"));
+    for (const char *name: benchCases) {
+        // bench,<name>,<iterations>,<min>,<median>, cycles per iteration with two decimals
+        const std::string prefix = std::string("bench,") + name + ",";
+        const size_t start = output.text.find(prefix);
+        TEST_ASSERT_TRUE_MESSAGE(start != std::string::npos, name);
+
+        unsigned long iterations = 0;
+        double minCycles = 0;
+        double medianCycles = 0;
+        TEST_ASSERT_EQUAL_INT_MESSAGE(3, sscanf(output.text.c_str() + start + prefix.size(), "%lu,%lf,%lf",
+                                                &iterations, &minCycles, &medianCycles), name);
+        TEST_ASSERT_GREATER_THAN_UINT32(0, iterations);
+        TEST_ASSERT_TRUE_MESSAGE(minCycles > 0 && minCycles <= medianCycles, name);
+    }
+}
+
+/*=============================================================================
+                                Library Entry Point
+=============================================================================*/
+
+int main(int argc, char **argv) {
+    // The fixtures of modBenchInit() need the clock and its time zone, the render needs the display buffers
+    modCli0Init();
+    svcConfigInit();
+    svcClockInit();
+    svcDisplayInit();
+    if (!modBenchInit()) {
+        return 1;
+    }
+
+    const char *path = getenv("BENCH_OUTPUT");
+    output.file = fopen(path != nullptr ? path : BENCH_DEFAULT_OUTPUT, "w");
+    if (output.file == nullptr) {
+        perror(path != nullptr ? path : BENCH_DEFAULT_OUTPUT);
+        return 1;
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(test_every_case_is_measured);
+    const int failures = UNITY_END();
+    fclose(output.file);
+    return failures;
+}
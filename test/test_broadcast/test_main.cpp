@@ -0,0 +1,385 @@
+/*===========================================================================*/
+/// \file test_main.cpp
+///
+/// \brief
+///    Broadcast fragments through a lossy channel to a fleet of assemblers
+///
+/// \details
+///     A sender cycles through the fragments of a month like the leader does. The channel in front of each listener
+///     drops, duplicates and corrupts fragments with a seeded generator, so a failure repeats. Every listener must
+///     end up with the exact body, and the rounds it takes depend on the loss rate, not on the number of listeners.
+///     The listener of mod_broadcast is then fed through the mock BLE transport while its timetables are held.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+#include <mock_ble.h>
+#include <mod_broadcast.h>
+#include <mod_cli0.h>
+#include <random>
+#include <stdio.h>
+#include <string.h>
+#include <svc_broadcast.h>
+#include <svc_config.h>
+#include <svc_event.h>
+#include <svc_log.h>
+#include <svc_power.h>
+#include <svc_protocol.h>
+#include <unity.h>
+#include <vector>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define MONTH_DAYS 31
+// Number of days, the days, end of timings
+#define MONTH_BODY_SIZE (SVC_PROTOCOL_NUMBER_OF_DAYS_SIZE + MONTH_DAYS * SVC_PROTOCOL_PRAYER_TIMINGS_SIZE + \
+                         SVC_PROTOCOL_END_OF_TIMINGS_SIZE)
+#define FLEET_SIZE 50
+// Rounds of the sender after which a listener counts as stuck
+#define MAX_ROUNDS 40
+// Deeper than the timetables of the listener, this subscriber holds them all
+#define HOLDER_QUEUE_SIZE 4
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    uint32_t lossPercent;
+    uint32_t duplicatePercent;
+    uint32_t corruptPercent;
+} channel_t;
+
+typedef struct {
+    svcBroadcastAssembler_t assembler;
+    uint32_t rounds; // Rounds it took to complete, 0 while incomplete
+} listener_t;
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static void buildMonth(uint8_t seed, std::vector<uint8_t> *body);
+
+static std::vector<std::vector<uint8_t>> encodeAll(const std::vector<uint8_t> &body, svcBroadcastBodyId_t id);
+
+static uint32_t runFleet(const std::vector<std::vector<uint8_t>> &fragments, const channel_t *channel,
+                         std::vector<listener_t> *fleet);
+
+static svcBroadcastStatus_t feedAll(svcBroadcastAssembler_t *assembler,
+                                    const std::vector<std::vector<uint8_t>> &fragments);
+
+static void advertiseAll(const std::vector<std::vector<uint8_t>> &fragments);
+
+static const PrayerTimetable *receiveTimetable();
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static std::mt19937 generator;
+static std::vector<uint8_t> month;
+static svcBroadcastBodyId_t monthId;
+static QueueHandle_t holder = nullptr;
+
+/*=============================================================================
+                                      Tests
+=============================================================================*/
+
+void setUp() {
+    generator.seed(2025);
+    buildMonth(1, &month);
+    monthId = {7, svcBroadcastBodyCrc(month.data(), month.size())};
+}
+
+void tearDown() {
+}
+
+void test_month_fits_the_fragments() {
+    TEST_ASSERT_EQUAL_size_t(MONTH_BODY_SIZE, month.size());
+    const uint8_t count = svcBroadcastFragmentCount(month.size());
+    TEST_ASSERT_EQUAL_UINT8((MONTH_BODY_SIZE + SVC_BROADCAST_PAYLOAD_SIZE - 1) / SVC_BROADCAST_PAYLOAD_SIZE, count);
+    TEST_ASSERT_TRUE(count <= SVC_BROADCAST_MAX_FRAGMENTS);
+    TEST_ASSERT_EQUAL_UINT8(0, svcBroadcastFragmentCount(SVC_BROADCAST_MAX_BODY_SIZE + 1));
+
+    uint8_t fragment[SVC_BROADCAST_FRAGMENT_SIZE];
+    TEST_ASSERT_EQUAL_size_t(SVC_BROADCAST_FRAGMENT_SIZE, svcBroadcastEncode(month.data(), month.size(), monthId, 0,
+                                                                             fragment));
+    TEST_ASSERT_EQUAL_UINT8(SVC_BROADCAST_COMPANY_ID & 0xFF, fragment[0]);
+    TEST_ASSERT_EQUAL_UINT8(SVC_BROADCAST_COMPANY_ID >> 8, fragment[1]);
+    TEST_ASSERT_EQUAL_UINT8(SVC_BROADCAST_MAGIC, fragment[2]);
+    TEST_ASSERT_EQUAL_size_t(0, svcBroadcastEncode(month.data(), month.size(), monthId, count, fragment));
+}
+
+void test_lossless_channel_completes_in_one_round() {
+    const channel_t channel = {0, 0, 0};
+    std::vector<listener_t> fleet(1);
+    TEST_ASSERT_EQUAL_UINT32(1, runFleet(encodeAll(month, monthId), &channel, &fleet));
+    TEST_ASSERT_EQUAL_MEMORY(month.data(), fleet[0].assembler.body, month.size());
+    TEST_ASSERT_EQUAL_UINT16(month.size(), fleet[0].assembler.length);
+    TEST_ASSERT_EQUAL_UINT32(1, fleet[0].assembler.bodies);
+}
+
+void test_lossy_channel_fleet() {
+    const std::vector<std::vector<uint8_t>> fragments = encodeAll(month, monthId);
+    const channel_t channels[] = {
+        {10, 5, 2},
+        {30, 10, 5},
+        {50, 10, 10},
+    };
+
+    for (const channel_t &channel: channels) {
+        // Every listener hears the same advertisements, the fleet size only adds draws of the same rounds
+        std::vector<listener_t> fleet(FLEET_SIZE);
+        generator.seed(channel.lossPercent);
+        const uint32_t slowest = runFleet(fragments, &channel, &fleet);
+
+        uint32_t corrupted = 0;
+        uint32_t duplicates = 0;
+        uint32_t totalRounds = 0;
+        for (const listener_t &listener: fleet) {
+            TEST_ASSERT_EQUAL_UINT16(month.size(), listener.assembler.length);
+            TEST_ASSERT_EQUAL_MEMORY(month.data(), listener.assembler.body, month.size());
+            TEST_ASSERT_EQUAL_UINT32(1, listener.assembler.bodies);
+            corrupted += listener.assembler.corrupted;
+            duplicates += listener.assembler.duplicates;
+            totalRounds += listener.rounds;
+        }
+        TEST_ASSERT_GREATER_THAN_UINT32(0, corrupted);
+        TEST_ASSERT_GREATER_THAN_UINT32(0, duplicates);
+
+        char report[128];
+        snprintf(report, sizeof(report), "loss %lu %%: %d listeners done in %.1f rounds on average, %lu at most",
+                 (unsigned long) channel.lossPercent, FLEET_SIZE, (double) totalRounds / FLEET_SIZE,
+                 (unsigned long) slowest);
+        TEST_MESSAGE(report);
+    }
+}
+
+void test_same_crc_with_a_new_sequence_is_a_new_body() {
+    svcBroadcastAssembler_t assembler;
+    svcBroadcastReset(&assembler);
+    TEST_ASSERT_EQUAL(SVC_BROADCAST_COMPLETE, feedAll(&assembler, encodeAll(month, monthId)));
+    // Repeated by the sender, nothing new
+    TEST_ASSERT_EQUAL(SVC_BROADCAST_DUPLICATE, feedAll(&assembler, encodeAll(month, monthId)));
+
+    // Timetable sent again, or another one sharing the CRC: the next sequence number makes it a new body
+    const svcBroadcastBodyId_t next = {(uint16_t) (monthId.sequence + 1), monthId.crc};
+    TEST_ASSERT_EQUAL(SVC_BROADCAST_COMPLETE, feedAll(&assembler, encodeAll(month, next)));
+    TEST_ASSERT_EQUAL_UINT32(2, assembler.bodies);
+    TEST_ASSERT_EQUAL_UINT16(next.sequence, assembler.completed.sequence);
+}
+
+void test_newer_body_replaces_a_partial_one() {
+    std::vector<uint8_t> nextMonth;
+    buildMonth(2, &nextMonth);
+    const svcBroadcastBodyId_t nextId = {(uint16_t) (monthId.sequence + 1),
+                                         svcBroadcastBodyCrc(nextMonth.data(), nextMonth.size())};
+    const std::vector<std::vector<uint8_t>> first = encodeAll(month, monthId);
+    const std::vector<std::vector<uint8_t>> second = encodeAll(nextMonth, nextId);
+
+    svcBroadcastAssembler_t assembler;
+    svcBroadcastReset(&assembler);
+    for (size_t i = 0; i < first.size() / 2; i++) {
+        TEST_ASSERT_EQUAL(SVC_BROADCAST_ADDED, svcBroadcastFeed(&assembler, first[i].data(), first[i].size()));
+    }
+    // The fragments of the first half are not mixed into the new body
+    TEST_ASSERT_EQUAL(SVC_BROADCAST_COMPLETE, feedAll(&assembler, second));
+    TEST_ASSERT_EQUAL_MEMORY(nextMonth.data(), assembler.body, nextMonth.size());
+    TEST_ASSERT_EQUAL_UINT16(nextId.crc, assembler.completed.crc);
+}
+
+void test_reused_sequence_fails_the_body_crc() {
+    // A sender giving another body the sequence number and CRC of the month
+    std::vector<uint8_t> other;
+    buildMonth(3, &other);
+    svcBroadcastAssembler_t assembler;
+    svcBroadcastReset(&assembler);
+    TEST_ASSERT_EQUAL(SVC_BROADCAST_CORRUPTED, feedAll(&assembler, encodeAll(other, monthId)));
+    TEST_ASSERT_FALSE(assembler.hasCompleted);
+
+    TEST_ASSERT_EQUAL(SVC_BROADCAST_COMPLETE, feedAll(&assembler, encodeAll(month, monthId)));
+}
+
+void test_foreign_advertisements_are_ignored() {
+    uint8_t fragment[SVC_BROADCAST_FRAGMENT_SIZE];
+    const size_t length = svcBroadcastEncode(month.data(), month.size(), monthId, 0, fragment);
+    svcBroadcastAssembler_t assembler;
+    svcBroadcastReset(&assembler);
+
+    // Another device on the test company id, an older format, another company
+    for (const size_t offset: {2, 3, 0}) {
+        uint8_t foreign[SVC_BROADCAST_FRAGMENT_SIZE];
+        memcpy(foreign, fragment, length);
+        foreign[offset] ^= 0x01;
+        TEST_ASSERT_EQUAL(SVC_BROADCAST_FOREIGN, svcBroadcastFeed(&assembler, foreign, length));
+    }
+    TEST_ASSERT_EQUAL(SVC_BROADCAST_FOREIGN, svcBroadcastFeed(&assembler, fragment, 3));
+    TEST_ASSERT_EQUAL_UINT32(0, assembler.corrupted + assembler.fragments + assembler.duplicates);
+}
+
+void test_listener_assembles_again_a_body_it_had_no_buffer_for() {
+    std::vector<uint8_t> months[3];
+    std::vector<std::vector<uint8_t>> fragments[3];
+    for (int i = 0; i < 3; i++) {
+        buildMonth(10 + i, &months[i]);
+        fragments[i] = encodeAll(months[i], {(uint16_t) (100 + i), svcBroadcastBodyCrc(months[i].data(),
+                                                                                      months[i].size())});
+    }
+
+    // The first two timetables take both buffers of the listener and stay held
+    advertiseAll(fragments[0]);
+    const PrayerTimetable *first = receiveTimetable();
+    advertiseAll(fragments[1]);
+    const PrayerTimetable *second = receiveTimetable();
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT_TRUE(first != second);
+
+    // The third one completes with nowhere to go
+    advertiseAll(fragments[2]);
+    TEST_ASSERT_NULL(receiveTimetable());
+
+    // Once the buffers are released, the next round of the same fragments delivers it
+    svcEventRelease(first);
+    svcEventRelease(second);
+    vTaskDelay(pdMS_TO_TICKS(2 * MOD_BROADCAST_FRAGMENT_PERIOD_MS));
+    advertiseAll(fragments[2]);
+    const PrayerTimetable *third = receiveTimetable();
+    TEST_ASSERT_NOT_NULL(third);
+    TEST_ASSERT_EQUAL_UINT8(MONTH_DAYS, third->numberOfDays);
+    // Fajr minute of the first day, from the seed of buildMonth()
+    TEST_ASSERT_EQUAL_UINT8((1 * 7 + 12) % 60, third->days[0].fajr.minute);
+    svcEventRelease(third);
+}
+
+/*=============================================================================
+                                Library Entry Point
+=============================================================================*/
+
+int main(int argc, char **argv) {
+    // The order of setup(), the listener of mod_broadcast on the mock transport
+    modCli0Init();
+    svcConfigInit();
+    svcLogInit();
+    svcLogSetLevel(SVC_LOG_LEVEL_ERROR);
+    svcPowerInit();
+    svcEventInit();
+    holder = svcEventSubscribe(SVC_EVENT_MASK(SVC_EVENT_TIMETABLE_UPDATED), HOLDER_QUEUE_SIZE);
+    if (holder == nullptr || !modBroadcastInit(mockBleTransport()) || !modBroadcastSetMode(MOD_BROADCAST_LISTEN)) {
+        return 1;
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(test_month_fits_the_fragments);
+    RUN_TEST(test_lossless_channel_completes_in_one_round);
+    RUN_TEST(test_lossy_channel_fleet);
+    RUN_TEST(test_same_crc_with_a_new_sequence_is_a_new_body);
+    RUN_TEST(test_newer_body_replaces_a_partial_one);
+    RUN_TEST(test_reused_sequence_fails_the_body_crc);
+    RUN_TEST(test_foreign_advertisements_are_ignored);
+    RUN_TEST(test_listener_assembles_again_a_body_it_had_no_buffer_for);
+    return UNITY_END();
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+void buildMonth(uint8_t seed, std::vector<uint8_t> *body) {
+    body->clear();
+    body->push_back(NUMBER_OF_DAYS_HEADER);
+    body->push_back(MONTH_DAYS);
+    for (uint8_t day = 1; day <= MONTH_DAYS; day++) {
+        uint8_t packet[SVC_PROTOCOL_PRAYER_TIMINGS_SIZE] = {PRAYER_TIMINGS_HEADER, day, 3, 20, 25};
+        for (int i = 0; i < SVC_PROTOCOL_PRAYER_COUNT; i++) {
+            packet[5 + i * 2] = (uint8_t) (5 + i * 3);
+            packet[6 + i * 2] = (uint8_t) ((day * 7 + i * 11 + seed) % 60);
+        }
+        body->insert(body->end(), packet, packet + sizeof(packet));
+    }
+    body->push_back(END_OF_TIMINGS_HEADER);
+}
+
+std::vector<std::vector<uint8_t>> encodeAll(const std::vector<uint8_t> &body, svcBroadcastBodyId_t id) {
+    std::vector<std::vector<uint8_t>> fragments;
+    const uint8_t count = svcBroadcastFragmentCount(body.size());
+    for (uint8_t index = 0; index < count; index++) {
+        uint8_t fragment[SVC_BROADCAST_FRAGMENT_SIZE];
+        const size_t length = svcBroadcastEncode(body.data(), body.size(), id, index, fragment);
+        fragments.emplace_back(fragment, fragment + length);
+    }
+    return fragments;
+}
+
+uint32_t runFleet(const std::vector<std::vector<uint8_t>> &fragments, const channel_t *channel,
+                  std::vector<listener_t> *fleet) {
+    for (listener_t &listener: *fleet) {
+        svcBroadcastReset(&listener.assembler);
+        listener.rounds = 0;
+    }
+
+    std::uniform_int_distribution<uint32_t> percent(0, 99);
+    uint32_t slowest = 0;
+    for (uint32_t round = 1; round <= MAX_ROUNDS && slowest == 0; round++) {
+        for (const std::vector<uint8_t> &fragment: fragments) {
+            for (listener_t &listener: *fleet) {
+                if (percent(generator) < channel->lossPercent) {
+                    continue;
+                }
+                std::vector<uint8_t> received = fragment;
+                if (percent(generator) < channel->corruptPercent) {
+                    received[percent(generator) % received.size()] ^= (uint8_t) (1 << percent(generator) % 8);
+                }
+                const int copies = percent(generator) < channel->duplicatePercent ? 2 : 1;
+                for (int copy = 0; copy < copies; copy++) {
+                    const svcBroadcastStatus_t status = svcBroadcastFeed(&listener.assembler, received.data(),
+                                                                         received.size());
+                    if (status == SVC_BROADCAST_COMPLETE) {
+                        listener.rounds = round;
+                    }
+                }
+            }
+        }
+
+        slowest = round;
+        for (const listener_t &listener: *fleet) {
+            if (listener.rounds == 0) {
+                slowest = 0;
+            }
+        }
+    }
+    TEST_ASSERT_TRUE_MESSAGE(slowest > 0, "a listener never completed the body");
+    return slowest;
+}
+
+svcBroadcastStatus_t feedAll(svcBroadcastAssembler_t *assembler, const std::vector<std::vector<uint8_t>> &fragments) {
+    svcBroadcastStatus_t status = SVC_BROADCAST_STATUS_COUNT;
+    for (const std::vector<uint8_t> &fragment: fragments) {
+        status = svcBroadcastFeed(assembler, fragment.data(), fragment.size());
+    }
+    return status;
+}
+
+void advertiseAll(const std::vector<std::vector<uint8_t>> &fragments) {
+    for (const std::vector<uint8_t> &fragment: fragments) {
+        mockBleTransport()->advertise(fragment.data(), fragment.size());
+    }
+}
+
+const PrayerTimetable *receiveTimetable() {
+    svcEvent_t event;
+    if (xQueueReceive(holder, &event, 0) != pdTRUE) {
+        return nullptr;
+    }
+    return (const PrayerTimetable *) event.data.buffer;
+}
@@ -0,0 +1,322 @@
+/*===========================================================================*/
+/// \file test_main.cpp
+///
+/// \brief
+///    CLI sessions over a pty, with the test as the terminal on the slave side
+///
+/// \details
+///     The sessions are first driven directly over an FdCliTransport: line editing, escape sequences, a client that
+///     stops reading and one that goes away. The CLI task then serves the pty of modCli0Init() like it does on a
+///     host build. The pty moves the bytes from one side to the other asynchronously, the helpers wait for them.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+#include <fcntl.h>
+#include <mod_cli0.h>
+#include <string.h>
+#include <string>
+#include <svc_cli_session.h>
+#include <svc_cli_transport_fd.h>
+#include <svc_config.h>
+#include <unistd.h>
+#include <unity.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+// Real time given to the pty to move the bytes across
+#define PTY_WAIT_MS 500
+#define PTY_WAIT_STEP_MS 5
+// Output ring of the sessions driven directly, small enough to fill
+#define PTY_OUTPUT_SIZE 256
+// Written to a client that never reads, far more than the pty buffers
+#define FLOOD_SIZE (1024 * 1024)
+// Virtual time given to the CLI task to serve the pty
+#define CLI_TASK_PERIOD_MS 20
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static int attachClient(const char *path);
+
+static void type(int descriptor, const char *text);
+
+static std::string receive(int descriptor, const char *expected);
+
+static svcCliSessionStatus_t waitStatus(svcCliSession_t *session, svcCliSessionStatus_t expected);
+
+static std::string serve(const char *expected);
+
+static std::string runCommand(const char *line);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static FdCliTransport transport;
+static svcCliSession_t session;
+static uint8_t output[PTY_OUTPUT_SIZE];
+static int client = -1;
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const char PROMPT[] = "\r\n> ";
+
+/*=============================================================================
+                                      Tests
+=============================================================================*/
+
+void setUp() {
+    // A fresh pty per test, nobody attached yet
+    TEST_ASSERT_TRUE(transport.openPty());
+    svcCliSessionInit(&session, &transport, output, sizeof(output), true);
+    client = -1;
+}
+
+void tearDown() {
+    if (client >= 0) {
+        close(client);
+    }
+}
+
+void test_nothing_happens_without_a_client() {
+    TEST_ASSERT_FALSE(transport.isConnected());
+    TEST_ASSERT_EQUAL(SVC_CLI_SESSION_IDLE, svcCliSessionPoll(&session));
+    TEST_ASSERT_EQUAL_size_t(0, svcCliSessionWrite(&session, (const uint8_t *) "lost", 4));
+
+    client = attachClient(transport.slaveName());
+    TEST_ASSERT_EQUAL(SVC_CLI_SESSION_ATTACHED, svcCliSessionPoll(&session));
+    TEST_ASSERT_EQUAL(SVC_CLI_SESSION_IDLE, svcCliSessionPoll(&session));
+}
+
+void test_lines_are_edited_and_echoed() {
+    client = attachClient(transport.slaveName());
+    TEST_ASSERT_EQUAL(SVC_CLI_SESSION_ATTACHED, svcCliSessionPoll(&session));
+
+    // Backspace on an empty line does nothing, BS and DEL both erase
+    type(client, "\becho\x7fp\bo hi\x7f\x7fyo\r");
+    TEST_ASSERT_EQUAL(SVC_CLI_SESSION_LINE, waitStatus(&session, SVC_CLI_SESSION_LINE));
+    TEST_ASSERT_EQUAL_STRING("echo yo", session.line);
+    svcCliSessionPump(&session);
+    TEST_ASSERT_EQUAL_STRING("echo\b \bp\b \bo hi\b \b\b \byo", receive(client, "yo").c_str());
+
+    // CR LF is one end of line, a lone LF is another
+    svcCliSessionLineDone(&session);
+    type(client, "\nlf\n");
+    TEST_ASSERT_EQUAL(SVC_CLI_SESSION_LINE, waitStatus(&session, SVC_CLI_SESSION_LINE));
+    TEST_ASSERT_EQUAL_STRING("lf", session.line);
+    TEST_ASSERT_EQUAL_UINT32(2, session.lines);
+}
+
+void test_escape_sequences_are_skipped() {
+    client = attachClient(transport.slaveName());
+    TEST_ASSERT_EQUAL(SVC_CLI_SESSION_ATTACHED, svcCliSessionPoll(&session));
+
+    // Arrows, Ctrl+Right with its parameters and a two byte ESC 7 never reach the line nor the echo
+    type(client, "ls\x1b[A\x1b[D\x1b[1;5C -l\x1b" "7a\r");
+    TEST_ASSERT_EQUAL(SVC_CLI_SESSION_LINE, waitStatus(&session, SVC_CLI_SESSION_LINE));
+    TEST_ASSERT_EQUAL_STRING("ls -la", session.line);
+    svcCliSessionPump(&session);
+    TEST_ASSERT_EQUAL_STRING("ls -la", receive(client, "la").c_str());
+}
+
+void test_long_line_is_discarded() {
+    client = attachClient(transport.slaveName());
+    TEST_ASSERT_EQUAL(SVC_CLI_SESSION_ATTACHED, svcCliSessionPoll(&session));
+    session.echo = false;
+
+    const std::string tooLong(SVC_CLI_SESSION_LINE_SIZE + 10, 'x');
+    type(client, (tooLong + "\r").c_str());
+    TEST_ASSERT_EQUAL(SVC_CLI_SESSION_LINE, waitStatus(&session, SVC_CLI_SESSION_LINE));
+    TEST_ASSERT_EQUAL_STRING("", session.line);
+    svcCliSessionPump(&session);
+    TEST_ASSERT_NOT_NULL(strstr(receive(client, "discarded").c_str(), "Line too long"));
+}
+
+void test_client_that_stops_reading_loses_its_output() {
+    client = attachClient(transport.slaveName());
+    TEST_ASSERT_EQUAL(SVC_CLI_SESSION_ATTACHED, svcCliSessionPoll(&session));
+
+    // Neither the session nor the transport wait: the pty fills up, then the ring, then the output is dropped
+    uint8_t chunk[PTY_OUTPUT_SIZE];
+    for (size_t i = 0; i < sizeof(chunk); i++) {
+        chunk[i] = 'a' + i % 26;
+    }
+    for (size_t sent = 0; sent < FLOOD_SIZE; sent += sizeof(chunk)) {
+        svcCliSessionWrite(&session, chunk, sizeof(chunk));
+        svcCliSessionPump(&session);
+    }
+    TEST_ASSERT_GREATER_THAN_UINT32(0, session.dropped);
+    TEST_ASSERT_EQUAL_UINT32(FLOOD_SIZE, session.bytesOut + session.outputCount + session.dropped);
+
+    // Once the client reads again, everything kept reaches it
+    size_t received = 0;
+    for (int i = 0; i < PTY_WAIT_MS / PTY_WAIT_STEP_MS && !(svcCliSessionPump(&session) && received == session.bytesOut);
+         i++) {
+        uint8_t data[4096];
+        const ssize_t count = read(client, data, sizeof(data));
+        if (count > 0) {
+            received += count;
+        } else {
+            usleep(PTY_WAIT_STEP_MS * 1000);
+        }
+    }
+    TEST_ASSERT_EQUAL_size_t(0, session.outputCount);
+    TEST_ASSERT_EQUAL_size_t(session.bytesOut, received);
+}
+
+void test_disconnect_drops_the_line_and_the_output() {
+    client = attachClient(transport.slaveName());
+    TEST_ASSERT_EQUAL(SVC_CLI_SESSION_ATTACHED, svcCliSessionPoll(&session));
+    session.echo = false;
+
+    // Half a line typed and output the client never read
+    type(client, "reb");
+    waitStatus(&session, SVC_CLI_SESSION_LINE);
+    TEST_ASSERT_EQUAL_size_t(3, session.lineLength);
+    svcCliSessionWrite(&session, (const uint8_t *) "pending", 7);
+    close(client);
+    client = -1;
+
+    TEST_ASSERT_EQUAL(SVC_CLI_SESSION_IDLE, svcCliSessionPoll(&session));
+    TEST_ASSERT_FALSE(session.connected);
+    TEST_ASSERT_EQUAL_size_t(0, session.lineLength);
+    TEST_ASSERT_EQUAL_size_t(0, session.outputCount);
+    TEST_ASSERT_EQUAL_size_t(0, svcCliSessionWrite(&session, (const uint8_t *) "lost", 4));
+
+    // The next client starts afresh
+    client = attachClient(transport.slaveName());
+    TEST_ASSERT_EQUAL(SVC_CLI_SESSION_ATTACHED, svcCliSessionPoll(&session));
+    type(client, "oot\r");
+    TEST_ASSERT_EQUAL(SVC_CLI_SESSION_LINE, waitStatus(&session, SVC_CLI_SESSION_LINE));
+    TEST_ASSERT_EQUAL_STRING("oot", session.line);
+}
+
+void test_cli_task_serves_the_pty() {
+    TEST_ASSERT_TRUE(strlen(modCli0PtyName()) > 0);
+    client = attachClient(modCli0PtyName());
+    TEST_ASSERT_TRUE(serve(PROMPT) == PROMPT);
+
+    // Echoed as typed, then the output of the command and the next prompt
+    const std::string echo = runCommand("echo over the pty");
+    TEST_ASSERT_NOT_NULL(strstr(echo.c_str(), "echo over the pty\r\nover the pty"));
+
+    const std::string sessions = runCommand("sessions");
+    TEST_ASSERT_NOT_NULL(strstr(sessions.c_str(), "* pty  attached"));
+
+    // Detached once the task has the half line, which is forgotten, the next client gets its own prompt
+    type(client, "echo");
+    TEST_ASSERT_TRUE(serve("echo") == "echo");
+    close(client);
+    vTaskDelay(pdMS_TO_TICKS(CLI_TASK_PERIOD_MS));
+    client = attachClient(modCli0PtyName());
+    TEST_ASSERT_TRUE(serve(PROMPT) == PROMPT);
+    // Had the line been kept, " again" would complete "echo"
+    TEST_ASSERT_TRUE(runCommand(" again") == std::string(" again") + PROMPT);
+}
+
+/*=============================================================================
+                                Library Entry Point
+=============================================================================*/
+
+int main(int argc, char **argv) {
+    // The order of setup(), only the CLI task runs
+    modCli0Init();
+    svcConfigInit();
+    xTaskCreate(modCli0EntryPoint, "modCli0Task", 4096, nullptr, 1, nullptr);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_nothing_happens_without_a_client);
+    RUN_TEST(test_lines_are_edited_and_echoed);
+    RUN_TEST(test_escape_sequences_are_skipped);
+    RUN_TEST(test_long_line_is_discarded);
+    RUN_TEST(test_client_that_stops_reading_loses_its_output);
+    RUN_TEST(test_disconnect_drops_the_line_and_the_output);
+    RUN_TEST(test_cli_task_serves_the_pty);
+    return UNITY_END();
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+int attachClient(const char *path) {
+    const int descriptor = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    TEST_ASSERT_TRUE_MESSAGE(descriptor >= 0, path);
+    return descriptor;
+}
+
+void type(int descriptor, const char *text) {
+    TEST_ASSERT_EQUAL_INT((int) strlen(text), (int) write(descriptor, text, strlen(text)));
+}
+
+std::string receive(int descriptor, const char *expected) {
+    // Everything that arrives until the text ends with the expected bytes
+    std::string text;
+    for (int i = 0; i < PTY_WAIT_MS / PTY_WAIT_STEP_MS; i++) {
+        char data[256];
+        const ssize_t count = read(descriptor, data, sizeof(data));
+        if (count > 0) {
+            text.append(data, count);
+            if (text.size() >= strlen(expected) && text.compare(text.size() - strlen(expected), std::string::npos,
+                                                                expected) == 0) {
+                break;
+            }
+        } else {
+            usleep(PTY_WAIT_STEP_MS * 1000);
+        }
+    }
+    return text;
+}
+
+svcCliSessionStatus_t waitStatus(svcCliSession_t *session, svcCliSessionStatus_t expected) {
+    svcCliSessionStatus_t status = SVC_CLI_SESSION_IDLE;
+    for (int i = 0; i < PTY_WAIT_MS / PTY_WAIT_STEP_MS; i++) {
+        status = svcCliSessionPoll(session);
+        if (status == expected) {
+            break;
+        }
+        usleep(PTY_WAIT_STEP_MS * 1000);
+    }
+    return status;
+}
+
+std::string serve(const char *expected) {
+    // The CLI task only runs while the test waits on the virtual clock
+    std::string text;
+    for (int i = 0; i < PTY_WAIT_MS / PTY_WAIT_STEP_MS; i++) {
+        vTaskDelay(pdMS_TO_TICKS(CLI_TASK_PERIOD_MS));
+        char data[256];
+        const ssize_t count = read(client, data, sizeof(data));
+        if (count > 0) {
+            text.append(data, count);
+        } else {
+            usleep(PTY_WAIT_STEP_MS * 1000);
+        }
+        if (text.size() >= strlen(expected) &&
+            text.compare(text.size() - strlen(expected), std::string::npos, expected) == 0) {
+            break;
+        }
+    }
+    return text;
+}
+
+std::string runCommand(const char *line) {
+    type(client, line);
+    type(client, "\r");
+    // The echo of the line, the output and the next prompt
+    const std::string text = serve(PROMPT);
+    return text.size() > strlen(line) + strlen(PROMPT) ? text : text + serve(PROMPT);
+}
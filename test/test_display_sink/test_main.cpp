@@ -0,0 +1,257 @@
+/*===========================================================================*/
+/// \file test_main.cpp
+///
+/// \brief
+///    Frame flushes to several emulated panels
+///
+/// \details
+///     Two SSD1306 behind the I2C mock check what reaches the graphic RAM of each panel, sinks kept in memory check
+///     the chunking, a sink that cannot take any byte and the pages each sink gets again after a failure.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Wire.h>
+#include <mock.h>
+#include <string.h>
+#include <svc_display_sink.h>
+#include <svc_display_ssd1306.h>
+#include <unity.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SECOND_PANEL 0x3D
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+/// Panel in memory, records every chunk
+class MemorySink : public DisplaySink {
+public:
+    explicit MemorySink(size_t chunk) : chunk(chunk) {
+        memset(gddram, 0, sizeof(gddram));
+    }
+
+    bool begin() override {
+        return true;
+    }
+
+    bool writeChunk(uint8_t page, uint8_t column, const uint8_t *data, size_t length) override {
+        chunks++;
+        largestChunk = length > largestChunk ? length : largestChunk;
+        if (length == 0 || length > chunk || column + length > SVC_DISPLAY_WIDTH || page >= SVC_DISPLAY_PAGES) {
+            misuses++;
+            return false;
+        }
+        if (failPage == page) {
+            return false;
+        }
+        pageWrites[page]++;
+        memcpy(&gddram[page * SVC_DISPLAY_WIDTH + column], data, length);
+        return true;
+    }
+
+    size_t chunkSize() const override {
+        return chunk;
+    }
+
+    size_t chunk;
+    int failPage = -1;
+    uint32_t chunks = 0;
+    uint32_t misuses = 0;
+    size_t largestChunk = 0;
+    uint32_t pageWrites[SVC_DISPLAY_PAGES] = {};
+    uint8_t gddram[SVC_DISPLAY_FRAME_SIZE];
+};
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static void drawFrame(uint8_t seed);
+
+static uint32_t totalPageWrites(const MemorySink *sink);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static uint8_t frame[SVC_DISPLAY_FRAME_SIZE];
+static uint8_t previous[SVC_DISPLAY_FRAME_SIZE];
+static svcDisplayFlushStats_t stats;
+
+/*=============================================================================
+                                      Tests
+=============================================================================*/
+
+void setUp() {
+    memset(previous, 0, sizeof(previous));
+    memset(&stats, 0, sizeof(stats));
+    drawFrame(1);
+}
+
+void tearDown() {
+}
+
+void test_two_i2c_panels_receive_the_frame() {
+    Wire.begin();
+    mockI2cSetPresent(SECOND_PANEL, true);
+    Ssd1306I2cSink first(&Wire, MOCK_I2C_DEFAULT_PANEL);
+    Ssd1306I2cSink second(&Wire, SECOND_PANEL);
+    TEST_ASSERT_TRUE(first.begin());
+    TEST_ASSERT_TRUE(second.begin());
+    DisplaySink *sinks[] = {&first, &second};
+
+    TEST_ASSERT_TRUE(svcDisplaySinkFlush(sinks, 2, frame, previous, &stats));
+    TEST_ASSERT_EQUAL_MEMORY(frame, mockSsd1306Gddram(MOCK_I2C_DEFAULT_PANEL), SVC_DISPLAY_FRAME_SIZE);
+    TEST_ASSERT_EQUAL_MEMORY(frame, mockSsd1306Gddram(SECOND_PANEL), SVC_DISPLAY_FRAME_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(SVC_DISPLAY_PAGES, stats.pagesSent);
+
+    // The second panel drops off the bus while one page changes
+    const size_t firstBytes = mockSsd1306DataBytes(MOCK_I2C_DEFAULT_PANEL);
+    frame[3 * SVC_DISPLAY_WIDTH + 5] ^= 0xFF;
+    mockI2cSetPresent(SECOND_PANEL, false);
+    TEST_ASSERT_FALSE(svcDisplaySinkFlush(sinks, 2, frame, previous, &stats));
+    TEST_ASSERT_EQUAL_MEMORY(frame, mockSsd1306Gddram(MOCK_I2C_DEFAULT_PANEL), SVC_DISPLAY_FRAME_SIZE);
+    TEST_ASSERT_EQUAL_size_t(firstBytes + SVC_DISPLAY_WIDTH, mockSsd1306DataBytes(MOCK_I2C_DEFAULT_PANEL));
+    TEST_ASSERT_EQUAL_UINT8(1 << 3, second.stalePages);
+
+    // Powered again with a blank RAM, like after svcDisplayAddSink() it gets every page, the first panel none
+    mockI2cSetPresent(SECOND_PANEL, true);
+    TEST_ASSERT_TRUE(second.begin());
+    second.stalePages = 0xFF;
+    TEST_ASSERT_TRUE(svcDisplaySinkFlush(sinks, 2, frame, previous, &stats));
+    TEST_ASSERT_EQUAL_MEMORY(frame, mockSsd1306Gddram(SECOND_PANEL), SVC_DISPLAY_FRAME_SIZE);
+    TEST_ASSERT_EQUAL_size_t(firstBytes + SVC_DISPLAY_WIDTH, mockSsd1306DataBytes(MOCK_I2C_DEFAULT_PANEL));
+    TEST_ASSERT_EQUAL_UINT8(0, second.stalePages);
+}
+
+void test_unchanged_pages_are_skipped() {
+    MemorySink sink(64);
+    DisplaySink *sinks[] = {&sink};
+    TEST_ASSERT_TRUE(svcDisplaySinkFlush(sinks, 1, frame, previous, &stats));
+    TEST_ASSERT_EQUAL_UINT32(SVC_DISPLAY_PAGES, totalPageWrites(&sink) / 2);
+
+    frame[0] ^= 0x01;
+    frame[7 * SVC_DISPLAY_WIDTH + 127] ^= 0x80;
+    TEST_ASSERT_TRUE(svcDisplaySinkFlush(sinks, 1, frame, previous, &stats));
+    TEST_ASSERT_EQUAL_UINT32(SVC_DISPLAY_PAGES + 2, stats.pagesSent);
+    TEST_ASSERT_EQUAL_UINT32(SVC_DISPLAY_PAGES - 2, stats.pagesSkipped);
+    TEST_ASSERT_EQUAL_MEMORY(frame, sink.gddram, SVC_DISPLAY_FRAME_SIZE);
+    TEST_ASSERT_EQUAL_MEMORY(frame, previous, SVC_DISPLAY_FRAME_SIZE);
+}
+
+void test_chunks_fit_every_sink() {
+    MemorySink wide(SVC_DISPLAY_WIDTH);
+    MemorySink narrow(48);
+    DisplaySink *sinks[] = {&wide, &narrow};
+    TEST_ASSERT_TRUE(svcDisplaySinkFlush(sinks, 2, frame, nullptr, &stats));
+
+    // 48 + 48 + 32 bytes per page, the same for both so they interleave
+    TEST_ASSERT_EQUAL_UINT32(0, wide.misuses + narrow.misuses);
+    TEST_ASSERT_EQUAL_size_t(48, wide.largestChunk);
+    TEST_ASSERT_EQUAL_UINT32(3 * SVC_DISPLAY_PAGES, narrow.chunks);
+    TEST_ASSERT_EQUAL_MEMORY(frame, wide.gddram, SVC_DISPLAY_FRAME_SIZE);
+    TEST_ASSERT_EQUAL_MEMORY(frame, narrow.gddram, SVC_DISPLAY_FRAME_SIZE);
+}
+
+void test_sink_without_chunk_size_does_not_stall_the_others() {
+    MemorySink broken(0);
+    MemorySink working(64);
+    DisplaySink *sinks[] = {&broken, &working};
+    TEST_ASSERT_FALSE(svcDisplaySinkFlush(sinks, 2, frame, previous, &stats));
+
+    TEST_ASSERT_EQUAL_UINT32(0, broken.chunks);
+    TEST_ASSERT_EQUAL_UINT8(0xFF, broken.stalePages);
+    TEST_ASSERT_EQUAL_UINT32(SVC_DISPLAY_PAGES, stats.errors);
+    TEST_ASSERT_EQUAL_MEMORY(frame, working.gddram, SVC_DISPLAY_FRAME_SIZE);
+    TEST_ASSERT_EQUAL_UINT8(0, working.stalePages);
+}
+
+void test_failed_page_is_resent_to_its_sink_only() {
+    MemorySink healthy(64);
+    MemorySink flaky(64);
+    DisplaySink *sinks[] = {&healthy, &flaky};
+    TEST_ASSERT_TRUE(svcDisplaySinkFlush(sinks, 2, frame, previous, &stats));
+
+    drawFrame(2);
+    flaky.failPage = 4;
+    TEST_ASSERT_FALSE(svcDisplaySinkFlush(sinks, 2, frame, previous, &stats));
+    TEST_ASSERT_EQUAL_UINT8(1 << 4, flaky.stalePages);
+    TEST_ASSERT_EQUAL_UINT8(0, healthy.stalePages);
+
+    // Same frame again: only the page the flaky sink missed is sent, and only to it
+    flaky.failPage = -1;
+    const uint32_t healthyWrites = totalPageWrites(&healthy);
+    const uint32_t flakyPage4 = flaky.pageWrites[4];
+    TEST_ASSERT_TRUE(svcDisplaySinkFlush(sinks, 2, frame, previous, &stats));
+    TEST_ASSERT_EQUAL_UINT32(healthyWrites, totalPageWrites(&healthy));
+    TEST_ASSERT_EQUAL_UINT32(flakyPage4 + 2, flaky.pageWrites[4]);
+    TEST_ASSERT_EQUAL_UINT8(0, flaky.stalePages);
+    TEST_ASSERT_EQUAL_MEMORY(frame, flaky.gddram, SVC_DISPLAY_FRAME_SIZE);
+}
+
+void test_sink_added_later_gets_every_page() {
+    MemorySink first(64);
+    DisplaySink *sinks[] = {&first, nullptr};
+    TEST_ASSERT_TRUE(svcDisplaySinkFlush(sinks, 1, frame, previous, &stats));
+
+    MemorySink late(64);
+    sinks[1] = &late;
+    TEST_ASSERT_TRUE(svcDisplaySinkFlush(sinks, 2, frame, previous, &stats));
+    TEST_ASSERT_EQUAL_MEMORY(frame, late.gddram, SVC_DISPLAY_FRAME_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(SVC_DISPLAY_PAGES, totalPageWrites(&first) / 2);
+}
+
+void test_too_many_sinks_are_refused() {
+    MemorySink sink(64);
+    DisplaySink *sinks[SVC_DISPLAY_MAX_SINKS + 1];
+    for (size_t i = 0; i < SVC_DISPLAY_MAX_SINKS + 1; i++) {
+        sinks[i] = &sink;
+    }
+    TEST_ASSERT_FALSE(svcDisplaySinkFlush(sinks, SVC_DISPLAY_MAX_SINKS + 1, frame, previous, &stats));
+    TEST_ASSERT_EQUAL_UINT32(0, sink.chunks);
+}
+
+/*=============================================================================
+                                Library Entry Point
+=============================================================================*/
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_two_i2c_panels_receive_the_frame);
+    RUN_TEST(test_unchanged_pages_are_skipped);
+    RUN_TEST(test_chunks_fit_every_sink);
+    RUN_TEST(test_sink_without_chunk_size_does_not_stall_the_others);
+    RUN_TEST(test_failed_page_is_resent_to_its_sink_only);
+    RUN_TEST(test_sink_added_later_gets_every_page);
+    RUN_TEST(test_too_many_sinks_are_refused);
+    return UNITY_END();
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+void drawFrame(uint8_t seed) {
+    for (size_t i = 0; i < sizeof(frame); i++) {
+        frame[i] = (uint8_t) (i * 31 + seed * 17 + (i >> 7));
+    }
+}
+
+uint32_t totalPageWrites(const MemorySink *sink) {
+    uint32_t total = 0;
+    for (int page = 0; page < SVC_DISPLAY_PAGES; page++) {
+        total += sink->pageWrites[page];
+    }
+    return total;
+}
@@ -0,0 +1,208 @@
+/*===========================================================================*/
+/// \file test_main.cpp
+///
+/// \brief
+///    Glyph runs decoded back to their bitmaps
+///
+/// \details
+///     The runs below were written by encode() of scripts/gen_glyph_atlas.py for the bitmaps of the tests, the decoder
+///     has to give back every set pixel once: runs ending on a row end, runs of 255 and longer carried over several
+///     bytes, a glyph whose last clear run is left out and a blank one.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <string.h>
+#include <svc_glyph.h>
+#include <unity.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define MAX_WIDTH 32
+#define MAX_HEIGHT 20
+#define MAX_SPANS 32
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    int16_t x;
+    int16_t y;
+    int16_t length;
+} span_t;
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static void recordSpan(int16_t x, int16_t y, int16_t length, void *context);
+
+static void decode(const svcGlyphEntry_t *entry, int16_t x, int16_t y);
+
+static void assertCanvas(const svcGlyphEntry_t *entry, const char *const *rows);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static char canvas[MAX_HEIGHT][MAX_WIDTH + 1];
+static span_t spans[MAX_SPANS];
+static size_t spanCount;
+static const svcGlyphEntry_t *drawn;
+static int16_t originX;
+static int16_t originY;
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+// python scripts/gen_glyph_atlas.py encode() of the bitmaps below
+static const svcGlyphEntry_t ROW_END = {8, 3, 0, 4};
+static const svcGlyphEntry_t CONTINUE = {32, 20, 4, 6};
+static const svcGlyphEntry_t TRAILING_CLEAR = {5, 2, 10, 2};
+static const svcGlyphEntry_t BLANK = {4, 2, 12, 0};
+static const uint8_t DATA[] = {0x04, 0x08, 0x04, 0x08, 0xff, 0x2d, 0xff, 0x00, 0x01, 0x54, 0x01, 0x01};
+
+static const char *const ROW_END_ROWS[] = {
+    "....####",
+    "####....",
+    "########",
+};
+
+// 300 clear (255, 45), exactly 255 set (255, 0), 1 clear and 84 set up to the last pixel
+static const char *const CONTINUE_ROWS[] = {
+    "................................",
+    "................................",
+    "................................",
+    "................................",
+    "................................",
+    "................................",
+    "................................",
+    "................................",
+    "................................",
+    "............####################",
+    "################################",
+    "################################",
+    "################################",
+    "################################",
+    "################################",
+    "################################",
+    "################################",
+    "###########.####################",
+    "################################",
+    "################################",
+};
+
+static const char *const TRAILING_CLEAR_ROWS[] = {
+    ".#...",
+    ".....",
+};
+
+static const char *const BLANK_ROWS[] = {
+    "....",
+    "....",
+};
+
+/*=============================================================================
+                                      Tests
+=============================================================================*/
+
+void setUp() {
+    memset(canvas, 0, sizeof(canvas));
+    memset(spans, 0, sizeof(spans));
+    spanCount = 0;
+}
+
+void tearDown() {
+}
+
+void test_run_ending_on_a_row_end_is_split_there() {
+    decode(&ROW_END, 10, 20);
+    assertCanvas(&ROW_END, ROW_END_ROWS);
+
+    // The 8 set pixels from the middle of the first row end in the middle of the second
+    TEST_ASSERT_EQUAL_size_t(3, spanCount);
+    const int16_t expected[] = {14, 20, 4, 10, 21, 4, 10, 22, 8};
+    TEST_ASSERT_EQUAL_INT16_ARRAY(expected, (const int16_t *) spans, 9);
+}
+
+void test_runs_of_255_continue_with_the_next_byte() {
+    decode(&CONTINUE, 0, 0);
+    assertCanvas(&CONTINUE, CONTINUE_ROWS);
+
+    // One span per row from the tenth on, two on the row with the clear pixel
+    TEST_ASSERT_EQUAL_size_t(12, spanCount);
+    TEST_ASSERT_EQUAL_INT16(12, spans[0].x);
+    TEST_ASSERT_EQUAL_INT16(9, spans[0].y);
+    TEST_ASSERT_EQUAL_INT16(20, spans[0].length);
+    TEST_ASSERT_EQUAL_INT16(11, spans[8].length);
+    TEST_ASSERT_EQUAL_INT16(12, spans[9].x);
+    TEST_ASSERT_EQUAL_INT16(17, spans[9].y);
+}
+
+void test_last_clear_run_can_be_left_out() {
+    decode(&TRAILING_CLEAR, 0, 0);
+    assertCanvas(&TRAILING_CLEAR, TRAILING_CLEAR_ROWS);
+    TEST_ASSERT_EQUAL_size_t(1, spanCount);
+}
+
+void test_blank_glyph_has_no_runs() {
+    decode(&BLANK, 0, 0);
+    assertCanvas(&BLANK, BLANK_ROWS);
+    TEST_ASSERT_EQUAL_size_t(0, spanCount);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_run_ending_on_a_row_end_is_split_there);
+    RUN_TEST(test_runs_of_255_continue_with_the_next_byte);
+    RUN_TEST(test_last_clear_run_can_be_left_out);
+    RUN_TEST(test_blank_glyph_has_no_runs);
+    return UNITY_END();
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+void recordSpan(int16_t x, int16_t y, int16_t length, void *context) {
+    TEST_ASSERT_EQUAL_PTR(&spans, context);
+    TEST_ASSERT_TRUE(length > 0);
+    TEST_ASSERT_TRUE(spanCount < MAX_SPANS);
+    spans[spanCount++] = {x, y, length};
+
+    // Within the glyph and on pixels not drawn yet
+    const int16_t column = (int16_t) (x - originX);
+    const int16_t row = (int16_t) (y - originY);
+    TEST_ASSERT_TRUE(column >= 0 && column + length <= drawn->width);
+    TEST_ASSERT_TRUE(row >= 0 && row < drawn->height);
+    for (int16_t i = column; i < column + length; i++) {
+        TEST_ASSERT_EQUAL_CHAR('.', canvas[row][i]);
+        canvas[row][i] = '#';
+    }
+}
+
+void decode(const svcGlyphEntry_t *entry, int16_t x, int16_t y) {
+    for (uint8_t row = 0; row < entry->height; row++) {
+        memset(canvas[row], '.', entry->width);
+    }
+    drawn = entry;
+    originX = x;
+    originY = y;
+    svcGlyphDecode(entry, DATA, x, y, recordSpan, &spans);
+}
+
+void assertCanvas(const svcGlyphEntry_t *entry, const char *const *rows) {
+    for (uint8_t row = 0; row < entry->height; row++) {
+        TEST_ASSERT_EQUAL_STRING(rows[row], canvas[row]);
+    }
+}
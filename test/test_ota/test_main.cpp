@@ -0,0 +1,289 @@
+/*===========================================================================*/
+/// \file test_main.cpp
+///
+/// \brief
+///    Update session against a partition backed by a file
+///
+/// \details
+///     The file behaves like NOR flash: erased bytes read 0xFF and a write can only clear bits, so a chunk written
+///     to a sector the session forgot to erase shows up as a hash mismatch. The verifier accepts a single signature,
+///     the ECDSA check itself belongs to mbedTLS.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <mbedtls/sha256.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <svc_ota.h>
+#include <unity.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define TEST_PARTITION_SIZE (16 * SVC_OTA_SECTOR_SIZE)
+#define TEST_IMAGE_SIZE (5 * SVC_OTA_SECTOR_SIZE + 1234)
+// Chunk of a 247 byte MTU, does not divide the sector size
+#define TEST_CHUNK_SIZE 244
+
+/*=============================================================================
+                                Class Definitions
+=============================================================================*/
+
+/// NOR flash in a temporary file
+class FileOtaPartition : public OtaPartition {
+public:
+    FileOtaPartition() : file(tmpfile()) {
+        uint8_t sector[SVC_OTA_SECTOR_SIZE];
+        // Random content, like flash holding a previous image
+        for (size_t i = 0; i < sizeof(sector); i++) {
+            sector[i] = (uint8_t) rand();
+        }
+        for (uint32_t offset = 0; offset < TEST_PARTITION_SIZE; offset += sizeof(sector)) {
+            fwrite(sector, 1, sizeof(sector), file);
+        }
+    }
+
+    ~FileOtaPartition() override {
+        fclose(file);
+    }
+
+    uint32_t size() const override {
+        return TEST_PARTITION_SIZE;
+    }
+
+    bool erase(uint32_t offset, uint32_t length) override {
+        if (offset % SVC_OTA_SECTOR_SIZE != 0 || length % SVC_OTA_SECTOR_SIZE != 0 ||
+            offset + length > TEST_PARTITION_SIZE) {
+            return false;
+        }
+        erases += length / SVC_OTA_SECTOR_SIZE;
+        uint8_t erased[SVC_OTA_SECTOR_SIZE];
+        memset(erased, 0xFF, sizeof(erased));
+        fseek(file, offset, SEEK_SET);
+        for (uint32_t i = 0; i < length; i += sizeof(erased)) {
+            fwrite(erased, 1, sizeof(erased), file);
+        }
+        return true;
+    }
+
+    bool write(uint32_t offset, const uint8_t *data, size_t length) override {
+        if (failWrites || offset + length > TEST_PARTITION_SIZE) {
+            return false;
+        }
+        uint8_t stored[SVC_OTA_SECTOR_SIZE];
+        for (size_t done = 0; done < length; done += sizeof(stored)) {
+            const size_t part = length - done < sizeof(stored) ? length - done : sizeof(stored);
+            read(offset + done, stored, part);
+            for (size_t i = 0; i < part; i++) {
+                stored[i] &= data[done + i];
+            }
+            fseek(file, offset + done, SEEK_SET);
+            fwrite(stored, 1, part, file);
+        }
+        return true;
+    }
+
+    bool read(uint32_t offset, uint8_t *data, size_t length) override {
+        fseek(file, offset, SEEK_SET);
+        return fread(data, 1, length, file) == length;
+    }
+
+    /// \brief Clear bits behind the session, like a bad cell
+    void corrupt(uint32_t offset) {
+        uint8_t value;
+        read(offset, &value, 1);
+        value &= 0x0F;
+        fseek(file, offset, SEEK_SET);
+        fwrite(&value, 1, 1, file);
+    }
+
+    uint32_t erases = 0;
+    bool failWrites = false;
+
+private:
+    FILE *file;
+};
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static bool verifyRelease(const uint8_t *digest, const uint8_t *signature, size_t length);
+
+static svcOtaStatus_t beginImage(FileOtaPartition *partition, const uint8_t *signature);
+
+static svcOtaStatus_t sendChunks(uint32_t from, uint32_t to);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static uint8_t image[TEST_IMAGE_SIZE];
+static uint8_t digest[SVC_OTA_DIGEST_SIZE];
+static svcOtaSession_t session;
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+static const uint8_t releaseSignature[] = {0x30, 0x44, 0x02, 0x20, 0x5A, 0xA5};
+static const uint8_t otherSignature[] = {0x30, 0x44, 0x02, 0x20, 0x00, 0x00};
+
+/*=============================================================================
+                                      Tests
+=============================================================================*/
+
+void setUp() {
+    for (size_t i = 0; i < sizeof(image); i++) {
+        image[i] = (uint8_t) rand();
+    }
+    mbedtls_sha256_ret(image, sizeof(image), digest, 0);
+    memset(&session, 0, sizeof(session));
+}
+
+void tearDown() {
+}
+
+void test_image_is_written_and_verified() {
+    FileOtaPartition partition;
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, beginImage(&partition, releaseSignature));
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, sendChunks(0, TEST_IMAGE_SIZE));
+    // Each sector erased once, just before the first chunk reaching it
+    TEST_ASSERT_EQUAL_UINT32((TEST_IMAGE_SIZE + SVC_OTA_SECTOR_SIZE - 1) / SVC_OTA_SECTOR_SIZE, partition.erases);
+
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, svcOtaFinish(&session, verifyRelease));
+    TEST_ASSERT_TRUE(session.verified);
+
+    static uint8_t written[TEST_IMAGE_SIZE];
+    TEST_ASSERT_TRUE(partition.read(0, written, sizeof(written)));
+    TEST_ASSERT_EQUAL_MEMORY(image, written, sizeof(image));
+}
+
+void test_transfer_resumes_from_the_received_offset() {
+    FileOtaPartition partition;
+    const uint32_t dropped = 9 * TEST_CHUNK_SIZE;
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, beginImage(&partition, releaseSignature));
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, sendChunks(0, dropped));
+
+    // The connection dropped, the sender starts again with the same image
+    TEST_ASSERT_EQUAL(SVC_OTA_RESUMED, beginImage(&partition, releaseSignature));
+    TEST_ASSERT_EQUAL_UINT32(dropped, session.received);
+    TEST_ASSERT_EQUAL(SVC_OTA_WRONG_OFFSET, svcOtaWrite(&session, 0, image, TEST_CHUNK_SIZE));
+    TEST_ASSERT_EQUAL(SVC_OTA_WRONG_OFFSET,
+                      svcOtaWrite(&session, dropped + TEST_CHUNK_SIZE, &image[dropped + TEST_CHUNK_SIZE],
+                                  TEST_CHUNK_SIZE));
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, sendChunks(dropped, TEST_IMAGE_SIZE));
+
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, svcOtaFinish(&session, verifyRelease));
+}
+
+void test_another_image_starts_from_scratch() {
+    FileOtaPartition partition;
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, beginImage(&partition, releaseSignature));
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, sendChunks(0, 3 * TEST_CHUNK_SIZE));
+
+    image[0] ^= 0xFF;
+    mbedtls_sha256_ret(image, sizeof(image), digest, 0);
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, beginImage(&partition, releaseSignature));
+    TEST_ASSERT_EQUAL_UINT32(0, session.received);
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, sendChunks(0, TEST_IMAGE_SIZE));
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, svcOtaFinish(&session, verifyRelease));
+}
+
+void test_flash_content_differing_from_the_digest_is_refused() {
+    FileOtaPartition partition;
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, beginImage(&partition, releaseSignature));
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, sendChunks(0, TEST_IMAGE_SIZE));
+    partition.corrupt(TEST_IMAGE_SIZE / 2);
+
+    TEST_ASSERT_EQUAL(SVC_OTA_HASH_MISMATCH, svcOtaFinish(&session, verifyRelease));
+    TEST_ASSERT_FALSE(session.verified);
+    // The image has to be sent again from the start
+    TEST_ASSERT_EQUAL(SVC_OTA_NO_SESSION, svcOtaWrite(&session, 0, image, TEST_CHUNK_SIZE));
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, beginImage(&partition, releaseSignature));
+    TEST_ASSERT_EQUAL_UINT32(0, session.received);
+}
+
+void test_signature_not_made_by_the_release_key_is_refused() {
+    FileOtaPartition partition;
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, beginImage(&partition, otherSignature));
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, sendChunks(0, TEST_IMAGE_SIZE));
+
+    TEST_ASSERT_EQUAL(SVC_OTA_BAD_SIGNATURE, svcOtaFinish(&session, verifyRelease));
+    TEST_ASSERT_FALSE(session.verified);
+}
+
+void test_finish_before_the_last_chunk_keeps_the_session() {
+    FileOtaPartition partition;
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, beginImage(&partition, releaseSignature));
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, sendChunks(0, TEST_IMAGE_SIZE - 1));
+
+    TEST_ASSERT_EQUAL(SVC_OTA_INCOMPLETE, svcOtaFinish(&session, verifyRelease));
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, sendChunks(TEST_IMAGE_SIZE - 1, TEST_IMAGE_SIZE));
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, svcOtaFinish(&session, verifyRelease));
+}
+
+void test_invalid_sizes_and_flash_errors_are_reported() {
+    FileOtaPartition partition;
+    TEST_ASSERT_EQUAL(SVC_OTA_TOO_LARGE, svcOtaBegin(&session, &partition, TEST_PARTITION_SIZE + 1, digest,
+                                                     releaseSignature, sizeof(releaseSignature)));
+    TEST_ASSERT_EQUAL(SVC_OTA_BAD_PACKET, svcOtaBegin(&session, &partition, TEST_IMAGE_SIZE, digest,
+                                                      releaseSignature, 0));
+
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, beginImage(&partition, releaseSignature));
+    TEST_ASSERT_EQUAL(SVC_OTA_OK, sendChunks(0, TEST_IMAGE_SIZE - 10));
+    TEST_ASSERT_EQUAL(SVC_OTA_TOO_LARGE, svcOtaWrite(&session, session.received, image, 11));
+
+    partition.failWrites = true;
+    TEST_ASSERT_EQUAL(SVC_OTA_FLASH_ERROR, svcOtaWrite(&session, session.received, image, 10));
+    // Nothing counts as received, the chunk is sent again
+    TEST_ASSERT_EQUAL_UINT32(TEST_IMAGE_SIZE - 10, session.received);
+}
+
+/*=============================================================================
+                                Library Entry Point
+=============================================================================*/
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_image_is_written_and_verified);
+    RUN_TEST(test_transfer_resumes_from_the_received_offset);
+    RUN_TEST(test_another_image_starts_from_scratch);
+    RUN_TEST(test_flash_content_differing_from_the_digest_is_refused);
+    RUN_TEST(test_signature_not_made_by_the_release_key_is_refused);
+    RUN_TEST(test_finish_before_the_last_chunk_keeps_the_session);
+    RUN_TEST(test_invalid_sizes_and_flash_errors_are_reported);
+    return UNITY_END();
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+bool verifyRelease(const uint8_t *digest, const uint8_t *signature, size_t length) {
+    return length == sizeof(releaseSignature) && memcmp(signature, releaseSignature, length) == 0;
+}
+
+svcOtaStatus_t beginImage(FileOtaPartition *partition, const uint8_t *signature) {
+    return svcOtaBegin(&session, partition, TEST_IMAGE_SIZE, digest, signature, sizeof(releaseSignature));
+}
+
+svcOtaStatus_t sendChunks(uint32_t from, uint32_t to) {
+    for (uint32_t offset = from; offset < to; offset += TEST_CHUNK_SIZE) {
+        const size_t length = to - offset < TEST_CHUNK_SIZE ? to - offset : TEST_CHUNK_SIZE;
+        const svcOtaStatus_t status = svcOtaWrite(&session, offset, &image[offset], length);
+        if (status != SVC_OTA_OK) {
+            return status;
+        }
+    }
+    return SVC_OTA_OK;
+}
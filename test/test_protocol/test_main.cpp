@@ -0,0 +1,239 @@
+/*===========================================================================*/
+/// \file test_main.cpp
+///
+/// \brief
+///    Replay of packet captures through the decoder, with its throughput
+///
+/// \details
+///     A capture is BLE packets back to back, the body the Wi-Fi sync accepts and scripts/timetable_server.py serves.
+///     The built-in one is a year of monthly syncs with the time packets and exchanges the phone sends around them,
+///     and a few malformed packets; PROTOCOL_CAPTURE names a file to replay instead, such as a recorded sync or a
+///     fuzzer finding. The decode rate is measured on the host and printed, it only compares builds on the same
+///     machine, the bench command gives the figures of the device.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <svc_protocol.h>
+#include <unity.h>
+#include <vector>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define CAPTURE_YEAR 2025
+#define CAPTURE_MONTHS 12
+// Packets not decoding in the built-in capture: an unknown header, a short packet, a day 0 and an hour 24
+#define CAPTURE_MALFORMED 5
+// Replays timed for the rate, long enough for the clock resolution
+#define REPLAY_ROUNDS 200
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    uint32_t packets;
+    uint32_t statuses[SVC_PROTOCOL_STATUS_COUNT];
+    uint32_t headers[256]; // packets decoded, by header
+} replayStats_t;
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static void replay(const std::vector<uint8_t> &capture, replayStats_t *stats);
+
+static void buildCapture(std::vector<uint8_t> *capture);
+
+static bool readCapture(const char *path, std::vector<uint8_t> *capture);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static std::vector<uint8_t> capture;
+static bool builtIn = true;
+
+/*=============================================================================
+                                      Tests
+=============================================================================*/
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_capture_decodes() {
+    replayStats_t stats;
+    replay(capture, &stats);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, stats.packets);
+
+    char report[128];
+    snprintf(report, sizeof(report), "%lu packets, %lu ok, %lu unknown header, %lu too short, %lu out of range",
+             (unsigned long) stats.packets, (unsigned long) stats.statuses[SVC_PROTOCOL_OK],
+             (unsigned long) stats.statuses[SVC_PROTOCOL_UNKNOWN_HEADER],
+             (unsigned long) stats.statuses[SVC_PROTOCOL_TOO_SHORT],
+             (unsigned long) stats.statuses[SVC_PROTOCOL_OUT_OF_RANGE]);
+    TEST_MESSAGE(report);
+
+    if (!builtIn) {
+        return;
+    }
+    // 365 days, a sync and a time packet per month, a time exchange per day
+    TEST_ASSERT_EQUAL_UINT32(365, stats.headers[PRAYER_TIMINGS_HEADER]);
+    TEST_ASSERT_EQUAL_UINT32(CAPTURE_MONTHS, stats.headers[NUMBER_OF_DAYS_HEADER]);
+    TEST_ASSERT_EQUAL_UINT32(CAPTURE_MONTHS, stats.headers[END_OF_TIMINGS_HEADER]);
+    TEST_ASSERT_EQUAL_UINT32(CAPTURE_MONTHS, stats.headers[CURRENT_TIME_HEADER]);
+    TEST_ASSERT_EQUAL_UINT32(365, stats.headers[TIME_REQUEST_HEADER]);
+    TEST_ASSERT_EQUAL_UINT32(365, stats.headers[TIME_RESULT_HEADER]);
+    TEST_ASSERT_EQUAL_UINT32(CAPTURE_MALFORMED, stats.packets - stats.statuses[SVC_PROTOCOL_OK]);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.statuses[SVC_PROTOCOL_UNKNOWN_HEADER]);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.statuses[SVC_PROTOCOL_TOO_SHORT]);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.statuses[SVC_PROTOCOL_OUT_OF_RANGE]);
+}
+
+void test_decode_rate() {
+    replayStats_t stats;
+    const auto start = std::chrono::steady_clock::now();
+    uint32_t packets = 0;
+    for (int i = 0; i < REPLAY_ROUNDS; i++) {
+        replay(capture, &stats);
+        packets += stats.packets;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    TEST_ASSERT_TRUE(seconds > 0);
+
+    char report[96];
+    snprintf(report, sizeof(report), "bench,protocol_replay,%lu packets,%.0f packets/s,%.1f ns/packet",
+             (unsigned long) packets, packets / seconds, seconds * 1e9 / packets);
+    TEST_MESSAGE(report);
+}
+
+/*=============================================================================
+                                Library Entry Point
+=============================================================================*/
+
+int main(int argc, char **argv) {
+    const char *path = getenv("PROTOCOL_CAPTURE");
+    if (path != nullptr) {
+        builtIn = false;
+        if (!readCapture(path, &capture)) {
+            perror(path);
+            return 1;
+        }
+    } else {
+        buildCapture(&capture);
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(test_capture_decodes);
+    RUN_TEST(test_decode_rate);
+    return UNITY_END();
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+void replay(const std::vector<uint8_t> &capture, replayStats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    size_t offset = 0;
+    while (offset < capture.size()) {
+        const uint8_t header = capture[offset];
+        const size_t remaining = capture.size() - offset;
+        size_t size = svcProtocolPacketSize(header);
+        // Nothing tells where a packet of unknown type ends, the next byte is tried as a header
+        if (size == 0) {
+            size = 1;
+        } else if (size > remaining) {
+            size = remaining;
+        }
+
+        svcProtocolPacket_t packet;
+        const svcProtocolStatus_t status = svcProtocolDecode(&capture[offset], size, &packet);
+        stats->packets++;
+        stats->statuses[status]++;
+        if (status == SVC_PROTOCOL_OK) {
+            stats->headers[header]++;
+        }
+        offset += size;
+    }
+}
+
+void buildCapture(std::vector<uint8_t> *capture) {
+    static const uint8_t monthDays[CAPTURE_MONTHS] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    int64_t utcUs = 1735689600LL * 1000000; // 2025-01-01
+    uint8_t sequence = 0;
+
+    for (int month = 1; month <= CAPTURE_MONTHS; month++) {
+        const uint8_t currentTime[SVC_PROTOCOL_CURRENT_TIME_SIZE] = {
+            CURRENT_TIME_HEADER, 0, 5, 0, 1, (uint8_t) (month - 1), CAPTURE_YEAR / 100, CAPTURE_YEAR % 100
+        };
+        capture->insert(capture->end(), currentTime, currentTime + sizeof(currentTime));
+        capture->push_back(NUMBER_OF_DAYS_HEADER);
+        capture->push_back(monthDays[month - 1]);
+
+        for (int day = 1; day <= monthDays[month - 1]; day++) {
+            uint8_t timings[SVC_PROTOCOL_PRAYER_TIMINGS_SIZE] = {
+                PRAYER_TIMINGS_HEADER, (uint8_t) day, (uint8_t) month, CAPTURE_YEAR / 100, CAPTURE_YEAR % 100
+            };
+            for (int i = 0; i < SVC_PROTOCOL_PRAYER_COUNT; i++) {
+                timings[5 + i * 2] = (uint8_t) (5 + i * 3 + day % 2);
+                timings[6 + i * 2] = (uint8_t) ((day * 7 + i * 11) % 60);
+            }
+            capture->insert(capture->end(), timings, timings + sizeof(timings));
+
+            // A request and its result, as many times as the phone syncs its clock
+            for (uint8_t header: {TIME_REQUEST_HEADER, TIME_RESULT_HEADER}) {
+                capture->push_back(header);
+                capture->push_back(sequence);
+                for (int i = 0; i < 8; i++) {
+                    capture->push_back((uint8_t) (utcUs >> (i * 8)));
+                }
+                utcUs += 40000;
+            }
+            sequence++;
+            utcUs += 86400LL * 1000000;
+        }
+        capture->push_back(END_OF_TIMINGS_HEADER);
+    }
+
+    const uint8_t unknownHeader[] = {0x00};
+    const uint8_t dayZero[SVC_PROTOCOL_PRAYER_TIMINGS_SIZE] = {PRAYER_TIMINGS_HEADER, 0, 1, 20, 25};
+    const uint8_t monthZero[SVC_PROTOCOL_PRAYER_TIMINGS_SIZE] = {PRAYER_TIMINGS_HEADER, 1, 0, 20, 25};
+    const uint8_t hour24[SVC_PROTOCOL_CURRENT_TIME_SIZE] = {CURRENT_TIME_HEADER, 24, 0, 0, 1, 0, 20, 25};
+    const uint8_t shortPacket[] = {PRAYER_TIMINGS_HEADER, 1, 1, 20};
+    capture->insert(capture->end(), unknownHeader, unknownHeader + sizeof(unknownHeader));
+    capture->insert(capture->end(), dayZero, dayZero + sizeof(dayZero));
+    capture->insert(capture->end(), monthZero, monthZero + sizeof(monthZero));
+    capture->insert(capture->end(), hour24, hour24 + sizeof(hour24));
+    // Last, its missing bytes are the end of the capture
+    capture->insert(capture->end(), shortPacket, shortPacket + sizeof(shortPacket));
+}
+
+bool readCapture(const char *path, std::vector<uint8_t> *capture) {
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    uint8_t chunk[512];
+    size_t length;
+    while ((length = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        capture->insert(capture->end(), chunk, chunk + length);
+    }
+    fclose(file);
+    return true;
+}
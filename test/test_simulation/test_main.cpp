@@ -0,0 +1,302 @@
+/*===========================================================================*/
+/// \file test_main.cpp
+///
+/// \brief
+///    A year of the firmware on the host: every prayer and DST transition of 2025 in Europe/Paris, on time
+///
+/// \details
+///     The services and the display, timings and prayer tasks start like in setup(), on the FreeRTOS mock. The test
+///     plays the phone over the mock BLE backend: it sends each month's timetable once the last isha of the previous
+///     month is due, and checks every PRAYER_DUE against the UTC instant computed here with the C library, not with
+///     the transition table of the firmware. The clock is warped so the year runs in real minutes of the mock and
+///     seconds of the host; a wait of the prayer task ends on a tick of the real clock, which bounds the error.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+#include <mock.h>
+#include <mock_ble.h>
+#include <mod_cli0.h>
+#include <mod_display.h>
+#include <mod_prayer.h>
+#include <mod_timings.h>
+#include <svc_clock.h>
+#include <svc_config.h>
+#include <svc_display.h>
+#include <svc_event.h>
+#include <svc_log.h>
+#include <svc_power.h>
+#include <svc_protocol.h>
+#include <svc_state.h>
+#include <svc_trace.h>
+#include <unity.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define SIMULATION_YEAR 2025
+#define SIMULATION_MONTHS 12
+#define SIMULATION_WARP 1000
+// One tick of the real clock seen through the warp, plus the timer reads between the wake-up and the check
+#define SIMULATION_TOLERANCE_MS (SIMULATION_WARP * portTICK_PERIOD_MS + 100)
+#define SIMULATION_EVENT_QUEUE_SIZE 8
+
+// Europe/Paris
+#define SIMULATION_CET_S 3600
+#define SIMULATION_CEST_S 7200
+
+/*=============================================================================
+                                    Structures
+=============================================================================*/
+
+typedef struct {
+    uint32_t count;
+    int64_t maxMs;
+    int64_t totalMs;
+} simulationErrors_t;
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static int64_t utcOf(int year, int month, int day, int hour, int minute);
+
+static int daysInMonth(int year, int month);
+
+static bool isSummerTime(int month, int day);
+
+static void dayTimings(int month, int day, svcProtocolTime_t *prayers);
+
+static void sendTimetable(int month);
+
+static void recordError(simulationErrors_t *errors, int64_t errorMs);
+
+static void startFirmware();
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static QueueHandle_t prayerEvents = nullptr;
+
+/*=============================================================================
+                                Private Constants
+=============================================================================*/
+
+// Last Sunday of March and of October at 01:00 UTC
+static const int64_t dstTransitions[] = {
+    utcOf(SIMULATION_YEAR, 3, 30, 1, 0),
+    utcOf(SIMULATION_YEAR, 10, 26, 1, 0),
+};
+
+static const int32_t dstOffsets[] = {SIMULATION_CEST_S, SIMULATION_CET_S};
+
+/*=============================================================================
+                                      Tests
+=============================================================================*/
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_year_of_prayers_and_transitions() {
+    svcClockSet(utcOf(SIMULATION_YEAR, 1, 1, 0, 0) - SIMULATION_CET_S, SVC_CLOCK_SOURCE_CLI);
+    TEST_ASSERT_TRUE(svcClockSetWarp(SIMULATION_WARP));
+    mockBleTransport()->connect();
+    sendTimetable(1);
+
+    simulationErrors_t prayerErrors = {0, 0, 0};
+    simulationErrors_t transitionErrors = {0, 0, 0};
+    size_t nextTransition = 0;
+
+    for (int month = 1; month <= SIMULATION_MONTHS; month++) {
+        for (int day = 1; day <= daysInMonth(SIMULATION_YEAR, month); day++) {
+            svcProtocolTime_t prayers[SVC_PROTOCOL_PRAYER_COUNT];
+            dayTimings(month, day, prayers);
+            const int32_t offset = isSummerTime(month, day) ? SIMULATION_CEST_S : SIMULATION_CET_S;
+
+            for (int i = 0; i < SVC_PROTOCOL_PRAYER_COUNT; i++) {
+                const int64_t expectedUtc = utcOf(SIMULATION_YEAR, month, day, prayers[i].hour, prayers[i].minute) -
+                                            offset;
+
+                // The transitions of the night before the prayer, seen when the test task wakes up for them
+                svcEvent_t event;
+                while (true) {
+                    TickType_t timeout = portMAX_DELAY;
+                    if (nextTransition < sizeof(dstTransitions) / sizeof(dstTransitions[0])) {
+                        const int64_t remainingMs = svcClockRealMsUntil(dstTransitions[nextTransition] * 1000);
+                        timeout = pdMS_TO_TICKS(remainingMs);
+                    }
+                    if (xQueueReceive(prayerEvents, &event, timeout)) {
+                        break;
+                    }
+                    const int64_t nowMs = svcClockNowMs();
+                    if (nowMs < dstTransitions[nextTransition] * 1000) {
+                        continue;
+                    }
+                    TEST_ASSERT_EQUAL_INT32_MESSAGE(dstOffsets[nextTransition], svcClockUtcOffset(nowMs / 1000),
+                                                    "local time did not change at the transition");
+                    TEST_ASSERT_EQUAL_INT32(dstOffsets[nextTransition] == SIMULATION_CEST_S ? SIMULATION_CET_S
+                                                                                            : SIMULATION_CEST_S,
+                                            svcClockUtcOffset(dstTransitions[nextTransition] - 1));
+                    const int64_t errorMs = nowMs - dstTransitions[nextTransition] * 1000;
+                    TEST_ASSERT_LESS_THAN_INT64_MESSAGE(SIMULATION_TOLERANCE_MS, errorMs, "transition seen late");
+                    recordError(&transitionErrors, errorMs);
+                    nextTransition++;
+                }
+
+                const int64_t errorMs = svcClockNowMs() - expectedUtc * 1000;
+                char message[96];
+                snprintf(message, sizeof(message), "prayer %d of %04d-%02d-%02d, error %lld ms", i, SIMULATION_YEAR,
+                         month, day, (long long) errorMs);
+                TEST_ASSERT_EQUAL_INT_MESSAGE(i, event.data.prayer.name, message);
+                TEST_ASSERT_EQUAL_INT_MESSAGE(prayers[i].hour, event.data.prayer.hour, message);
+                TEST_ASSERT_EQUAL_INT_MESSAGE(prayers[i].minute, event.data.prayer.minute, message);
+                TEST_ASSERT_GREATER_OR_EQUAL_INT64_MESSAGE(0, errorMs, message);
+                TEST_ASSERT_LESS_THAN_INT64_MESSAGE(SIMULATION_TOLERANCE_MS, errorMs, message);
+                recordError(&prayerErrors, errorMs);
+            }
+        }
+
+        // The prayer module only takes the days of the current month, the next one follows its last isha
+        if (month < SIMULATION_MONTHS) {
+            sendTimetable(month + 1);
+        }
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(365 * SVC_PROTOCOL_PRAYER_COUNT, prayerErrors.count);
+    TEST_ASSERT_EQUAL_UINT32(2, transitionErrors.count);
+
+    char report[160];
+    snprintf(report, sizeof(report), "%lu prayers: max error %lld ms, mean %lld ms; DST transitions: max %lld ms",
+             (unsigned long) prayerErrors.count, (long long) prayerErrors.maxMs,
+             (long long) (prayerErrors.totalMs / prayerErrors.count), (long long) transitionErrors.maxMs);
+    TEST_MESSAGE(report);
+
+    svcDisplayFlushStats_t flush;
+    svcDisplayGetFlushStats(&flush);
+    TEST_ASSERT_EQUAL_UINT32(0, flush.errors);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, flush.frames);
+
+    const uint8_t *panel = mockSsd1306Gddram(MOCK_I2C_DEFAULT_PANEL);
+    TEST_ASSERT_NOT_NULL(panel);
+    size_t litBytes = 0;
+    for (size_t i = 0; i < MOCK_SSD1306_GDDRAM_SIZE; i++) {
+        litBytes += panel[i] != 0;
+    }
+    TEST_ASSERT_GREATER_THAN(0, litBytes);
+}
+
+/*=============================================================================
+                                Library Entry Point
+=============================================================================*/
+
+int main(int argc, char **argv) {
+    startFirmware();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_year_of_prayers_and_transitions);
+    return UNITY_END();
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+int64_t utcOf(int year, int month, int day, int hour, int minute) {
+    // Days from the civil date, so the expected instants do not go through the firmware's calendar code
+    const int y = month <= 2 ? year - 1 : year;
+    const int era = y / 400;
+    const int yearOfEra = y - era * 400;
+    const int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    const int64_t days = (int64_t) era * 146097 + dayOfEra - 719468;
+    return days * 86400 + hour * 3600 + minute * 60;
+}
+
+int daysInMonth(int year, int month) {
+    const int nextYear = month == 12 ? year + 1 : year;
+    const int nextMonth = month == 12 ? 1 : month + 1;
+    return (int) ((utcOf(nextYear, nextMonth, 1, 0, 0) - utcOf(year, month, 1, 0, 0)) / 86400);
+}
+
+bool isSummerTime(int month, int day) {
+    // Every prayer falls after the transition of its day, which happens at night
+    const int64_t date = utcOf(SIMULATION_YEAR, month, day, 12, 0);
+    return date > dstTransitions[0] && date < dstTransitions[1];
+}
+
+void dayTimings(int month, int day, svcProtocolTime_t *prayers) {
+    // Spread over the day like real timings and moving from one day to the next
+    static const uint16_t baseMinutes[SVC_PROTOCOL_PRAYER_COUNT] = {5 * 60, 12 * 60 + 30, 15 * 60 + 30, 18 * 60,
+                                                                     20 * 60};
+    const int dayOfYear = (int) ((utcOf(SIMULATION_YEAR, month, day, 0, 0) -
+                                  utcOf(SIMULATION_YEAR, 1, 1, 0, 0)) / 86400);
+    for (int i = 0; i < SVC_PROTOCOL_PRAYER_COUNT; i++) {
+        const int minutes = baseMinutes[i] + dayOfYear * (i + 3) % 50;
+        prayers[i].hour = (uint8_t) (minutes / 60);
+        prayers[i].minute = (uint8_t) (minutes % 60);
+    }
+}
+
+void sendTimetable(int month) {
+    MockBleTransport *ble = mockBleTransport();
+    const int days = daysInMonth(SIMULATION_YEAR, month);
+
+    const uint8_t numberOfDays[SVC_PROTOCOL_NUMBER_OF_DAYS_SIZE] = {NUMBER_OF_DAYS_HEADER, (uint8_t) days};
+    TEST_ASSERT_TRUE(ble->write(SVC_BLE_CHAR_OPERATION, numberOfDays, sizeof(numberOfDays)));
+
+    for (int day = 1; day <= days; day++) {
+        svcProtocolTime_t prayers[SVC_PROTOCOL_PRAYER_COUNT];
+        dayTimings(month, day, prayers);
+        uint8_t packet[SVC_PROTOCOL_PRAYER_TIMINGS_SIZE] = {
+            PRAYER_TIMINGS_HEADER, (uint8_t) day, (uint8_t) month, SIMULATION_YEAR / 100, SIMULATION_YEAR % 100
+        };
+        for (int i = 0; i < SVC_PROTOCOL_PRAYER_COUNT; i++) {
+            packet[5 + i * 2] = prayers[i].hour;
+            packet[6 + i * 2] = prayers[i].minute;
+        }
+        TEST_ASSERT_TRUE(ble->write(SVC_BLE_CHAR_OPERATION, packet, sizeof(packet)));
+    }
+
+    const uint8_t end[SVC_PROTOCOL_END_OF_TIMINGS_SIZE] = {END_OF_TIMINGS_HEADER};
+    TEST_ASSERT_TRUE(ble->write(SVC_BLE_CHAR_OPERATION, end, sizeof(end)));
+}
+
+void recordError(simulationErrors_t *errors, int64_t errorMs) {
+    errors->count++;
+    errors->totalMs += errorMs;
+    errors->maxMs = errorMs > errors->maxMs ? errorMs : errors->maxMs;
+}
+
+void startFirmware() {
+    // The order of setup(), without the CLI and audio tasks the simulation does not use
+    modCli0Init();
+    svcConfigInit();
+    svcLogInit();
+    svcLogSetLevel(SVC_LOG_LEVEL_WARNING);
+    xTaskCreate(svcLogTaskProcess, "svcLogTask", 3072, nullptr, 1, nullptr);
+    svcTraceInit();
+    svcPowerInit();
+    svcClockInit();
+    svcEventInit();
+    svcStateInit();
+    svcDisplayInit();
+
+    // Before the prayer task, so no PRAYER_DUE is published ahead of the subscription
+    prayerEvents = svcEventSubscribe(SVC_EVENT_MASK(SVC_EVENT_PRAYER_DUE), SIMULATION_EVENT_QUEUE_SIZE);
+
+    xTaskCreate(modDisplayTaskProcess, "modDisplayTask", 4096, nullptr, 4, nullptr);
+    xTaskCreate(modBTETaskProcess, "modTimingsTask", 8192, nullptr, 5, nullptr);
+    xTaskCreate(modPrayerTaskProcess, "modPrayerTask", 8192, nullptr, 5, nullptr);
+}
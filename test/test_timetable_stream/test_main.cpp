@@ -0,0 +1,242 @@
+/*===========================================================================*/
+/// \file test_main.cpp
+///
+/// \brief
+///    Timetable bodies of the Wi-Fi sync through the streaming parser
+///
+/// \details
+///     The same timetable as BLE packets back to back and as JSON is fed split at every byte, as the HTTP client can
+///     hand it over, then bodies the parser has to refuse: cut short, an unknown header, a record with a field too many
+///     and a year out of range.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <stdio.h>
+#include <string>
+#include <svc_timetable_stream.h>
+#include <unity.h>
+#include <vector>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define TIMETABLE_DAYS 3
+#define TIMETABLE_MONTH 3
+#define TIMETABLE_YEAR 2025
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static void onPacket(const svcProtocolPacket_t *packet, void *context);
+
+static bool parse(svcTimetableStreamFormat_t format, const std::string &body, size_t split, bool *fed);
+
+static std::string binaryBody();
+
+static std::string jsonBody();
+
+static void assertTimings(const svcProtocolPacket_t *packet, uint8_t day);
+
+static uint8_t hourOf(uint8_t day, int prayer);
+
+static uint8_t minuteOf(uint8_t day, int prayer);
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static std::vector<svcProtocolPacket_t> received;
+static svcTimetableStream_t stream;
+
+/*=============================================================================
+                                      Tests
+=============================================================================*/
+
+void setUp() {
+    received.clear();
+}
+
+void tearDown() {
+}
+
+void test_binary_body_split_at_every_byte() {
+    const std::string body = binaryBody();
+    for (size_t split = 0; split <= body.size(); split++) {
+        received.clear();
+        bool fed = false;
+        TEST_ASSERT_TRUE(parse(SVC_TIMETABLE_STREAM_BINARY, body, split, &fed));
+        TEST_ASSERT_TRUE(fed);
+
+        // The number of days, each day and the end
+        TEST_ASSERT_EQUAL_size_t(TIMETABLE_DAYS + 2, received.size());
+        TEST_ASSERT_EQUAL_UINT32(TIMETABLE_DAYS + 2, stream.records);
+        TEST_ASSERT_EQUAL_UINT8(NUMBER_OF_DAYS_HEADER, received[0].header);
+        TEST_ASSERT_EQUAL_UINT8(TIMETABLE_DAYS, received[0].numberOfDays);
+        for (uint8_t day = 1; day <= TIMETABLE_DAYS; day++) {
+            assertTimings(&received[day], day);
+        }
+        TEST_ASSERT_EQUAL_UINT8(END_OF_TIMINGS_HEADER, received[TIMETABLE_DAYS + 1].header);
+    }
+}
+
+void test_json_body_split_at_every_byte() {
+    const std::string body = jsonBody();
+    for (size_t split = 0; split <= body.size(); split++) {
+        received.clear();
+        bool fed = false;
+        TEST_ASSERT_TRUE(parse(SVC_TIMETABLE_STREAM_JSON, body, split, &fed));
+        TEST_ASSERT_TRUE(fed);
+
+        TEST_ASSERT_EQUAL_size_t(TIMETABLE_DAYS, received.size());
+        for (uint8_t day = 1; day <= TIMETABLE_DAYS; day++) {
+            assertTimings(&received[day - 1], day);
+        }
+    }
+}
+
+void test_truncated_body_does_not_end() {
+    // Cut in the middle of the last day, the days before it are still given
+    std::string body = binaryBody();
+    body.resize(body.size() - SVC_PROTOCOL_END_OF_TIMINGS_SIZE - 4);
+    bool fed = false;
+    TEST_ASSERT_FALSE(parse(SVC_TIMETABLE_STREAM_BINARY, body, body.size() / 2, &fed));
+    TEST_ASSERT_TRUE(fed);
+    TEST_ASSERT_EQUAL_size_t(TIMETABLE_DAYS, received.size());
+    assertTimings(&received[TIMETABLE_DAYS - 1], TIMETABLE_DAYS - 1);
+
+    // Without its closing bracket, every record is complete but the array is not
+    received.clear();
+    body = jsonBody();
+    body.resize(body.rfind(']'));
+    TEST_ASSERT_FALSE(parse(SVC_TIMETABLE_STREAM_JSON, body, body.size() / 2, &fed));
+    TEST_ASSERT_TRUE(fed);
+    TEST_ASSERT_EQUAL_size_t(TIMETABLE_DAYS, received.size());
+}
+
+void test_unknown_header_stops_the_body() {
+    std::string body = binaryBody();
+    const size_t firstDayEnd = SVC_PROTOCOL_NUMBER_OF_DAYS_SIZE + SVC_PROTOCOL_PRAYER_TIMINGS_SIZE;
+    body.insert(firstDayEnd, 1, '\x00');
+    bool fed = true;
+    TEST_ASSERT_FALSE(parse(SVC_TIMETABLE_STREAM_BINARY, body, body.size(), &fed));
+    TEST_ASSERT_FALSE(fed);
+
+    // Nothing after it, there is no way to find the next packet
+    TEST_ASSERT_EQUAL_size_t(2, received.size());
+    assertTimings(&received[1], 1);
+}
+
+void test_record_with_fourteen_fields_stops_the_body() {
+    std::string body = jsonBody();
+    const size_t secondRecordEnd = body.find(']', body.find(']') + 1);
+    body.insert(secondRecordEnd, ", 7");
+    bool fed = true;
+    TEST_ASSERT_FALSE(parse(SVC_TIMETABLE_STREAM_JSON, body, 1, &fed));
+    TEST_ASSERT_FALSE(fed);
+    TEST_ASSERT_EQUAL_size_t(1, received.size());
+    assertTimings(&received[0], 1);
+}
+
+void test_year_out_of_range() {
+    // Five digits cannot be a year, the body is malformed
+    std::string body = jsonBody();
+    const std::string year = std::to_string(TIMETABLE_YEAR);
+    body.replace(body.rfind(year), year.size(), "10000");
+    bool fed = true;
+    TEST_ASSERT_FALSE(parse(SVC_TIMETABLE_STREAM_JSON, body, body.size(), &fed));
+    TEST_ASSERT_FALSE(fed);
+    TEST_ASSERT_EQUAL_size_t(TIMETABLE_DAYS - 1, received.size());
+
+    // A packet with a century byte over 99 is well framed, only that day is rejected
+    received.clear();
+    body = binaryBody();
+    body[SVC_PROTOCOL_NUMBER_OF_DAYS_SIZE + 3] = 100;
+    TEST_ASSERT_TRUE(parse(SVC_TIMETABLE_STREAM_BINARY, body, body.size(), &fed));
+    TEST_ASSERT_TRUE(fed);
+    TEST_ASSERT_EQUAL_UINT32(1, stream.rejected);
+    TEST_ASSERT_EQUAL_size_t(TIMETABLE_DAYS + 1, received.size());
+    assertTimings(&received[1], 2);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_binary_body_split_at_every_byte);
+    RUN_TEST(test_json_body_split_at_every_byte);
+    RUN_TEST(test_truncated_body_does_not_end);
+    RUN_TEST(test_unknown_header_stops_the_body);
+    RUN_TEST(test_record_with_fourteen_fields_stops_the_body);
+    RUN_TEST(test_year_out_of_range);
+    return UNITY_END();
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+void onPacket(const svcProtocolPacket_t *packet, void *context) {
+    TEST_ASSERT_EQUAL_PTR(&received, context);
+    received.push_back(*packet);
+}
+
+bool parse(svcTimetableStreamFormat_t format, const std::string &body, size_t split, bool *fed) {
+    const uint8_t *data = (const uint8_t *) body.data();
+    svcTimetableStreamBegin(&stream, format, onPacket, &received);
+    *fed = svcTimetableStreamFeed(&stream, data, split);
+    *fed = svcTimetableStreamFeed(&stream, &data[split], body.size() - split) && *fed;
+    return svcTimetableStreamEnd(&stream);
+}
+
+std::string binaryBody() {
+    std::string body = {NUMBER_OF_DAYS_HEADER, TIMETABLE_DAYS};
+    for (uint8_t day = 1; day <= TIMETABLE_DAYS; day++) {
+        body += {PRAYER_TIMINGS_HEADER, (char) day, TIMETABLE_MONTH, TIMETABLE_YEAR / 100, TIMETABLE_YEAR % 100};
+        for (int i = 0; i < SVC_PROTOCOL_PRAYER_COUNT; i++) {
+            body += {(char) hourOf(day, i), (char) minuteOf(day, i)};
+        }
+    }
+    body += (char) END_OF_TIMINGS_HEADER;
+    return body;
+}
+
+std::string jsonBody() {
+    std::string body = "[";
+    for (uint8_t day = 1; day <= TIMETABLE_DAYS; day++) {
+        char record[96];
+        snprintf(record, sizeof(record), "%s\n  [%d, %d, %d", day > 1 ? "," : "", day, TIMETABLE_MONTH, TIMETABLE_YEAR);
+        body += record;
+        for (int i = 0; i < SVC_PROTOCOL_PRAYER_COUNT; i++) {
+            snprintf(record, sizeof(record), ", %d, %d", hourOf(day, i), minuteOf(day, i));
+            body += record;
+        }
+        body += "]";
+    }
+    return body + "\n]\n";
+}
+
+void assertTimings(const svcProtocolPacket_t *packet, uint8_t day) {
+    TEST_ASSERT_EQUAL_UINT8(PRAYER_TIMINGS_HEADER, packet->header);
+    TEST_ASSERT_EQUAL_UINT8(day, packet->timings.day);
+    TEST_ASSERT_EQUAL_UINT8(TIMETABLE_MONTH, packet->timings.month);
+    TEST_ASSERT_EQUAL_UINT16(TIMETABLE_YEAR, packet->timings.year);
+    for (int i = 0; i < SVC_PROTOCOL_PRAYER_COUNT; i++) {
+        TEST_ASSERT_EQUAL_UINT8(hourOf(day, i), packet->timings.prayers[i].hour);
+        TEST_ASSERT_EQUAL_UINT8(minuteOf(day, i), packet->timings.prayers[i].minute);
+    }
+}
+
+uint8_t hourOf(uint8_t day, int prayer) {
+    return (uint8_t) (5 + prayer * 3 + day % 2);
+}
+
+uint8_t minuteOf(uint8_t day, int prayer) {
+    return (uint8_t) ((day * 7 + prayer * 11) % 60);
+}
@@ -0,0 +1,395 @@
+/*===========================================================================*/
+/// \file test_main.cpp
+///
+/// \brief
+///    The BLE protocol of the timings module, driven through the mock backend
+///
+/// \details
+///     The timings task starts on the FreeRTOS mock like in setup(), the test plays the phone: it connects, writes
+///     the operation characteristic and reads back the characteristics and notifications the module produced. The
+///     timetables it publishes are received and released like the prayer module does.
+///
+/// \author
+///     Ayoub Q.
+///
+/*===========================================================================*/
+
+/*=============================================================================
+                                     Includes
+=============================================================================*/
+
+#include <Arduino.h>
+#include <mock_ble.h>
+#include <mod_cli0.h>
+#include <mod_telemetry.h>
+#include <mod_timings.h>
+#include <string.h>
+#include <svc_clock.h>
+#include <svc_config.h>
+#include <svc_event.h>
+#include <svc_log.h>
+#include <svc_power.h>
+#include <svc_protocol.h>
+#include <svc_state.h>
+#include <svc_trace.h>
+#include <unity.h>
+
+/*=============================================================================
+                                     Defines
+=============================================================================*/
+
+#define TIMINGS_YEAR 2025
+#define TIMINGS_MONTH 3
+#define TIMINGS_DAYS 3
+#define TIMINGS_EVENT_QUEUE_SIZE 8
+// Longer than an iteration of the timings task, which wakes up at least every second
+#define TIMINGS_TASK_PERIOD_MS 1100
+
+#define READBACK_DAY_SIZE 14
+#define STATUS_SIZE 10
+#define TIME_ANSWER_SIZE 13
+
+/*=============================================================================
+                            Private Function Prototypes
+=============================================================================*/
+
+static void dayPacket(uint8_t day, uint8_t shift, uint8_t *packet);
+
+static void sendDays(uint8_t header, const uint8_t *base, uint8_t numberOfDays, const uint8_t *days,
+                     const uint8_t *shifts, size_t count);
+
+static bool waitEvent(svcEventTopic_t topic, uint32_t timeoutMs, svcEvent_t *event);
+
+static const PrayerTimetable *waitTimetable();
+
+static void writeExchange(uint8_t header, uint8_t sequence, int64_t utcUs);
+
+static void startFirmware();
+
+/*=============================================================================
+                                Private Variables
+=============================================================================*/
+
+static QueueHandle_t events = nullptr;
+
+/*=============================================================================
+                                      Tests
+=============================================================================*/
+
+void setUp() {
+    mockBleTransport()->connect();
+    mockBleTransport()->clearNotifications();
+    // Starts from an empty queue, the timetables left by a failed test released
+    svcEvent_t event;
+    while (waitEvent(SVC_EVENT_TOPIC_COUNT, 0, &event)) {
+    }
+}
+
+void tearDown() {
+}
+
+void test_stack_started_with_the_configured_name() {
+    TEST_ASSERT_TRUE(mockBleTransport()->started());
+    TEST_ASSERT_EQUAL_STRING(svcConfigGet()->deviceName, mockBleTransport()->name());
+
+    // Empty timetable readback before any sync
+    const std::vector<uint8_t> &readback = mockBleTransport()->value(SVC_BLE_CHAR_TIMETABLE);
+    TEST_ASSERT_EQUAL_size_t(2, readback.size());
+    TEST_ASSERT_EQUAL_UINT8(0, readback[1]);
+}
+
+void test_connection_is_published() {
+    MockBleTransport *ble = mockBleTransport();
+    svcEvent_t event;
+    ble->disconnect();
+    TEST_ASSERT_TRUE(waitEvent(SVC_EVENT_SYNC_CHANGED, 0, &event));
+    TEST_ASSERT_FALSE(event.data.sync.connected);
+
+    ble->connect();
+    TEST_ASSERT_TRUE(waitEvent(SVC_EVENT_SYNC_CHANGED, 0, &event));
+    TEST_ASSERT_TRUE(event.data.sync.connected);
+}
+
+void test_timetable_sync() {
+    const uint8_t days[TIMINGS_DAYS] = {1, 2, 3};
+    const uint8_t shifts[TIMINGS_DAYS] = {0, 0, 0};
+    sendDays(NUMBER_OF_DAYS_HEADER, nullptr, TIMINGS_DAYS, days, shifts, TIMINGS_DAYS);
+    svcEvent_t event;
+    TEST_ASSERT_TRUE(waitEvent(SVC_EVENT_SYNC_CHANGED, 0, &event));
+    TEST_ASSERT_EQUAL(SYNC_RECEIVING, event.data.sync.status);
+
+    const PrayerTimetable *timetable = waitTimetable();
+    TEST_ASSERT_NOT_NULL(timetable);
+    TEST_ASSERT_EQUAL_UINT8(TIMINGS_DAYS, timetable->numberOfDays);
+    for (uint8_t i = 0; i < TIMINGS_DAYS; i++) {
+        uint8_t packet[SVC_PROTOCOL_PRAYER_TIMINGS_SIZE];
+        dayPacket(i + 1, 0, packet);
+        const PrayerTimings &timings = timetable->days[i];
+        TEST_ASSERT_EQUAL_UINT8(i + 1, timings.day);
+        TEST_ASSERT_EQUAL_UINT8(TIMINGS_MONTH, timings.month);
+        TEST_ASSERT_EQUAL_UINT16(TIMINGS_YEAR, timings.year);
+        TEST_ASSERT_EQUAL_UINT8(packet[5], timings.fajr.hour);
+        TEST_ASSERT_EQUAL_UINT8(packet[14], timings.isha.minute);
+        TEST_ASSERT_EQUAL(ISHA, timings.isha.name);
+    }
+    svcEventRelease(timetable);
+
+    // The readback holds bytes [1] to [14] of each day packet, once the task took the timetable
+    vTaskDelay(pdMS_TO_TICKS(TIMINGS_TASK_PERIOD_MS));
+    const std::vector<uint8_t> &readback = mockBleTransport()->value(SVC_BLE_CHAR_TIMETABLE);
+    TEST_ASSERT_EQUAL_size_t(2 + TIMINGS_DAYS * READBACK_DAY_SIZE, readback.size());
+    TEST_ASSERT_EQUAL_UINT8(TIMINGS_DAYS, readback[1]);
+    uint8_t packet[SVC_PROTOCOL_PRAYER_TIMINGS_SIZE];
+    dayPacket(2, 0, packet);
+    TEST_ASSERT_EQUAL_MEMORY(&packet[1], &readback[2 + READBACK_DAY_SIZE], READBACK_DAY_SIZE);
+
+    const std::vector<uint8_t> &manifest = mockBleTransport()->value(SVC_BLE_CHAR_MANIFEST);
+    TEST_ASSERT_EQUAL_size_t(2 + (1 + TIMINGS_DAYS) * SVC_PROTOCOL_HASH_SIZE, manifest.size());
+    TEST_ASSERT_EQUAL_UINT8(TIMINGS_DAYS, manifest[1]);
+}
+
+void test_update_applies_to_the_stored_timetable() {
+    const std::vector<uint8_t> manifest = mockBleTransport()->value(SVC_BLE_CHAR_MANIFEST);
+    TEST_ASSERT_EQUAL_UINT8(TIMINGS_DAYS, manifest[1]);
+
+    // Computed against another timetable: refused with its days, nothing published
+    const uint8_t changedDay[] = {2};
+    const uint8_t shift[] = {7};
+    const uint8_t wrongBase[SVC_PROTOCOL_HASH_SIZE] = {(uint8_t) (manifest[2] ^ 0xFF), manifest[3], manifest[4],
+                                                       manifest[5]};
+    sendDays(UPDATE_OF_DAYS_HEADER, wrongBase, TIMINGS_DAYS, changedDay, shift, 1);
+    TEST_ASSERT_NULL(waitTimetable());
+
+    // Only day 2 is sent, days 1 and 3 come from the stored timetable
+    sendDays(UPDATE_OF_DAYS_HEADER, &manifest[2], TIMINGS_DAYS, changedDay, shift, 1);
+    const PrayerTimetable *timetable = waitTimetable();
+    TEST_ASSERT_NOT_NULL(timetable);
+    TEST_ASSERT_EQUAL_UINT8(TIMINGS_DAYS, timetable->numberOfDays);
+    for (uint8_t i = 0; i < TIMINGS_DAYS; i++) {
+        uint8_t packet[SVC_PROTOCOL_PRAYER_TIMINGS_SIZE];
+        dayPacket(i + 1, i == 1 ? shift[0] : 0, packet);
+        TEST_ASSERT_EQUAL_UINT8(i + 1, timetable->days[i].day);
+        TEST_ASSERT_EQUAL_UINT8(packet[6], timetable->days[i].fajr.minute);
+        TEST_ASSERT_EQUAL_UINT8(packet[12], timetable->days[i].maghrib.minute);
+    }
+    svcEventRelease(timetable);
+
+    vTaskDelay(pdMS_TO_TICKS(TIMINGS_TASK_PERIOD_MS));
+    const std::vector<uint8_t> &updated = mockBleTransport()->value(SVC_BLE_CHAR_MANIFEST);
+    TEST_ASSERT_EQUAL_MEMORY(&manifest[2 + SVC_PROTOCOL_HASH_SIZE], &updated[2 + SVC_PROTOCOL_HASH_SIZE],
+                             SVC_PROTOCOL_HASH_SIZE);
+    TEST_ASSERT_FALSE(memcmp(&manifest[2], &updated[2], SVC_PROTOCOL_HASH_SIZE) == 0);
+    TEST_ASSERT_FALSE(memcmp(&manifest[2 + 2 * SVC_PROTOCOL_HASH_SIZE], &updated[2 + 2 * SVC_PROTOCOL_HASH_SIZE],
+                             SVC_PROTOCOL_HASH_SIZE) == 0);
+}
+
+void test_malformed_packets_are_ignored() {
+    MockBleTransport *ble = mockBleTransport();
+    const uint8_t unknownHeader[] = {0x00, 1, 2};
+    const uint8_t dayZero[SVC_PROTOCOL_PRAYER_TIMINGS_SIZE] = {PRAYER_TIMINGS_HEADER, 0, 1, 20, 25};
+    const uint8_t shortPacket[] = {CURRENT_TIME_HEADER, 1, 2};
+    TEST_ASSERT_TRUE(ble->write(SVC_BLE_CHAR_OPERATION, unknownHeader, sizeof(unknownHeader)));
+    TEST_ASSERT_TRUE(ble->write(SVC_BLE_CHAR_OPERATION, dayZero, sizeof(dayZero)));
+    TEST_ASSERT_TRUE(ble->write(SVC_BLE_CHAR_OPERATION, shortPacket, sizeof(shortPacket)));
+    TEST_ASSERT_TRUE(ble->write(SVC_BLE_CHAR_OPERATION, nullptr, 0));
+
+    svcEvent_t event;
+    TEST_ASSERT_FALSE(waitEvent(SVC_EVENT_TIME_CHANGED, TIMINGS_TASK_PERIOD_MS, &event));
+    TEST_ASSERT_NULL(waitTimetable());
+}
+
+void test_current_time_sets_the_clock_and_notifies_the_status() {
+    // 2025-03-02 10:20:30 local time, the month counted from 0
+    const uint8_t currentTime[SVC_PROTOCOL_CURRENT_TIME_SIZE] = {
+        CURRENT_TIME_HEADER, 10, 20, 30, 2, TIMINGS_MONTH - 1, TIMINGS_YEAR / 100, TIMINGS_YEAR % 100
+    };
+    TEST_ASSERT_TRUE(mockBleTransport()->write(SVC_BLE_CHAR_OPERATION, currentTime, sizeof(currentTime)));
+
+    svcEvent_t event;
+    TEST_ASSERT_TRUE(waitEvent(SVC_EVENT_TIME_CHANGED, 0, &event));
+    svcClockDateTime_t local;
+    svcClockToDateTime(event.data.time + svcClockUtcOffset(event.data.time), &local);
+    TEST_ASSERT_EQUAL_UINT8(10, local.hour);
+    TEST_ASSERT_EQUAL_UINT8(20, local.minute);
+    TEST_ASSERT_EQUAL_UINT8(2, local.day);
+    TEST_ASSERT_EQUAL_UINT8(TIMINGS_MONTH, local.month);
+
+    // Notified by the task with the clock just set
+    vTaskDelay(pdMS_TO_TICKS(TIMINGS_TASK_PERIOD_MS));
+    const std::vector<mockBleNotification_t> &sent = mockBleTransport()->notifications();
+    TEST_ASSERT_GREATER_THAN_size_t(0, sent.size());
+    const mockBleNotification_t &status = sent.back();
+    TEST_ASSERT_EQUAL(SVC_BLE_CHAR_STATUS, status.characteristic);
+    TEST_ASSERT_EQUAL_size_t(STATUS_SIZE, status.value.size());
+    uint32_t clock;
+    memcpy(&clock, &status.value[6], sizeof(clock));
+    TEST_ASSERT_UINT32_WITHIN(2, (uint32_t) event.data.time, clock);
+}
+
+void test_time_exchange_is_answered_and_applied() {
+    svcClockSyncStatus_t before;
+    svcClockGetSyncStatus(&before);
+
+    const int64_t phoneUs = svcClockNowUs() + 250000;
+    const int64_t requestedUs = svcClockNowUs();
+    writeExchange(TIME_REQUEST_HEADER, 42, phoneUs);
+
+    const std::vector<mockBleNotification_t> &sent = mockBleTransport()->notifications();
+    TEST_ASSERT_EQUAL_size_t(1, sent.size());
+    TEST_ASSERT_EQUAL(SVC_BLE_CHAR_TIME, sent[0].characteristic);
+    TEST_ASSERT_EQUAL_size_t(TIME_ANSWER_SIZE, sent[0].value.size());
+    TEST_ASSERT_EQUAL_UINT8(42, sent[0].value[0]);
+    int64_t receivedUs;
+    memcpy(&receivedUs, &sent[0].value[1], sizeof(receivedUs));
+    TEST_ASSERT_INT64_WITHIN(1000, requestedUs, receivedUs);
+
+    // A result of another sequence kept in the same slot is not matched with the request
+    writeExchange(TIME_RESULT_HEADER, 42 + 4, phoneUs + 1000);
+    svcClockSyncStatus_t after;
+    svcClockGetSyncStatus(&after);
+    TEST_ASSERT_EQUAL_UINT32(before.samples, after.samples);
+
+    writeExchange(TIME_RESULT_HEADER, 42, phoneUs + 1000);
+    svcClockGetSyncStatus(&after);
+    TEST_ASSERT_EQUAL_UINT32(before.samples + 1, after.samples);
+}
+
+void test_sync_requests_the_bulk_link() {
+    MockBleTransport *ble = mockBleTransport();
+    // The telemetry module releases the timetables on its period, until then both buffers may be taken
+    vTaskDelay(pdMS_TO_TICKS(MOD_TELEMETRY_PERIOD_MS));
+    TEST_ASSERT_EQUAL(SVC_BLE_LINK_IDLE, ble->linkProfile());
+
+    const uint8_t numberOfDays[SVC_PROTOCOL_NUMBER_OF_DAYS_SIZE] = {NUMBER_OF_DAYS_HEADER, TIMINGS_DAYS};
+    TEST_ASSERT_TRUE(ble->write(SVC_BLE_CHAR_OPERATION, numberOfDays, sizeof(numberOfDays)));
+    vTaskDelay(pdMS_TO_TICKS(TIMINGS_TASK_PERIOD_MS));
+    TEST_ASSERT_EQUAL(SVC_BLE_LINK_BULK, ble->linkProfile());
+
+    // Abandoned by the phone, back to idle without the end packet
+    vTaskDelay(pdMS_TO_TICKS(5000 + TIMINGS_TASK_PERIOD_MS));
+    TEST_ASSERT_EQUAL(SVC_BLE_LINK_IDLE, ble->linkProfile());
+
+    const uint8_t days[TIMINGS_DAYS] = {1, 2, 3};
+    const uint8_t shifts[TIMINGS_DAYS] = {0, 0, 0};
+    sendDays(NUMBER_OF_DAYS_HEADER, nullptr, TIMINGS_DAYS, days, shifts, TIMINGS_DAYS);
+    const PrayerTimetable *timetable = waitTimetable();
+    TEST_ASSERT_NOT_NULL(timetable);
+    svcEventRelease(timetable);
+    vTaskDelay(pdMS_TO_TICKS(TIMINGS_TASK_PERIOD_MS));
+    TEST_ASSERT_EQUAL(SVC_BLE_LINK_IDLE, ble->linkProfile());
+}
+
+void test_nothing_is_notified_without_a_client() {
+    MockBleTransport *ble = mockBleTransport();
+    ble->disconnect();
+    writeExchange(TIME_REQUEST_HEADER, 1, svcClockNowUs());
+    TEST_ASSERT_EQUAL_size_t(0, ble->notifications().size());
+}
+
+/*=============================================================================
+                                Library Entry Point
+=============================================================================*/
+
+int main(int argc, char **argv) {
+    startFirmware();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_stack_started_with_the_configured_name);
+    RUN_TEST(test_connection_is_published);
+    RUN_TEST(test_timetable_sync);
+    RUN_TEST(test_update_applies_to_the_stored_timetable);
+    RUN_TEST(test_malformed_packets_are_ignored);
+    RUN_TEST(test_current_time_sets_the_clock_and_notifies_the_status);
+    RUN_TEST(test_time_exchange_is_answered_and_applied);
+    RUN_TEST(test_sync_requests_the_bulk_link);
+    RUN_TEST(test_nothing_is_notified_without_a_client);
+    return UNITY_END();
+}
+
+/*=============================================================================
+                                Private Functions
+=============================================================================*/
+
+void dayPacket(uint8_t day, uint8_t shift, uint8_t *packet) {
+    const uint8_t header[] = {PRAYER_TIMINGS_HEADER, day, TIMINGS_MONTH, TIMINGS_YEAR / 100, TIMINGS_YEAR % 100};
+    memcpy(packet, header, sizeof(header));
+    for (int i = 0; i < SVC_PROTOCOL_PRAYER_COUNT; i++) {
+        packet[5 + i * 2] = (uint8_t) (5 + i * 3);
+        packet[6 + i * 2] = (uint8_t) ((day * 7 + i * 11 + shift) % 60);
+    }
+}
+
+void sendDays(uint8_t header, const uint8_t *base, uint8_t numberOfDays, const uint8_t *days,
+              const uint8_t *shifts, size_t count) {
+    MockBleTransport *ble = mockBleTransport();
+    uint8_t start[SVC_PROTOCOL_UPDATE_OF_DAYS_SIZE] = {header, numberOfDays};
+    size_t startLength = SVC_PROTOCOL_NUMBER_OF_DAYS_SIZE;
+    if (header == UPDATE_OF_DAYS_HEADER) {
+        memcpy(&start[2], base, SVC_PROTOCOL_HASH_SIZE);
+        startLength = SVC_PROTOCOL_UPDATE_OF_DAYS_SIZE;
+    }
+    TEST_ASSERT_TRUE(ble->write(SVC_BLE_CHAR_OPERATION, start, startLength));
+
+    for (size_t i = 0; i < count; i++) {
+        uint8_t packet[SVC_PROTOCOL_PRAYER_TIMINGS_SIZE];
+        dayPacket(days[i], shifts[i], packet);
+        TEST_ASSERT_TRUE(ble->write(SVC_BLE_CHAR_OPERATION, packet, sizeof(packet)));
+    }
+
+    const uint8_t end[SVC_PROTOCOL_END_OF_TIMINGS_SIZE] = {END_OF_TIMINGS_HEADER};
+    TEST_ASSERT_TRUE(ble->write(SVC_BLE_CHAR_OPERATION, end, sizeof(end)));
+}
+
+bool waitEvent(svcEventTopic_t topic, uint32_t timeoutMs, svcEvent_t *event) {
+    // The events of other topics published meanwhile are skipped, the timetables released
+    const uint32_t startMs = millis();
+    while (true) {
+        const uint32_t elapsedMs = millis() - startMs;
+        const TickType_t timeout = elapsedMs < timeoutMs ? pdMS_TO_TICKS(timeoutMs - elapsedMs) : 0;
+        if (!xQueueReceive(events, event, timeout)) {
+            return false;
+        }
+        if (event->topic == topic) {
+            return true;
+        }
+        if (event->topic == SVC_EVENT_TIMETABLE_UPDATED) {
+            svcEventRelease(event->data.buffer);
+        }
+    }
+}
+
+const PrayerTimetable *waitTimetable() {
+    svcEvent_t event;
+    if (!waitEvent(SVC_EVENT_TIMETABLE_UPDATED, TIMINGS_TASK_PERIOD_MS, &event)) {
+        return nullptr;
+    }
+    return (const PrayerTimetable *) event.data.buffer;
+}
+
+void writeExchange(uint8_t header, uint8_t sequence, int64_t utcUs) {
+    uint8_t packet[SVC_PROTOCOL_TIME_EXCHANGE_SIZE] = {header, sequence};
+    for (int i = 0; i < 8; i++) {
+        packet[2 + i] = (uint8_t) (utcUs >> (i * 8));
+    }
+    TEST_ASSERT_TRUE(mockBleTransport()->write(SVC_BLE_CHAR_OPERATION, packet, sizeof(packet)));
+}
+
+void startFirmware() {
+    // The order of setup(), only the timings task runs
+    modCli0Init();
+    svcConfigInit();
+    svcLogInit();
+    svcLogSetLevel(SVC_LOG_LEVEL_ERROR);
+    xTaskCreate(svcLogTaskProcess, "svcLogTask", 3072, nullptr, 1, nullptr);
+    svcTraceInit();
+    svcPowerInit();
+    svcClockInit();
+    svcEventInit();
+    svcStateInit();
+
+    events = svcEventSubscribe(SVC_EVENT_MASK(SVC_EVENT_TIMETABLE_UPDATED) | SVC_EVENT_MASK(SVC_EVENT_SYNC_CHANGED) |
+                               SVC_EVENT_MASK(SVC_EVENT_TIME_CHANGED), TIMINGS_EVENT_QUEUE_SIZE);
+    xTaskCreate(modBTETaskProcess, "modTimingsTask", 8192, nullptr, 5, nullptr);
+    // Lets the task start the stack before the first test
+    vTaskDelay(pdMS_TO_TICKS(10));
+}